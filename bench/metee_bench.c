@@ -0,0 +1,537 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+/*
+ * Library benchmark suite: init/connect/disconnect rate, round trip
+ * latency percentiles, messages per second at a given concurrency and
+ * message size, and FW status read rate, reported as one JSON object so
+ * runs of different library versions can be compared.
+ * Runs against a real device, a broker socket, the loopback backend or,
+ * when built with BUILD_SIM, an in-process firmware simulator.
+ * Requests are MKHI GET_FW_VERSION padded to the message size.
+ */
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "metee.h"
+#ifdef BENCH_SIM
+#include "metee_sim.h"
+#endif /* BENCH_SIM */
+
+#ifndef BENCH_LIB_VERSION
+#define BENCH_LIB_VERSION "unknown"
+#endif
+
+#define BENCH_MKHI_GET_FW_VERSION 0x000002FFU /* GEN group, GET_FW_VERSION command */
+#define BENCH_NSEC 1000000000ULL
+
+static const GUID bench_guid = {0x8e6a6715, 0x9abc, 0x4043,
+	{0x88, 0xef, 0x9e, 0x39, 0xc6, 0xf6, 0x3e, 0x0f}};
+
+struct bench_opts {
+	const char *backend;    /* device, broker, loopback or sim */
+	const char *path;       /* device or broker socket path */
+	size_t size;            /* request size */
+	unsigned int trips;     /* latency round trips */
+	unsigned int threads;   /* throughput concurrency */
+	unsigned int seconds;   /* throughput duration */
+	unsigned int inits;     /* init/connect/disconnect cycles */
+	unsigned int fwsts;     /* FW status reads */
+	uint32_t latency_us;    /* simulated FW latency */
+};
+
+/* workers start together once every handle is connected */
+struct bench_gate {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	unsigned int ready;
+	bool go;
+	uint64_t deadline;
+};
+
+struct bench_worker {
+	const struct bench_opts *opts;
+	const struct tee_device_address *addr;
+	struct bench_gate *gate;
+	uint64_t end;
+	uint64_t messages;
+	uint64_t errors;
+	TEESTATUS status;
+};
+
+static uint64_t bench_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * BENCH_NSEC + (uint64_t)ts.tv_nsec;
+}
+
+static double bench_rate(uint64_t count, uint64_t ns)
+{
+	return ns ? (double)count * BENCH_NSEC / (double)ns : 0;
+}
+
+static double bench_us(uint64_t ns)
+{
+	return (double)ns / 1000;
+}
+
+static TEESTATUS bench_open(const struct tee_device_address *addr, PTEEHANDLE handle)
+{
+	TEESTATUS status;
+
+	status = TeeInitFull2(handle, &bench_guid, *addr, TEE_LOG_LEVEL_QUIET, NULL);
+	if (status)
+		return status;
+	status = TeeConnect(handle);
+	if (status)
+		TeeDisconnect(handle);
+	return status;
+}
+
+/* one request and its response */
+static TEESTATUS bench_trip(PTEEHANDLE handle, const uint8_t *req, size_t size,
+			    uint8_t *rsp, size_t rsp_size)
+{
+	TEESTATUS status;
+	size_t bytes;
+
+	status = TeeWrite(handle, req, size, &bytes, 1000);
+	if (status)
+		return status;
+	return TeeRead(handle, rsp, rsp_size, &bytes, 1000);
+}
+
+static uint8_t *bench_request(size_t size)
+{
+	uint32_t hdr = BENCH_MKHI_GET_FW_VERSION;
+	uint8_t *req = calloc(1, size);
+
+	if (req)
+		memcpy(req, &hdr, size < sizeof(hdr) ? size : sizeof(hdr));
+	return req;
+}
+
+static int bench_cmp(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a;
+	uint64_t y = *(const uint64_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+/* nearest rank percentile in permille of sorted samples */
+static uint64_t bench_percentile(const uint64_t *samples, size_t n, unsigned int permille)
+{
+	size_t rank = (n * permille + 999) / 1000;
+
+	return samples[rank ? rank - 1 : 0];
+}
+
+static TEESTATUS bench_init(const struct bench_opts *opts, const struct tee_device_address *addr)
+{
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	TEESTATUS status;
+	uint64_t start, ns;
+	unsigned int i;
+
+	start = bench_now();
+	for (i = 0; i < opts->inits; i++) {
+		status = bench_open(addr, &handle);
+		if (status) {
+			fprintf(stderr, "init %u failed %u\n", i, status);
+			return status;
+		}
+		TeeDisconnect(&handle);
+	}
+	ns = bench_now() - start;
+
+	printf("  \"init\": {\"count\": %u, \"seconds\": %.3f, \"ops_per_sec\": %.1f},\n",
+	       opts->inits, (double)ns / BENCH_NSEC, bench_rate(opts->inits, ns));
+	return TEE_SUCCESS;
+}
+
+static TEESTATUS bench_latency(const struct bench_opts *opts, PTEEHANDLE handle)
+{
+	size_t rsp_size = TeeGetMaxMsgLen(handle);
+	uint64_t *samples = NULL;
+	uint8_t *req = NULL;
+	uint8_t *rsp = NULL;
+	TEESTATUS status = TEE_INTERNAL_ERROR;
+	uint64_t start, sum = 0;
+	unsigned int i;
+
+	samples = calloc(opts->trips, sizeof(*samples));
+	req = bench_request(opts->size);
+	rsp = malloc(rsp_size);
+	if (!samples || !req || !rsp)
+		goto End;
+
+	for (i = 0; i < opts->trips; i++) {
+		start = bench_now();
+		status = bench_trip(handle, req, opts->size, rsp, rsp_size);
+		if (status) {
+			fprintf(stderr, "round trip %u failed %u\n", i, status);
+			goto End;
+		}
+		samples[i] = bench_now() - start;
+		sum += samples[i];
+	}
+	qsort(samples, opts->trips, sizeof(*samples), bench_cmp);
+
+	printf("  \"latency\": {\"count\": %u, \"size\": %zu, \"min_us\": %.2f, \"mean_us\": %.2f, "
+	       "\"p50_us\": %.2f, \"p99_us\": %.2f, \"p999_us\": %.2f, \"max_us\": %.2f},\n",
+	       opts->trips, opts->size, bench_us(samples[0]), bench_us(sum / opts->trips),
+	       bench_us(bench_percentile(samples, opts->trips, 500)),
+	       bench_us(bench_percentile(samples, opts->trips, 990)),
+	       bench_us(bench_percentile(samples, opts->trips, 999)),
+	       bench_us(samples[opts->trips - 1]));
+	status = TEE_SUCCESS;
+End:
+	free(rsp);
+	free(req);
+	free(samples);
+	return status;
+}
+
+static void *bench_worker_run(void *arg)
+{
+	struct bench_worker *w = arg;
+	struct bench_gate *gate = w->gate;
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	uint8_t *req = NULL;
+	uint8_t *rsp = NULL;
+	uint64_t deadline;
+	size_t rsp_size;
+
+	w->status = bench_open(w->addr, &handle);
+	pthread_mutex_lock(&gate->lock);
+	gate->ready++;
+	pthread_cond_broadcast(&gate->cond);
+	while (!gate->go)
+		pthread_cond_wait(&gate->cond, &gate->lock);
+	deadline = gate->deadline;
+	pthread_mutex_unlock(&gate->lock);
+	if (w->status)
+		return NULL;
+
+	rsp_size = TeeGetMaxMsgLen(&handle);
+	req = bench_request(w->opts->size);
+	rsp = malloc(rsp_size);
+	if (!req || !rsp) {
+		w->status = TEE_INTERNAL_ERROR;
+		goto End;
+	}
+	while ((w->end = bench_now()) < deadline) {
+		if (bench_trip(&handle, req, w->opts->size, rsp, rsp_size))
+			w->errors++;
+		else
+			w->messages++;
+	}
+End:
+	free(rsp);
+	free(req);
+	TeeDisconnect(&handle);
+	return NULL;
+}
+
+static TEESTATUS bench_throughput(const struct bench_opts *opts, const struct tee_device_address *addr)
+{
+	struct bench_gate gate = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0, false, 0};
+	struct bench_worker *workers;
+	pthread_t *threads;
+	TEESTATUS status = TEE_SUCCESS;
+	uint64_t messages = 0, errors = 0;
+	uint64_t begin, ns = 0;
+	unsigned int created;
+	unsigned int i;
+
+	workers = calloc(opts->threads, sizeof(*workers));
+	threads = calloc(opts->threads, sizeof(*threads));
+	if (!workers || !threads) {
+		free(threads);
+		free(workers);
+		return TEE_INTERNAL_ERROR;
+	}
+
+	for (created = 0; created < opts->threads; created++) {
+		workers[created].opts = opts;
+		workers[created].addr = addr;
+		workers[created].gate = &gate;
+		if (pthread_create(&threads[created], NULL, bench_worker_run, &workers[created])) {
+			status = TEE_INTERNAL_ERROR;
+			break;
+		}
+	}
+
+	pthread_mutex_lock(&gate.lock);
+	while (gate.ready < created)
+		pthread_cond_wait(&gate.cond, &gate.lock);
+	begin = bench_now();
+	/* a failed start releases the workers with a past deadline */
+	gate.deadline = status ? 0 : begin + (uint64_t)opts->seconds * BENCH_NSEC;
+	gate.go = true;
+	pthread_cond_broadcast(&gate.cond);
+	pthread_mutex_unlock(&gate.lock);
+
+	for (i = 0; i < created; i++) {
+		pthread_join(threads[i], NULL);
+		if (workers[i].status && !status) {
+			fprintf(stderr, "worker %u failed %u\n", i, workers[i].status);
+			status = workers[i].status;
+		}
+		if (workers[i].end > begin && workers[i].end - begin > ns)
+			ns = workers[i].end - begin;
+		messages += workers[i].messages;
+		errors += workers[i].errors;
+	}
+	free(threads);
+	free(workers);
+	if (status)
+		return status;
+
+	printf("  \"throughput\": {\"threads\": %u, \"size\": %zu, \"seconds\": %.3f, "
+	       "\"messages\": %llu, \"errors\": %llu, \"messages_per_sec\": %.1f, \"bytes_per_sec\": %.1f}\n",
+	       opts->threads, opts->size, (double)ns / BENCH_NSEC,
+	       (unsigned long long)messages, (unsigned long long)errors,
+	       bench_rate(messages, ns), bench_rate(messages * opts->size, ns));
+	return TEE_SUCCESS;
+}
+
+static TEESTATUS bench_fwstatus(const struct bench_opts *opts, PTEEHANDLE handle)
+{
+	TEESTATUS status;
+	uint64_t start, ns;
+	uint32_t value;
+	unsigned int i;
+
+	status = TeeFWStatus(handle, 0, &value);
+	if (status == TEE_NOTSUPPORTED) {
+		printf("  \"fw_status\": {\"supported\": false},\n");
+		return TEE_SUCCESS;
+	}
+
+	start = bench_now();
+	for (i = 0; i < opts->fwsts && !status; i++)
+		status = TeeFWStatus(handle, 0, &value);
+	ns = bench_now() - start;
+	if (status) {
+		fprintf(stderr, "FW status read %u failed %u\n", i, status);
+		return status;
+	}
+
+	printf("  \"fw_status\": {\"supported\": true, \"count\": %u, \"ops_per_sec\": %.1f},\n",
+	       opts->fwsts, bench_rate(opts->fwsts, ns));
+	return TEE_SUCCESS;
+}
+
+static void usage(const char *p)
+{
+	fprintf(stderr, "Usage: %s [-h] [-b <backend>] [-p <path>] [-s <size>] [-n <count>]\n"
+			"          [-c <threads>] [-t <seconds>] [-i <count>] [-f <count>] [-l <us>]\n", p);
+	fprintf(stderr, "        -h                help\n");
+	fprintf(stderr, "        -b <backend>      device (default), broker, loopback"
+#ifdef BENCH_SIM
+			", sim"
+#endif /* BENCH_SIM */
+			"\n");
+	fprintf(stderr, "        -p <path>         device path or broker socket path\n");
+	fprintf(stderr, "        -s <size>         request size in bytes (default: 4)\n");
+	fprintf(stderr, "        -n <count>        latency round trips (default: 10000)\n");
+	fprintf(stderr, "        -c <threads>      throughput concurrency, a handle each (default: 1)\n");
+	fprintf(stderr, "        -t <seconds>      throughput duration (default: 2)\n");
+	fprintf(stderr, "        -i <count>        init/connect/disconnect cycles (default: 1000)\n");
+	fprintf(stderr, "        -f <count>        FW status reads (default: 10000)\n");
+	fprintf(stderr, "        -l <us>           simulated FW latency in microseconds (default: 0)\n");
+}
+
+static bool bench_uint(const char *arg, unsigned int *value, bool zero)
+{
+	return sscanf(arg, "%u", value) == 1 && (zero || *value);
+}
+
+/* JSON string of a path */
+static void bench_json_str(const char *str)
+{
+	putchar('"');
+	for (; str && *str; str++) {
+		if (*str == '"' || *str == '\\')
+			putchar('\\');
+		putchar(*str);
+	}
+	putchar('"');
+}
+
+#ifdef BENCH_SIM
+static void *bench_sim_run(void *arg)
+{
+	metee_sim_run(arg);
+	return NULL;
+}
+
+/* MKHI client without connection limit served on a private socket */
+static TEESTATUS bench_sim_start(const struct bench_opts *opts, char *path, size_t len,
+				 struct metee_sim **sim, pthread_t *runner)
+{
+	struct metee_sim_config cfg;
+	struct metee_sim_client client;
+	TEESTATUS status;
+
+	snprintf(path, len, "/tmp/metee-bench-%d.sock", (int)getpid());
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.socket_path = path;
+	status = metee_sim_create(&cfg, sim);
+	if (status)
+		return status;
+	metee_sim_client_preset(METEE_SIM_MKHI, &client);
+	client.max_conn = 0;
+	client.latency_us = opts->latency_us;
+	status = metee_sim_add_client(*sim, &client);
+	if (!status && pthread_create(runner, NULL, bench_sim_run, *sim))
+		status = TEE_INTERNAL_ERROR;
+	if (status)
+		metee_sim_destroy(*sim);
+	return status;
+}
+#endif /* BENCH_SIM */
+
+int main(int argc, char *argv[])
+{
+	struct bench_opts opts = {"device", NULL, 4, 10000, 1, 2, 1000, 10000, 0};
+	struct tee_device_address addr;
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	TEESTATUS status;
+	unsigned int size;
+	int ret = EXIT_FAILURE;
+	int opt;
+#ifdef BENCH_SIM
+	struct metee_sim *sim = NULL;
+	pthread_t runner;
+	char sim_path[64];
+#endif /* BENCH_SIM */
+
+	while ((opt = getopt(argc, argv, "hb:p:s:n:c:t:i:f:l:")) != -1) {
+		bool ok = true;
+
+		switch (opt) {
+		case 'b':
+			opts.backend = optarg;
+			break;
+		case 'p':
+			opts.path = optarg;
+			break;
+		case 's':
+			ok = bench_uint(optarg, &size, false);
+			opts.size = size;
+			break;
+		case 'n':
+			ok = bench_uint(optarg, &opts.trips, false);
+			break;
+		case 'c':
+			ok = bench_uint(optarg, &opts.threads, false);
+			break;
+		case 't':
+			ok = bench_uint(optarg, &opts.seconds, false);
+			break;
+		case 'i':
+			ok = bench_uint(optarg, &opts.inits, false);
+			break;
+		case 'f':
+			ok = bench_uint(optarg, &opts.fwsts, false);
+			break;
+		case 'l':
+			ok = bench_uint(optarg, &opts.latency_us, true);
+			break;
+		case 'h':
+			usage(argv[0]);
+			return EXIT_SUCCESS;
+		default:
+			ok = false;
+			break;
+		}
+		if (!ok) {
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	if (!strcmp(opts.backend, "device")) {
+		addr.type = opts.path ? TEE_DEVICE_TYPE_PATH : TEE_DEVICE_TYPE_NONE;
+		addr.data.path = opts.path;
+	} else if (!strcmp(opts.backend, "broker") && opts.path) {
+		addr.type = TEE_DEVICE_TYPE_BROKER;
+		addr.data.path = opts.path;
+	} else if (!strcmp(opts.backend, "loopback")) {
+		addr.type = TEE_DEVICE_TYPE_LOOPBACK;
+#ifdef BENCH_SIM
+	} else if (!strcmp(opts.backend, "sim")) {
+		status = bench_sim_start(&opts, sim_path, sizeof(sim_path), &sim, &runner);
+		if (status) {
+			fprintf(stderr, "simulator start failed %u\n", status);
+			return EXIT_FAILURE;
+		}
+		addr.type = TEE_DEVICE_TYPE_BROKER;
+		addr.data.path = sim_path;
+		opts.path = sim_path;
+#endif /* BENCH_SIM */
+	} else {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	status = bench_open(&addr, &handle);
+	if (status) {
+		fprintf(stderr, "connect failed %u\n", status);
+		goto out;
+	}
+	if (opts.size > TeeGetMaxMsgLen(&handle)) {
+		fprintf(stderr, "size %zu is above the client MTU %u\n", opts.size, TeeGetMaxMsgLen(&handle));
+		goto out;
+	}
+
+	printf("{\n  \"library\": \"%s\",\n  \"backend\": ", BENCH_LIB_VERSION);
+	bench_json_str(opts.backend);
+	printf(",\n  \"path\": ");
+	if (opts.path)
+		bench_json_str(opts.path);
+	else
+		printf("null");
+	printf(",\n  \"max_msg_len\": %u,\n  \"protocol_ver\": %u,\n",
+	       TeeGetMaxMsgLen(&handle), TeeGetProtocolVer(&handle));
+
+	/* FW clients may accept one connection, sections run one at a time */
+	TeeDisconnect(&handle);
+	if (bench_init(&opts, &addr))
+		goto out;
+	status = bench_open(&addr, &handle);
+	if (status) {
+		fprintf(stderr, "connect failed %u\n", status);
+		goto out;
+	}
+	if (bench_latency(&opts, &handle) || bench_fwstatus(&opts, &handle))
+		goto out;
+	TeeDisconnect(&handle);
+	if (bench_throughput(&opts, &addr))
+		goto out;
+	printf("}\n");
+	ret = EXIT_SUCCESS;
+out:
+	TeeDisconnect(&handle);
+#ifdef BENCH_SIM
+	if (sim) {
+		metee_sim_stop(sim);
+		pthread_join(runner, NULL);
+		metee_sim_destroy(sim);
+	}
+#endif /* BENCH_SIM */
+	return ret;
+}
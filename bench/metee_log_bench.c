@@ -0,0 +1,229 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+/*
+ * Per-call cost of TeeRead/TeeWrite with the log level checks in place
+ * (runtime quiet) or removed at build time (METEE_MIN_LOG_LEVEL=0).
+ * The same source is linked against both library builds; the device is
+ * an in-process echo peer speaking the broker protocol, so no firmware
+ * is needed. With -t the handle logs verbose into the trace ring,
+ * drained and formatted by a separate thread.
+ */
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "metee.h"
+#include "metee_broker_proto.h"
+
+#ifndef BENCH_VARIANT
+#define BENCH_VARIANT "runtime-quiet"
+#endif
+
+#define BENCH_MTU 4096
+
+static const GUID bench_guid = {0x8e6a6715, 0x9abc, 0x4043,
+	{0x88, 0xef, 0x9e, 0x39, 0xc6, 0xf6, 0x3e, 0x0f}};
+
+/* answer BROKER_CONNECT and echo every BROKER_DATA */
+static void *bench_peer(void *arg)
+{
+	int listen_fd = *(int *)arg;
+	uint8_t buf[BENCH_MTU];
+	struct broker_hdr hdr;
+	ssize_t rc;
+	int fd;
+
+	fd = accept(listen_fd, NULL, NULL);
+	if (fd < 0)
+		return NULL;
+	while ((rc = broker_recv(fd, &hdr, buf, sizeof(buf), NULL)) > 0) {
+		size_t len = (size_t)rc - sizeof(hdr);
+
+		if (hdr.type == BROKER_CONNECT) {
+			struct broker_connect_rsp rsp;
+
+			memset(&rsp, 0, sizeof(rsp));
+			rsp.max_msg_len = BENCH_MTU;
+			rsp.protocol_ver = 1;
+			hdr.status = TEE_SUCCESS;
+			hdr.param = 0;
+			broker_send(fd, &hdr, &rsp, sizeof(rsp));
+		} else {
+			hdr.status = TEE_SUCCESS;
+			broker_send(fd, &hdr, buf, len);
+		}
+	}
+	close(fd);
+	return NULL;
+}
+
+static volatile bool bench_tracing;
+static uint64_t bench_traced;
+static uint64_t bench_dropped;
+
+static void bench_trace_count(void *ctx, const struct tee_trace_record *record)
+{
+	(void)record;
+	(*(uint64_t *)ctx)++;
+}
+
+static void *bench_drain(void *arg)
+{
+	uint64_t dropped;
+
+	(void)arg;
+	while (bench_tracing) {
+		if (TeeTraceDrain(bench_trace_count, &bench_traced, &dropped) == TEE_SUCCESS)
+			bench_dropped += dropped;
+		usleep(1000);
+	}
+	if (TeeTraceDrain(bench_trace_count, &bench_traced, &dropped) == TEE_SUCCESS)
+		bench_dropped += dropped;
+	return NULL;
+}
+
+static double bench_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1000000000 + (double)ts.tv_nsec;
+}
+
+static void usage(const char *p)
+{
+	fprintf(stderr, "Usage: %s [-h] [-t] [-n <count>]\n", p);
+	fprintf(stderr, "        -h                help\n");
+	fprintf(stderr, "        -t                verbose log into trace ring\n");
+	fprintf(stderr, "        -n <count>        round trips (default: 200000), rejected calls are 50 times more\n");
+}
+
+int main(int argc, char *argv[])
+{
+	struct tee_device_address addr;
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	struct sockaddr_un sa;
+	uint8_t buf[64] = {0};
+	unsigned int count = 200000;
+	unsigned int i;
+	pthread_t peer, drain;
+	bool trace = false;
+	char path[64];
+	double start, reject_ns, trip_ns;
+	size_t bytes;
+	TEESTATUS status;
+	int listen_fd;
+	int ret = EXIT_FAILURE;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "htn:")) != -1) {
+		switch (opt) {
+		case 't':
+			trace = true;
+			break;
+		case 'n':
+			if (sscanf(optarg, "%u", &count) != 1 || !count) {
+				usage(argv[0]);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'h':
+			usage(argv[0]);
+			return EXIT_SUCCESS;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	snprintf(path, sizeof(path), "/tmp/metee-log-bench-%d.sock", (int)getpid());
+	listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (listen_fd < 0)
+		return EXIT_FAILURE;
+	memset(&sa, 0, sizeof(sa));
+	sa.sun_family = AF_UNIX;
+	strncpy(sa.sun_path, path, sizeof(sa.sun_path) - 1);
+	if (bind(listen_fd, (struct sockaddr *)&sa, sizeof(sa)) || listen(listen_fd, 1) ||
+	    pthread_create(&peer, NULL, bench_peer, &listen_fd)) {
+		fprintf(stderr, "cannot listen on %s\n", path);
+		close(listen_fd);
+		unlink(path);
+		return EXIT_FAILURE;
+	}
+
+	addr.type = TEE_DEVICE_TYPE_BROKER;
+	addr.data.path = path;
+	status = TeeInitFull2(&handle, &bench_guid, addr, TEE_LOG_LEVEL_QUIET, NULL);
+	if (!status)
+		status = TeeConnect(&handle);
+	if (status) {
+		fprintf(stderr, "connect failed %u\n", status);
+		goto out;
+	}
+	if (trace) {
+		status = TeeTraceStart(4 * 1024 * 1024);
+		if (status) {
+			fprintf(stderr, "trace start failed %u\n", status);
+			goto out;
+		}
+		TeeSetLogLevel(&handle, TEE_LOG_LEVEL_VERBOSE);
+		bench_tracing = true;
+		if (pthread_create(&drain, NULL, bench_drain, NULL)) {
+			bench_tracing = false;
+			goto out;
+		}
+	}
+
+	/* calls failing argument validation: entry, error and exit logging only */
+	start = bench_now();
+	for (i = 0; i < count * 50; i++) {
+		if (TeeWrite(&handle, buf, 0, NULL, 0) != TEE_INVALID_PARAMETER)
+			goto out;
+	}
+	reject_ns = (bench_now() - start) / (count * 50);
+
+	start = bench_now();
+	for (i = 0; i < count; i++) {
+		status = TeeWrite(&handle, buf, sizeof(buf), NULL, 1000);
+		if (!status)
+			status = TeeRead(&handle, buf, sizeof(buf), &bytes, 1000);
+		if (status) {
+			fprintf(stderr, "round trip %u failed %u\n", i, status);
+			goto out;
+		}
+	}
+	trip_ns = (bench_now() - start) / count;
+
+	if (trace) {
+		TeeSetLogLevel(&handle, TEE_LOG_LEVEL_QUIET);
+		bench_tracing = false;
+		pthread_join(drain, NULL);
+		TeeTraceStop();
+	}
+
+	printf("%-16s %14s %16s\n", "logging", "rejected ns", "round trip ns");
+	printf("%-16s %14.1f %16.1f\n", trace ? "verbose-trace" : BENCH_VARIANT, reject_ns, trip_ns);
+	if (trace)
+		printf("traced %llu events, dropped %llu\n",
+		       (unsigned long long)bench_traced, (unsigned long long)bench_dropped);
+	ret = EXIT_SUCCESS;
+out:
+	if (bench_tracing) {
+		bench_tracing = false;
+		pthread_join(drain, NULL);
+		TeeTraceStop();
+	}
+	TeeDisconnect(&handle);
+	pthread_join(peer, NULL);
+	close(listen_fd);
+	unlink(path);
+	return ret;
+}
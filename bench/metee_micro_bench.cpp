@@ -0,0 +1,266 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+/*
+ * Fixed library cost of a metee call: argument and state checks, entry and
+ * exit logging, handle translation, backend dispatch and status mapping.
+ * The firmware is the peer of a socket pair served inline by the benchmark
+ * thread, so replies have no latency; every Raw benchmark performs the same
+ * socket calls without the library and the difference is the overhead.
+ * The Device benchmarks take the libmei path on the first /dev/mei device,
+ * real or served by libmetee-preload.so, and are skipped without one.
+ */
+#include <benchmark/benchmark.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#include "metee.h"
+
+static const GUID bench_guid = {0x8e6a6715, 0x9abc, 0x4043,
+	{0x88, 0xef, 0x9e, 0x39, 0xc6, 0xf6, 0x3e, 0x0f}};
+
+static const uint32_t bench_mkhi_get_fw_version = 0x000002FF;
+
+/* handle on a socket pair, the benchmark thread is the firmware */
+class SocketFw {
+public:
+	SocketFw() : handle(TEEHANDLE_ZERO), fw(-1), dev(-1), ok(false)
+	{
+		struct tee_device_address addr = {};
+		int sv[2];
+
+		if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv))
+			return;
+		dev = sv[0];
+		fw = sv[1];
+		addr.type = tee_device_address::TEE_DEVICE_TYPE_SOCKET;
+		addr.data.handle = dev;
+		if (TeeInitFull2(&handle, &bench_guid, addr, TEE_LOG_LEVEL_QUIET, nullptr))
+			return;
+		ok = TeeConnect(&handle) == TEE_SUCCESS;
+	}
+
+	~SocketFw()
+	{
+		TeeDisconnect(&handle);
+		if (dev >= 0)
+			close(dev);
+		if (fw >= 0)
+			close(fw);
+	}
+
+	TEEHANDLE handle;
+	int fw;
+	int dev;
+	bool ok;
+};
+
+static void BM_GetMaxMsgLen(benchmark::State &state)
+{
+	SocketFw sf;
+
+	if (!sf.ok) {
+		state.SkipWithError("socket handle failed");
+		return;
+	}
+	for (auto _ : state)
+		benchmark::DoNotOptimize(TeeGetMaxMsgLen(&sf.handle));
+}
+BENCHMARK(BM_GetMaxMsgLen);
+
+/* rejected on argument validation, entry and exit only */
+static void BM_WriteInvalid(benchmark::State &state)
+{
+	SocketFw sf;
+	uint8_t buf[4] = {0};
+
+	if (!sf.ok) {
+		state.SkipWithError("socket handle failed");
+		return;
+	}
+	for (auto _ : state)
+		benchmark::DoNotOptimize(TeeWrite(&sf.handle, buf, 0, nullptr, 0));
+}
+BENCHMARK(BM_WriteInvalid);
+
+/* not supported by the socket backend, dispatch and status mapping only */
+static void BM_FWStatus(benchmark::State &state)
+{
+	SocketFw sf;
+	uint32_t value;
+
+	if (!sf.ok) {
+		state.SkipWithError("socket handle failed");
+		return;
+	}
+	for (auto _ : state)
+		benchmark::DoNotOptimize(TeeFWStatus(&sf.handle, 0, &value));
+}
+BENCHMARK(BM_FWStatus);
+
+static void BM_Write(benchmark::State &state)
+{
+	SocketFw sf;
+	std::vector<uint8_t> buf(static_cast<size_t>(state.range(0)));
+	size_t bytes;
+
+	if (!sf.ok) {
+		state.SkipWithError("socket handle failed");
+		return;
+	}
+	for (auto _ : state) {
+		if (TeeWrite(&sf.handle, buf.data(), buf.size(), &bytes, 1000) ||
+		    recv(sf.fw, buf.data(), buf.size(), 0) < 0) {
+			state.SkipWithError("write failed");
+			break;
+		}
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_Write)->Arg(4)->Arg(512)->Arg(4096);
+
+static void BM_RawWrite(benchmark::State &state)
+{
+	SocketFw sf;
+	std::vector<uint8_t> buf(static_cast<size_t>(state.range(0)));
+
+	if (!sf.ok) {
+		state.SkipWithError("socket handle failed");
+		return;
+	}
+	for (auto _ : state) {
+		if (send(sf.dev, buf.data(), buf.size(), MSG_NOSIGNAL | MSG_DONTWAIT) < 0 ||
+		    recv(sf.fw, buf.data(), buf.size(), 0) < 0) {
+			state.SkipWithError("write failed");
+			break;
+		}
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_RawWrite)->Arg(4)->Arg(512)->Arg(4096);
+
+static void BM_Read(benchmark::State &state)
+{
+	SocketFw sf;
+	std::vector<uint8_t> buf(static_cast<size_t>(state.range(0)));
+	size_t bytes;
+
+	if (!sf.ok) {
+		state.SkipWithError("socket handle failed");
+		return;
+	}
+	for (auto _ : state) {
+		if (send(sf.fw, buf.data(), buf.size(), MSG_NOSIGNAL) < 0 ||
+		    TeeRead(&sf.handle, buf.data(), buf.size(), &bytes, 1000)) {
+			state.SkipWithError("read failed");
+			break;
+		}
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_Read)->Arg(4)->Arg(512)->Arg(4096);
+
+static void BM_RawRead(benchmark::State &state)
+{
+	SocketFw sf;
+	std::vector<uint8_t> buf(static_cast<size_t>(state.range(0)));
+
+	if (!sf.ok) {
+		state.SkipWithError("socket handle failed");
+		return;
+	}
+	for (auto _ : state) {
+		if (send(sf.fw, buf.data(), buf.size(), MSG_NOSIGNAL) < 0 ||
+		    recv(sf.dev, buf.data(), buf.size(), MSG_TRUNC | MSG_DONTWAIT) < 0) {
+			state.SkipWithError("read failed");
+			break;
+		}
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_RawRead)->Arg(4)->Arg(512)->Arg(4096);
+
+/* handle on the first device, connected to MKHI */
+class DeviceFw {
+public:
+	DeviceFw() : handle(TEEHANDLE_ZERO), ok(false)
+	{
+		if (TeeInit(&handle, &bench_guid, nullptr))
+			return;
+		ok = TeeConnect(&handle) == TEE_SUCCESS;
+	}
+
+	~DeviceFw()
+	{
+		TeeDisconnect(&handle);
+	}
+
+	TEEHANDLE handle;
+	bool ok;
+};
+
+static void BM_DeviceRoundTrip(benchmark::State &state)
+{
+	DeviceFw df;
+	std::vector<uint8_t> rsp;
+	size_t bytes;
+
+	if (!df.ok) {
+		state.SkipWithError("no device");
+		return;
+	}
+	rsp.resize(TeeGetMaxMsgLen(&df.handle));
+	for (auto _ : state) {
+		if (TeeWrite(&df.handle, &bench_mkhi_get_fw_version, sizeof(bench_mkhi_get_fw_version),
+			     &bytes, 1000) ||
+		    TeeRead(&df.handle, rsp.data(), rsp.size(), &bytes, 1000)) {
+			state.SkipWithError("round trip failed");
+			break;
+		}
+	}
+}
+BENCHMARK(BM_DeviceRoundTrip);
+
+static void BM_DeviceRawRoundTrip(benchmark::State &state)
+{
+	DeviceFw df;
+	std::vector<uint8_t> rsp;
+	int fd;
+
+	if (!df.ok) {
+		state.SkipWithError("no device");
+		return;
+	}
+	rsp.resize(TeeGetMaxMsgLen(&df.handle));
+	fd = TeeGetDeviceHandle(&df.handle);
+	for (auto _ : state) {
+		if (write(fd, &bench_mkhi_get_fw_version, sizeof(bench_mkhi_get_fw_version)) < 0 ||
+		    read(fd, rsp.data(), rsp.size()) < 0) {
+			state.SkipWithError("round trip failed");
+			break;
+		}
+	}
+}
+BENCHMARK(BM_DeviceRawRoundTrip);
+
+static void BM_DeviceFWStatus(benchmark::State &state)
+{
+	DeviceFw df;
+	uint32_t value;
+
+	if (!df.ok) {
+		state.SkipWithError("no device");
+		return;
+	}
+	for (auto _ : state) {
+		if (TeeFWStatus(&df.handle, 0, &value)) {
+			state.SkipWithError("FW status failed");
+			break;
+		}
+	}
+}
+BENCHMARK(BM_DeviceFWStatus);
+
+BENCHMARK_MAIN();
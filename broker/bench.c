@@ -0,0 +1,240 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+/*
+ * Compare broker data paths: socket against shared memory ring.
+ * The broker runs in-process over an echo device answering every request
+ * immediately, so the numbers are the broker transport cost alone.
+ */
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "metee_broker.h"
+
+#define BENCH_MTU (64 * 1024)
+
+struct echo_dev {
+	int efd;
+	size_t len;
+	uint8_t buf[BENCH_MTU];
+};
+
+static TEESTATUS echo_open(void *ctx, const GUID *guid, void **dev,
+			   uint32_t *max_msg_len, uint8_t *protocol_ver)
+{
+	struct echo_dev *e;
+
+	(void)ctx;
+	(void)guid;
+	e = calloc(1, sizeof(*e));
+	if (!e)
+		return TEE_INTERNAL_ERROR;
+	e->efd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (e->efd < 0) {
+		free(e);
+		return TEE_INTERNAL_ERROR;
+	}
+	*dev = e;
+	*max_msg_len = BENCH_MTU;
+	*protocol_ver = 1;
+	return TEE_SUCCESS;
+}
+
+static int echo_fd(void *dev)
+{
+	return ((struct echo_dev *)dev)->efd;
+}
+
+static TEESTATUS echo_write(void *dev, const void *buffer, size_t size, uint32_t timeout)
+{
+	struct echo_dev *e = dev;
+	uint64_t value = 1;
+
+	(void)timeout;
+	memcpy(e->buf, buffer, size);
+	e->len = size;
+	if (write(e->efd, &value, sizeof(value)) < 0)
+		return TEE_INTERNAL_ERROR;
+	return TEE_SUCCESS;
+}
+
+static TEESTATUS echo_read(void *dev, void *buffer, size_t size, size_t *bytes, uint32_t timeout)
+{
+	struct echo_dev *e = dev;
+	uint64_t value;
+
+	(void)timeout;
+	if (read(e->efd, &value, sizeof(value)) < 0)
+		return TEE_TIMEOUT;
+	if (e->len > size)
+		return TEE_INSUFFICIENT_BUFFER;
+	memcpy(buffer, e->buf, e->len);
+	*bytes = e->len;
+	return TEE_SUCCESS;
+}
+
+static void echo_close(void *dev)
+{
+	struct echo_dev *e = dev;
+
+	close(e->efd);
+	free(e);
+}
+
+static const struct metee_broker_device_ops echo_ops = {
+	.open = echo_open,
+	.fd = echo_fd,
+	.write = echo_write,
+	.read = echo_read,
+	.close = echo_close,
+};
+
+static const GUID bench_guid = {0x8e6a6715, 0x9abc, 0x4043,
+	{0x88, 0xef, 0x9e, 0x39, 0xc6, 0xf6, 0x3e, 0x0f}};
+
+static void *bench_broker(void *broker)
+{
+	metee_broker_run(broker);
+	return NULL;
+}
+
+static double bench_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000;
+}
+
+static int bench_run(const char *path, bool shm, size_t size, unsigned int count)
+{
+	struct tee_device_address addr;
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	uint8_t *req = NULL, *rsp = NULL;
+	TEESTATUS status;
+	double start, elapsed;
+	size_t bytes;
+	unsigned int i;
+	int ret = 1;
+
+	addr.type = shm ? TEE_DEVICE_TYPE_BROKER_SHM : TEE_DEVICE_TYPE_BROKER;
+	addr.data.path = path;
+	status = TeeInitFull2(&handle, &bench_guid, addr, TEE_LOG_LEVEL_ERROR, NULL);
+	if (status) {
+		fprintf(stderr, "init failed %u\n", status);
+		return 1;
+	}
+	status = TeeConnect(&handle);
+	if (status) {
+		fprintf(stderr, "connect failed %u\n", status);
+		goto out;
+	}
+
+	req = calloc(1, size);
+	rsp = malloc(size);
+	if (!req || !rsp)
+		goto out;
+
+	start = bench_now();
+	for (i = 0; i < count; i++) {
+		status = TeeWrite(&handle, req, size, NULL, 1000);
+		if (!status)
+			status = TeeRead(&handle, rsp, size, &bytes, 1000);
+		if (status) {
+			fprintf(stderr, "transaction %u failed %u\n", i, status);
+			goto out;
+		}
+	}
+	elapsed = bench_now() - start;
+
+	/* throughput counts request and response */
+	printf("%-8s %8zu %10.0f %10.2f %10.1f\n", shm ? "shm" : "socket", size,
+	       count / elapsed, elapsed * 1000000 / count,
+	       (double)(2 * size) * count / elapsed / (1024 * 1024));
+	ret = 0;
+out:
+	free(req);
+	free(rsp);
+	TeeDisconnect(&handle);
+	return ret;
+}
+
+static void usage(const char *p)
+{
+	fprintf(stderr, "Usage: %s [-h] [-n <count>] [-s <size>]\n", p);
+	fprintf(stderr, "        -h                help\n");
+	fprintf(stderr, "        -n <count>        transactions per run (default: 20000)\n");
+	fprintf(stderr, "        -s <size>         message size, up to %u (default: 64, 4096 and %u)\n",
+		BENCH_MTU, BENCH_MTU);
+}
+
+int main(int argc, char *argv[])
+{
+	size_t sizes[] = {64, 4096, BENCH_MTU};
+	size_t nsizes = sizeof(sizes) / sizeof(sizes[0]);
+	struct metee_broker_config cfg;
+	struct metee_broker *broker;
+	unsigned int count = 20000;
+	char path[64];
+	pthread_t runner;
+	size_t i;
+	int ret = 0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "hn:s:")) != -1) {
+		switch (opt) {
+		case 'n':
+			if (sscanf(optarg, "%u", &count) != 1 || !count) {
+				usage(argv[0]);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 's':
+			if (sscanf(optarg, "%zu", &sizes[0]) != 1 ||
+			    !sizes[0] || sizes[0] > BENCH_MTU) {
+				usage(argv[0]);
+				return EXIT_FAILURE;
+			}
+			nsizes = 1;
+			break;
+		case 'h':
+			usage(argv[0]);
+			return EXIT_SUCCESS;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	snprintf(path, sizeof(path), "/tmp/metee-broker-bench-%d.sock", (int)getpid());
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.socket_path = path;
+	cfg.ops = &echo_ops;
+	cfg.timeout = 1000;
+	if (metee_broker_create(&cfg, &broker)) {
+		fprintf(stderr, "cannot create broker on %s\n", path);
+		return EXIT_FAILURE;
+	}
+	if (pthread_create(&runner, NULL, bench_broker, broker)) {
+		metee_broker_destroy(broker);
+		return EXIT_FAILURE;
+	}
+
+	printf("%-8s %8s %10s %10s %10s\n", "path", "size", "msg/s", "us/msg", "MB/s");
+	for (i = 0; i < nsizes && !ret; i++) {
+		ret = bench_run(path, false, sizes[i], count);
+		if (!ret)
+			ret = bench_run(path, true, sizes[i], count);
+	}
+
+	metee_broker_stop(broker);
+	pthread_join(runner, NULL);
+	metee_broker_destroy(broker);
+	return ret ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,98 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "metee_broker.h"
+
+static struct metee_broker *broker;
+
+static void broker_signal(int sig)
+{
+	(void)sig;
+	metee_broker_stop(broker);
+}
+
+static void broker_print(bool is_error, const char *msg)
+{
+	fprintf(is_error ? stderr : stdout, "metee-broker: %s", msg);
+}
+
+static void usage(const char *p)
+{
+	fprintf(stderr, "Usage: %s [-hv] [-s <socket>] [-d <device>] [-t <ms>] [-q <n>]\n", p);
+	fprintf(stderr, "        -h                help\n");
+	fprintf(stderr, "        -v                verbose\n");
+	fprintf(stderr, "        -s <socket>       listening socket (default: %s)\n",
+		METEE_BROKER_DEFAULT_SOCKET);
+	fprintf(stderr, "        -d <device>       device path (default: first device)\n");
+	fprintf(stderr, "        -t <ms>           FW response timeout (default: 30000, 0 infinite)\n");
+	fprintf(stderr, "        -q <n>            requests queued per client (default: 16)\n");
+}
+
+int main(int argc, char *argv[])
+{
+	struct metee_broker_config cfg;
+	struct sigaction sa;
+	TEESTATUS status;
+	int opt;
+
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.socket_path = METEE_BROKER_DEFAULT_SOCKET;
+	cfg.timeout = 30000;
+	cfg.log_callback = broker_print;
+
+	while ((opt = getopt(argc, argv, "hvs:d:t:q:")) != -1) {
+		switch (opt) {
+		case 'v':
+			cfg.verbose = true;
+			break;
+		case 's':
+			cfg.socket_path = optarg;
+			break;
+		case 'd':
+			cfg.ops_ctx = optarg;
+			break;
+		case 't':
+			if (sscanf(optarg, "%u", &cfg.timeout) != 1) {
+				usage(argv[0]);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'q':
+			if (sscanf(optarg, "%u", &cfg.queue_depth) != 1) {
+				usage(argv[0]);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'h':
+			usage(argv[0]);
+			return EXIT_SUCCESS;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	status = metee_broker_create(&cfg, &broker);
+	if (status) {
+		fprintf(stderr, "metee-broker: cannot listen on %s, status %u\n",
+			cfg.socket_path, status);
+		return EXIT_FAILURE;
+	}
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = broker_signal;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+	signal(SIGPIPE, SIG_IGN);
+
+	status = metee_broker_run(broker);
+	metee_broker_destroy(broker);
+	return status ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,860 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+#include <errno.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "metee_broker.h"
+#include "metee_broker_proto.h"
+
+#define BROKER_MAX_CLIENTS 64
+#define BROKER_MAX_CONNS 16
+#define BROKER_DEFAULT_QUEUE_DEPTH 16
+#define BROKER_BACKLOG 16
+#define BROKER_LOG_LEN 256
+
+struct broker_msg {
+	struct broker_msg *next;
+	size_t len;
+	uint8_t data[];
+};
+
+struct broker_conn;
+
+struct broker_client {
+	int fd;                     /* -1 when the slot is free */
+	struct broker_conn *conn;   /* FW connection, NULL before BROKER_CONNECT */
+	struct broker_msg *head;    /* queued requests */
+	struct broker_msg *tail;
+	uint32_t queued;
+	struct broker_shm_area *shm; /* shared memory data path, NULL if not attached */
+	int doorbell[3];             /* eventfds: from client, responses, request ring space */
+};
+
+struct broker_conn {
+	bool used;
+	uint32_t refs;                /* clients connected through, the slot is freed when it drops to 0 */
+	GUID guid;
+	void *dev;                    /* NULL when FW connection is closed */
+	uint32_t max_msg_len;
+	uint8_t protocol_ver;
+	bool busy;                    /* request is outstanding in FW */
+	struct broker_client *active; /* requester, NULL if it went away */
+	uint64_t deadline;            /* response deadline in ms, 0 for infinite */
+	size_t next;                  /* round robin position in clients */
+};
+
+enum broker_poll_kind {
+	BROKER_POLL_CLIENT,
+	BROKER_POLL_DOORBELL,
+	BROKER_POLL_CONN,
+};
+
+struct metee_broker {
+	struct metee_broker_config cfg;
+	int listen_fd;
+	int stop_fd;
+	struct broker_client clients[BROKER_MAX_CLIENTS];
+	struct broker_conn conns[BROKER_MAX_CONNS];
+	uint8_t buf[sizeof(struct broker_hdr) + BROKER_MAX_PAYLOAD];
+};
+
+static void broker_log(struct metee_broker *b, bool is_error, const char *fmt, ...)
+{
+	char msg[BROKER_LOG_LEN];
+	va_list varl;
+
+	if (!b->cfg.log_callback || (!is_error && !b->cfg.verbose))
+		return;
+	va_start(varl, fmt);
+	vsnprintf(msg, sizeof(msg), fmt, varl);
+	va_end(varl);
+	b->cfg.log_callback(is_error, msg);
+}
+
+/*
+ * the socket path may be left over by a broker that did not exit cleanly;
+ * remove it only if it is a socket nobody listens on
+ */
+static TEESTATUS broker_path_release(const char *path, const struct sockaddr_un *addr)
+{
+	struct stat st;
+	int fd;
+	int rc;
+
+	if (lstat(path, &st))
+		return (errno == ENOENT) ? TEE_SUCCESS : TEE_PERMISSION_DENIED;
+	if (!S_ISSOCK(st.st_mode))
+		return TEE_INVALID_PARAMETER;
+
+	fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		return TEE_INTERNAL_ERROR;
+	rc = connect(fd, (const struct sockaddr *)addr, sizeof(*addr));
+	close(fd);
+	if (!rc)
+		return TEE_BUSY;
+	if (errno != ECONNREFUSED && errno != ENOENT)
+		return TEE_INTERNAL_ERROR;
+	if (unlink(path) && errno != ENOENT)
+		return (errno == EACCES || errno == EPERM) ? TEE_PERMISSION_DENIED : TEE_INTERNAL_ERROR;
+	return TEE_SUCCESS;
+}
+
+static uint64_t broker_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+/* default device operations: metee connection */
+static TEESTATUS metee_dev_open(void *ctx, const GUID *guid, void **dev,
+				uint32_t *max_msg_len, uint8_t *protocol_ver)
+{
+	struct tee_device_address addr;
+	PTEEHANDLE handle;
+	TEESTATUS status;
+
+	handle = calloc(1, sizeof(*handle));
+	if (!handle)
+		return TEE_INTERNAL_ERROR;
+
+	addr.type = ctx ? TEE_DEVICE_TYPE_PATH : TEE_DEVICE_TYPE_NONE;
+	addr.data.path = ctx;
+	status = TeeInitFull2(handle, guid, addr, TEE_LOG_LEVEL_ERROR, NULL);
+	if (status) {
+		free(handle);
+		return status;
+	}
+	status = TeeConnect(handle);
+	if (status) {
+		TeeDisconnect(handle);
+		free(handle);
+		return status;
+	}
+	*max_msg_len = TeeGetMaxMsgLen(handle);
+	*protocol_ver = TeeGetProtocolVer(handle);
+	*dev = handle;
+	return TEE_SUCCESS;
+}
+
+static int metee_dev_fd(void *dev)
+{
+	return TeeGetDeviceHandle(dev);
+}
+
+static TEESTATUS metee_dev_write(void *dev, const void *buffer, size_t size, uint32_t timeout)
+{
+	return TeeWrite(dev, buffer, size, NULL, timeout);
+}
+
+static TEESTATUS metee_dev_read(void *dev, void *buffer, size_t size, size_t *bytes, uint32_t timeout)
+{
+	return TeeRead(dev, buffer, size, bytes, timeout);
+}
+
+static void metee_dev_close(void *dev)
+{
+	TeeDisconnect(dev);
+	free(dev);
+}
+
+static const struct metee_broker_device_ops metee_dev_ops = {
+	.open = metee_dev_open,
+	.fd = metee_dev_fd,
+	.write = metee_dev_write,
+	.read = metee_dev_read,
+	.close = metee_dev_close,
+};
+
+static void broker_reply(struct metee_broker *b, struct broker_client *cl,
+			 uint16_t type, TEESTATUS status, const void *payload, size_t len);
+static void broker_respond(struct metee_broker *b, struct broker_client *cl,
+			   TEESTATUS status, const void *payload, size_t len);
+
+static void broker_client_flush(struct broker_client *cl)
+{
+	while (cl->head) {
+		struct broker_msg *m = cl->head;
+
+		cl->head = m->next;
+		free(m);
+	}
+	cl->tail = NULL;
+	cl->queued = 0;
+}
+
+static void broker_client_shm_detach(struct broker_client *cl)
+{
+	if (!cl->shm)
+		return;
+	munmap(cl->shm, sizeof(*cl->shm));
+	close(cl->doorbell[0]);
+	close(cl->doorbell[1]);
+	close(cl->doorbell[2]);
+	cl->shm = NULL;
+}
+
+static void broker_doorbell(int fd)
+{
+	uint64_t value = 1;
+
+	/* counter overflow only, the peer is woken anyway */
+	if (write(fd, &value, sizeof(value)) < 0)
+		return;
+}
+
+/* detach the client from its connection, the slot is reaped by the run loop */
+static void broker_client_detach(struct broker_client *cl)
+{
+	if (!cl->conn)
+		return;
+	if (cl->conn->active == cl)
+		cl->conn->active = NULL;
+	cl->conn->refs--;
+	cl->conn = NULL;
+}
+
+static void broker_client_drop(struct broker_client *cl)
+{
+	broker_client_detach(cl);
+	broker_client_flush(cl);
+	broker_client_shm_detach(cl);
+	close(cl->fd);
+	cl->fd = -1;
+}
+
+static void broker_conn_close(struct metee_broker *b, struct broker_conn *conn)
+{
+	if (conn->dev)
+		b->cfg.ops->close(conn->dev);
+	conn->dev = NULL;
+	conn->busy = false;
+	conn->active = NULL;
+}
+
+static void broker_conn_free(struct metee_broker *b, struct broker_conn *conn)
+{
+	broker_conn_close(b, conn);
+	conn->used = false;
+}
+
+/*
+ * free connections without clients; runs at the end of the poll round,
+ * so a slot is never reused while its descriptor is in the poll set
+ */
+static void broker_conn_reap(struct metee_broker *b)
+{
+	size_t i;
+
+	for (i = 0; i < BROKER_MAX_CONNS; i++) {
+		if (b->conns[i].used && !b->conns[i].refs)
+			broker_conn_free(b, &b->conns[i]);
+	}
+}
+
+static TEESTATUS broker_conn_open(struct metee_broker *b, struct broker_conn *conn)
+{
+	TEESTATUS status;
+
+	if (conn->dev)
+		return TEE_SUCCESS;
+	status = b->cfg.ops->open(b->cfg.ops_ctx, &conn->guid, &conn->dev,
+				  &conn->max_msg_len, &conn->protocol_ver);
+	if (status) {
+		conn->dev = NULL;
+		broker_log(b, true, "FW client connect failed %u\n", status);
+		return status;
+	}
+	if (conn->max_msg_len > BROKER_MAX_PAYLOAD)
+		conn->max_msg_len = BROKER_MAX_PAYLOAD;
+	return TEE_SUCCESS;
+}
+
+static struct broker_conn *broker_conn_get(struct metee_broker *b, const GUID *guid)
+{
+	struct broker_conn *free_conn = NULL;
+	size_t i;
+
+	for (i = 0; i < BROKER_MAX_CONNS; i++) {
+		if (!b->conns[i].used) {
+			if (!free_conn)
+				free_conn = &b->conns[i];
+			continue;
+		}
+		if (!memcmp(&b->conns[i].guid, guid, sizeof(*guid)))
+			return &b->conns[i];
+	}
+	if (!free_conn)
+		return NULL;
+	memset(free_conn, 0, sizeof(*free_conn));
+	free_conn->used = true;
+	memcpy(&free_conn->guid, guid, sizeof(*guid));
+	return free_conn;
+}
+
+/*
+ * shared memory client has a request ready if its response ring can take the answer;
+ * a client that does not consume its responses is not served until it does
+ */
+static bool broker_client_shm_ready(struct metee_broker *b, struct broker_client *cl)
+{
+	uint32_t len;
+	uint16_t status;
+	bool err;
+
+	if (!broker_ring_peek(&cl->shm->req, cl->conn->max_msg_len, &len, &status, &err)) {
+		if (err) {
+			broker_log(b, true, "Client %d corrupted request ring, dropping\n", cl->fd);
+			broker_client_drop(cl);
+		}
+		return false;
+	}
+	if (broker_ring_fits(&cl->shm->rsp, cl->conn->max_msg_len))
+		return true;
+	return !broker_ring_wait_space(&cl->shm->rsp, cl->conn->max_msg_len);
+}
+
+/* pick next client with queued request for the connection in round robin order */
+static struct broker_client *broker_conn_next(struct metee_broker *b, struct broker_conn *conn)
+{
+	size_t i;
+
+	for (i = 0; i < BROKER_MAX_CLIENTS; i++) {
+		size_t idx = (conn->next + i) % BROKER_MAX_CLIENTS;
+		struct broker_client *cl = &b->clients[idx];
+
+		if (cl->fd == -1 || cl->conn != conn)
+			continue;
+		if (cl->shm ? broker_client_shm_ready(b, cl) : cl->head != NULL) {
+			conn->next = idx + 1;
+			return cl;
+		}
+	}
+	return NULL;
+}
+
+/* send next queued request to FW unless a request is outstanding */
+static void broker_dispatch(struct metee_broker *b, struct broker_conn *conn)
+{
+	struct broker_client *cl;
+
+	while (!conn->busy && (cl = broker_conn_next(b, conn)) != NULL) {
+		TEESTATUS status;
+
+		status = broker_conn_open(b, conn);
+		if (cl->shm) {
+			const uint8_t *payload;
+			uint32_t len;
+			uint16_t flags;
+			bool err;
+
+			/* request goes to FW straight from the client ring */
+			payload = broker_ring_peek(&cl->shm->req, conn->max_msg_len, &len, &flags, &err);
+			if (!status && payload && len)
+				status = b->cfg.ops->write(conn->dev, payload, len, b->cfg.timeout);
+			else if (!status)
+				status = TEE_INVALID_PARAMETER;
+			if (payload && broker_ring_pop(&cl->shm->req, len))
+				broker_doorbell(cl->doorbell[2]);
+		} else {
+			struct broker_msg *m = cl->head;
+
+			cl->head = m->next;
+			if (!cl->head)
+				cl->tail = NULL;
+			cl->queued--;
+			if (!status)
+				status = b->cfg.ops->write(conn->dev, m->data, m->len, b->cfg.timeout);
+			free(m);
+		}
+		if (status) {
+			if (status != TEE_INVALID_PARAMETER)
+				broker_conn_close(b, conn);
+			broker_respond(b, cl, status, NULL, 0);
+			continue;
+		}
+		conn->busy = true;
+		conn->active = cl;
+		conn->deadline = b->cfg.timeout ? broker_now() + b->cfg.timeout : 0;
+	}
+}
+
+static void broker_reply(struct metee_broker *b, struct broker_client *cl,
+			 uint16_t type, TEESTATUS status, const void *payload, size_t len)
+{
+	struct broker_hdr hdr;
+
+	hdr.type = type;
+	hdr.status = status;
+	hdr.param = 0;
+	/* never block on a client that does not read its replies */
+	if (broker_send(cl->fd, &hdr, payload, len) < 0 && errno != EINTR) {
+		broker_log(b, true, "Client %d reply failed %d, dropping\n", cl->fd, errno);
+		broker_client_drop(cl);
+	}
+}
+
+/* answer data request through the client data path */
+static void broker_respond(struct metee_broker *b, struct broker_client *cl,
+			   TEESTATUS status, const void *payload, size_t len)
+{
+	uint8_t *slot;
+
+	if (!cl->shm) {
+		broker_reply(b, cl, BROKER_DATA, status, payload, len);
+		return;
+	}
+	slot = broker_ring_reserve(&cl->shm->rsp, len);
+	if (!slot) {
+		broker_log(b, true, "Client %d response ring overflow, dropping\n", cl->fd);
+		broker_client_drop(cl);
+		return;
+	}
+	if (len)
+		memcpy(slot, payload, len);
+	broker_ring_commit(&cl->shm->rsp, len, (uint16_t)status);
+	broker_doorbell(cl->doorbell[1]);
+}
+
+static void broker_client_connect(struct metee_broker *b, struct broker_client *cl,
+				  const struct broker_hdr *hdr, size_t len)
+{
+	struct broker_connect_rsp rsp;
+	struct broker_conn *conn;
+	TEESTATUS status;
+
+	if (hdr->param != BROKER_PROTO_VERSION || len != sizeof(GUID)) {
+		broker_reply(b, cl, BROKER_CONNECT, TEE_NOTSUPPORTED, NULL, 0);
+		return;
+	}
+
+	broker_client_detach(cl);
+	broker_client_flush(cl);
+	broker_client_shm_detach(cl);
+
+	conn = broker_conn_get(b, (const GUID *)(b->buf + sizeof(*hdr)));
+	if (!conn) {
+		broker_reply(b, cl, BROKER_CONNECT, TEE_BUSY, NULL, 0);
+		return;
+	}
+	status = broker_conn_open(b, conn);
+	if (status) {
+		/* failed open has no descriptor in the poll set, the slot can go at once */
+		if (!conn->refs)
+			broker_conn_free(b, conn);
+		broker_reply(b, cl, BROKER_CONNECT, status, NULL, 0);
+		return;
+	}
+
+	cl->conn = conn;
+	conn->refs++;
+	memset(&rsp, 0, sizeof(rsp));
+	rsp.max_msg_len = conn->max_msg_len;
+	rsp.protocol_ver = conn->protocol_ver;
+	broker_reply(b, cl, BROKER_CONNECT, TEE_SUCCESS, &rsp, sizeof(rsp));
+}
+
+static void broker_client_shm_attach(struct metee_broker *b, struct broker_client *cl)
+{
+	struct broker_hdr hdr = {BROKER_SHM_ATTACH, TEE_SUCCESS, 0};
+	int fds[BROKER_SHM_FDS] = {-1, -1, -1, -1};
+	void *area = MAP_FAILED;
+	TEESTATUS status;
+	size_t i;
+
+	if (!cl->conn) {
+		status = TEE_DISCONNECTED;
+		goto End;
+	}
+	if (cl->shm || cl->head) {
+		status = TEE_BUSY;
+		goto End;
+	}
+
+	/* sealed size: client can not shrink the area under the broker */
+	fds[0] = memfd_create("metee-broker", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if (fds[0] < 0 || ftruncate(fds[0], sizeof(struct broker_shm_area)) ||
+	    fcntl(fds[0], F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL)) {
+		broker_log(b, true, "Cannot create shared memory %d\n", errno);
+		status = TEE_INTERNAL_ERROR;
+		goto End;
+	}
+	area = mmap(NULL, sizeof(struct broker_shm_area), PROT_READ | PROT_WRITE,
+		    MAP_SHARED, fds[0], 0);
+	fds[1] = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	fds[2] = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	fds[3] = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (area == MAP_FAILED || fds[1] < 0 || fds[2] < 0 || fds[3] < 0) {
+		broker_log(b, true, "Cannot map shared memory %d\n", errno);
+		status = TEE_INTERNAL_ERROR;
+		goto End;
+	}
+
+	if (broker_send_fds(cl->fd, &hdr, fds, BROKER_SHM_FDS) < 0) {
+		broker_log(b, true, "Client %d attach reply failed %d, dropping\n", cl->fd, errno);
+		munmap(area, sizeof(struct broker_shm_area));
+		for (i = 0; i < BROKER_SHM_FDS; i++)
+			close(fds[i]);
+		broker_client_drop(cl);
+		return;
+	}
+	close(fds[0]);
+	cl->shm = area;
+	cl->doorbell[0] = fds[1];
+	cl->doorbell[1] = fds[2];
+	cl->doorbell[2] = fds[3];
+	broker_log(b, false, "Client %d attached shared memory\n", cl->fd);
+	return;
+
+End:
+	if (area != MAP_FAILED)
+		munmap(area, sizeof(struct broker_shm_area));
+	for (i = 0; i < BROKER_SHM_FDS; i++) {
+		if (fds[i] >= 0)
+			close(fds[i]);
+	}
+	broker_reply(b, cl, BROKER_SHM_ATTACH, status, NULL, 0);
+}
+
+static void broker_client_data(struct metee_broker *b, struct broker_client *cl, size_t len)
+{
+	struct broker_msg *m;
+
+	if (cl->shm) {
+		broker_reply(b, cl, BROKER_DATA, TEE_NOTSUPPORTED, NULL, 0);
+		return;
+	}
+	if (!cl->conn) {
+		broker_reply(b, cl, BROKER_DATA, TEE_DISCONNECTED, NULL, 0);
+		return;
+	}
+	if (!len || len > cl->conn->max_msg_len) {
+		broker_reply(b, cl, BROKER_DATA, TEE_INVALID_PARAMETER, NULL, 0);
+		return;
+	}
+
+	m = malloc(sizeof(*m) + len);
+	if (!m) {
+		broker_reply(b, cl, BROKER_DATA, TEE_INTERNAL_ERROR, NULL, 0);
+		return;
+	}
+	m->next = NULL;
+	m->len = len;
+	memcpy(m->data, b->buf + sizeof(struct broker_hdr), len);
+	if (cl->tail)
+		cl->tail->next = m;
+	else
+		cl->head = m;
+	cl->tail = m;
+	cl->queued++;
+
+	broker_dispatch(b, cl->conn);
+}
+
+static void broker_client_recv(struct metee_broker *b, struct broker_client *cl)
+{
+	struct broker_hdr hdr;
+	int truncated;
+	ssize_t rc;
+	size_t len;
+
+	rc = broker_recv(cl->fd, &hdr, b->buf + sizeof(hdr), BROKER_MAX_PAYLOAD, &truncated);
+	if (rc <= 0) {
+		broker_client_drop(cl);
+		return;
+	}
+	/* keep header in front of payload for handlers */
+	memcpy(b->buf, &hdr, sizeof(hdr));
+	len = (size_t)rc - sizeof(hdr);
+	if (truncated) {
+		broker_reply(b, cl, hdr.type, TEE_INVALID_PARAMETER, NULL, 0);
+		return;
+	}
+
+	switch (hdr.type) {
+	case BROKER_CONNECT:
+		broker_client_connect(b, cl, &hdr, len);
+		break;
+	case BROKER_DATA:
+		broker_client_data(b, cl, len);
+		break;
+	case BROKER_SHM_ATTACH:
+		broker_client_shm_attach(b, cl);
+		break;
+	default:
+		broker_reply(b, cl, hdr.type, TEE_NOTSUPPORTED, NULL, 0);
+		break;
+	}
+}
+
+static void broker_conn_recv(struct metee_broker *b, struct broker_conn *conn)
+{
+	struct broker_client *cl = conn->active;
+	uint8_t *slot = NULL;
+	size_t bytes = 0;
+	TEESTATUS status;
+
+	/* response to shared memory client lands directly in its ring, space was checked on dispatch */
+	if (cl && cl->shm)
+		slot = broker_ring_reserve(&cl->shm->rsp, conn->max_msg_len);
+	status = b->cfg.ops->read(conn->dev, slot ? slot : b->buf, conn->max_msg_len,
+				  &bytes, b->cfg.timeout);
+	if (status == TEE_TIMEOUT)
+		return;
+	if (slot) {
+		broker_ring_commit(&cl->shm->rsp, status ? 0 : bytes, (uint16_t)status);
+		broker_doorbell(cl->doorbell[1]);
+	} else if (cl) {
+		broker_respond(b, cl, status, b->buf, status ? 0 : bytes);
+	}
+	conn->busy = false;
+	conn->active = NULL;
+	if (status) {
+		broker_log(b, true, "FW client read failed %u, reconnecting\n", status);
+		broker_conn_close(b, conn);
+	}
+	broker_dispatch(b, conn);
+}
+
+static void broker_accept(struct metee_broker *b)
+{
+	int fd;
+	size_t i;
+
+	fd = accept4(b->listen_fd, NULL, NULL, SOCK_CLOEXEC | SOCK_NONBLOCK);
+	if (fd < 0)
+		return;
+	for (i = 0; i < BROKER_MAX_CLIENTS; i++) {
+		if (b->clients[i].fd == -1) {
+			memset(&b->clients[i], 0, sizeof(b->clients[i]));
+			b->clients[i].fd = fd;
+			broker_log(b, false, "Client %d accepted\n", fd);
+			return;
+		}
+	}
+	broker_log(b, true, "Too many clients\n");
+	close(fd);
+}
+
+static void broker_expire(struct metee_broker *b, uint64_t now)
+{
+	size_t i;
+
+	for (i = 0; i < BROKER_MAX_CONNS; i++) {
+		struct broker_conn *conn = &b->conns[i];
+
+		if (!conn->used || !conn->busy || !conn->deadline || conn->deadline > now)
+			continue;
+		if (conn->active)
+			broker_respond(b, conn->active, TEE_TIMEOUT, NULL, 0);
+		/* late response must not reach the next requester */
+		broker_log(b, true, "FW client response timeout, reconnecting\n");
+		broker_conn_close(b, conn);
+		broker_dispatch(b, conn);
+	}
+}
+
+TEESTATUS metee_broker_create(const struct metee_broker_config *config,
+			      struct metee_broker **broker)
+{
+	struct sockaddr_un addr;
+	struct metee_broker *b;
+	TEESTATUS status;
+	size_t len;
+	size_t i;
+
+	if (!config || !config->socket_path || !broker)
+		return TEE_INVALID_PARAMETER;
+	len = strlen(config->socket_path);
+	if (len == 0 || len >= sizeof(addr.sun_path))
+		return TEE_INVALID_PARAMETER;
+
+	b = calloc(1, sizeof(*b));
+	if (!b)
+		return TEE_INTERNAL_ERROR;
+	b->cfg = *config;
+	if (!b->cfg.ops)
+		b->cfg.ops = &metee_dev_ops;
+	if (!b->cfg.queue_depth)
+		b->cfg.queue_depth = BROKER_DEFAULT_QUEUE_DEPTH;
+	for (i = 0; i < BROKER_MAX_CLIENTS; i++)
+		b->clients[i].fd = -1;
+
+	b->stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (b->stop_fd < 0) {
+		status = TEE_INTERNAL_ERROR;
+		goto err_free;
+	}
+
+	b->listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (b->listen_fd < 0) {
+		status = TEE_INTERNAL_ERROR;
+		goto err_stop;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	memcpy(addr.sun_path, config->socket_path, len);
+	status = broker_path_release(config->socket_path, &addr);
+	if (status) {
+		broker_log(b, true, "Cannot take over %s: %u\n", config->socket_path, status);
+		goto err_listen;
+	}
+	if (bind(b->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) ||
+	    listen(b->listen_fd, BROKER_BACKLOG)) {
+		status = (errno == EACCES) ? TEE_PERMISSION_DENIED : TEE_INTERNAL_ERROR;
+		broker_log(b, true, "Cannot listen on %s: %d\n", config->socket_path, errno);
+		goto err_listen;
+	}
+
+	*broker = b;
+	return TEE_SUCCESS;
+
+err_listen:
+	close(b->listen_fd);
+err_stop:
+	close(b->stop_fd);
+err_free:
+	free(b);
+	return status;
+}
+
+TEESTATUS metee_broker_run(struct metee_broker *b)
+{
+	struct pollfd pfd[2 + 2 * BROKER_MAX_CLIENTS + BROKER_MAX_CONNS];
+	void *owner[2 + 2 * BROKER_MAX_CLIENTS + BROKER_MAX_CONNS];
+	enum broker_poll_kind kind[2 + 2 * BROKER_MAX_CLIENTS + BROKER_MAX_CONNS];
+	uint64_t value;
+
+	if (!b)
+		return TEE_INVALID_PARAMETER;
+
+	while (true) {
+		nfds_t n = 2;
+		nfds_t i;
+		uint64_t now = broker_now();
+		uint64_t deadline = 0;
+		int timeout = -1;
+
+		pfd[0].fd = b->stop_fd;
+		pfd[0].events = POLLIN;
+		pfd[1].fd = b->listen_fd;
+		pfd[1].events = POLLIN;
+		for (i = 0; i < BROKER_MAX_CLIENTS; i++) {
+			struct broker_client *cl = &b->clients[i];
+
+			if (cl->fd == -1)
+				continue;
+			pfd[n].fd = cl->fd;
+			pfd[n].events = (cl->queued < b->cfg.queue_depth) ? POLLIN : 0;
+			kind[n] = BROKER_POLL_CLIENT;
+			owner[n++] = cl;
+			if (cl->shm) {
+				pfd[n].fd = cl->doorbell[0];
+				pfd[n].events = POLLIN;
+				kind[n] = BROKER_POLL_DOORBELL;
+				owner[n++] = cl;
+			}
+		}
+		for (i = 0; i < BROKER_MAX_CONNS; i++) {
+			struct broker_conn *conn = &b->conns[i];
+
+			if (!conn->used || !conn->busy || !conn->dev)
+				continue;
+			pfd[n].fd = b->cfg.ops->fd(conn->dev);
+			pfd[n].events = POLLIN;
+			kind[n] = BROKER_POLL_CONN;
+			owner[n++] = conn;
+			if (conn->deadline && (!deadline || conn->deadline < deadline))
+				deadline = conn->deadline;
+		}
+		if (deadline)
+			timeout = (deadline > now) ? (int)(deadline - now) : 0;
+
+		if (poll(pfd, n, timeout) < 0) {
+			if (errno == EINTR)
+				continue;
+			return TEE_INTERNAL_ERROR;
+		}
+
+		if (pfd[0].revents) {
+			if (read(b->stop_fd, &value, sizeof(value)) < 0) {
+				/* nothing to do, stop anyway */
+			}
+			return TEE_SUCCESS;
+		}
+		if (pfd[1].revents & POLLIN)
+			broker_accept(b);
+		for (i = 2; i < n; i++) {
+			struct broker_client *cl = owner[i];
+			struct broker_conn *conn = owner[i];
+
+			if (!pfd[i].revents)
+				continue;
+			switch (kind[i]) {
+			case BROKER_POLL_CLIENT:
+				if (cl->fd != -1)
+					broker_client_recv(b, cl);
+				break;
+			case BROKER_POLL_DOORBELL:
+				/* ring state is the source of truth, the counter only wakes us */
+				if (cl->shm && read(cl->doorbell[0], &value, sizeof(value)) >= 0 && cl->conn)
+					broker_dispatch(b, cl->conn);
+				break;
+			case BROKER_POLL_CONN:
+				if (conn->busy && conn->dev)
+					broker_conn_recv(b, conn);
+				break;
+			}
+		}
+		broker_expire(b, broker_now());
+		broker_conn_reap(b);
+	}
+}
+
+void metee_broker_stop(struct metee_broker *b)
+{
+	uint64_t value = 1;
+
+	if (!b)
+		return;
+	if (write(b->stop_fd, &value, sizeof(value)) < 0) {
+		/* eventfd counter overflow only, already signaled */
+	}
+}
+
+void metee_broker_destroy(struct metee_broker *b)
+{
+	size_t i;
+
+	if (!b)
+		return;
+	for (i = 0; i < BROKER_MAX_CLIENTS; i++) {
+		if (b->clients[i].fd != -1)
+			broker_client_drop(&b->clients[i]);
+	}
+	for (i = 0; i < BROKER_MAX_CONNS; i++) {
+		if (b->conns[i].used)
+			broker_conn_free(b, &b->conns[i]);
+	}
+	close(b->listen_fd);
+	close(b->stop_fd);
+	unlink(b->cfg.socket_path);
+	free(b);
+}
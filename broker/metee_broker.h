@@ -0,0 +1,87 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+/*! \file metee_broker.h
+ *  \brief metee broker core: multiplexes FW client connections across local processes
+ */
+#ifndef __METEE_BROKER_H
+#define __METEE_BROKER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "metee.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! Default broker socket path */
+#define METEE_BROKER_DEFAULT_SOCKET "/run/metee-broker.sock"
+
+/*! Device operations used by the broker to reach the firmware */
+struct metee_broker_device_ops {
+	/*! Open and connect FW client
+	 *  \param ctx ops context from configuration
+	 *  \param guid FW client GUID
+	 *  \param dev opened device
+	 *  \param max_msg_len FW client MTU
+	 *  \param protocol_ver FW client protocol version
+	 */
+	TEESTATUS (*open)(void *ctx, const GUID *guid, void **dev,
+			  uint32_t *max_msg_len, uint8_t *protocol_ver);
+	/*! Descriptor polled for FW response */
+	int (*fd)(void *dev);
+	/*! Write request to FW client */
+	TEESTATUS (*write)(void *dev, const void *buffer, size_t size, uint32_t timeout);
+	/*! Read response from FW client */
+	TEESTATUS (*read)(void *dev, void *buffer, size_t size, size_t *bytes, uint32_t timeout);
+	/*! Disconnect and free device */
+	void (*close)(void *dev);
+};
+
+/*! Broker configuration */
+struct metee_broker_config {
+	const char *socket_path; /**< listening socket path */
+	const struct metee_broker_device_ops *ops; /**< device operations, NULL for metee devices */
+	void *ops_ctx; /**< ops context, for metee devices device path or NULL for default device */
+	uint32_t timeout; /**< FW response timeout in milliseconds, zero for infinite */
+	uint32_t queue_depth; /**< requests queued per client, zero for default */
+	TeeLogCallback2 log_callback; /**< log callback, may be NULL */
+	bool verbose; /**< log every request */
+};
+
+struct metee_broker;
+
+/*! Create broker and bind listening socket
+ *  A stale socket left at the path is replaced, a live one is not.
+ *  \param config broker configuration
+ *  \param broker created broker
+ *  \return 0 if successful, TEE_BUSY if another broker listens on the path,
+ *          TEE_INVALID_PARAMETER if the path is not a socket, otherwise error code
+ */
+TEESTATUS metee_broker_create(const struct metee_broker_config *config,
+			      struct metee_broker **broker);
+
+/*! Serve clients until metee_broker_stop() is called
+ *  \param broker the broker
+ *  \return 0 if stopped, otherwise error code
+ */
+TEESTATUS metee_broker_run(struct metee_broker *broker);
+
+/*! Stop metee_broker_run(), async-signal-safe
+ *  \param broker the broker
+ */
+void metee_broker_stop(struct metee_broker *broker);
+
+/*! Close all connections, remove socket and free broker
+ *  \param broker the broker
+ */
+void metee_broker_destroy(struct metee_broker *broker);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __METEE_BROKER_H */
@@ -76,16 +76,47 @@ extern "C" {
 
 	#define IS_HANDLE_INVALID(h) (NULL == h || 0 == h->handle || -1 == h->handle)
 	#define INIT_STATUS -EPERM
+
+	bool StructuredCallbackSet(IN PTEEHANDLE handle);
+	void StructuredPrintHelper(IN PTEEHANDLE handle, bool is_error, const char *file,
+				   const char *func, int line, const char *fmt, ...);
+	#define STRUCTURED_CALLBACK_SET(h) StructuredCallbackSet(h)
+	#define STRUCTURED_PRINT(h, is_err, _x_, ...) \
+		StructuredPrintHelper((h), is_err, __FILE__, __FUNCTION__, __LINE__, _x_, ##__VA_ARGS__);
 #endif /* _WIN32 */
 
+#ifndef STRUCTURED_PRINT
+	#define STRUCTURED_CALLBACK_SET(h) 0
+	#define STRUCTURED_PRINT(h, is_err, _x_, ...) {}
+#endif /* STRUCTURED_PRINT */
+
+/* Lowest log level compiled in, prints above it are removed at compile time */
+#ifndef METEE_MIN_LOG_LEVEL
+	#define METEE_MIN_LOG_LEVEL TEE_LOG_LEVEL_VERBOSE
+#endif
+
+#ifdef METEE_TRACE
+	#include "metee_trace.h"
+	#define TRACE_ACTIVE() metee_trace_active()
+	#define TRACE_PRINT(h, is_err, _x_, ...) \
+		METEE_TRACE_RECORD((h)->handle, is_err, NULL, 0, _x_, ##__VA_ARGS__)
+#else
+	#define TRACE_ACTIVE() 0
+	#define TRACE_PRINT(h, is_err, _x_, ...) {}
+#endif /* METEE_TRACE */
+
 #define LEGACY_CALLBACK_SET(h) ((h)->log_callback ? 1 : 0)
 #define STANDARD_CALLBACK_SET(h) ((h)->log_callback2 ? 1 : 0)
 
 void CallbackPrintHelper(IN PTEEHANDLE handle, bool is_error, const char* args, ...);
 
 #define DBGPRINT(h, _x_, ...) \
-	if ((h) && (h)->log_level >= TEE_LOG_LEVEL_VERBOSE) { \
-		if (LEGACY_CALLBACK_SET(h)) \
+	if (METEE_MIN_LOG_LEVEL >= TEE_LOG_LEVEL_VERBOSE && (h) && (h)->log_level >= TEE_LOG_LEVEL_VERBOSE) { \
+		if (TRACE_ACTIVE()) \
+			TRACE_PRINT(h, false, _x_, ##__VA_ARGS__) \
+		else if (STRUCTURED_CALLBACK_SET(h)) \
+			STRUCTURED_PRINT(h, false, _x_, ##__VA_ARGS__) \
+		else if (LEGACY_CALLBACK_SET(h)) \
 		    (h)->log_callback(false, DEBUG_PRINT_ME_PREFIX_EXTERNAL _x_,__FILE__,__FUNCTION__,__LINE__, ##__VA_ARGS__); \
 		else if (STANDARD_CALLBACK_SET(h)) \
 				CallbackPrintHelper((h), false, DEBUG_PRINT_ME_PREFIX_EXTERNAL _x_,__FILE__,__FUNCTION__,__LINE__, ##__VA_ARGS__); \
@@ -94,8 +125,12 @@ void CallbackPrintHelper(IN PTEEHANDLE handle, bool is_error, const char* args,
 	}
 
 #define ERRPRINT(h, _x_, ...) \
-	if ((h) && (h)->log_level >= TEE_LOG_LEVEL_ERROR) { \
-		if (LEGACY_CALLBACK_SET(h)) \
+	if (METEE_MIN_LOG_LEVEL >= TEE_LOG_LEVEL_ERROR && (h) && (h)->log_level >= TEE_LOG_LEVEL_ERROR) { \
+		if (TRACE_ACTIVE()) \
+			TRACE_PRINT(h, true, _x_, ##__VA_ARGS__) \
+		else if (STRUCTURED_CALLBACK_SET(h)) \
+			STRUCTURED_PRINT(h, true, _x_, ##__VA_ARGS__) \
+		else if (LEGACY_CALLBACK_SET(h)) \
 		    (h)->log_callback(true, DEBUG_PRINT_ME_PREFIX_EXTERNAL _x_,__FILE__,__FUNCTION__,__LINE__, ##__VA_ARGS__); \
 		else if (STANDARD_CALLBACK_SET(h)) \
 				CallbackPrintHelper((h), true, DEBUG_PRINT_ME_PREFIX_EXTERNAL _x_,__FILE__,__FUNCTION__,__LINE__, ##__VA_ARGS__); \
@@ -99,6 +99,38 @@ typedef void(*TeeLogCallback)(bool is_error, const char* fmt, ...);
  */
 typedef void(*TeeLogCallback2)(bool is_error, const char* msg);
 
+/*! Kind of structured log event
+ */
+enum tee_log_op {
+	TEE_LOG_OP_MESSAGE = 0, /**< text message, see TeeLogEventFormat */
+	TEE_LOG_OP_CONNECT = 1, /**< TeeConnect completed */
+	TEE_LOG_OP_READ = 2,    /**< TeeRead completed */
+	TEE_LOG_OP_WRITE = 3,   /**< TeeWrite completed */
+};
+
+/*! Structured log event, valid only during the callback
+ */
+struct tee_log_event {
+	enum tee_log_level level; /**< TEE_LOG_LEVEL_ERROR or TEE_LOG_LEVEL_VERBOSE */
+	enum tee_log_op op; /**< event kind */
+	uintptr_t handle_id; /**< value of TEEHANDLE.handle of the logging handle */
+	int error; /**< errno of the failed system call, 0 if none */
+	uint32_t status; /**< operation status (TEESTATUS), 0 for messages */
+	size_t bytes; /**< bytes read or written */
+	uint64_t duration_us; /**< operation duration in microseconds, 0 for messages */
+	const char *file; /**< source file of the event */
+	const char *function; /**< function of the event */
+	uint32_t line; /**< source line of the event */
+	const char *fmt; /**< printf format of the message, NULL for operations */
+	void *args; /**< message arguments, for TeeLogEventFormat only */
+};
+
+/*! Structured log callback function format
+ *  Operations complete with TEE_LOG_LEVEL_VERBOSE on success and
+ *  TEE_LOG_LEVEL_ERROR on failure, the handle log level filters both kinds.
+ */
+typedef void(*TeeLogCallback3)(void *ctx, const struct tee_log_event *event);
+
 #pragma pack(1)
 
 /*!
@@ -120,6 +152,8 @@ typedef struct _TEEHANDLE {
  */
 typedef TEEHANDLE *PTEEHANDLE;
 
+struct tee_script;
+
 /*! Device address passed to the init function
  */
 struct tee_device_address {
@@ -131,14 +165,21 @@ struct tee_device_address {
 		TEE_DEVICE_TYPE_HANDLE = 2, /**< Use device by pre-opend handle */
 		TEE_DEVICE_TYPE_GUID = 3, /**< Select first device by GUID (Windows only) */
 		TEE_DEVICE_TYPE_BDF = 4, /**< Use BDF to work with HECI, EFI only */
-		TEE_DEVICE_TYPE_MAX = 5, /**< upper sentinel */
+		TEE_DEVICE_TYPE_BROKER = 5, /**< Use metee broker by socket path (char*), Linux only */
+		TEE_DEVICE_TYPE_BROKER_SHM = 6, /**< Use metee broker by socket path (char*) with shared memory data path, Linux only */
+		TEE_DEVICE_TYPE_REPLAY = 7, /**< Replay capture file by path (char*), Linux only */
+		TEE_DEVICE_TYPE_LOOPBACK = 8, /**< In-memory client echoing every message, Linux only */
+		TEE_DEVICE_TYPE_SOCKET = 9, /**< Client served by the peer of a connected SOCK_SEQPACKET socket (handle), Linux only */
+		TEE_DEVICE_TYPE_SCRIPT = 10, /**< In-memory client answering through struct tee_script (script), Linux only */
+		TEE_DEVICE_TYPE_MAX = 11, /**< upper sentinel */
 	} type;
 
 	/*! Device address */
 	union {
-		const char* path; /** < Path to device */
+		const char* path; /** < Path to device or broker socket */
 		const GUID* guid; /** Device GUID (Windows only) */
 		TEE_DEVICE_HANDLE handle; /**< Pre-opend handle */
+		const struct tee_script *script; /**< Scripted client */
 		struct {
 			struct {
 				uint32_t segment;                     /** HECI device Segment */
@@ -190,11 +231,33 @@ typedef uint16_t TEESTATUS; /**< return status for API functions */
 #define TEE_INSUFFICIENT_BUFFER           (TEE_ERROR_BASE + 11)
 /** The user don't have permission for this operation  */
 #define TEE_PERMISSION_DENIED             (TEE_ERROR_BASE + 12)
+/** The device firmware is resetting or powered down */
+#define TEE_DEVICE_RESETTING              (TEE_ERROR_BASE + 13)
 
 /*! Macro for successful operation result check
  */
 #define TEE_IS_SUCCESS(Status) (((TEESTATUS)(Status)) == TEE_SUCCESS)
 
+/*! Scripted client responder, called on every written message
+ *  \param ctx Context from struct tee_script.
+ *  \param request The written message.
+ *  \param request_len The written message length.
+ *  \param response Buffer of max_msg_len bytes for the response.
+ *  \param response_len Response length, leave 0 to send no response.
+ *  \return 0 if successful, otherwise the status returned by TeeWrite.
+ */
+typedef TEESTATUS(*TeeScriptResponder)(void *ctx, const void *request, size_t request_len,
+				       void *response, size_t *response_len);
+
+/*! Scripted client for TEE_DEVICE_TYPE_SCRIPT, copied on init
+ */
+struct tee_script {
+	uint32_t max_msg_len; /**< client maximum message length reported on connect */
+	uint8_t protocol_ver; /**< client protocol version reported on connect */
+	TeeScriptResponder responder; /**< produces the response to every written message */
+	void *ctx; /**< responder context */
+};
+
  /*! Initializes a TEE connection
   *  @deprecated Since version 6.0
   *  \param handle A handle to the TEE device. All subsequent calls to the lib's functions
@@ -313,6 +376,95 @@ void TEEAPI TeeDisconnect(IN PTEEHANDLE handle);
  */
 void TEEAPI TeeCancelIO(IN PTEEHANDLE handle);
 
+/*! Cancellation token of individual operations
+ *  A token attached to TeeReadEx, TeeWriteEx or TeeTransact stops only the
+ *  operations it is attached to, on any handle, when it is canceled or its
+ *  deadline passes; the operations return TEE_UNABLE_TO_COMPLETE_OPERATION.
+ *  A canceled token stops every later operation until reset.
+ *  Supported on Linux only.
+ */
+struct tee_cancel_token;
+
+/*! Create cancellation token
+ *  \param token The memory to store the new token.
+ *  \return 0 if successful, otherwise error code.
+ */
+TEESTATUS TEEAPI TeeCancelTokenCreate(OUT struct tee_cancel_token **token);
+
+/*! Free cancellation token, no operation may be using it
+ *  \param token The token, NULL is ignored.
+ */
+void TEEAPI TeeCancelTokenFree(IN struct tee_cancel_token *token);
+
+/*! Cancel the token automatically after timeout
+ *  The deadline applies to operations started after the call.
+ *  \param token The token.
+ *  \param timeout The time from now in milliseconds, zero removes the deadline.
+ *  \return 0 if successful, otherwise error code.
+ */
+TEESTATUS TEEAPI TeeCancelTokenSetDeadline(IN struct tee_cancel_token *token, IN uint32_t timeout);
+
+/*! Cancel the token, safe to call from any thread
+ *  \param token The token.
+ */
+void TEEAPI TeeCancelTokenCancel(IN struct tee_cancel_token *token);
+
+/*! Return the token to not canceled state without deadline
+ *  \param token The token.
+ */
+void TEEAPI TeeCancelTokenReset(IN struct tee_cancel_token *token);
+
+/*! Check the token state, a passed deadline cancels the token
+ *  \param token The token.
+ *  \return true if the token is canceled.
+ */
+bool TEEAPI TeeCancelTokenIsCanceled(IN struct tee_cancel_token *token);
+
+/*! Read data from the TEE device synchronously, stopped by cancellation token.
+ *  \param handle The handle of the session to read from.
+ *  \param buffer A pointer to a buffer that receives the data read from the TEE device.
+ *  \param bufferSize The number of bytes to be read.
+ *  \param pNumOfBytesRead A pointer to the variable that receives the number of bytes read,
+ *         ignored if set to NULL.
+ *  \param timeout The timeout to complete read in milliseconds, zero for infinite
+ *  \param token The cancellation token, NULL to behave as TeeRead.
+ *  \return 0 if successful, otherwise error code
+ */
+TEESTATUS TEEAPI TeeReadEx(IN PTEEHANDLE handle, IN OUT void *buffer, IN size_t bufferSize,
+			   OUT OPTIONAL size_t *pNumOfBytesRead, IN OPTIONAL uint32_t timeout,
+			   IN OPTIONAL struct tee_cancel_token *token);
+
+/*! Writes the specified buffer to the TEE device synchronously, stopped by cancellation token.
+ *  \param handle The handle of the session to write to.
+ *  \param buffer A pointer to the buffer containing the data to be written to the TEE device.
+ *  \param bufferSize The number of bytes to be written.
+ *  \param numberOfBytesWritten A pointer to the variable that receives the number of bytes written,
+ *         ignored if set to NULL.
+ *  \param timeout The timeout to complete write in milliseconds, zero for infinite
+ *  \param token The cancellation token, NULL to behave as TeeWrite.
+ *  \return 0 if successful, otherwise error code
+ */
+TEESTATUS TEEAPI TeeWriteEx(IN PTEEHANDLE handle, IN const void *buffer, IN size_t bufferSize,
+			    OUT OPTIONAL size_t *numberOfBytesWritten, IN OPTIONAL uint32_t timeout,
+			    IN OPTIONAL struct tee_cancel_token *token);
+
+/*! Write request and read the response synchronously.
+ *  \param handle The handle of the session.
+ *  \param request A pointer to the request.
+ *  \param requestSize The size of the request in bytes.
+ *  \param response A pointer to a buffer that receives the response.
+ *  \param responseSize The size of the response buffer in bytes.
+ *  \param pNumOfBytesRead A pointer to the variable that receives the response size,
+ *         ignored if set to NULL.
+ *  \param timeout The timeout to complete write and read together in milliseconds, zero for infinite
+ *  \param token The cancellation token, may be NULL.
+ *  \return 0 if successful, otherwise error code
+ */
+TEESTATUS TEEAPI TeeTransact(IN PTEEHANDLE handle, IN const void *request, IN size_t requestSize,
+			     IN OUT void *response, IN size_t responseSize,
+			     OUT OPTIONAL size_t *pNumOfBytesRead, IN OPTIONAL uint32_t timeout,
+			     IN OPTIONAL struct tee_cancel_token *token);
+
 /*! Returns handle of TEE device
  *  Obtains HECI device handle on Windows and mei device file descriptor on Linux
  *  \param handle The handle of the session.
@@ -338,6 +490,8 @@ typedef struct {
 TEESTATUS TEEAPI GetDriverVersion(IN PTEEHANDLE handle, IN OUT teeDriverVersion_t *driverVersion);
 
 /*! Set log level
+ *
+ *  Levels above the build time METEE_MIN_LOG_LEVEL print nothing.
  *
  *  \param handle The handle of the session.
  *  \param log_level log level to set
@@ -368,6 +522,28 @@ TEESTATUS TEEAPI TeeSetLogCallback(IN const PTEEHANDLE handle, TeeLogCallback lo
  */
 TEESTATUS TEEAPI TeeSetLogCallback2(IN const PTEEHANDLE handle, TeeLogCallback2 log_callback);
 
+/*! Set structured log callback
+ *  While set, the callback receives all log events of the handle instead of the text callbacks;
+ *  nothing is formatted unless the callback calls TeeLogEventFormat.
+ *  Supported on Linux.
+ *  \param handle The handle of the session.
+ *  \param log_callback pointer to function to run for log event, set NULL to restore text logging
+ *  \param ctx context passed to the callback
+ *  \return 0 if successful, otherwise error code.
+ */
+TEESTATUS TEEAPI TeeSetLogCallback3(IN const PTEEHANDLE handle, IN OPTIONAL TeeLogCallback3 log_callback,
+				    IN OPTIONAL void *ctx);
+
+/*! Format structured log event as text
+ *  Messages are formatted from their format and arguments,
+ *  operations as a summary of their fields.
+ *  \param event Event passed to TeeLogCallback3.
+ *  \param buf Buffer to fill with null terminated text.
+ *  \param size Buffer size in bytes, longer text is truncated.
+ *  \return 0 if successful, otherwise error code.
+ */
+TEESTATUS TEEAPI TeeLogEventFormat(IN const struct tee_log_event *event, OUT char *buf, IN size_t size);
+
 /*! Retrieve client maximum message length (MTU)
  *
  *  \param handle The handle of the session.
@@ -394,6 +570,366 @@ uint8_t TEEAPI TeeGetProtocolVer(IN const PTEEHANDLE handle);
  */
 TEESTATUS TEEAPI TeeGetKind(IN PTEEHANDLE handle, IN OUT char *kind, IN OUT size_t *kindSize);
 
+/*! Number of latency histogram buckets
+ *  Bucket N counts operations that took [2^N, 2^(N+1)) microseconds,
+ *  bucket 0 counts also faster operations and the last bucket all slower ones.
+ */
+#define TEE_STATS_HIST_BUCKETS 24
+
+/*! Number of per-status error counters, bigger status codes are counted in the last one
+ */
+#define TEE_STATS_STATUS_MAX 16
+
+/*! Latency histogram
+ */
+struct tee_stats_hist {
+	uint64_t count; /**< number of samples */
+	uint64_t total_us; /**< sum of samples in microseconds */
+	uint64_t buckets[TEE_STATS_HIST_BUCKETS]; /**< log2 microseconds buckets */
+};
+
+/*! Bucket of a latency histogram sample
+ *  Shared by the library and the C++ wrappers, so all histograms bucket alike.
+ *  \param us The sample in microseconds.
+ *  \return Bucket index, less than TEE_STATS_HIST_BUCKETS.
+ */
+static inline unsigned int TeeStatsHistBucket(uint64_t us)
+{
+	unsigned int bucket = 0;
+
+#if defined(__GNUC__)
+	if (us > 1)
+		bucket = 63U - (unsigned int)__builtin_clzll(us);
+#else
+	while (bucket < TEE_STATS_HIST_BUCKETS && (us >> (bucket + 1)))
+		bucket++;
+#endif
+	return (bucket < TEE_STATS_HIST_BUCKETS) ? bucket : TEE_STATS_HIST_BUCKETS - 1;
+}
+
+/*! Per-handle I/O statistics
+ *  Counters start at zero on handle initialization and are never reset.
+ */
+struct tee_stats {
+	uint64_t write_msgs; /**< successful writes */
+	uint64_t write_bytes; /**< bytes written */
+	uint64_t read_msgs; /**< successful reads */
+	uint64_t read_bytes; /**< bytes read */
+	uint64_t timeouts; /**< reads and writes failed with TEE_TIMEOUT */
+	uint64_t cancels; /**< reads and writes stopped by TeeCancelIO or a cancellation token */
+	uint64_t connects; /**< successful connects */
+	uint64_t reconnects; /**< successful connects after the first one */
+	uint64_t errors[TEE_STATS_STATUS_MAX]; /**< failed calls by returned status */
+	struct tee_stats_hist write_wait; /**< time waiting for the device to accept write */
+	struct tee_stats_hist write; /**< time to pass the message to the device once it can accept it */
+	struct tee_stats_hist read_wait; /**< time waiting for the response */
+	struct tee_stats_hist read; /**< time to take the message from the device once it is available */
+	struct tee_stats_hist transact; /**< time from write start to the end of the following read */
+};
+
+/*! Retrieves I/O statistics of the handle
+ *  Supported on Linux, the library may be built without statistics support.
+ *  \param handle The handle of the session.
+ *  \param stats Buffer to fill with statistics snapshot.
+ *  \return 0 if successful, otherwise error code.
+ */
+TEESTATUS TEEAPI TeeGetStats(IN PTEEHANDLE handle, OUT struct tee_stats *stats);
+
+/*! Event recorded in the trace ring, passed to TeeTraceCallback
+ */
+struct tee_trace_record {
+	uint64_t timestamp_ns; /**< CLOCK_MONOTONIC time of the event */
+	uintptr_t handle_id; /**< value of TEEHANDLE.handle of the handle that logged the event */
+	uintptr_t site_id; /**< call site id, the same for all events of one log statement */
+	bool is_error; /**< error event */
+	const char *file; /**< source file of the call site */
+	const char *function; /**< function of the call site */
+	uint32_t line; /**< line of the call site */
+	const char *msg; /**< message formatted on drain */
+	const uint8_t *payload; /**< message bytes sent or received, NULL if none */
+	size_t payload_len; /**< stored payload length, at most TEE_TRACE_PAYLOAD_MAX */
+};
+
+/*! Maximal number of payload bytes stored in one trace event
+ */
+#define TEE_TRACE_PAYLOAD_MAX 256
+
+/*! Trace drain callback function format
+ *  The record and the strings it points to are valid only during the call.
+ */
+typedef void(*TeeTraceCallback)(void *ctx, const struct tee_trace_record *record);
+
+/*! Starts process-wide binary trace
+ *  While the trace runs the messages passing the handle log level are stored
+ *  in a lock-free ring buffer without formatting instead of being printed;
+ *  data buffers are stored as payload at TEE_LOG_LEVEL_VERBOSE.
+ *  Supported on Linux, the library may be built without trace support.
+ *  \param size Ring buffer size in bytes, rounded up to power of two, 4KiB to 64MiB.
+ *  \return 0 if successful, otherwise error code.
+ */
+TEESTATUS TEEAPI TeeTraceStart(IN size_t size);
+
+/*! Stops the trace and releases the ring buffer, events not drained are lost
+ *  \return 0 if successful, otherwise error code.
+ */
+TEESTATUS TEEAPI TeeTraceStop(void);
+
+/*! Formats and passes the stored events to the callback, oldest first
+ *  Can be called from any thread while the trace runs, one drain at a time.
+ *  \param callback Function to call for every event.
+ *  \param ctx Context passed to the callback.
+ *  \param dropped Optional, number of events dropped on full ring since the previous drain.
+ *  \return 0 if successful, otherwise error code.
+ */
+TEESTATUS TEEAPI TeeTraceDrain(IN TeeTraceCallback callback, IN OPTIONAL void *ctx,
+			       OUT OPTIONAL uint64_t *dropped);
+
+/*! Starts capture of the handle traffic into a file
+ *  Every connect, written and read message is appended to the file as a framed
+ *  record with timestamp, direction, client GUID, vtag and payload.
+ *  The file can be replayed later by a handle initialized with TEE_DEVICE_TYPE_REPLAY.
+ *  The capture stops on TeeCaptureStop or TeeDisconnect.
+ *  Supported on Linux.
+ *  \param handle The handle of the session.
+ *  \param path Capture file path, the file is created or truncated.
+ *  \return 0 if successful, otherwise error code.
+ */
+TEESTATUS TEEAPI TeeCaptureStart(IN PTEEHANDLE handle, IN const char *path);
+
+/*! Stops the handle traffic capture and closes the capture file
+ *  \param handle The handle of the session.
+ *  \return 0 if successful, otherwise error code.
+ */
+TEESTATUS TEEAPI TeeCaptureStop(IN PTEEHANDLE handle);
+
+/*! Sets the pace of a replay handle
+ *  \param handle The handle initialized with TEE_DEVICE_TYPE_REPLAY.
+ *  \param speed 1 - original timing (default), N - N times faster, 0 - no delays.
+ *  \return 0 if successful, otherwise error code.
+ */
+TEESTATUS TEEAPI TeeReplaySetSpeed(IN PTEEHANDLE handle, IN uint32_t speed);
+
+/*! Kind of fault injected by TeeFaultStart
+ */
+enum tee_fault_kind {
+	TEE_FAULT_DELAY = 0, /**< the operation starts delay_ms later, the delay is part of the caller timeout */
+	TEE_FAULT_TIMEOUT = 1, /**< TEE_TIMEOUT after the caller timeout or delay_ms if set, a read loses the response */
+	TEE_FAULT_BUSY = 2, /**< TEE_BUSY */
+	TEE_FAULT_DISCONNECT = 3, /**< FW reset: TEE_DISCONNECTED until TeeConnect, responses not read are lost */
+	TEE_FAULT_TRUNCATE = 4, /**< a read returns at most truncate_len bytes of the response */
+	TEE_FAULT_KIND_MAX = 5, /**< upper sentinel */
+};
+
+#define TEE_FAULT_OP_CONNECT 0x1U /**< rule applies to TeeConnect */
+#define TEE_FAULT_OP_WRITE   0x2U /**< rule applies to TeeWrite */
+#define TEE_FAULT_OP_READ    0x4U /**< rule applies to TeeRead */
+
+/*! Maximal number of rules in struct tee_fault_config
+ */
+#define TEE_FAULT_RULES_MAX 16
+
+/*! Fault injection rule
+ *  A rule fires on every period-th operation it applies to, or at random
+ *  with the given probability when period is zero.
+ */
+struct tee_fault_rule {
+	uint32_t kind; /**< enum tee_fault_kind */
+	uint32_t ops; /**< TEE_FAULT_OP_* mask of the operations the rule applies to */
+	uint32_t probability; /**< chance per operation in parts per million, used when period is zero */
+	uint32_t period; /**< fire on every period-th operation, zero for probability */
+	uint32_t skip; /**< operations passed before the rule may fire */
+	uint32_t limit; /**< maximal number of injections, zero for unlimited */
+	uint32_t delay_ms; /**< TEE_FAULT_DELAY and TEE_FAULT_TIMEOUT time */
+	uint32_t truncate_len; /**< TEE_FAULT_TRUNCATE response length */
+};
+
+/*! Fault injection configuration, copied on start
+ */
+struct tee_fault_config {
+	uint64_t seed; /**< random generator seed, zero for default */
+	size_t rules_num; /**< number of rules, at most TEE_FAULT_RULES_MAX */
+	const struct tee_fault_rule *rules; /**< rules, the first one firing on an operation is applied */
+};
+
+/*! Fault injection statistics
+ */
+struct tee_fault_stats {
+	uint64_t operations; /**< operations seen by the injector */
+	uint64_t injected[TEE_FAULT_KIND_MAX]; /**< injected faults by kind */
+	uint64_t recoveries; /**< successful reads ending a series of injected faults */
+	struct tee_stats_hist recovery; /**< time from the first fault of a series to the next successful read */
+	struct tee_stats_hist transact; /**< time from write start to the end of the following successful read */
+};
+
+/*! Starts fault injection on the handle
+ *  Faults are injected between the library and the transport backend,
+ *  so every device address type can be used; the handle behaves for the
+ *  caller like on a slow or failing firmware.
+ *  Start and stop must not run concurrently with other calls on the handle.
+ *  Supported on Linux.
+ *  \param handle The handle of the session.
+ *  \param config Fault injection rules.
+ *  \return 0 if successful, otherwise error code.
+ */
+TEESTATUS TEEAPI TeeFaultStart(IN PTEEHANDLE handle, IN const struct tee_fault_config *config);
+
+/*! Stops fault injection on the handle
+ *  A connection broken by an injected fault is restored.
+ *  \param handle The handle of the session.
+ *  \return 0 if successful, otherwise error code.
+ */
+TEESTATUS TEEAPI TeeFaultStop(IN PTEEHANDLE handle);
+
+/*! Retrieves fault injection statistics of the handle
+ *  \param handle The handle of the session with fault injection running.
+ *  \param stats Buffer to fill with statistics snapshot.
+ *  \return 0 if successful, otherwise error code.
+ */
+TEESTATUS TEEAPI TeeFaultGetStats(IN PTEEHANDLE handle, OUT struct tee_fault_stats *stats);
+
+/*! Starts process-wide monitor of mei device hotplug
+ *  A thread follows kernel uevents of the mei class and keeps a table of
+ *  present devices. When the device of a handle is removed, e.g. on GPU reset
+ *  or driver rebind, waits in flight end and new reads and writes fail at once
+ *  with TEE_DISCONNECTED instead of running into the timeout. TeeConnect fails
+ *  at once while the device is absent and reopens the device node once it is back.
+ *  Handles on a mei device node are watched automatically, see TeeHotplugBind.
+ *  Supported on Linux.
+ *  \param source TEE_INVALID_DEVICE_HANDLE to listen to the kernel, or a datagram socket
+ *         delivering messages in kernel uevent format, e.g. from a test; the socket is not closed
+ *         by the library.
+ *  \return 0 if successful, otherwise error code.
+ */
+TEESTATUS TEEAPI TeeHotplugStart(IN TEE_DEVICE_HANDLE source);
+
+/*! Stops the hotplug monitor, the handles are not failed fast anymore
+ *  \return 0 if successful, otherwise error code.
+ */
+TEESTATUS TEEAPI TeeHotplugStop(void);
+
+/*! Retrieves device presence from the hotplug monitor table
+ *  \param name Device name or path, e.g. mei0 or /dev/mei0.
+ *  \param present Set to true if the device is present.
+ *  \return 0 if successful, TEE_DEVICE_NOT_FOUND for a device never seen,
+ *          TEE_NOTSUPPORTED if the monitor is not running.
+ */
+TEESTATUS TEEAPI TeeHotplugQuery(IN const char *name, OUT bool *present);
+
+/*! Binds the handle to the device watched by the hotplug monitor
+ *  Needed only for handles not opened on a mei device node, e.g. a broker
+ *  or test transport standing for a device. Must not run concurrently with
+ *  other calls on the handle.
+ *  \param handle The handle of the session.
+ *  \param name Device name or path, e.g. mei0 or /dev/mei0, NULL to stop watching.
+ *  \return 0 if successful, otherwise error code.
+ */
+TEESTATUS TEEAPI TeeHotplugBind(IN PTEEHANDLE handle, IN OPTIONAL const char *name);
+
+/*! Waits until the device of the handle is present, to be followed by TeeConnect
+ *  \param handle The handle of the session.
+ *  \param timeout The timeout to complete the wait in milliseconds, zero for infinite.
+ *  \return 0 if the device is present, TEE_TIMEOUT if still absent,
+ *          TEE_NOTSUPPORTED if the monitor is not running or the handle is not watched,
+ *          otherwise error code.
+ */
+TEESTATUS TEEAPI TeeHotplugWait(IN PTEEHANDLE handle, IN OPTIONAL uint32_t timeout);
+
+/*! Handling of operations while the device is not enabled
+ *  The device state is read from the sysfs dev_state attribute of the mei device,
+ *  e.g. RESETTING or POWER_DOWN during firmware reset; nothing is gated when it is unknown.
+ */
+enum tee_devstate_policy {
+	TEE_DEVSTATE_IGNORE = 0, /**< operations run regardless of the device state */
+	TEE_DEVSTATE_FAIL = 1, /**< reads, writes and connect fail at once with TEE_DEVICE_RESETTING, default */
+	TEE_DEVSTATE_WAIT = 2, /**< reads and writes wait within their timeout until the device is enabled,
+				    connect up to 10 seconds; TeeCancelIO stops the wait */
+	TEE_DEVSTATE_MAX = 3, /**< upper sentinel */
+};
+
+/*! Sets the handling of operations while the device is not enabled
+ *  Supported on Linux.
+ *  \param handle The handle of the session.
+ *  \param policy enum tee_devstate_policy.
+ *  \return 0 if successful, otherwise error code.
+ */
+TEESTATUS TEEAPI TeeSetDevStatePolicy(IN PTEEHANDLE handle, IN uint32_t policy);
+
+/*! Obtains the device state, e.g. ENABLED or RESETTING
+ *  \param handle The handle of the session.
+ *  \param state Buffer to fill with device state null terminated string, may be NULL.
+ *  \param stateSize Pointer to state buffer size in bytes, updated to number of bytes filled in buffer, including null character, on out.
+ *          If buffer is NULL, required size is returned anyway.
+ *  \return 0 if successful, TEE_NOTSUPPORTED if the state is unknown, otherwise error code.
+ */
+TEESTATUS TEEAPI TeeGetDevState(IN PTEEHANDLE handle, IN OUT char *state, IN OUT size_t *stateSize);
+
+/*! Binds the handle to a device state attribute file
+ *  Handles on a mei device node are bound to its dev_state automatically;
+ *  needed for other transports standing for a device, e.g. in tests.
+ *  Reads and writes in flight move to the new file; the call returns once none
+ *  of them uses the old one. Must not run concurrently with another
+ *  TeeDevStateBind or with TeeDisconnect on the handle.
+ *  \param handle The handle of the session.
+ *  \param path Path of the dev_state attribute, NULL to stop gating.
+ *  \return 0 if successful, otherwise error code.
+ */
+TEESTATUS TEEAPI TeeDevStateBind(IN PTEEHANDLE handle, IN OPTIONAL const char *path);
+
+/*! Runtime power management statistics of the handle
+ *  Requests are counted only when the runtime status of the device is known;
+ *  requests on a pinned handle are counted as active without reading it.
+ */
+struct tee_power_stats {
+	uint64_t requests; /**< successful writes */
+	uint64_t cold_requests; /**< successful writes while the device was suspended or resuming */
+	uint64_t prewakes; /**< TeePowerPreWake calls that resumed a suspended device */
+	struct tee_stats_hist cold_transact; /**< time from write start to the end of the following read, cold device */
+	struct tee_stats_hist warm_transact; /**< time from write start to the end of the following read, active device */
+};
+
+/*! Keeps the device resumed until TeePowerUnpin or disconnect
+ *  Supported on Linux, writes the power/control sysfs attribute of the device,
+ *  the value seen by the first pin in the process is restored by the last unpin.
+ *  \param handle The handle of the session.
+ *  \return 0 if successful, TEE_NOTSUPPORTED if the power directory is unknown,
+ *          TEE_PERMISSION_DENIED if the attribute is not writable, otherwise error code.
+ */
+TEESTATUS TEEAPI TeePowerPin(IN PTEEHANDLE handle);
+
+/*! Drops the pin taken by TeePowerPin, does nothing if the handle has no pin
+ *  \param handle The handle of the session.
+ *  \return 0 if successful, otherwise error code.
+ */
+TEESTATUS TEEAPI TeePowerUnpin(IN PTEEHANDLE handle);
+
+/*! Resumes the device now, ahead of a burst of requests
+ *  The device suspends again after its autosuspend delay without requests.
+ *  \param handle The handle of the session.
+ *  \return 0 if successful, TEE_NOTSUPPORTED if the power directory is unknown,
+ *          TEE_PERMISSION_DENIED if the attribute is not writable, otherwise error code.
+ */
+TEESTATUS TEEAPI TeePowerPreWake(IN PTEEHANDLE handle);
+
+/*! Retrieves runtime power management statistics of the handle
+ *  \param handle The handle of the session.
+ *  \param stats Buffer to fill with statistics snapshot.
+ *  \return 0 if successful, TEE_NOTSUPPORTED if statistics are not compiled in,
+ *          otherwise error code.
+ */
+TEESTATUS TEEAPI TeeGetPowerStats(IN PTEEHANDLE handle, OUT struct tee_power_stats *stats);
+
+/*! Binds the handle to a power directory
+ *  Handles on a mei device node are bound to device/power of the mei device automatically;
+ *  needed for other transports standing for a device, e.g. in tests.
+ *  Statistics and the pin of the handle carry over to the new directory.
+ *  May run concurrently with reads and writes, not with other power calls
+ *  or with TeeDisconnect on the handle.
+ *  \param handle The handle of the session.
+ *  \param dir Path of the directory holding control and runtime_status, NULL to unbind.
+ *  \return 0 if successful, otherwise error code.
+ */
+TEESTATUS TEEAPI TeePowerBind(IN PTEEHANDLE handle, IN OPTIONAL const char *dir);
+
 #ifdef __cplusplus
 }
 #endif
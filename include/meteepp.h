@@ -8,10 +8,12 @@
 #ifndef _METEEPP_H_
 #define _METEEPP_H_
 
+#include <cstring>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <system_error>
+#include <type_traits>
 #include <vector>
 #include "metee.h"
 
@@ -42,6 +44,7 @@ namespace intel {
 					TEE_ERR_STATE(DISCONNECTED);
 					TEE_ERR_STATE(INSUFFICIENT_BUFFER);
 					TEE_ERR_STATE(PERMISSION_DENIED);
+					TEE_ERR_STATE(DEVICE_RESETTING);
 				default:
 					return std::to_string(ev);
 				}
@@ -74,6 +77,157 @@ namespace intel {
 			virtual ~metee_exception() noexcept {}
 		};
 
+		/*! Response validation policy: accept any response */
+		struct any_response {
+			/*! Validate response against the request
+			 *  \param request request sent
+			 *  \param response response received
+			 */
+			template <typename Request, typename Response>
+			static void validate(const Request& request, const Response& response)
+			{
+				(void)request;
+				(void)response;
+			}
+		};
+
+		/*! Response validation policy: compare protocol header placed at the compile-time offset
+		 *  \brief Match should provide static bool match(const Header& request, const Header& response)
+		 *  \tparam Header protocol header type
+		 *  \tparam Match header matcher
+		 *  \tparam Offset header offset in both request and response
+		 */
+		template <typename Header, typename Match, size_t Offset = 0>
+		struct header_check {
+			/*! Validate response against the request
+			 *  \param request request sent
+			 *  \param response response received
+			 */
+			template <typename Request, typename Response>
+			static void validate(const Request& request, const Response& response)
+			{
+				static_assert(std::is_trivially_copyable<Header>::value, "Header should be trivially copyable");
+				static_assert(Offset + sizeof(Header) <= sizeof(Request), "Header is out of request bounds");
+				static_assert(Offset + sizeof(Header) <= sizeof(Response), "Header is out of response bounds");
+
+				/* copies: the header may be misaligned inside packed messages */
+				Header req;
+				Header rsp;
+				std::memcpy(&req, reinterpret_cast<const uint8_t*>(&request) + Offset, sizeof(Header));
+				std::memcpy(&rsp, reinterpret_cast<const uint8_t*>(&response) + Offset, sizeof(Header));
+				if (!Match::match(req, rsp)) {
+					throw metee_exception("Response header mismatch", TEE_INTERNAL_ERROR);
+				}
+			}
+		};
+
+		/*! Write typed request and read typed response
+		 *  \brief The request is written from its own storage and the response is read
+		 *          into the reusable buffer, no per-call vector is allocated.
+		 *  \tparam Request trivially copyable request type
+		 *  \tparam Response trivially copyable response type
+		 *  \tparam Check response validation policy
+		 *  \param device device with metee read/write interface
+		 *  \param buffer reusable receive buffer, grown to client MTU on first use
+		 *  \param request request to send
+		 *  \param response response to fill
+		 *  \param timeout The timeout for each of write and read in milliseconds, zero for infinite
+		 *  \return number of bytes received, may be bigger than the response for variable length messages
+		 */
+		template <typename Request, typename Response, typename Check = any_response, typename Device>
+		size_t transact(Device& device, std::vector<uint8_t>& buffer,
+				const Request& request, Response& response, uint32_t timeout)
+		{
+			static_assert(std::is_trivially_copyable<Request>::value, "Request should be trivially copyable");
+			static_assert(std::is_trivially_copyable<Response>::value, "Response should be trivially copyable");
+			static_assert(std::is_standard_layout<Request>::value, "Request should have standard layout");
+			static_assert(std::is_standard_layout<Response>::value, "Response should have standard layout");
+
+			const size_t mtu = device.max_msg_len();
+			if (sizeof(Request) > mtu || sizeof(Response) > mtu) {
+				throw metee_exception("Message is bigger than client MTU", TEE_INVALID_PARAMETER);
+			}
+			if (buffer.size() < mtu) {
+				buffer.resize(mtu);
+			}
+
+			device.write(&request, sizeof(Request), timeout);
+			size_t size = device.read(buffer.data(), mtu, timeout);
+			if (size < sizeof(Response)) {
+				throw metee_exception("Response is too short", TEE_INTERNAL_ERROR);
+			}
+			std::memcpy(&response, buffer.data(), sizeof(Response));
+			Check::validate(request, response);
+			return size;
+		}
+
+		/*! Cancellation token of individual operations (Linux only)
+		 * \brief Cancels only the reads and writes it is passed to, on demand or at the deadline.
+		 */
+		class cancel_token
+		{
+		public:
+			/*! Constructor */
+			cancel_token() : _token(nullptr)
+			{
+				TEESTATUS status = TeeCancelTokenCreate(&_token);
+				if (!TEE_IS_SUCCESS(status)) {
+					throw metee_exception("Cancel token create failed", status);
+				}
+			}
+
+			cancel_token(const cancel_token &) = delete;
+			cancel_token &operator=(const cancel_token &) = delete;
+
+			/*! Destructor */
+			~cancel_token()
+			{
+				TeeCancelTokenFree(_token);
+			}
+
+			/*! Cancel the operations using the token, safe to call from any thread */
+			void cancel() noexcept
+			{
+				TeeCancelTokenCancel(_token);
+			}
+
+			/*! Return the token to not canceled state without deadline */
+			void reset() noexcept
+			{
+				TeeCancelTokenReset(_token);
+			}
+
+			/*! Cancel the token automatically after timeout
+			 *  \param timeout The time from now in milliseconds, zero removes the deadline
+			 */
+			void set_deadline(uint32_t timeout)
+			{
+				TEESTATUS status = TeeCancelTokenSetDeadline(_token, timeout);
+				if (!TEE_IS_SUCCESS(status)) {
+					throw metee_exception("Cancel token deadline failed", status);
+				}
+			}
+
+			/*! Check the token state
+			 *  \return true if the token is canceled or its deadline passed
+			 */
+			bool canceled() const noexcept
+			{
+				return TeeCancelTokenIsCanceled(_token);
+			}
+
+			/*! Native token
+			 *  \return token to pass to the C API
+			 */
+			struct tee_cancel_token *native() const noexcept
+			{
+				return _token;
+			}
+
+		private:
+			struct tee_cancel_token *_token; /**< native token */
+		};
+
 		/*! Dummy client GUID for default constructor */
 		DEFINE_GUID(METEE_GUID_ZERO,
 			0x00000000, 0x0000, 0x0000, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
@@ -167,7 +321,7 @@ namespace intel {
 			/*! Move constructor
 			 *  \param other Object to move from
 			 */
-			metee(metee&& other) noexcept : _handle(other._handle)
+			metee(metee&& other) noexcept : _handle(other._handle), _buffer(std::move(other._buffer))
 			{
 				other._handle.handle = nullptr;
 			}
@@ -182,6 +336,7 @@ namespace intel {
 			{
 				TeeDisconnect(&_handle);
 				_handle = other._handle;
+				_buffer = std::move(other._buffer);
 				other._handle.handle = nullptr;
 				return *this;
 			}
@@ -228,6 +383,45 @@ namespace intel {
 				return std::move(buffer);
 			}
 
+			/*! Read data from the TEE device synchronously into caller buffer.
+			 *  \param buffer A pointer to a buffer that receives the data read from the TEE device.
+			 *  \param size The size of the buffer in bytes.
+			 *  \param timeout The timeout to complete read in milliseconds, zero for infinite
+			 *  \return the number of bytes read
+			 */
+			size_t read(void *buffer, size_t size, uint32_t timeout)
+			{
+				TEESTATUS status;
+				size_t read_size = 0;
+
+				status = TeeRead(&_handle, buffer, size, &read_size, timeout);
+				if (!TEE_IS_SUCCESS(status)) {
+					throw metee_exception("Read failed", status);
+				}
+
+				return read_size;
+			}
+
+			/*! Read data from the TEE device synchronously into caller buffer, stopped by cancellation token.
+			 *  \param buffer A pointer to a buffer that receives the data read from the TEE device.
+			 *  \param size The size of the buffer in bytes.
+			 *  \param timeout The timeout to complete read in milliseconds, zero for infinite
+			 *  \param token The cancellation token
+			 *  \return the number of bytes read
+			 */
+			size_t read(void *buffer, size_t size, uint32_t timeout, const cancel_token &token)
+			{
+				TEESTATUS status;
+				size_t read_size = 0;
+
+				status = TeeReadEx(&_handle, buffer, size, &read_size, timeout, token.native());
+				if (!TEE_IS_SUCCESS(status)) {
+					throw metee_exception("Read failed", status);
+				}
+
+				return read_size;
+			}
+
 			/*! Writes the specified buffer to the TEE device synchronously.
 			 *  \param buffer vector containing the data to be written to the TEE device.
 			 *  \param timeout The timeout to complete write in milliseconds, zero for infinite
@@ -246,6 +440,62 @@ namespace intel {
 				return size;
 			}
 
+			/*! Writes the specified buffer to the TEE device synchronously.
+			 *  \param buffer A pointer to the buffer containing the data to be written to the TEE device.
+			 *  \param size The number of bytes to be written.
+			 *  \param timeout The timeout to complete write in milliseconds, zero for infinite
+			 *  \return the number of bytes written
+			 */
+			size_t write(const void *buffer, size_t size, uint32_t timeout)
+			{
+				TEESTATUS status;
+				size_t written = 0;
+
+				status = TeeWrite(&_handle, buffer, size, &written, timeout);
+				if (!TEE_IS_SUCCESS(status)) {
+					throw metee_exception("Write failed", status);
+				}
+
+				return written;
+			}
+
+			/*! Writes the specified buffer to the TEE device synchronously, stopped by cancellation token.
+			 *  \param buffer A pointer to the buffer containing the data to be written to the TEE device.
+			 *  \param size The number of bytes to be written.
+			 *  \param timeout The timeout to complete write in milliseconds, zero for infinite
+			 *  \param token The cancellation token
+			 *  \return the number of bytes written
+			 */
+			size_t write(const void *buffer, size_t size, uint32_t timeout, const cancel_token &token)
+			{
+				TEESTATUS status;
+				size_t written = 0;
+
+				status = TeeWriteEx(&_handle, buffer, size, &written, timeout, token.native());
+				if (!TEE_IS_SUCCESS(status)) {
+					throw metee_exception("Write failed", status);
+				}
+
+				return written;
+			}
+
+			/*! Write typed request and read typed response.
+			 *  \tparam Request trivially copyable request type
+			 *  \tparam Response trivially copyable response type
+			 *  \tparam Check response validation policy
+			 *  \param request request to send
+			 *  \param timeout The timeout for each of write and read in milliseconds, zero for infinite
+			 *  \return the response
+			 */
+			template <typename Request, typename Response, typename Check = any_response>
+			Response transact(const Request& request, uint32_t timeout)
+			{
+				Response response;
+
+				security::transact<Request, Response, Check>(*this, _buffer, request, response, timeout);
+				return response;
+			}
+
 			/*! Retrieves specified FW status register.
 			 *  \param fwStatusNum The FW status register number (0-5).
 			 *  \return obtained FW status.
@@ -296,6 +546,172 @@ namespace intel {
 
 				return kind;
 			}
+
+			/*! Retrieves I/O statistics of the session
+			 *  \return statistics snapshot.
+			 */
+			struct tee_stats stats()
+			{
+				TEESTATUS status;
+				struct tee_stats st;
+
+				status = TeeGetStats(&_handle, &st);
+				if (!TEE_IS_SUCCESS(status)) {
+					throw metee_exception("TeeGetStats failed", status);
+				}
+
+				return st;
+			}
+
+			/*! Start capture of the session traffic into a file
+			 *  \param path capture file path
+			 */
+			void capture_start(const std::string &path)
+			{
+				TEESTATUS status = TeeCaptureStart(&_handle, path.c_str());
+				if (!TEE_IS_SUCCESS(status)) {
+					throw metee_exception("TeeCaptureStart failed", status);
+				}
+			}
+
+			/*! Stop capture of the session traffic
+			 */
+			void capture_stop()
+			{
+				TEESTATUS status = TeeCaptureStop(&_handle);
+				if (!TEE_IS_SUCCESS(status)) {
+					throw metee_exception("TeeCaptureStop failed", status);
+				}
+			}
+
+			/*! Start fault injection on the session
+			 *  \param config fault injection rules
+			 */
+			void fault_start(const struct tee_fault_config &config)
+			{
+				TEESTATUS status = TeeFaultStart(&_handle, &config);
+				if (!TEE_IS_SUCCESS(status)) {
+					throw metee_exception("TeeFaultStart failed", status);
+				}
+			}
+
+			/*! Stop fault injection on the session
+			 */
+			void fault_stop()
+			{
+				TEESTATUS status = TeeFaultStop(&_handle);
+				if (!TEE_IS_SUCCESS(status)) {
+					throw metee_exception("TeeFaultStop failed", status);
+				}
+			}
+
+			/*! Retrieve fault injection statistics
+			 *  \return statistics snapshot.
+			 */
+			struct tee_fault_stats fault_stats()
+			{
+				struct tee_fault_stats st;
+				TEESTATUS status = TeeFaultGetStats(&_handle, &st);
+				if (!TEE_IS_SUCCESS(status)) {
+					throw metee_exception("TeeFaultGetStats failed", status);
+				}
+				return st;
+			}
+
+			/*! Bind the session to a device watched by the hotplug monitor
+			 *  \param name device name or path, empty to stop watching
+			 */
+			void hotplug_bind(const std::string &name)
+			{
+				TEESTATUS status = TeeHotplugBind(&_handle, name.empty() ? nullptr : name.c_str());
+				if (!TEE_IS_SUCCESS(status)) {
+					throw metee_exception("TeeHotplugBind failed", status);
+				}
+			}
+
+			/*! Wait until the device of the session is present again
+			 *  \param timeout The timeout to complete the wait in milliseconds, zero for infinite
+			 */
+			void hotplug_wait(uint32_t timeout)
+			{
+				TEESTATUS status = TeeHotplugWait(&_handle, timeout);
+				if (!TEE_IS_SUCCESS(status)) {
+					throw metee_exception("TeeHotplugWait failed", status);
+				}
+			}
+
+			/*! Set handling of operations while the device is not enabled
+			 *  \param policy enum tee_devstate_policy
+			 */
+			void set_devstate_policy(uint32_t policy)
+			{
+				TEESTATUS status = TeeSetDevStatePolicy(&_handle, policy);
+				if (!TEE_IS_SUCCESS(status)) {
+					throw metee_exception("TeeSetDevStatePolicy failed", status);
+				}
+			}
+
+			/*! Retrieve device state
+			 *  \return device state string, e.g. ENABLED
+			 */
+			std::string devstate()
+			{
+				TEESTATUS status;
+				const size_t STATE_SIZE = 32;
+				char state[STATE_SIZE];
+				size_t state_size = STATE_SIZE;
+
+				status = TeeGetDevState(&_handle, state, &state_size);
+				if (!TEE_IS_SUCCESS(status)) {
+					throw metee_exception("TeeGetDevState failed", status);
+				}
+
+				return state;
+			}
+
+			/*! Keep the device resumed until power_unpin or disconnect
+			 */
+			void power_pin()
+			{
+				TEESTATUS status = TeePowerPin(&_handle);
+				if (!TEE_IS_SUCCESS(status)) {
+					throw metee_exception("TeePowerPin failed", status);
+				}
+			}
+
+			/*! Drop the pin taken by power_pin
+			 */
+			void power_unpin()
+			{
+				TEESTATUS status = TeePowerUnpin(&_handle);
+				if (!TEE_IS_SUCCESS(status)) {
+					throw metee_exception("TeePowerUnpin failed", status);
+				}
+			}
+
+			/*! Resume the device ahead of a burst of requests
+			 */
+			void power_prewake()
+			{
+				TEESTATUS status = TeePowerPreWake(&_handle);
+				if (!TEE_IS_SUCCESS(status)) {
+					throw metee_exception("TeePowerPreWake failed", status);
+				}
+			}
+
+			/*! Retrieve runtime power management statistics
+			 *  \return statistics snapshot.
+			 */
+			struct tee_power_stats power_stats()
+			{
+				struct tee_power_stats st;
+				TEESTATUS status = TeeGetPowerStats(&_handle, &st);
+				if (!TEE_IS_SUCCESS(status)) {
+					throw metee_exception("TeeGetPowerStats failed", status);
+				}
+				return st;
+			}
+
 			/*! Set log level
 			 *
 			 *  \param log_level log level to set
@@ -324,6 +740,19 @@ namespace intel {
 				TeeSetLogCallback(&_handle, log_callback);
 			}
 
+			/*! Set structured log callback
+			 *
+			 *  \param log_callback pointer to function to run for log event, set NULL to restore text logging
+			 *  \param ctx context passed to the callback
+			 */
+			void log_callback(TeeLogCallback3 log_callback, void *ctx)
+			{
+				TEESTATUS status = TeeSetLogCallback3(&_handle, log_callback, ctx);
+				if (!TEE_IS_SUCCESS(status)) {
+					throw metee_exception("TeeSetLogCallback3 failed", status);
+				}
+			}
+
 			/*! Retrieve client maximum message length (MTU)
 			 *
 			 *  \return client maximum message length.
@@ -375,6 +804,38 @@ namespace intel {
 
 		private:
 			_TEEHANDLE _handle; /*!< Internal device handle */
+			std::vector<uint8_t> _buffer; /*!< Reusable receive buffer for typed messages */
+		};
+
+		/*! Keeps the device of a session resumed for a latency critical window
+		 */
+		class power_pin_guard
+		{
+		public:
+			/*! Pins the device
+			 *  \param dev session to pin the device of
+			 */
+			explicit power_pin_guard(metee &dev) : _dev(dev)
+			{
+				_dev.power_pin();
+			}
+
+			/*! Unpins the device, errors are ignored
+			 */
+			~power_pin_guard()
+			{
+				try {
+					_dev.power_unpin();
+				}
+				catch (const metee_exception &) {
+				}
+			}
+
+			power_pin_guard(const power_pin_guard &) = delete;
+			power_pin_guard &operator=(const power_pin_guard &) = delete;
+
+		private:
+			metee &_dev; /*!< Pinned session */
 		};
 	} // namespace security
 } // namespace intel
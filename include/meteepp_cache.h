@@ -0,0 +1,241 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+/*! \file meteepp_cache.h
+	\brief metee C++ response cache for idempotent firmware queries
+ */
+#ifndef _METEEPP_CACHE_H_
+#define _METEEPP_CACHE_H_
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "meteepp.h"
+
+namespace intel {
+	namespace security {
+
+		/*! In-process cache of firmware responses with per-entry time to live
+		 * \brief Entries are keyed by device, client GUID and request bytes.
+		 *        Invalidation is per device: all entries of the device are dropped at once.
+		 *        Thread safe, may be shared by several clients.
+		 */
+		class response_cache
+		{
+		public:
+			/*! Clock used for entry expiration */
+			typedef std::chrono::steady_clock clock;
+
+			response_cache() : _hits(0), _misses(0) {}
+			response_cache(const response_cache&) = delete;
+			response_cache& operator=(const response_cache&) = delete;
+
+			/*! Find valid entry
+			 *  \param device device identifier
+			 *  \param key entry key, should start with device identifier
+			 *  \param response filled with cached response on hit
+			 *  \return true on hit
+			 */
+			bool lookup(const std::string& device, const std::string& key, std::vector<uint8_t>& response)
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				std::unordered_map<std::string, entry>::iterator it = _entries.find(key);
+
+				if (it == _entries.end()) {
+					_misses++;
+					return false;
+				}
+				if (it->second.expires <= clock::now() || it->second.generation != _generations[device]) {
+					_entries.erase(it);
+					_misses++;
+					return false;
+				}
+				response.assign(it->second.data.begin(), it->second.data.end());
+				_hits++;
+				return true;
+			}
+
+			/*! Store entry
+			 *  \param device device identifier
+			 *  \param key entry key, should start with device identifier
+			 *  \param response response to cache
+			 *  \param ttl entry time to live
+			 */
+			void store(const std::string& device, const std::string& key,
+				const std::vector<uint8_t>& response, clock::duration ttl)
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				entry& e = _entries[key];
+
+				e.data = response;
+				e.expires = clock::now() + ttl;
+				e.generation = _generations[device];
+			}
+
+			/*! Drop all entries of the device
+			 *  \param device device identifier
+			 */
+			void invalidate(const std::string& device)
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_generations[device]++;
+			}
+
+			/*! Drop all entries */
+			void clear()
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_entries.clear();
+			}
+
+			/*! \return number of lookups served from the cache */
+			uint64_t hits() const
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				return _hits;
+			}
+			/*! \return number of lookups not served from the cache */
+			uint64_t misses() const
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				return _misses;
+			}
+
+		private:
+			struct entry {
+				std::vector<uint8_t> data;
+				clock::time_point expires;
+				uint64_t generation;
+			};
+
+			mutable std::mutex _mutex;
+			std::unordered_map<std::string, entry> _entries;
+			std::unordered_map<std::string, uint64_t> _generations;
+			uint64_t _hits;
+			uint64_t _misses;
+		};
+
+		/*! Client answering repeated idempotent queries from response_cache
+		 * \brief Firmware reset drops the device entries. Reset is detected by a change of
+		 *        the first FW status register, sampled on every miss and at most once per
+		 *        status interval on hits, by disconnect errors, and by connect() through the client.
+		 *        Only queries with static answers (versions, capabilities) should go through it.
+		 * \tparam Device device with metee read/write and fw_status interface
+		 */
+		template <typename Device>
+		class basic_cached_client
+		{
+		public:
+			/*! Constructor
+			 *  \param cache shared cache
+			 *  \param device device to query on miss
+			 *  \param device_id device identifier, e.g. device path
+			 *  \param guid client GUID of the connection
+			 *  \param status_interval minimal interval between FW status samples on hits
+			 */
+			basic_cached_client(response_cache& cache, Device& device, const std::string& device_id,
+				const GUID& guid, response_cache::clock::duration status_interval = std::chrono::milliseconds(100))
+				: _cache(cache), _device(device), _device_id(device_id), _interval(status_interval),
+				  _status(0), _status_valid(false)
+			{
+				_prefix = device_id;
+				_prefix.push_back('\0');
+				_prefix.append(reinterpret_cast<const char*>(&guid), sizeof(guid));
+				_key.reserve(_prefix.size() + device.max_msg_len());
+			}
+			basic_cached_client(const basic_cached_client&) = delete;
+			basic_cached_client& operator=(const basic_cached_client&) = delete;
+
+			/*! Answer query from the cache or from the device
+			 *  \param request request bytes
+			 *  \param ttl time to live of a new entry
+			 *  \param timeout The timeout for each of write and read in milliseconds, zero for infinite
+			 *  \return response, valid until the next call
+			 */
+			const std::vector<uint8_t>& transact(const std::vector<uint8_t>& request,
+				response_cache::clock::duration ttl, uint32_t timeout)
+			{
+				_key.assign(_prefix);
+				_key.append(reinterpret_cast<const char*>(request.data()), request.size());
+
+				response_cache::clock::time_point now = response_cache::clock::now();
+				bool sampled = false;
+				if (now - _sampled >= _interval) {
+					check_status(now);
+					sampled = true;
+				}
+				if (_cache.lookup(_device_id, _key, _response)) {
+					return _response;
+				}
+
+				if (!sampled) {
+					check_status(now);
+				}
+				_response.resize(_device.max_msg_len());
+				try {
+					_device.write(request.data(), request.size(), timeout);
+					_response.resize(_device.read(_response.data(), _response.size(), timeout));
+				}
+				catch (const metee_exception& ex) {
+					if (ex.code().category() == metee_category && ex.code().value() == TEE_DISCONNECTED) {
+						invalidate();
+					}
+					throw;
+				}
+				_cache.store(_device_id, _key, _response, ttl);
+				return _response;
+			}
+
+			/*! Reconnect the device and drop its entries */
+			void connect()
+			{
+				invalidate();
+				_device.connect();
+			}
+
+			/*! Drop all entries of the device */
+			void invalidate()
+			{
+				_status_valid = false;
+				_cache.invalidate(_device_id);
+			}
+
+		private:
+			void check_status(response_cache::clock::time_point now)
+			{
+				uint32_t status;
+
+				_sampled = now;
+				try {
+					status = _device.fw_status(0);
+				}
+				catch (const metee_exception&) {
+					return;
+				}
+				if (_status_valid && status != _status) {
+					_cache.invalidate(_device_id);
+				}
+				_status = status;
+				_status_valid = true;
+			}
+
+			response_cache& _cache;
+			Device& _device;
+			std::string _device_id;
+			std::string _prefix;
+			std::string _key;
+			std::vector<uint8_t> _response;
+			response_cache::clock::duration _interval;
+			response_cache::clock::time_point _sampled;
+			uint32_t _status;
+			bool _status_valid;
+		};
+
+		/*! Cached client over metee connection */
+		typedef basic_cached_client<metee> cached_metee;
+	} // namespace security
+} // namespace intel
+#endif // _METEEPP_CACHE_H_
@@ -0,0 +1,657 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+/*! \file meteepp_coro.h
+	\brief metee C++20 coroutine API
+ */
+#ifndef _METEEPP_CORO_H_
+#define _METEEPP_CORO_H_
+
+#if !defined(__cpp_impl_coroutine) || !__has_include(<coroutine>)
+#error "meteepp_coro.h requires C++20 coroutines support"
+#endif
+#ifndef __linux__
+#error "meteepp_coro.h is supported only on Linux"
+#endif
+
+#include <chrono>
+#include <concepts>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include "meteepp.h"
+
+namespace intel {
+	namespace security {
+
+		/*! Requirements on the device driven by the coroutine API
+		 *  \brief metee and any object with the same read/write interface
+		 */
+		template <typename D>
+		concept async_device = requires(D d, void *buf, const void *cbuf, size_t size, uint32_t timeout) {
+			{ d.device_handle() } -> std::convertible_to<int>;
+			{ d.max_msg_len() } -> std::convertible_to<uint32_t>;
+			{ d.read(buf, size, timeout) } -> std::convertible_to<size_t>;
+			{ d.write(cbuf, size, timeout) } -> std::convertible_to<size_t>;
+		};
+
+		template <typename T> class task;
+		class reactor;
+
+		namespace detail {
+			/*! Common part of task promise */
+			class task_promise_base {
+			public:
+				/*! Final awaiter, resumes awaiting coroutine */
+				struct final_awaiter {
+					bool await_ready() const noexcept { return false; }
+					template <typename P>
+					std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept
+					{
+						std::coroutine_handle<> cont = h.promise()._continuation;
+						return cont ? cont : std::noop_coroutine();
+					}
+					void await_resume() const noexcept {}
+				};
+
+				/*! Task is lazy, started on co_await */
+				std::suspend_always initial_suspend() const noexcept { return {}; }
+				/*! Resume continuation on exit */
+				final_awaiter final_suspend() const noexcept { return {}; }
+				/*! Store exception to rethrow in awaiter */
+				void unhandled_exception() noexcept { _exception = std::current_exception(); }
+
+				std::coroutine_handle<> _continuation; /*!< Awaiting coroutine */
+				std::exception_ptr _exception; /*!< Stored exception */
+			};
+
+			/*! Task promise returning value */
+			template <typename T>
+			class task_promise : public task_promise_base {
+			public:
+				task<T> get_return_object() noexcept;
+				/*! Store return value */
+				void return_value(T value) { _value.emplace(std::move(value)); }
+				/*! Retrieve result or rethrow */
+				T result()
+				{
+					if (_exception)
+						std::rethrow_exception(_exception);
+					return std::move(*_value);
+				}
+			private:
+				std::optional<T> _value;
+			};
+
+			/*! Task promise without value */
+			template <>
+			class task_promise<void> : public task_promise_base {
+			public:
+				task<void> get_return_object() noexcept;
+				/*! Nothing to store */
+				void return_void() noexcept {}
+				/*! Rethrow stored exception */
+				void result()
+				{
+					if (_exception)
+						std::rethrow_exception(_exception);
+				}
+			};
+		} // namespace detail
+
+		/*! Lazily started coroutine
+		 * \brief Result of the asynchronous metee operations,
+		 *        obtain the value with co_await or with reactor::run()
+		 */
+		template <typename T = void>
+		class task
+		{
+		public:
+			/*! Coroutine promise type */
+			using promise_type = detail::task_promise<T>;
+
+			/*! Constructor from coroutine handle */
+			explicit task(std::coroutine_handle<promise_type> h) noexcept : _h(h) {}
+			/*! Copy constructor - disabled */
+			task(const task &) = delete;
+			/*! Copy operator - disabled */
+			task &operator=(const task &) = delete;
+			/*! Move constructor */
+			task(task &&other) noexcept : _h(std::exchange(other._h, {})) {}
+			/*! Move operator */
+			task &operator=(task &&other) noexcept
+			{
+				if (this != &other) {
+					if (_h)
+						_h.destroy();
+					_h = std::exchange(other._h, {});
+				}
+				return *this;
+			}
+			/*! Destructor, destroys the coroutine frame */
+			~task()
+			{
+				if (_h)
+					_h.destroy();
+			}
+
+			/*! Awaiter interface: ready when already finished */
+			bool await_ready() const noexcept { return !_h || _h.done(); }
+			/*! Awaiter interface: start the task and resume awaiter on completion */
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept
+			{
+				_h.promise()._continuation = awaiter;
+				return _h;
+			}
+			/*! Awaiter interface: retrieve result or rethrow */
+			T await_resume() { return _h.promise().result(); }
+
+		private:
+			friend class reactor;
+			std::coroutine_handle<promise_type> _h;
+		};
+
+		namespace detail {
+			template <typename T>
+			inline task<T> task_promise<T>::get_return_object() noexcept
+			{
+				return task<T>(std::coroutine_handle<task_promise<T>>::from_promise(*this));
+			}
+
+			inline task<void> task_promise<void>::get_return_object() noexcept
+			{
+				return task<void>(std::coroutine_handle<task_promise<void>>::from_promise(*this));
+			}
+		} // namespace detail
+
+		/*! epoll based event loop
+		 * \brief Suspends coroutines waiting for device readiness and resumes them
+		 *        when the device file descriptor becomes ready, timed out or canceled.
+		 *        Coroutines awaiting the device must run on the reactor thread,
+		 *        stop(), post() and cancel() are safe to call from any thread.
+		 */
+		class reactor
+		{
+		public:
+			/*! Pending operation, internal */
+			struct operation {
+				int fd = -1; /*!< Device file descriptor */
+				bool on_read = true; /*!< Wait for read or write readiness */
+				bool has_deadline = false; /*!< Deadline is set */
+				std::chrono::steady_clock::time_point deadline; /*!< Operation timeout */
+				std::coroutine_handle<> waiter; /*!< Suspended coroutine */
+				TEESTATUS status = TEE_SUCCESS; /*!< Operation completion status */
+				bool pending = false; /*!< Operation is queued in reactor */
+			};
+
+			/*! Constructor */
+			reactor()
+			{
+				struct epoll_event ev = {};
+
+				_epfd = epoll_create1(EPOLL_CLOEXEC);
+				if (_epfd < 0) {
+					throw metee_exception("epoll_create1 failed", TEE_INTERNAL_ERROR);
+				}
+				_wakefd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+				if (_wakefd < 0) {
+					close(_epfd);
+					throw metee_exception("eventfd failed", TEE_INTERNAL_ERROR);
+				}
+				ev.events = EPOLLIN;
+				ev.data.fd = _wakefd;
+				if (epoll_ctl(_epfd, EPOLL_CTL_ADD, _wakefd, &ev)) {
+					close(_wakefd);
+					close(_epfd);
+					throw metee_exception("epoll_ctl failed", TEE_INTERNAL_ERROR);
+				}
+			}
+
+			/*! Copy constructor - disabled */
+			reactor(const reactor &) = delete;
+			/*! Copy operator - disabled */
+			reactor &operator=(const reactor &) = delete;
+
+			/*! Destructor */
+			~reactor()
+			{
+				_spawned.clear();
+				close(_wakefd);
+				close(_epfd);
+			}
+
+			/*! Run the loop until the task completes
+			 *  \param t task to run
+			 *  \return the task result
+			 */
+			template <typename T>
+			T run(task<T> t)
+			{
+				t._h.resume();
+				while (!t._h.done())
+					run_one(-1);
+				return t._h.promise().result();
+			}
+
+			/*! Start a task that runs concurrently with others,
+			 *  exception escaping the task is rethrown from run() or run_one(),
+			 *  one failed task per call
+			 *  \param t task to start
+			 */
+			void spawn(task<void> t)
+			{
+				_spawned.push_back(std::move(t));
+				_spawned.back()._h.resume();
+			}
+
+			/*! Run the loop until all spawned tasks complete or stop() is called */
+			void run()
+			{
+				_stopped = false;
+				while (!_stopped) {
+					/* tasks may have completed without waiting, e.g. right in spawn() */
+					_reap();
+					if (_spawned.empty() && _fds.empty())
+						break;
+					run_one(-1);
+				}
+			}
+
+			/*! Wait for events once and resume ready coroutines
+			 *  \param timeout_ms maximal wait in milliseconds, -1 for infinite
+			 *  \return number of completed operations
+			 */
+			size_t run_one(int timeout_ms)
+			{
+				const int MAX_EVENTS = 16;
+				struct epoll_event events[MAX_EVENTS];
+				int wait_ms = timeout_ms;
+				size_t completed;
+				int n;
+
+				_nearest_deadline(wait_ms);
+				n = epoll_wait(_epfd, events, MAX_EVENTS, wait_ms);
+				if (n < 0 && errno != EINTR) {
+					throw metee_exception("epoll_wait failed", TEE_INTERNAL_ERROR);
+				}
+
+				for (int i = 0; i < n; i++) {
+					if (events[i].data.fd == _wakefd) {
+						uint64_t cnt;
+						if (::read(_wakefd, &cnt, sizeof(cnt)) < 0 && errno != EAGAIN) {
+							throw metee_exception("eventfd read failed", TEE_INTERNAL_ERROR);
+						}
+						continue;
+					}
+					auto it = _fds.find(events[i].data.fd);
+					if (it == _fds.end())
+						continue;
+					const uint32_t err = EPOLLERR | EPOLLHUP;
+					if ((events[i].events & (EPOLLIN | err)) && !it->second.readers.empty())
+						_complete(it->second.readers.front(), TEE_SUCCESS);
+					if ((events[i].events & (EPOLLOUT | err)) && !it->second.writers.empty())
+						_complete(it->second.writers.front(), TEE_SUCCESS);
+				}
+
+				_run_posted();
+				_expire();
+
+				completed = _ready.size();
+				while (!_ready.empty()) {
+					operation *op = _ready.front();
+					_ready.pop_front();
+					op->waiter.resume();
+				}
+				_reap();
+				return completed;
+			}
+
+			/*! Stop the loop started by run() */
+			void stop()
+			{
+				post([this]() { _stopped = true; });
+			}
+
+			/*! Execute function on the reactor thread
+			 *  \param fn function to execute
+			 */
+			void post(std::function<void()> fn)
+			{
+				const uint64_t one = 1;
+				{
+					std::lock_guard<std::mutex> lock(_posted_lock);
+					_posted.push_back(std::move(fn));
+				}
+				if (::write(_wakefd, &one, sizeof(one)) < 0) {
+					throw metee_exception("eventfd write failed", TEE_INTERNAL_ERROR);
+				}
+			}
+
+			/*! Abort all pending operations on the device,
+			 *  those complete with TEE_UNABLE_TO_COMPLETE_OPERATION same as after TeeCancelIO
+			 *  \param fd device file descriptor
+			 */
+			void cancel(int fd)
+			{
+				post([this, fd]() { _cancel_fd(fd); });
+			}
+
+			/*! Queue operation, internal */
+			void add(operation *op)
+			{
+				auto &st = _fds[op->fd];
+				(op->on_read ? st.readers : st.writers).push_back(op);
+				op->pending = true;
+				_update(op->fd, st);
+			}
+
+			/*! Remove operation without completing it, internal */
+			void remove(operation *op)
+			{
+				for (auto qi = _ready.begin(); qi != _ready.end(); ++qi) {
+					if (*qi == op) {
+						_ready.erase(qi);
+						break;
+					}
+				}
+				_dequeue(op);
+			}
+
+		private:
+			struct fd_state {
+				std::deque<operation *> readers;
+				std::deque<operation *> writers;
+				uint32_t events = 0;
+			};
+
+			void _dequeue(operation *op)
+			{
+				if (!op->pending)
+					return;
+				auto it = _fds.find(op->fd);
+				if (it != _fds.end()) {
+					auto &q = op->on_read ? it->second.readers : it->second.writers;
+					for (auto qi = q.begin(); qi != q.end(); ++qi) {
+						if (*qi == op) {
+							q.erase(qi);
+							break;
+						}
+					}
+					_update(op->fd, it->second);
+				}
+				op->pending = false;
+			}
+
+			void _update(int fd, fd_state &st)
+			{
+				struct epoll_event ev = {};
+				int rc;
+
+				ev.events = (st.readers.empty() ? 0U : uint32_t(EPOLLIN)) | (st.writers.empty() ? 0U : uint32_t(EPOLLOUT));
+				ev.data.fd = fd;
+				if (ev.events == st.events)
+					return;
+				if (!ev.events)
+					rc = epoll_ctl(_epfd, EPOLL_CTL_DEL, fd, &ev);
+				else if (!st.events)
+					rc = epoll_ctl(_epfd, EPOLL_CTL_ADD, fd, &ev);
+				else
+					rc = epoll_ctl(_epfd, EPOLL_CTL_MOD, fd, &ev);
+				if (rc && ev.events) {
+					throw metee_exception("epoll_ctl failed", TEE_INTERNAL_ERROR);
+				}
+				st.events = ev.events;
+				if (!ev.events)
+					_fds.erase(fd);
+			}
+
+			void _complete(operation *op, TEESTATUS status)
+			{
+				_dequeue(op);
+				op->status = status;
+				_ready.push_back(op);
+			}
+
+			void _cancel_fd(int fd)
+			{
+				auto it = _fds.find(fd);
+				if (it == _fds.end())
+					return;
+
+				std::vector<operation *> canceled(it->second.readers.begin(), it->second.readers.end());
+				canceled.insert(canceled.end(), it->second.writers.begin(), it->second.writers.end());
+				for (operation *op : canceled)
+					_complete(op, TEE_UNABLE_TO_COMPLETE_OPERATION);
+			}
+
+			void _nearest_deadline(int &wait_ms) const
+			{
+				auto now = std::chrono::steady_clock::now();
+
+				for (const auto &fd : _fds) {
+					for (const auto *q : { &fd.second.readers, &fd.second.writers }) {
+						for (const operation *op : *q) {
+							if (!op->has_deadline)
+								continue;
+							auto left = std::chrono::ceil<std::chrono::milliseconds>(op->deadline - now).count();
+							int left_ms = left < 0 ? 0 : static_cast<int>(left);
+							if (wait_ms < 0 || left_ms < wait_ms)
+								wait_ms = left_ms;
+						}
+					}
+				}
+			}
+
+			void _expire()
+			{
+				auto now = std::chrono::steady_clock::now();
+				std::vector<operation *> expired;
+
+				for (const auto &fd : _fds)
+					for (const auto *q : { &fd.second.readers, &fd.second.writers })
+						for (operation *op : *q)
+							if (op->has_deadline && op->deadline <= now)
+								expired.push_back(op);
+				for (operation *op : expired)
+					_complete(op, TEE_TIMEOUT);
+			}
+
+			void _run_posted()
+			{
+				std::vector<std::function<void()>> posted;
+				{
+					std::lock_guard<std::mutex> lock(_posted_lock);
+					posted.swap(_posted);
+				}
+				for (auto &fn : posted)
+					fn();
+			}
+
+			/* drop finished tasks, stop at the first failed one so
+			 * exceptions of other failed tasks are rethrown by the next calls */
+			void _reap()
+			{
+				for (auto it = _spawned.begin(); it != _spawned.end();) {
+					if (!it->_h.done()) {
+						++it;
+						continue;
+					}
+					std::exception_ptr ex = it->_h.promise()._exception;
+					it = _spawned.erase(it);
+					if (ex)
+						std::rethrow_exception(ex);
+				}
+			}
+
+			int _epfd = -1;
+			int _wakefd = -1;
+			bool _stopped = false;
+			std::map<int, fd_state> _fds;
+			std::deque<operation *> _ready;
+			std::list<task<void>> _spawned;
+			std::mutex _posted_lock;
+			std::vector<std::function<void()>> _posted;
+		};
+
+		/*! Asynchronous interface to the TEE device
+		 * \brief Awaitable read/write/transact over metee or another device
+		 *        satisfying async_device, all operations are driven by the reactor.
+		 */
+		template <async_device Device>
+		class basic_async_metee
+		{
+		public:
+			/*! Awaitable I/O operation */
+			class io_awaiter
+			{
+			public:
+				/*! Constructor, internal */
+				io_awaiter(basic_async_metee &owner, bool on_read, void *buffer, size_t size, uint32_t timeout)
+					: _owner(owner), _buffer(buffer), _size(size), _timeout(timeout)
+				{
+					_op.on_read = on_read;
+				}
+				/*! Copy constructor - disabled */
+				io_awaiter(const io_awaiter &) = delete;
+				/*! Copy operator - disabled */
+				io_awaiter &operator=(const io_awaiter &) = delete;
+				/*! Destructor, withdraws the operation when awaiting coroutine is destroyed */
+				~io_awaiter() { _owner._reactor.remove(&_op); }
+
+				/*! Awaiter interface: always wait for the reactor */
+				bool await_ready() const noexcept { return false; }
+				/*! Awaiter interface: queue operation in the reactor */
+				void await_suspend(std::coroutine_handle<> h)
+				{
+					_op.fd = _owner._device.device_handle();
+					_op.waiter = h;
+					if (_timeout) {
+						_op.has_deadline = true;
+						_op.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(_timeout);
+					}
+					_owner._reactor.add(&_op);
+				}
+				/*! Awaiter interface: perform the I/O on ready device,
+				 *  bounded by what is left of the operation timeout
+				 *  \return the number of bytes transferred
+				 */
+				size_t await_resume()
+				{
+					uint32_t timeout = _timeout;
+
+					if (!TEE_IS_SUCCESS(_op.status)) {
+						throw metee_exception(_op.on_read ? "Read failed" : "Write failed", _op.status);
+					}
+					if (_op.has_deadline) {
+						/* zero means infinite for the device, keep at least 1ms */
+						auto left = std::chrono::ceil<std::chrono::milliseconds>(_op.deadline - std::chrono::steady_clock::now()).count();
+						timeout = left < 1 ? 1 : static_cast<uint32_t>(left);
+					}
+					if (_op.on_read)
+						return _owner._device.read(_buffer, _size, timeout);
+					return _owner._device.write(_buffer, _size, timeout);
+				}
+
+			private:
+				basic_async_metee &_owner;
+				reactor::operation _op;
+				void *_buffer;
+				size_t _size;
+				uint32_t _timeout;
+			};
+
+			/*! Constructor
+			 *  \param r reactor driving the operations
+			 *  \param device connected device
+			 */
+			basic_async_metee(reactor &r, Device &device) : _reactor(r), _device(device) {}
+
+			/*! Read data from the TEE device asynchronously.
+			 *  \param buffer A pointer to a buffer that receives the data read from the TEE device.
+			 *  \param size The size of the buffer in bytes.
+			 *  \param timeout The timeout to complete read in milliseconds, zero for infinite
+			 *  \return awaitable returning the number of bytes read
+			 */
+			io_awaiter read(void *buffer, size_t size, uint32_t timeout)
+			{
+				return io_awaiter(*this, true, buffer, size, timeout);
+			}
+
+			/*! Read data from the TEE device asynchronously.
+			 *  \param timeout The timeout to complete read in milliseconds, zero for infinite
+			 *  \return task returning vector with data read from the TEE device
+			 */
+			task<std::vector<uint8_t>> read(uint32_t timeout)
+			{
+				std::vector<uint8_t> buffer(_device.max_msg_len());
+
+				size_t size = co_await read(buffer.data(), buffer.size(), timeout);
+				buffer.resize(size);
+				co_return buffer;
+			}
+
+			/*! Writes the specified buffer to the TEE device asynchronously.
+			 *  \param buffer A pointer to the buffer containing the data to be written to the TEE device,
+			 *         should be valid until the operation completes.
+			 *  \param size The number of bytes to be written.
+			 *  \param timeout The timeout to complete write in milliseconds, zero for infinite
+			 *  \return awaitable returning the number of bytes written
+			 */
+			io_awaiter write(const void *buffer, size_t size, uint32_t timeout)
+			{
+				return io_awaiter(*this, false, const_cast<void *>(buffer), size, timeout);
+			}
+
+			/*! Writes the specified buffer to the TEE device asynchronously.
+			 *  \param buffer vector containing the data to be written to the TEE device,
+			 *         should be valid until the operation completes.
+			 *  \param timeout The timeout to complete write in milliseconds, zero for infinite
+			 *  \return awaitable returning the number of bytes written
+			 */
+			io_awaiter write(const std::vector<uint8_t> &buffer, uint32_t timeout)
+			{
+				return write(buffer.data(), buffer.size(), timeout);
+			}
+
+			/*! Write request and read the response asynchronously.
+			 *  \param request vector containing the data to be written to the TEE device
+			 *  \param timeout The timeout for each of write and read in milliseconds, zero for infinite
+			 *  \return task returning vector with the response
+			 */
+			task<std::vector<uint8_t>> transact(std::vector<uint8_t> request, uint32_t timeout)
+			{
+				co_await write(request.data(), request.size(), timeout);
+				co_return co_await read(timeout);
+			}
+
+			/*! Abort all pending asynchronous reads and writes on this device,
+			 *  those complete with TEE_UNABLE_TO_COMPLETE_OPERATION as with TeeCancelIO.
+			 *  Safe to call from any thread.
+			 */
+			void cancel_io()
+			{
+				_reactor.cancel(_device.device_handle());
+			}
+
+		private:
+			reactor &_reactor;
+			Device &_device;
+		};
+
+		/*! Asynchronous interface to metee */
+		using async_metee = basic_async_metee<metee>;
+	} // namespace security
+} // namespace intel
+#endif // _METEEPP_CORO_H_
@@ -0,0 +1,177 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+/*! \file meteepp_frag.h
+	\brief metee C++ large message fragmentation library
+ */
+#ifndef _METEEPP_FRAG_H_
+#define _METEEPP_FRAG_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "meteepp.h"
+
+namespace intel {
+	namespace security {
+		namespace frag {
+
+			/*! Default continuation header: total payload length and chunk offset.
+			 * \brief Framing policy interface:
+			 *        header_size - size of the header prepended to each chunk;
+			 *        encode(hdr, offset, total) - fill chunk header;
+			 *        decode(hdr, offset, total) - parse chunk header, false if malformed.
+			 */
+			struct offset_framing {
+				/*! Header size */
+				static const size_t header_size = 8;
+
+				/*! Fill chunk header
+				 *  \param hdr header storage, header_size bytes
+				 *  \param offset chunk offset in the payload
+				 *  \param total total payload size
+				 */
+				static void encode(uint8_t* hdr, size_t offset, size_t total)
+				{
+					uint32_t fields[2] = { static_cast<uint32_t>(total), static_cast<uint32_t>(offset) };
+					std::memcpy(hdr, fields, sizeof(fields));
+				}
+
+				/*! Parse chunk header
+				 *  \param hdr header storage, header_size bytes
+				 *  \param offset chunk offset in the payload
+				 *  \param total total payload size
+				 *  \return false if header is malformed
+				 */
+				static bool decode(const uint8_t* hdr, size_t& offset, size_t& total)
+				{
+					uint32_t fields[2];
+					std::memcpy(fields, hdr, sizeof(fields));
+					total = fields[0];
+					offset = fields[1];
+					return offset <= total;
+				}
+			};
+
+			/*! Splits large payloads into client MTU sized messages and reassembles them
+			 * \brief Chunks of one payload are written back to back without waiting for
+			 *        the peer; received chunks are reassembled in a buffer that keeps its
+			 *        capacity between messages. Not thread safe.
+			 * \tparam Device device with metee read/write interface
+			 * \tparam Framing continuation header policy
+			 */
+			template <typename Device, typename Framing = offset_framing>
+			class basic_fragmenter
+			{
+			public:
+				/*! Constructor
+				 *  \param device connected device
+				 *  \param max_payload biggest payload accepted by read
+				 */
+				explicit basic_fragmenter(Device& device, size_t max_payload = 16 * 1024 * 1024)
+					: _device(device), _max_payload(max_payload),
+					  _tx(device.max_msg_len()), _chunk(device.max_msg_len())
+				{
+					if (_tx.size() <= Framing::header_size) {
+						throw metee_exception("Client MTU is too small", TEE_INVALID_PARAMETER);
+					}
+				}
+				basic_fragmenter(const basic_fragmenter&) = delete;
+				basic_fragmenter& operator=(const basic_fragmenter&) = delete;
+
+				/*! \return payload bytes carried by one message */
+				size_t chunk_size() const { return _tx.size() - Framing::header_size; }
+
+				/*! Write payload of any size
+				 *  \param data payload
+				 *  \param size payload size
+				 *  \param timeout The timeout for each message write in milliseconds, zero for infinite
+				 *  \return number of messages written
+				 */
+				size_t write(const void* data, size_t size, uint32_t timeout)
+				{
+					const uint8_t* payload = static_cast<const uint8_t*>(data);
+					size_t offset = 0;
+					size_t count = 0;
+
+					if (size > UINT32_MAX) {
+						throw metee_exception("Payload is too big", TEE_INVALID_PARAMETER);
+					}
+					do {
+						size_t len = (std::min)(chunk_size(), size - offset);
+						Framing::encode(_tx.data(), offset, size);
+						if (len) {
+							std::memcpy(_tx.data() + Framing::header_size, payload + offset, len);
+						}
+						_device.write(_tx.data(), Framing::header_size + len, timeout);
+						offset += len;
+						count++;
+					} while (offset < size);
+					return count;
+				}
+
+				/*! Write payload of any size
+				 *  \param data payload
+				 *  \param timeout The timeout for each message write in milliseconds, zero for infinite
+				 *  \return number of messages written
+				 */
+				size_t write(const std::vector<uint8_t>& data, uint32_t timeout)
+				{
+					return write(data.data(), data.size(), timeout);
+				}
+
+				/*! Read and reassemble one payload
+				 *  \param timeout The timeout for each message read in milliseconds, zero for infinite
+				 *  \return payload, valid until the next read
+				 */
+				const std::vector<uint8_t>& read(uint32_t timeout)
+				{
+					size_t received = 0;
+					size_t expected = 0;
+
+					do {
+						size_t size = _device.read(_chunk.data(), _chunk.size(), timeout);
+						size_t offset;
+						size_t total;
+						if (size < Framing::header_size ||
+						    !Framing::decode(_chunk.data(), offset, total)) {
+							throw metee_exception("Malformed chunk header", TEE_INTERNAL_ERROR);
+						}
+						size_t len = size - Framing::header_size;
+						if (received == 0) {
+							if (total > _max_payload) {
+								throw metee_exception("Payload is too big", TEE_INSUFFICIENT_BUFFER);
+							}
+							expected = total;
+							_rx.resize(total);
+						}
+						if (total != expected || offset != received || len > expected - received) {
+							throw metee_exception("Unexpected chunk", TEE_INTERNAL_ERROR);
+						}
+						if (len) {
+							std::memcpy(_rx.data() + offset, _chunk.data() + Framing::header_size, len);
+						}
+						received += len;
+						if (!len && received < expected) {
+							throw metee_exception("Empty chunk", TEE_INTERNAL_ERROR);
+						}
+					} while (received < expected);
+					return _rx;
+				}
+
+			private:
+				Device& _device;
+				size_t _max_payload;
+				std::vector<uint8_t> _tx;
+				std::vector<uint8_t> _chunk;
+				std::vector<uint8_t> _rx;
+			};
+
+			/*! Fragmentation over metee connection with default framing */
+			typedef basic_fragmenter<metee> fragmenter;
+		} // namespace frag
+	} // namespace security
+} // namespace intel
+#endif // _METEEPP_FRAG_H_
@@ -0,0 +1,366 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+/*! \file meteepp_gsc.h
+	\brief metee C++ GSC firmware update streaming library
+ */
+#ifndef _METEEPP_GSC_H_
+#define _METEEPP_GSC_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#else /* _WIN32 */
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif /* _WIN32 */
+#include "meteepp.h"
+
+namespace intel {
+	namespace security {
+		namespace gsc {
+
+			/*! GSC firmware update client GUID */
+			DEFINE_GUID(FWU_GUID, 0x87d90ca5, 0x3495, 0x4559,
+				0x81, 0x05, 0x3f, 0xbf, 0xa3, 0x7b, 0x8b, 0x79);
+
+			/*! GSC firmware update command ids */
+			enum fwu_command : uint8_t {
+				FWU_START = 1,
+				FWU_DATA = 2,
+				FWU_END = 3,
+				FWU_GET_IP_VERSION = 6
+			};
+
+			/*! GSC firmware update payload types */
+			enum fwu_payload_type : uint32_t {
+				PAYLOAD_TYPE_INVALID = 0,
+				PAYLOAD_TYPE_GFX_FW = 1,
+				PAYLOAD_TYPE_OPROM_DATA = 2,
+				PAYLOAD_TYPE_OPROM_CODE = 3
+			};
+
+			/*! GSC firmware update status codes */
+			enum fwu_status : uint32_t {
+				FWU_STATUS_SUCCESS = 0x0,
+				FWU_STATUS_SIZE_ERROR = 0x5,
+				FWU_STATUS_INVALID_PARAMS = 0x85,
+				FWU_STATUS_INVALID_COMMAND = 0x8D,
+				FWU_STATUS_FAILURE = 0x9E
+			};
+
+#pragma pack(push, 1)
+			/*! GSC firmware update message header */
+			struct fwu_header {
+				uint8_t command_id; /*!< command, from enum fwu_command */
+				uint8_t is_response : 1; /*!< set by firmware in responses */
+				uint8_t reserved : 7; /*!< reserved */
+				uint8_t reserved2[2]; /*!< reserved */
+			};
+
+			/*! GSC firmware update response, common for all commands */
+			struct fwu_response {
+				fwu_header header; /*!< message header */
+				uint32_t status; /*!< command status, from enum fwu_status */
+				uint32_t reserved; /*!< reserved */
+			};
+
+			/*! GSC firmware update start request, followed by update metadata */
+			struct fwu_start_req {
+				fwu_header header; /*!< message header */
+				uint32_t update_img_length; /*!< total image length */
+				uint32_t payload_type; /*!< payload type, from enum fwu_payload_type */
+				uint32_t flags; /*!< update flags */
+				uint32_t reserved[8]; /*!< reserved */
+			};
+
+			/*! GSC firmware update data request, followed by data_length bytes of image */
+			struct fwu_data_req {
+				fwu_header header; /*!< message header */
+				uint32_t data_length; /*!< chunk length */
+				uint32_t reserved; /*!< reserved */
+			};
+
+			/*! GSC firmware update end request */
+			struct fwu_end_req {
+				fwu_header header; /*!< message header */
+				uint32_t reserved; /*!< reserved */
+			};
+#pragma pack(pop)
+
+			/*! \def FWU_STATUS(state)
+			 * Internal macro
+			 */
+
+			/*! GSC firmware update status error category class */
+			static class fwu_category_t : public std::error_category {
+			public:
+				virtual const char* name() const noexcept { return "GSC FWU"; }
+				virtual std::string message(int ev) const {
+#define FWU_STATUS(state) case FWU_STATUS_##state: return #state
+					switch (ev) {
+						FWU_STATUS(SUCCESS);
+						FWU_STATUS(SIZE_ERROR);
+						FWU_STATUS(INVALID_PARAMS);
+						FWU_STATUS(INVALID_COMMAND);
+						FWU_STATUS(FAILURE);
+					default:
+						return std::to_string(ev);
+					}
+#undef FWU_STATUS
+				}
+			} fwu_category;
+
+			/*! Firmware update image mapped read-only into memory */
+			class image_map
+			{
+			public:
+				/*! Constructor
+				 *  \param path image file path
+				 */
+				explicit image_map(const std::string& path) : _data(nullptr), _size(0)
+				{
+#ifdef _WIN32
+					HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+						OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+					if (file == INVALID_HANDLE_VALUE) {
+						throw metee_exception("Image open failed", TEE_DEVICE_NOT_FOUND);
+					}
+					LARGE_INTEGER size;
+					if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+						CloseHandle(file);
+						throw metee_exception("Image is empty", TEE_INVALID_PARAMETER);
+					}
+					HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+					CloseHandle(file);
+					if (mapping == NULL) {
+						throw metee_exception("Image map failed", TEE_INTERNAL_ERROR);
+					}
+					_data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+					CloseHandle(mapping);
+					if (_data == NULL) {
+						throw metee_exception("Image map failed", TEE_INTERNAL_ERROR);
+					}
+					_size = static_cast<size_t>(size.QuadPart);
+#else /* _WIN32 */
+					int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+					if (fd == -1) {
+						throw metee_exception("Image open failed", TEE_DEVICE_NOT_FOUND);
+					}
+					struct stat st;
+					if (fstat(fd, &st) || st.st_size == 0) {
+						close(fd);
+						throw metee_exception("Image is empty", TEE_INVALID_PARAMETER);
+					}
+					void* addr = mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+					close(fd);
+					if (addr == MAP_FAILED) {
+						throw metee_exception("Image map failed", TEE_INTERNAL_ERROR);
+					}
+					madvise(addr, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+					_data = static_cast<const uint8_t*>(addr);
+					_size = static_cast<size_t>(st.st_size);
+#endif /* _WIN32 */
+				}
+				image_map(const image_map&) = delete;
+				image_map& operator=(const image_map&) = delete;
+				/*! Destructor */
+				~image_map()
+				{
+#ifdef _WIN32
+					UnmapViewOfFile(_data);
+#else /* _WIN32 */
+					munmap(const_cast<uint8_t*>(_data), _size);
+#endif /* _WIN32 */
+				}
+
+				/*! \return mapped image */
+				const uint8_t* data() const { return _data; }
+				/*! \return image size */
+				size_t size() const { return _size; }
+
+			private:
+				const uint8_t* _data;
+				size_t _size;
+			};
+
+			/*! Firmware update progress */
+			struct fwu_progress {
+				size_t acked; /*!< image bytes acknowledged by firmware */
+				size_t total; /*!< image size */
+				size_t chunks; /*!< data chunks acknowledged by firmware */
+				std::chrono::steady_clock::duration elapsed; /*!< time since update start */
+
+				/*! \return throughput in bytes per second */
+				double throughput() const
+				{
+					double sec = std::chrono::duration<double>(elapsed).count();
+					return sec > 0 ? static_cast<double>(acked) / sec : 0;
+				}
+				/*! \return completion percentage */
+				unsigned int percent() const
+				{
+					return total ? static_cast<unsigned int>(acked * 100 / total) : 100;
+				}
+			};
+
+			/*! Progress report callback */
+			typedef std::function<void(const fwu_progress&)> fwu_progress_callback;
+
+			/*! GSC firmware update streaming sender
+			 * \brief Image is sent in chunks filling the client MTU, up to window
+			 *        data chunks are written before waiting for their acknowledgments.
+			 *        Window of one is strictly serial; bigger window needs firmware
+			 *        that queues requests on the connection.
+			 * \tparam Device device with metee read/write interface
+			 */
+			template <typename Device>
+			class basic_fwu_streamer
+			{
+			public:
+				/*! Constructor
+				 *  \param device connected device
+				 *  \param window maximum data chunks in flight
+				 */
+				explicit basic_fwu_streamer(Device& device, size_t window = 1)
+					: _device(device), _window(window ? window : 1),
+					  _tx(device.max_msg_len()), _rx(device.max_msg_len())
+				{
+					if (_tx.size() <= sizeof(fwu_data_req)) {
+						throw metee_exception("Client MTU is too small", TEE_INVALID_PARAMETER);
+					}
+				}
+				basic_fwu_streamer(const basic_fwu_streamer&) = delete;
+				basic_fwu_streamer& operator=(const basic_fwu_streamer&) = delete;
+
+				/*! \return image bytes carried by one data chunk */
+				size_t chunk_size() const { return _tx.size() - sizeof(fwu_data_req); }
+
+				/*! Stream firmware update image
+				 *  \param payload_type payload type, from enum fwu_payload_type
+				 *  \param image image data
+				 *  \param size image size
+				 *  \param meta update metadata sent with start request, may be null
+				 *  \param meta_size metadata size
+				 *  \param timeout The timeout for each of write and read in milliseconds, zero for infinite
+				 *  \param progress callback called for every acknowledged chunk, may be empty
+				 *  \return final progress
+				 *  \throw metee_exception in fwu_category when firmware returns failure status
+				 */
+				fwu_progress update(uint32_t payload_type, const uint8_t* image, size_t size,
+					const uint8_t* meta, size_t meta_size, uint32_t timeout,
+					const fwu_progress_callback& progress = fwu_progress_callback())
+				{
+					if (!image || !size || size > UINT32_MAX ||
+					    sizeof(fwu_start_req) + meta_size > _tx.size()) {
+						throw metee_exception("Invalid update image", TEE_INVALID_PARAMETER);
+					}
+
+					std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+					fwu_progress state = fwu_progress();
+					state.total = size;
+
+					fwu_start_req* start_req = reinterpret_cast<fwu_start_req*>(_tx.data());
+					std::memset(start_req, 0, sizeof(*start_req));
+					start_req->header.command_id = FWU_START;
+					start_req->update_img_length = static_cast<uint32_t>(size);
+					start_req->payload_type = payload_type;
+					if (meta_size) {
+						std::memcpy(_tx.data() + sizeof(*start_req), meta, meta_size);
+					}
+					_device.write(_tx.data(), sizeof(*start_req) + meta_size, timeout);
+					receive(FWU_START, timeout);
+
+					fwu_data_req* data_req = reinterpret_cast<fwu_data_req*>(_tx.data());
+					std::memset(data_req, 0, sizeof(*data_req));
+					data_req->header.command_id = FWU_DATA;
+
+					std::vector<size_t> inflight;
+					inflight.reserve(_window);
+					size_t sent = 0;
+					while (sent < size || !inflight.empty()) {
+						if (sent < size && inflight.size() < _window) {
+							size_t len = (std::min)(chunk_size(), size - sent);
+							data_req->data_length = static_cast<uint32_t>(len);
+							std::memcpy(_tx.data() + sizeof(*data_req), image + sent, len);
+							_device.write(_tx.data(), sizeof(*data_req) + len, timeout);
+							inflight.push_back(len);
+							sent += len;
+							continue;
+						}
+						receive(FWU_DATA, timeout);
+						state.acked += inflight.front();
+						state.chunks++;
+						inflight.erase(inflight.begin());
+						if (progress) {
+							state.elapsed = std::chrono::steady_clock::now() - start;
+							progress(state);
+						}
+					}
+
+					fwu_end_req end_req;
+					std::memset(&end_req, 0, sizeof(end_req));
+					end_req.header.command_id = FWU_END;
+					_device.write(&end_req, sizeof(end_req), timeout);
+					receive(FWU_END, timeout);
+
+					state.elapsed = std::chrono::steady_clock::now() - start;
+					return state;
+				}
+
+				/*! Stream firmware update image
+				 *  \param payload_type payload type, from enum fwu_payload_type
+				 *  \param image mapped image
+				 *  \param meta update metadata sent with start request
+				 *  \param timeout The timeout for each of write and read in milliseconds, zero for infinite
+				 *  \param progress callback called for every acknowledged chunk, may be empty
+				 *  \return final progress
+				 *  \throw metee_exception in fwu_category when firmware returns failure status
+				 */
+				fwu_progress update(uint32_t payload_type, const image_map& image,
+					const std::vector<uint8_t>& meta, uint32_t timeout,
+					const fwu_progress_callback& progress = fwu_progress_callback())
+				{
+					return update(payload_type, image.data(), image.size(),
+						meta.data(), meta.size(), timeout, progress);
+				}
+
+			private:
+				void receive(uint8_t command, uint32_t timeout)
+				{
+					size_t size = _device.read(_rx.data(), _rx.size(), timeout);
+					if (size < sizeof(fwu_response)) {
+						throw metee_exception("FWU response is too short", TEE_INTERNAL_ERROR);
+					}
+
+					fwu_response rsp;
+					std::memcpy(&rsp, _rx.data(), sizeof(rsp));
+					if (rsp.header.command_id != command || !rsp.header.is_response) {
+						throw metee_exception("FWU response header mismatch", TEE_INTERNAL_ERROR);
+					}
+					if (rsp.status != FWU_STATUS_SUCCESS) {
+						throw metee_exception(static_cast<int>(rsp.status), fwu_category, "FWU command failed");
+					}
+				}
+
+				Device& _device;
+				size_t _window;
+				std::vector<uint8_t> _tx;
+				std::vector<uint8_t> _rx;
+			};
+
+			/*! GSC firmware update streaming sender over metee connection */
+			typedef basic_fwu_streamer<metee> fwu_streamer;
+		} // namespace gsc
+	} // namespace security
+} // namespace intel
+#endif // _METEEPP_GSC_H_
@@ -0,0 +1,374 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+/*! \file meteepp_lanes.h
+	\brief metee C++ priority lanes for urgent and bulk traffic to the same firmware client
+ */
+#ifndef _METEEPP_LANES_H_
+#define _METEEPP_LANES_H_
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include "meteepp.h"
+
+namespace intel {
+	namespace security {
+
+		/*! Traffic class of a request, urgent requests go first */
+		enum class lane : unsigned int {
+			urgent = 0, /**< latency sensitive queries: watchdog, health, status */
+			bulk = 1, /**< long transfers: firmware update, data streaming */
+		};
+
+		/*! Number of traffic classes */
+		static const size_t lane_count = 2;
+
+		/*! Per-class statistics */
+		struct lane_stats {
+			uint64_t requests; /**< completed exchanges */
+			uint64_t errors; /**< exchanges ended by an error, queue timeouts included */
+			uint64_t overtakes; /**< exchanges dispatched while a lower class was waiting */
+			struct tee_stats_hist queue; /**< time from submit to dispatch */
+			struct tee_stats_hist latency; /**< time from submit to the end of the exchange */
+		};
+
+		/*! Priority scheduler of exchanges with a firmware client
+		 * \brief An exchange is a write and the following read. When the lanes share one
+		 *        connection, an exchange waiting in a higher class is dispatched before any
+		 *        waiting lower-class one as soon as the running exchange completes; a lane
+		 *        may also get its own connection when the client accepts several.
+		 *        Exchanges run on the calling threads, no thread is created. Thread safe.
+		 * \tparam Device device with metee read/write interface
+		 */
+		template <typename Device>
+		class basic_lane_scheduler
+		{
+		public:
+			/*! Clock of the statistics */
+			typedef std::chrono::steady_clock clock;
+
+			/*! Constructor, all lanes share the connection
+			 *  \param device connected device
+			 */
+			explicit basic_lane_scheduler(Device& device)
+			{
+				_groups[0].device = &device;
+				for (size_t i = 0; i < lane_count; i++)
+					_lanes[i] = &_groups[0];
+				std::memset(_stats, 0, sizeof(_stats));
+			}
+
+			/*! Constructor, every lane has its own connection
+			 *  \param urgent connected device of the urgent lane
+			 *  \param bulk connected device of the bulk lane
+			 */
+			basic_lane_scheduler(Device& urgent, Device& bulk)
+			{
+				_groups[static_cast<size_t>(lane::urgent)].device = &urgent;
+				_groups[static_cast<size_t>(lane::bulk)].device = &bulk;
+				for (size_t i = 0; i < lane_count; i++)
+					_lanes[i] = &_groups[i];
+				std::memset(_stats, 0, sizeof(_stats));
+			}
+			basic_lane_scheduler(const basic_lane_scheduler&) = delete;
+			basic_lane_scheduler& operator=(const basic_lane_scheduler&) = delete;
+
+			/*! Device-like access to one lane for multi-message protocols
+			 * \brief The first write takes the connection in the lane order, the read matching
+			 *        the last outstanding write releases it, so pipelined writes keep the
+			 *        connection until all their responses are read. Protocols with more responses
+			 *        than requests keep it with hold() until release().
+			 *        Not thread safe, use one channel per thread.
+			 */
+			class channel
+			{
+			public:
+				/*! Constructor
+				 *  \param scheduler scheduler
+				 *  \param cls traffic class of the channel
+				 */
+				channel(basic_lane_scheduler& scheduler, lane cls)
+					: _sched(scheduler), _cls(cls), _held(false), _hold(false), _pending(0) {}
+				channel(const channel&) = delete;
+				channel& operator=(const channel&) = delete;
+
+				/*! Destructor, releases the connection taken by write without read */
+				~channel()
+				{
+					if (_held)
+						_sched.release(_cls, _submit, false);
+				}
+
+				/*! \return maximum message length of the lane connection */
+				uint32_t max_msg_len()
+				{
+					return _sched.device(_cls).max_msg_len();
+				}
+
+				/*! Take the connection and keep it until release()
+				 *  \param timeout The timeout for dispatch in milliseconds, zero for infinite
+				 */
+				void hold(uint32_t timeout)
+				{
+					take(timeout);
+					_hold = true;
+				}
+
+				/*! Give up the connection taken by hold() once no response is outstanding */
+				void release()
+				{
+					_hold = false;
+					if (_held && !_pending)
+						drop(true);
+				}
+
+				/*! Write, takes the connection if not taken
+				 *  \param buffer data to write
+				 *  \param size data size
+				 *  \param timeout The timeout for each of dispatch and write in milliseconds, zero for infinite
+				 *  \return the number of bytes written
+				 */
+				size_t write(const void *buffer, size_t size, uint32_t timeout)
+				{
+					size_t len;
+
+					take(timeout);
+					try {
+						len = _sched.device(_cls).write(buffer, size, timeout);
+					}
+					catch (...) {
+						drop(false);
+						throw;
+					}
+					_pending++;
+					return len;
+				}
+
+				/*! Read, releases the connection when it answers the last outstanding write
+				 *  \param buffer buffer to fill
+				 *  \param size buffer size
+				 *  \param timeout The timeout for each of dispatch and read in milliseconds, zero for infinite
+				 *  \return the number of bytes read
+				 */
+				size_t read(void *buffer, size_t size, uint32_t timeout)
+				{
+					size_t len;
+
+					take(timeout);
+					try {
+						len = _sched.device(_cls).read(buffer, size, timeout);
+					}
+					catch (...) {
+						drop(false);
+						throw;
+					}
+					if (_pending)
+						_pending--;
+					if (!_pending && !_hold)
+						drop(true);
+					return len;
+				}
+
+			private:
+				void take(uint32_t timeout)
+				{
+					if (_held)
+						return;
+					_submit = clock::now();
+					_sched.acquire(_cls, _submit, timeout);
+					_held = true;
+				}
+
+				void drop(bool ok)
+				{
+					_held = false;
+					_hold = false;
+					_pending = 0;
+					_sched.release(_cls, _submit, ok);
+				}
+
+				basic_lane_scheduler& _sched;
+				lane _cls;
+				bool _held;
+				bool _hold; /* kept by hold() until release() */
+				size_t _pending; /* writes without matching read */
+				clock::time_point _submit;
+			};
+
+			/*! Write request and read response in the lane order
+			 *  \param cls traffic class
+			 *  \param request request bytes
+			 *  \param request_size request size
+			 *  \param response buffer for the response
+			 *  \param response_size response buffer size
+			 *  \param timeout The timeout for each of dispatch, write and read in milliseconds, zero for infinite
+			 *  \return the number of bytes read
+			 */
+			size_t transact(lane cls, const void *request, size_t request_size,
+					void *response, size_t response_size, uint32_t timeout)
+			{
+				channel ch(*this, cls);
+
+				ch.write(request, request_size, timeout);
+				return ch.read(response, response_size, timeout);
+			}
+
+			/*! Write request and read response in the lane order
+			 *  \param cls traffic class
+			 *  \param request request bytes
+			 *  \param timeout The timeout for each of dispatch, write and read in milliseconds, zero for infinite
+			 *  \return the response
+			 */
+			std::vector<uint8_t> transact(lane cls, const std::vector<uint8_t>& request, uint32_t timeout)
+			{
+				std::vector<uint8_t> response(device(cls).max_msg_len());
+
+				response.resize(transact(cls, request.data(), request.size(),
+							 response.data(), response.size(), timeout));
+				return response;
+			}
+
+			/*! Statistics snapshot of the class
+			 *  \param cls traffic class
+			 *  \return statistics since construction
+			 */
+			lane_stats stats(lane cls) const
+			{
+				std::lock_guard<std::mutex> lock(_stats_mutex);
+				return _stats[static_cast<size_t>(cls)];
+			}
+
+		private:
+			struct waiter {
+				std::condition_variable cv;
+			};
+
+			/* lanes served by one connection */
+			struct group {
+				group() : device(nullptr), busy(false) {}
+				Device *device;
+				std::mutex mutex;
+				bool busy;
+				std::deque<waiter *> queues[lane_count];
+			};
+
+			Device& device(lane cls)
+			{
+				return *_lanes[static_cast<size_t>(cls)]->device;
+			}
+
+			/* the head of the highest non-empty class goes when the connection is free */
+			static waiter *next(group& g)
+			{
+				for (size_t i = 0; i < lane_count; i++) {
+					if (!g.queues[i].empty())
+						return g.queues[i].front();
+				}
+				return nullptr;
+			}
+
+			static bool lower_waiting(const group& g, size_t c)
+			{
+				for (size_t i = c + 1; i < lane_count; i++) {
+					if (!g.queues[i].empty())
+						return true;
+				}
+				return false;
+			}
+
+			void acquire(lane cls, clock::time_point submit, uint32_t timeout)
+			{
+				const size_t c = static_cast<size_t>(cls);
+				group& g = *_lanes[c];
+				std::unique_lock<std::mutex> lock(g.mutex);
+				waiter w;
+				bool overtake;
+
+				g.queues[c].push_back(&w);
+				while (g.busy || next(g) != &w) {
+					if (!timeout) {
+						w.cv.wait(lock);
+						continue;
+					}
+					if (w.cv.wait_until(lock, submit + std::chrono::milliseconds(timeout)) ==
+					    std::cv_status::timeout && (g.busy || next(g) != &w)) {
+						g.queues[c].erase(std::find(g.queues[c].begin(), g.queues[c].end(), &w));
+						wake(g);
+						lock.unlock();
+						record(c, submit, false, false);
+						throw metee_exception("Lane dispatch timed out", TEE_TIMEOUT);
+					}
+				}
+				g.queues[c].pop_front();
+				g.busy = true;
+				overtake = lower_waiting(g, c);
+				lock.unlock();
+
+				std::lock_guard<std::mutex> slock(_stats_mutex);
+				if (overtake)
+					_stats[c].overtakes++;
+				hist(_stats[c].queue, clock::now() - submit);
+			}
+
+			void release(lane cls, clock::time_point submit, bool ok)
+			{
+				const size_t c = static_cast<size_t>(cls);
+				group& g = *_lanes[c];
+
+				{
+					std::lock_guard<std::mutex> lock(g.mutex);
+					g.busy = false;
+					wake(g);
+				}
+				record(c, submit, ok, true);
+			}
+
+			/* called with the group lock held */
+			static void wake(group& g)
+			{
+				waiter *w = next(g);
+
+				if (w && !g.busy)
+					w->cv.notify_one();
+			}
+
+			void record(size_t c, clock::time_point submit, bool ok, bool dispatched)
+			{
+				std::lock_guard<std::mutex> lock(_stats_mutex);
+
+				if (ok)
+					_stats[c].requests++;
+				else
+					_stats[c].errors++;
+				if (dispatched)
+					hist(_stats[c].latency, clock::now() - submit);
+			}
+
+			static void hist(struct tee_stats_hist& h, clock::duration d)
+			{
+				int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+
+				if (us < 0)
+					us = 0;
+				h.count++;
+				h.total_us += static_cast<uint64_t>(us);
+				h.buckets[TeeStatsHistBucket(static_cast<uint64_t>(us))]++;
+			}
+
+			group _groups[lane_count];
+			group *_lanes[lane_count];
+			mutable std::mutex _stats_mutex;
+			lane_stats _stats[lane_count];
+		};
+
+		/*! Lane scheduler over metee connections */
+		typedef basic_lane_scheduler<metee> lane_scheduler;
+	} // namespace security
+} // namespace intel
+#endif // _METEEPP_LANES_H_
@@ -0,0 +1,459 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+/*! \file meteepp_mkhi.h
+	\brief metee C++ MKHI client library
+ */
+#ifndef _METEEPP_MKHI_H_
+#define _METEEPP_MKHI_H_
+
+#include <cstring>
+#include <deque>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "meteepp.h"
+
+namespace intel {
+	namespace security {
+		namespace mkhi {
+
+			/*! MKHI client GUID */
+			DEFINE_GUID(MKHI_GUID, 0x8e6a6715, 0x9abc, 0x4043,
+				0x88, 0xef, 0x9e, 0x39, 0xc6, 0xf6, 0x3e, 0xf);
+
+			/*! MKHI group ids */
+			enum group_id : uint8_t {
+				CBM_GROUP_ID = 0,
+				PM_GROUP_ID,
+				PWD_GROUP_ID,
+				FWCAPS_GROUP_ID,
+				APP_GROUP_ID,
+				FWUPDATE_GROUP_ID,
+				FIRMWARE_UPDATE_GROUP_ID,
+				BIST_GROUP_ID,
+				MDES_GROUP_ID,
+				ME_DBG_GROUP_ID,
+				GEN_GROUP_ID = 0xFF
+			};
+
+			/*! MKHI result codes */
+			enum status : uint8_t {
+				STATUS_SUCCESS = 0x0,
+				STATUS_INTERNAL_ERROR = 0x1,
+				STATUS_NOT_READY = 0x2,
+				STATUS_INVALID_AMT_MODE = 0x3,
+				STATUS_INVALID_MESSAGE_LENGTH = 0x4
+			};
+
+#pragma pack(push, 1)
+			/*! MKHI message header */
+			struct header {
+				uint32_t group_id : 8; /*!< command group */
+				uint32_t command : 7; /*!< command in the group */
+				uint32_t is_response : 1; /*!< set by firmware in responses */
+				uint32_t reserved : 8; /*!< reserved */
+				uint32_t result : 8; /*!< result of the command, from enum status */
+			};
+#pragma pack(pop)
+			static_assert(sizeof(header) == 4, "MKHI header should be 4 bytes exactly!");
+
+			/*! \def MKHI_STATUS(state)
+			 * Internal macro
+			 */
+
+			/*! MKHI result error category class */
+			static class mkhi_category_t : public std::error_category {
+			public:
+				virtual const char* name() const noexcept { return "MKHI"; }
+				virtual std::string message(int ev) const {
+#define MKHI_STATUS(state) case STATUS_##state: return #state
+					switch (ev) {
+						MKHI_STATUS(SUCCESS);
+						MKHI_STATUS(INTERNAL_ERROR);
+						MKHI_STATUS(NOT_READY);
+						MKHI_STATUS(INVALID_AMT_MODE);
+						MKHI_STATUS(INVALID_MESSAGE_LENGTH);
+					default:
+						return std::to_string(ev);
+					}
+#undef MKHI_STATUS
+				}
+			} mkhi_category;
+
+			/*! MKHI command failure exception, carries MKHI result in mkhi_category */
+			class mkhi_error : public metee_exception
+			{
+			public:
+				/*! Constructor
+				 *  \param group command group
+				 *  \param command command in the group
+				 *  \param result MKHI result from the response header
+				 */
+				mkhi_error(uint8_t group, uint8_t command, uint8_t result)
+					: metee_exception(result, mkhi_category, "MKHI command failed"),
+					  _group(group), _command(command) {}
+				/*! Destructor */
+				virtual ~mkhi_error() noexcept {}
+				/*! \return group of the failed command */
+				uint8_t group() const { return _group; }
+				/*! \return failed command */
+				uint8_t command() const { return _command; }
+			private:
+				uint8_t _group;
+				uint8_t _command;
+			};
+
+			class buffer_pool;
+
+			/*! Buffer taken from buffer_pool, returned to the pool on destruction */
+			class pooled_buffer
+			{
+			public:
+				/*! Empty buffer */
+				pooled_buffer() : _pool(nullptr) {}
+				/*! Move constructor
+				 *  \param other object to move from
+				 */
+				pooled_buffer(pooled_buffer&& other) noexcept
+					: _pool(other._pool), _data(std::move(other._data))
+				{
+					other._pool = nullptr;
+				}
+				/*! Move operator
+				 *  \param other object to move from
+				 */
+				pooled_buffer& operator=(pooled_buffer&& other) noexcept
+				{
+					if (this != &other) {
+						release();
+						_pool = other._pool;
+						_data = std::move(other._data);
+						other._pool = nullptr;
+					}
+					return *this;
+				}
+				pooled_buffer(const pooled_buffer&) = delete;
+				pooled_buffer& operator=(const pooled_buffer&) = delete;
+				/*! Destructor */
+				~pooled_buffer() { release(); }
+
+				/*! \return buffer data */
+				uint8_t* data() { return _data.data(); }
+				/*! \return buffer data */
+				const uint8_t* data() const { return _data.data(); }
+				/*! \return buffer capacity */
+				size_t size() const { return _data.size(); }
+
+			private:
+				friend class buffer_pool;
+				pooled_buffer(buffer_pool* pool, std::vector<uint8_t>&& data)
+					: _pool(pool), _data(std::move(data)) {}
+				inline void release();
+
+				buffer_pool* _pool;
+				std::vector<uint8_t> _data;
+			};
+
+			/*! Pool of fixed size buffers, avoids allocation per message
+			 * \brief Not thread safe, owned by one client.
+			 */
+			class buffer_pool
+			{
+			public:
+				/*! Constructor
+				 *  \param size size of each buffer
+				 */
+				explicit buffer_pool(size_t size) : _size(size), _allocations(0) {}
+				buffer_pool(const buffer_pool&) = delete;
+				buffer_pool& operator=(const buffer_pool&) = delete;
+
+				/*! Take buffer from the pool, allocate if the pool is empty
+				 *  \return buffer of pool size
+				 */
+				pooled_buffer acquire()
+				{
+					if (_free.empty()) {
+						_allocations++;
+						return pooled_buffer(this, std::vector<uint8_t>(_size));
+					}
+					std::vector<uint8_t> data(std::move(_free.back()));
+					_free.pop_back();
+					return pooled_buffer(this, std::move(data));
+				}
+
+				/*! \return number of buffers allocated by the pool */
+				size_t allocations() const { return _allocations; }
+				/*! \return number of buffers available in the pool */
+				size_t available() const { return _free.size(); }
+
+			private:
+				friend class pooled_buffer;
+				void put(std::vector<uint8_t>&& data) { _free.push_back(std::move(data)); }
+
+				size_t _size;
+				size_t _allocations;
+				std::vector<std::vector<uint8_t>> _free;
+			};
+
+			inline void pooled_buffer::release()
+			{
+				if (_pool) {
+					_pool->put(std::move(_data));
+					_pool = nullptr;
+				}
+			}
+
+			/*! MKHI response received into pooled buffer */
+			class response
+			{
+			public:
+				/*! Empty response */
+				response() : _size(0) {}
+				/*! Constructor
+				 *  \param buffer buffer holding the message
+				 *  \param size message size
+				 */
+				response(pooled_buffer&& buffer, size_t size) : _buffer(std::move(buffer)), _size(size) {}
+
+				/*! \return message header */
+				struct header header() const
+				{
+					struct header hdr;
+					std::memcpy(&hdr, _buffer.data(), sizeof(hdr));
+					return hdr;
+				}
+				/*! \return whole message including header */
+				const uint8_t* data() const { return _buffer.data(); }
+				/*! \return whole message size */
+				size_t size() const { return _size; }
+				/*! \return message payload after the header */
+				const uint8_t* payload() const { return _buffer.data() + sizeof(struct header); }
+				/*! \return message payload size */
+				size_t payload_size() const { return _size - sizeof(struct header); }
+
+				/*! Copy the message into typed structure starting with MKHI header
+				 *  \tparam T trivially copyable message type
+				 *  \return the message
+				 */
+				template <typename T>
+				T as() const
+				{
+					static_assert(std::is_trivially_copyable<T>::value, "Response should be trivially copyable");
+					static_assert(sizeof(T) >= sizeof(struct header), "Response should start with MKHI header");
+					if (_size < sizeof(T)) {
+						throw metee_exception("Response is too short", TEE_INTERNAL_ERROR);
+					}
+					T msg;
+					std::memcpy(&msg, _buffer.data(), sizeof(T));
+					return msg;
+				}
+
+			private:
+				pooled_buffer _buffer;
+				size_t _size;
+			};
+
+			/*! MKHI client
+			 * \brief Requests are correlated with responses by group and command, in send order
+			 *        for the same group and command. Several independent requests may be sent
+			 *        before reading the responses. Not thread safe.
+			 * \tparam Device device with metee read/write interface
+			 */
+			template <typename Device>
+			class basic_client
+			{
+			public:
+				/*! Request identifier returned by send() */
+				typedef uint64_t ticket;
+
+				/*! Constructor
+				 *  \param device connected device
+				 */
+				explicit basic_client(Device& device)
+					: _device(device), _mtu(device.max_msg_len()), _pool(_mtu), _next(0) {}
+				basic_client(const basic_client&) = delete;
+				basic_client& operator=(const basic_client&) = delete;
+
+				/*! Send request built from header fields and payload
+				 *  \param group command group
+				 *  \param command command in the group
+				 *  \param payload request payload, may be null when size is zero
+				 *  \param size payload size
+				 *  \param timeout The timeout to complete write in milliseconds, zero for infinite
+				 *  \return ticket to receive the response
+				 */
+				ticket send(uint8_t group, uint8_t command, const void* payload, size_t size, uint32_t timeout)
+				{
+					if (command > 0x7F || sizeof(struct header) + size > _mtu) {
+						throw metee_exception("Invalid MKHI request", TEE_INVALID_PARAMETER);
+					}
+
+					pooled_buffer buf = _pool.acquire();
+					struct header hdr = header_for(group, command);
+					std::memcpy(buf.data(), &hdr, sizeof(hdr));
+					if (size) {
+						std::memcpy(buf.data() + sizeof(hdr), payload, size);
+					}
+					_device.write(buf.data(), sizeof(hdr) + size, timeout);
+					return enqueue(group, command);
+				}
+
+				/*! Send typed request, written directly from the request storage
+				 *  \tparam Request trivially copyable request starting with MKHI header
+				 *  \param request request to send
+				 *  \param timeout The timeout to complete write in milliseconds, zero for infinite
+				 *  \return ticket to receive the response
+				 */
+				template <typename Request>
+				ticket send(const Request& request, uint32_t timeout)
+				{
+					static_assert(std::is_trivially_copyable<Request>::value, "Request should be trivially copyable");
+					static_assert(sizeof(Request) >= sizeof(struct header), "Request should start with MKHI header");
+					if (sizeof(Request) > _mtu) {
+						throw metee_exception("Message is bigger than client MTU", TEE_INVALID_PARAMETER);
+					}
+
+					struct header hdr;
+					std::memcpy(&hdr, &request, sizeof(hdr));
+					_device.write(&request, sizeof(Request), timeout);
+					return enqueue(uint8_t(hdr.group_id), uint8_t(hdr.command));
+				}
+
+				/*! Receive response for the ticket
+				 *  \brief Responses for other pending tickets read on the way are kept
+				 *         until claimed, unsolicited messages are dropped.
+				 *  \param t ticket returned by send()
+				 *  \param timeout The timeout for each read in milliseconds, zero for infinite
+				 *  \return response
+				 *  \throw mkhi_error when firmware returns failure result
+				 */
+				response receive(ticket t, uint32_t timeout)
+				{
+					typename std::deque<pending>::iterator it = find(t);
+					while (!it->done) {
+						read_one(timeout);
+						it = find(t);
+					}
+
+					response rsp(std::move(it->rsp));
+					uint8_t group = it->group;
+					uint8_t command = it->command;
+					_pending.erase(it);
+
+					uint8_t result = uint8_t(rsp.header().result);
+					if (result != STATUS_SUCCESS) {
+						throw mkhi_error(group, command, result);
+					}
+					return rsp;
+				}
+
+				/*! Receive typed response for the ticket
+				 *  \tparam Response trivially copyable response starting with MKHI header
+				 *  \param t ticket returned by send()
+				 *  \param timeout The timeout for each read in milliseconds, zero for infinite
+				 *  \return response
+				 *  \throw mkhi_error when firmware returns failure result
+				 */
+				template <typename Response>
+				Response receive(ticket t, uint32_t timeout)
+				{
+					return receive(t, timeout).template as<Response>();
+				}
+
+				/*! Send typed request and receive typed response
+				 *  \tparam Request trivially copyable request starting with MKHI header
+				 *  \tparam Response trivially copyable response starting with MKHI header
+				 *  \param request request to send
+				 *  \param timeout The timeout for each of write and read in milliseconds, zero for infinite
+				 *  \return response
+				 *  \throw mkhi_error when firmware returns failure result
+				 */
+				template <typename Request, typename Response>
+				Response call(const Request& request, uint32_t timeout)
+				{
+					return receive<Response>(send(request, timeout), timeout);
+				}
+
+				/*! \return number of requests waiting for claim */
+				size_t in_flight() const { return _pending.size(); }
+
+				/*! \return buffer pool used for messages */
+				const buffer_pool& pool() const { return _pool; }
+
+			private:
+				struct pending {
+					ticket id;
+					uint8_t group;
+					uint8_t command;
+					bool done;
+					response rsp;
+				};
+
+				static struct header header_for(uint8_t group, uint8_t command)
+				{
+					struct header hdr;
+
+					std::memset(&hdr, 0, sizeof(hdr));
+					hdr.group_id = group;
+					hdr.command = command & 0x7F;
+					return hdr;
+				}
+
+				ticket enqueue(uint8_t group, uint8_t command)
+				{
+					pending p;
+
+					p.id = _next++;
+					p.group = group;
+					p.command = command;
+					p.done = false;
+					_pending.push_back(std::move(p));
+					return _pending.back().id;
+				}
+
+				typename std::deque<pending>::iterator find(ticket t)
+				{
+					for (typename std::deque<pending>::iterator it = _pending.begin(); it != _pending.end(); ++it) {
+						if (it->id == t)
+							return it;
+					}
+					throw metee_exception("Unknown MKHI ticket", TEE_INVALID_PARAMETER);
+				}
+
+				void read_one(uint32_t timeout)
+				{
+					pooled_buffer buf = _pool.acquire();
+					size_t size = _device.read(buf.data(), buf.size(), timeout);
+					if (size < sizeof(struct header)) {
+						throw metee_exception("MKHI response is too short", TEE_INTERNAL_ERROR);
+					}
+
+					struct header hdr;
+					std::memcpy(&hdr, buf.data(), sizeof(hdr));
+					if (!hdr.is_response)
+						return;
+					for (typename std::deque<pending>::iterator it = _pending.begin(); it != _pending.end(); ++it) {
+						if (!it->done && it->group == hdr.group_id && it->command == hdr.command) {
+							it->rsp = response(std::move(buf), size);
+							it->done = true;
+							return;
+						}
+					}
+				}
+
+				Device& _device;
+				size_t _mtu;
+				buffer_pool _pool;
+				ticket _next;
+				std::deque<pending> _pending;
+			};
+
+			/*! MKHI client over metee connection */
+			typedef basic_client<metee> client;
+		} // namespace mkhi
+	} // namespace security
+} // namespace intel
+#endif // _METEEPP_MKHI_H_
@@ -0,0 +1,372 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+/*! \file meteepp_workers.h
+	\brief metee C++ per-device I/O workers placed on the device NUMA node
+ */
+#ifndef _METEEPP_WORKERS_H_
+#define _METEEPP_WORKERS_H_
+
+#ifndef __linux__
+#error "meteepp_workers.h is supported only on Linux"
+#endif
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/mempolicy.h>
+#include "meteepp.h"
+
+namespace intel {
+	namespace security {
+
+		/*! Placement of a mei device: NUMA node and CPUs local to its PCI parent */
+		struct device_placement {
+			std::string name; /**< device name, e.g. mei0 */
+			std::string path; /**< device node, e.g. /dev/mei0 */
+			int numa_node; /**< NUMA node of the device, -1 if unknown */
+			std::vector<unsigned int> cpus; /**< CPUs local to the device, empty if unknown */
+		};
+
+		/*! Parse sysfs CPU list
+		 *  \param list list in "0-3,8,10-11" format
+		 *  \return CPU numbers in ascending order, empty on malformed list
+		 */
+		inline std::vector<unsigned int> parse_cpulist(const std::string& list)
+		{
+			std::vector<unsigned int> cpus;
+			const char *p = list.c_str();
+
+			while (*p && *p != '\n') {
+				char *end;
+				unsigned long first = std::strtoul(p, &end, 10);
+				unsigned long last = first;
+
+				if (end == p)
+					return std::vector<unsigned int>();
+				p = end;
+				if (*p == '-') {
+					last = std::strtoul(p + 1, &end, 10);
+					if (end == p + 1 || last < first || last >= CPU_SETSIZE)
+						return std::vector<unsigned int>();
+					p = end;
+				}
+				for (unsigned long cpu = first; cpu <= last; cpu++)
+					cpus.push_back(static_cast<unsigned int>(cpu));
+				if (*p == ',')
+					p++;
+				else if (*p && *p != '\n')
+					return std::vector<unsigned int>();
+			}
+			std::sort(cpus.begin(), cpus.end());
+			cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+			return cpus;
+		}
+
+		/*! Read device placement from sysfs
+		 *  \param name device name, e.g. mei0
+		 *  \param sysfs mei class directory
+		 *  \return placement, unknown node and CPUs when the attributes are missing
+		 */
+		inline device_placement read_placement(const std::string& name,
+						       const std::string& sysfs = "/sys/class/mei")
+		{
+			device_placement placement;
+			std::string dir = sysfs + "/" + name + "/device/";
+			std::string line;
+
+			placement.name = name;
+			placement.path = "/dev/" + name;
+			placement.numa_node = -1;
+
+			std::ifstream node(dir + "numa_node");
+			if (node >> placement.numa_node) {
+				if (placement.numa_node < -1)
+					placement.numa_node = -1;
+			} else {
+				placement.numa_node = -1;
+			}
+			std::ifstream cpulist(dir + "local_cpulist");
+			if (std::getline(cpulist, line))
+				placement.cpus = parse_cpulist(line);
+			return placement;
+		}
+
+		/*! Placements of all mei devices
+		 *  \param sysfs mei class directory
+		 *  \return placements ordered by device number
+		 */
+		inline std::vector<device_placement> list_placements(const std::string& sysfs = "/sys/class/mei")
+		{
+			std::vector<std::pair<unsigned long, std::string>> names;
+			std::vector<device_placement> placements;
+			DIR *dir = opendir(sysfs.c_str());
+			struct dirent *ent;
+
+			if (!dir)
+				return placements;
+			while ((ent = readdir(dir)) != nullptr) {
+				char *end;
+				unsigned long num;
+
+				if (std::string(ent->d_name).compare(0, 3, "mei") || !ent->d_name[3])
+					continue;
+				num = std::strtoul(ent->d_name + 3, &end, 10);
+				if (*end)
+					continue;
+				names.push_back(std::make_pair(num, std::string(ent->d_name)));
+			}
+			closedir(dir);
+			std::sort(names.begin(), names.end());
+			for (const auto& n : names)
+				placements.push_back(read_placement(n.second, sysfs));
+			return placements;
+		}
+
+		/*! I/O workers, one thread per device
+		 * \brief Every worker is pinned to the CPUs local to its device, prefers memory of
+		 *        the device NUMA node and opens the device itself, so the device state and
+		 *        the message buffer are allocated on that node. Jobs submitted from any
+		 *        thread run on the worker in submission order. Thread safe.
+		 * \tparam Device device with metee interface
+		 */
+		template <typename Device>
+		class basic_device_workers
+		{
+		public:
+			/*! Opens the device, runs on the worker after placement */
+			typedef std::function<std::unique_ptr<Device>(const device_placement&)> factory;
+			/*! Work item, gets the device and a node-local buffer of the device message size */
+			typedef std::function<void(Device&, std::vector<uint8_t>&)> job;
+
+			/*! Constructor, starts the workers and waits until the devices are open
+			 *  \param devices devices to serve, e.g. list_placements()
+			 *  \param make device factory, its exception fails the jobs of the device
+			 */
+			basic_device_workers(const std::vector<device_placement>& devices, factory make)
+			{
+				for (const device_placement& placement : devices)
+					_workers.emplace_back(new worker(placement));
+				try {
+					for (std::unique_ptr<worker>& w : _workers)
+						w->thread = std::thread(&basic_device_workers::run, w.get(), make);
+				}
+				catch (...) {
+					/* the started workers would terminate the process when destroyed joinable */
+					stop();
+					throw;
+				}
+				for (std::unique_ptr<worker>& w : _workers) {
+					std::unique_lock<std::mutex> lock(w->mutex);
+					w->cv.wait(lock, [&w]() { return w->ready; });
+				}
+			}
+			basic_device_workers(const basic_device_workers&) = delete;
+			basic_device_workers& operator=(const basic_device_workers&) = delete;
+
+			/*! Destructor, finishes the submitted jobs and closes the devices */
+			~basic_device_workers()
+			{
+				stop();
+			}
+
+			/*! \return number of workers */
+			size_t size() const
+			{
+				return _workers.size();
+			}
+
+			/*! Placement of the worker device
+			 *  \param index worker index
+			 *  \return placement
+			 */
+			const device_placement& placement(size_t index) const
+			{
+				return _workers.at(index)->placement;
+			}
+
+			/*! Whether the worker runs only on the device local CPUs
+			 *  \param index worker index
+			 *  \return true if the affinity was applied
+			 */
+			bool pinned(size_t index) const
+			{
+				return _workers.at(index)->pinned;
+			}
+
+			/*! Run job on the worker of the device
+			 *  \param index worker index
+			 *  \param j job
+			 *  \return future of the job, holds its exception or the device open exception
+			 */
+			std::future<void> submit(size_t index, job j)
+			{
+				worker& w = *_workers.at(index);
+				task t;
+				std::future<void> result = t.done.get_future();
+
+				t.fn = std::move(j);
+				std::lock_guard<std::mutex> lock(w.mutex);
+				w.jobs.push_back(std::move(t));
+				w.cv.notify_one();
+				return result;
+			}
+
+			/*! Run job on every device, each on its own worker
+			 *  \param j job
+			 *  \return futures in worker order
+			 */
+			std::vector<std::future<void>> fan_out(const job& j)
+			{
+				std::vector<std::future<void>> results;
+
+				results.reserve(_workers.size());
+				for (size_t i = 0; i < _workers.size(); i++)
+					results.push_back(submit(i, j));
+				return results;
+			}
+
+		private:
+			struct task {
+				job fn;
+				std::promise<void> done;
+			};
+
+			struct worker {
+				explicit worker(const device_placement& p) : placement(p), stop(false), ready(false), pinned(false) {}
+				device_placement placement;
+				std::thread thread;
+				std::mutex mutex;
+				std::condition_variable cv;
+				std::deque<task> jobs;
+				bool stop;
+				bool ready;
+				bool pinned;
+			};
+
+			/* bind the calling thread to the device CPUs and node, best effort */
+			static bool place(const device_placement& p)
+			{
+				bool pinned = false;
+
+				if (!p.cpus.empty()) {
+					cpu_set_t set;
+
+					CPU_ZERO(&set);
+					for (unsigned int cpu : p.cpus) {
+						if (cpu < CPU_SETSIZE)
+							CPU_SET(cpu, &set);
+					}
+					pinned = pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+				}
+				if (p.numa_node >= 0 && p.numa_node < static_cast<int>(sizeof(unsigned long) * 8)) {
+					unsigned long mask = 1UL << p.numa_node;
+
+					/* page faults of this thread are served from the node while it has memory */
+					syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mask, sizeof(mask) * 8);
+				}
+				return pinned;
+			}
+
+			/* finishes the submitted jobs and joins the workers started so far */
+			void stop()
+			{
+				for (std::unique_ptr<worker>& w : _workers) {
+					std::lock_guard<std::mutex> lock(w->mutex);
+					w->stop = true;
+					w->cv.notify_one();
+				}
+				for (std::unique_ptr<worker>& w : _workers) {
+					if (w->thread.joinable())
+						w->thread.join();
+				}
+			}
+
+			static void run(worker *w, factory make)
+			{
+				std::unique_ptr<Device> device;
+				std::exception_ptr error;
+				std::vector<uint8_t> buffer;
+				bool pinned = place(w->placement);
+
+				try {
+					device = make(w->placement);
+					if (!device)
+						throw metee_exception("Device factory returned no device", TEE_INTERNAL_ERROR);
+					/* touched here, the pages come from the worker node */
+					buffer.assign(device->max_msg_len(), 0);
+				}
+				catch (...) {
+					error = std::current_exception();
+				}
+				{
+					std::lock_guard<std::mutex> lock(w->mutex);
+					w->pinned = pinned;
+					w->ready = true;
+					w->cv.notify_all();
+				}
+
+				for (;;) {
+					task t;
+					{
+						std::unique_lock<std::mutex> lock(w->mutex);
+						w->cv.wait(lock, [w]() { return w->stop || !w->jobs.empty(); });
+						if (w->jobs.empty())
+							break;
+						t = std::move(w->jobs.front());
+						w->jobs.pop_front();
+					}
+					if (!device) {
+						/* the job is dropped, its future gets the open error */
+						t.done.set_exception(error);
+						continue;
+					}
+					try {
+						t.fn(*device, buffer);
+						t.done.set_value();
+					}
+					catch (...) {
+						t.done.set_exception(std::current_exception());
+					}
+				}
+			}
+
+			std::vector<std::unique_ptr<worker>> _workers;
+		};
+
+		/*! Workers over metee connections */
+		typedef basic_device_workers<metee> device_workers;
+
+		/*! Factory of metee connections to the client on the worker device
+		 *  \param guid client GUID
+		 *  \return factory for device_workers
+		 */
+		inline device_workers::factory metee_worker_factory(const GUID& guid)
+		{
+			return [guid](const device_placement& placement) {
+				struct tee_device_address addr = { tee_device_address::TEE_DEVICE_TYPE_PATH, { nullptr } };
+				addr.data.path = placement.path.c_str();
+				std::unique_ptr<metee> device(new metee(guid, addr, TEE_LOG_LEVEL_ERROR));
+				device->connect();
+				return device;
+			};
+		}
+	} // namespace security
+} // namespace intel
+#endif // _METEEPP_WORKERS_H_
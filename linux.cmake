@@ -1,9 +1,18 @@
 # SPDX-License-Identifier: Apache-2.0
 # Copyright (C) 2014-2026 Intel Corporation
-set(TEE_SOURCES src/linux/metee_linux.c src/linux/mei.c)
+set(TEE_SOURCES src/linux/metee_linux.c src/linux/mei.c src/linux/metee_trace.c
+                src/linux/metee_capture.c src/linux/metee_backend.c
+                src/linux/metee_backend_mei.c src/linux/metee_backend_broker.c
+                src/linux/metee_backend_script.c src/linux/metee_backend_socket.c
+                src/linux/metee_fault.c src/linux/metee_hotplug.c
+                src/linux/metee_power.c)
 
 add_library(${PROJECT_NAME} ${TEE_SOURCES})
 
+# Hotplug monitor thread
+find_package(Threads REQUIRED)
+target_link_libraries(${PROJECT_NAME} PRIVATE Threads::Threads)
+
 target_include_directories(${PROJECT_NAME} PRIVATE src/linux)
 target_compile_definitions(${PROJECT_NAME} PRIVATE
 			   $<$<BOOL:BUILD_SHARED_LIBS>:METEE_DLL>
@@ -68,6 +77,14 @@ if(NOT CONSOLE_OUTPUT)
   target_compile_definitions(${PROJECT_NAME} PRIVATE -DSYSLOG)
 endif()
 
+if(ENABLE_STATS)
+  target_compile_definitions(${PROJECT_NAME} PRIVATE -DMETEE_STATS)
+endif()
+
+if(ENABLE_TRACE)
+  target_compile_definitions(${PROJECT_NAME} PRIVATE -DMETEE_TRACE)
+endif()
+
 target_compile_definitions(${PROJECT_NAME} PRIVATE -D_GNU_SOURCE)
 if(ANDROID)
   target_link_libraries(${PROJECT_NAME} PRIVATE log)
@@ -0,0 +1,676 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+/*
+ * LD_PRELOAD shim: /dev/mei* character devices and /sys/class/mei
+ * attributes served by an in-process metee_sim, so unmodified binaries run
+ * the libmei code paths end to end on hosts without ME hardware.
+ *
+ * A device descriptor is a placeholder eventfd until the connect ioctl;
+ * from then on it is a duplicate of the simulator connection timer, so
+ * the kernel poll reports a due response without help. Write readiness
+ * and the error state of unconnected descriptors are added by the poll
+ * wrappers. Descriptors duplicated by the application are not emulated.
+ *
+ * Environment, applied to every simulated client (MKHI, AMTHI, GSC FWU):
+ *   METEE_PRELOAD_LATENCY_US   fixed or minimal response latency
+ *   METEE_PRELOAD_JITTER_US    latency distribution parameter
+ *   METEE_PRELOAD_DIST         fixed, uniform or exponential
+ *   METEE_PRELOAD_MAX_CONN     connections per client, 0 for unlimited
+ *   METEE_PRELOAD_RESET_AFTER  FW reset after every N responses of a client
+ *   METEE_PRELOAD_SEED         latency random generator seed
+ */
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <linux/mei.h>
+
+#include "metee_sim.h"
+
+#define PRELOAD_MIN_FDS 64
+#define PRELOAD_DEV_PREFIX "/dev/mei"
+#define PRELOAD_SYSFS_PREFIX "/sys/class/mei/"
+#define PRELOAD_PROC_FD_PREFIX "/proc/self/fd/"
+#define PRELOAD_ATTR_LEN 128
+#define PRELOAD_TX_QUEUE_LIMIT 50 /* kernel tx_queue_limit default */
+#define PRELOAD_POLL_SLICE_MS 10
+#define PRELOAD_HAS_MODE(flags) (((flags) & O_CREAT) || ((flags) & O_TMPFILE) == O_TMPFILE)
+
+struct preload_file {
+	struct metee_sim_conn *conn; /* NULL before connect */
+	char *path; /* device node, reported through /proc/self/fd */
+	bool nonblock;
+	bool notify;
+};
+
+struct preload_real {
+	int (*open)(const char *path, int flags, ...);
+	int (*openat)(int dirfd, const char *path, int flags, ...);
+	int (*close)(int fd);
+	ssize_t (*read)(int fd, void *buf, size_t count);
+	ssize_t (*write)(int fd, const void *buf, size_t count);
+	ssize_t (*readlink)(const char *path, char *buf, size_t bufsiz);
+	int (*ioctl)(int fd, unsigned long request, ...);
+	int (*poll)(struct pollfd *fds, nfds_t nfds, int timeout);
+	int (*ppoll)(struct pollfd *fds, nfds_t nfds, const struct timespec *tmo,
+		     const sigset_t *sigmask);
+};
+
+static struct preload_real real;
+static pthread_once_t real_once = PTHREAD_ONCE_INIT;
+static pthread_once_t sim_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t files_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct preload_file **files; /* indexed by descriptor, grows on demand */
+static size_t files_len;
+static struct metee_sim *sim;
+
+static void preload_real_init(void)
+{
+	real.open = dlsym(RTLD_NEXT, "open");
+	real.openat = dlsym(RTLD_NEXT, "openat");
+	real.close = dlsym(RTLD_NEXT, "close");
+	real.read = dlsym(RTLD_NEXT, "read");
+	real.write = dlsym(RTLD_NEXT, "write");
+	real.readlink = dlsym(RTLD_NEXT, "readlink");
+	real.ioctl = dlsym(RTLD_NEXT, "ioctl");
+	real.poll = dlsym(RTLD_NEXT, "poll");
+	real.ppoll = dlsym(RTLD_NEXT, "ppoll");
+}
+
+static uint32_t preload_env(const char *name, uint32_t def)
+{
+	const char *value = getenv(name);
+
+	return value ? (uint32_t)strtoul(value, NULL, 0) : def;
+}
+
+static void preload_sim_init(void)
+{
+	static const enum metee_sim_kind kinds[] = {METEE_SIM_MKHI, METEE_SIM_AMTHI, METEE_SIM_FWU};
+	struct metee_sim_config cfg;
+	struct metee_sim_client client;
+	const char *dist = getenv("METEE_PRELOAD_DIST");
+	const char *seed = getenv("METEE_PRELOAD_SEED");
+	size_t i;
+
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.seed = seed ? strtoull(seed, NULL, 0) : 0;
+	if (metee_sim_create(&cfg, &sim)) {
+		sim = NULL;
+		return;
+	}
+	for (i = 0; i < sizeof(kinds) / sizeof(kinds[0]); i++) {
+		metee_sim_client_preset(kinds[i], &client);
+		client.latency_us = preload_env("METEE_PRELOAD_LATENCY_US", 0);
+		client.jitter_us = preload_env("METEE_PRELOAD_JITTER_US", 0);
+		client.max_conn = preload_env("METEE_PRELOAD_MAX_CONN", client.max_conn);
+		client.reset_after = preload_env("METEE_PRELOAD_RESET_AFTER", 0);
+		if (dist && !strcmp(dist, "uniform"))
+			client.latency = METEE_SIM_LATENCY_UNIFORM;
+		else if (dist && !strcmp(dist, "exponential"))
+			client.latency = METEE_SIM_LATENCY_EXPONENTIAL;
+		metee_sim_add_client(sim, &client);
+	}
+}
+
+static bool preload_is_dev(const char *path)
+{
+	return path && !strncmp(path, PRELOAD_DEV_PREFIX, sizeof(PRELOAD_DEV_PREFIX) - 1) &&
+	       path[sizeof(PRELOAD_DEV_PREFIX) - 1] >= '0' && path[sizeof(PRELOAD_DEV_PREFIX) - 1] <= '9';
+}
+
+static bool preload_is_sysfs(const char *path)
+{
+	return path && !strncmp(path, PRELOAD_SYSFS_PREFIX, sizeof(PRELOAD_SYSFS_PREFIX) - 1);
+}
+
+static struct preload_file *preload_file(int fd)
+{
+	struct preload_file *file;
+
+	if (fd < 0)
+		return NULL;
+	pthread_mutex_lock(&files_lock);
+	file = ((size_t)fd < files_len) ? files[fd] : NULL;
+	pthread_mutex_unlock(&files_lock);
+	return file;
+}
+
+/* record emulated descriptor, called locked */
+static int preload_file_set(int fd, struct preload_file *file)
+{
+	struct preload_file **grown;
+	size_t len = files_len ? files_len : PRELOAD_MIN_FDS;
+
+	while ((size_t)fd >= len)
+		len *= 2;
+	if (len != files_len) {
+		grown = realloc(files, len * sizeof(*files));
+		if (!grown)
+			return -ENOMEM;
+		memset(grown + files_len, 0, (len - files_len) * sizeof(*files));
+		files = grown;
+		files_len = len;
+	}
+	files[fd] = file;
+	return 0;
+}
+
+static int preload_errno(TEESTATUS status)
+{
+	switch (status) {
+	case TEE_CLIENT_NOT_FOUND: return ENOTTY;
+	case TEE_BUSY: return EBUSY;
+	case TEE_DISCONNECTED: return ENODEV;
+	case TEE_INVALID_PARAMETER: return EINVAL;
+	case TEE_TIMEOUT: return EAGAIN;
+	case TEE_INSUFFICIENT_BUFFER: return ENOSPC;
+	default: return EIO;
+	}
+}
+
+static int preload_open_dev(const char *path, int flags)
+{
+	struct preload_file *file;
+	int fd;
+	int rc;
+
+	pthread_once(&sim_once, preload_sim_init);
+	if (!sim) {
+		errno = ENODEV;
+		return -1;
+	}
+
+	file = calloc(1, sizeof(*file));
+	if (!file) {
+		errno = ENOMEM;
+		return -1;
+	}
+	file->path = strdup(path);
+	if (!file->path) {
+		free(file);
+		errno = ENOMEM;
+		return -1;
+	}
+	file->nonblock = (flags & O_NONBLOCK) != 0;
+	fd = eventfd(0, (flags & O_CLOEXEC) ? EFD_CLOEXEC : 0);
+	if (fd < 0) {
+		free(file->path);
+		free(file);
+		return -1;
+	}
+	pthread_mutex_lock(&files_lock);
+	rc = preload_file_set(fd, file);
+	pthread_mutex_unlock(&files_lock);
+	if (rc) {
+		real.close(fd);
+		free(file->path);
+		free(file);
+		errno = -rc;
+		return -1;
+	}
+	return fd;
+}
+
+/* attribute content in a memory file, read with pread by libmei */
+static int preload_open_sysfs(const char *path, int flags)
+{
+	const char *attr = strrchr(path, '/') + 1;
+	char content[PRELOAD_ATTR_LEN];
+	int len;
+	int fd;
+
+	if (!strcmp(attr, "fw_status"))
+		len = snprintf(content, sizeof(content), "%08X\n%08X\n%08X\n%08X\n%08X\n%08X\n",
+			       0x90000245, 0x86110126, 0, 0, 0, 0);
+	else if (!strcmp(attr, "trc"))
+		len = snprintf(content, sizeof(content), "%08X\n", 0);
+	else if (!strcmp(attr, "kind"))
+		len = snprintf(content, sizeof(content), "mei\n");
+	else if (!strcmp(attr, "dev_state"))
+		len = snprintf(content, sizeof(content), "ENABLED\n");
+	else if (!strcmp(attr, "fw_ver"))
+		len = snprintf(content, sizeof(content), "0:18.0.5.2040\n0:18.0.5.2040\n0:18.0.5.2040\n");
+	else if (!strcmp(attr, "hbm_ver"))
+		len = snprintf(content, sizeof(content), "2.2\n");
+	else if (!strcmp(attr, "tx_queue_limit"))
+		len = snprintf(content, sizeof(content), "%d\n", PRELOAD_TX_QUEUE_LIMIT);
+	else {
+		errno = ENOENT;
+		return -1;
+	}
+
+	fd = memfd_create("metee-preload", (flags & O_CLOEXEC) ? MFD_CLOEXEC : 0);
+	if (fd < 0)
+		return -1;
+	if (real.write(fd, content, (size_t)len) != len || lseek(fd, 0, SEEK_SET)) {
+		real.close(fd);
+		errno = EIO;
+		return -1;
+	}
+	return fd;
+}
+
+static int preload_connect(int fd, struct preload_file *file, const void *uuid,
+			   struct mei_client *props)
+{
+	struct metee_sim_conn *conn;
+	struct metee_sim_conn *old;
+	uint32_t max_msg_len;
+	uint8_t protocol_ver;
+	TEESTATUS status;
+	GUID guid;
+	int fd_flags;
+
+	/* the kernel allows to reconnect only after disconnection */
+	if (file->conn && metee_sim_connected(file->conn)) {
+		errno = EBUSY;
+		return -1;
+	}
+	memcpy(&guid, uuid, sizeof(guid));
+	status = metee_sim_open(sim, &guid, &conn, &max_msg_len, &protocol_ver);
+	if (status) {
+		errno = preload_errno(status);
+		return -1;
+	}
+
+	/* descriptor follows the connection readiness from now on */
+	fd_flags = fcntl(fd, F_GETFD);
+	if (dup3(metee_sim_fd(conn), fd, (fd_flags > 0 && (fd_flags & FD_CLOEXEC)) ? O_CLOEXEC : 0) < 0) {
+		metee_sim_close(conn);
+		return -1;
+	}
+	pthread_mutex_lock(&files_lock);
+	old = file->conn;
+	file->conn = conn;
+	file->notify = false;
+	pthread_mutex_unlock(&files_lock);
+	metee_sim_close(old);
+
+	props->max_msg_length = max_msg_len;
+	props->protocol_version = protocol_ver;
+	return 0;
+}
+
+static int preload_ioctl(int fd, struct preload_file *file, unsigned long request, void *arg)
+{
+	struct mei_connect_client_data *data = arg;
+	struct mei_connect_client_data_vtag *data_v = arg;
+	uint32_t *value = arg;
+
+	if (!arg) {
+		errno = EFAULT;
+		return -1;
+	}
+	switch (request) {
+	case IOCTL_MEI_CONNECT_CLIENT:
+		return preload_connect(fd, file, &data->in_client_uuid, &data->out_client_properties);
+	case IOCTL_MEI_CONNECT_CLIENT_VTAG:
+		/* every vtag is accepted, messages are not tagged */
+		return preload_connect(fd, file, &data_v->connect.in_client_uuid,
+				       &data_v->out_client_properties);
+	case IOCTL_MEI_NOTIFY_SET:
+		if (!file->conn || !metee_sim_connected(file->conn)) {
+			errno = ENODEV;
+			return -1;
+		}
+		file->notify = *value != 0;
+		return 0;
+	case IOCTL_MEI_NOTIFY_GET:
+		if (!file->conn || !metee_sim_connected(file->conn)) {
+			errno = ENODEV;
+			return -1;
+		}
+		if (!file->notify) {
+			errno = EOPNOTSUPP;
+			return -1;
+		}
+		/* the simulator raises no notifications */
+		*value = 0;
+		return 0;
+	default:
+		errno = ENOTTY;
+		return -1;
+	}
+}
+
+static ssize_t preload_read(struct preload_file *file, void *buf, size_t count)
+{
+	TEESTATUS status;
+	size_t bytes = 0;
+
+	if (!file->conn) {
+		errno = ENODEV;
+		return -1;
+	}
+	status = metee_sim_read(file->conn, buf, count, &bytes, file->nonblock ? 0 : -1);
+	if (status) {
+		errno = preload_errno(status);
+		return -1;
+	}
+	return (ssize_t)bytes;
+}
+
+static ssize_t preload_write(struct preload_file *file, const void *buf, size_t count)
+{
+	TEESTATUS status;
+
+	if (!file->conn) {
+		errno = ENODEV;
+		return -1;
+	}
+	if (!count)
+		return 0;
+	status = metee_sim_write(file->conn, buf, count);
+	if (status) {
+		/* message above the client MTU */
+		errno = (status == TEE_INVALID_PARAMETER) ? EFBIG : preload_errno(status);
+		return -1;
+	}
+	return (ssize_t)count;
+}
+
+/*
+ * connected descriptor accepts a message while the tx queue is not full;
+ * like the kernel, the message the firmware is processing has left the
+ * tx queue and does not count against tx_queue_limit
+ */
+static bool preload_writable(struct preload_file *file)
+{
+	uint32_t pending = metee_sim_pending(file->conn);
+	uint32_t queued = pending ? pending - 1 : 0;
+
+	return queued < PRELOAD_TX_QUEUE_LIMIT;
+}
+
+/*
+ * emulated descriptors ready without waiting: writable or not connected;
+ * blocked is set when a descriptor becomes writable only on a read
+ */
+static bool preload_poll_ready(struct pollfd *fds, nfds_t nfds, bool *blocked)
+{
+	bool ready = false;
+	nfds_t i;
+
+	*blocked = false;
+	for (i = 0; i < nfds; i++) {
+		struct preload_file *file = preload_file(fds[i].fd);
+
+		if (!file)
+			continue;
+		if (!file->conn || !metee_sim_connected(file->conn))
+			ready = true;
+		else if (fds[i].events & POLLOUT) {
+			if (preload_writable(file))
+				ready = true;
+			else
+				*blocked = true;
+		}
+	}
+	return ready;
+}
+
+static int preload_poll_fixup(struct pollfd *fds, nfds_t nfds, int rv)
+{
+	nfds_t i;
+
+	if (rv < 0)
+		return rv;
+	rv = 0;
+	for (i = 0; i < nfds; i++) {
+		struct preload_file *file = preload_file(fds[i].fd);
+
+		if (file) {
+			if (!file->conn || !metee_sim_connected(file->conn))
+				fds[i].revents |= POLLERR;
+			else if ((fds[i].events & POLLOUT) && preload_writable(file))
+				fds[i].revents |= POLLOUT;
+		}
+		if (fds[i].revents)
+			rv++;
+	}
+	return rv;
+}
+
+static int preload_real_poll(struct pollfd *fds, nfds_t nfds, int timeout, const struct timespec *tmo,
+			     const sigset_t *sigmask, bool use_ppoll)
+{
+	struct timespec ts;
+
+	if (!use_ppoll)
+		return real.poll(fds, nfds, timeout);
+	if (timeout < 0)
+		return real.ppoll(fds, nfds, tmo, sigmask);
+	ts.tv_sec = timeout / 1000;
+	ts.tv_nsec = (timeout % 1000) * 1000000L;
+	return real.ppoll(fds, nfds, &ts, sigmask);
+}
+
+/*
+ * the kernel wakes a writer when the queue drains, here the wait is cut in
+ * slices to notice responses read by another thread
+ */
+static int preload_poll(struct pollfd *fds, nfds_t nfds, int timeout, const struct timespec *tmo,
+			const sigset_t *sigmask, bool use_ppoll)
+{
+	bool blocked;
+	int slice;
+	int rv;
+
+	if (preload_poll_ready(fds, nfds, &blocked))
+		return preload_poll_fixup(fds, nfds, preload_real_poll(fds, nfds, 0, NULL, sigmask, use_ppoll));
+	if (!blocked)
+		return preload_poll_fixup(fds, nfds, preload_real_poll(fds, nfds, timeout, tmo, sigmask, use_ppoll));
+
+	for (;;) {
+		slice = (timeout < 0 || timeout > PRELOAD_POLL_SLICE_MS) ? PRELOAD_POLL_SLICE_MS : timeout;
+		rv = preload_real_poll(fds, nfds, slice, NULL, sigmask, use_ppoll);
+		if (rv || preload_poll_ready(fds, nfds, &blocked))
+			break;
+		if (timeout >= 0) {
+			timeout -= slice;
+			if (timeout <= 0)
+				break;
+		}
+	}
+	return preload_poll_fixup(fds, nfds, rv);
+}
+
+int open(const char *path, int flags, ...)
+{
+	mode_t mode = 0;
+	va_list ap;
+
+	pthread_once(&real_once, preload_real_init);
+	if (preload_is_dev(path))
+		return preload_open_dev(path, flags);
+	if (preload_is_sysfs(path))
+		return preload_open_sysfs(path, flags);
+	if (PRELOAD_HAS_MODE(flags)) {
+		va_start(ap, flags);
+		mode = va_arg(ap, mode_t);
+		va_end(ap);
+	}
+	return real.open(path, flags, mode);
+}
+
+int open64(const char *path, int flags, ...)
+{
+	mode_t mode = 0;
+	va_list ap;
+
+	if (PRELOAD_HAS_MODE(flags)) {
+		va_start(ap, flags);
+		mode = va_arg(ap, mode_t);
+		va_end(ap);
+	}
+	return open(path, flags | O_LARGEFILE, mode);
+}
+
+int __open_2(const char *path, int flags)
+{
+	return open(path, flags);
+}
+
+int __open64_2(const char *path, int flags)
+{
+	return open(path, flags | O_LARGEFILE);
+}
+
+int openat(int dirfd, const char *path, int flags, ...)
+{
+	mode_t mode = 0;
+	va_list ap;
+
+	pthread_once(&real_once, preload_real_init);
+	if (preload_is_dev(path))
+		return preload_open_dev(path, flags);
+	if (preload_is_sysfs(path))
+		return preload_open_sysfs(path, flags);
+	if (PRELOAD_HAS_MODE(flags)) {
+		va_start(ap, flags);
+		mode = va_arg(ap, mode_t);
+		va_end(ap);
+	}
+	return real.openat(dirfd, path, flags, mode);
+}
+
+int openat64(int dirfd, const char *path, int flags, ...)
+{
+	mode_t mode = 0;
+	va_list ap;
+
+	if (PRELOAD_HAS_MODE(flags)) {
+		va_start(ap, flags);
+		mode = va_arg(ap, mode_t);
+		va_end(ap);
+	}
+	return openat(dirfd, path, flags | O_LARGEFILE, mode);
+}
+
+int close(int fd)
+{
+	struct preload_file *file = NULL;
+
+	pthread_once(&real_once, preload_real_init);
+	pthread_mutex_lock(&files_lock);
+	if (fd >= 0 && (size_t)fd < files_len) {
+		file = files[fd];
+		files[fd] = NULL;
+	}
+	pthread_mutex_unlock(&files_lock);
+	if (file) {
+		metee_sim_close(file->conn);
+		free(file->path);
+		free(file);
+	}
+	return real.close(fd);
+}
+
+/* libmei resolves the device name of a handle passed by the application */
+ssize_t readlink(const char *path, char *buf, size_t bufsiz)
+{
+	struct preload_file *file = NULL;
+	size_t len;
+	char *end;
+	long fd;
+
+	pthread_once(&real_once, preload_real_init);
+	if (!strncmp(path, PRELOAD_PROC_FD_PREFIX, sizeof(PRELOAD_PROC_FD_PREFIX) - 1)) {
+		fd = strtol(path + sizeof(PRELOAD_PROC_FD_PREFIX) - 1, &end, 10);
+		if (!*end && fd >= 0 && fd <= INT_MAX)
+			file = preload_file((int)fd);
+	}
+	if (!file)
+		return real.readlink(path, buf, bufsiz);
+	len = strlen(file->path);
+	if (len > bufsiz)
+		len = bufsiz;
+	memcpy(buf, file->path, len);
+	return (ssize_t)len;
+}
+
+ssize_t __readlink_chk(const char *path, char *buf, size_t bufsiz, size_t buflen)
+{
+	if (bufsiz > buflen)
+		abort();
+	return readlink(path, buf, bufsiz);
+}
+
+ssize_t read(int fd, void *buf, size_t count)
+{
+	struct preload_file *file = preload_file(fd);
+
+	pthread_once(&real_once, preload_real_init);
+	if (file)
+		return preload_read(file, buf, count);
+	return real.read(fd, buf, count);
+}
+
+ssize_t __read_chk(int fd, void *buf, size_t count, size_t buflen)
+{
+	if (count > buflen)
+		abort();
+	return read(fd, buf, count);
+}
+
+ssize_t write(int fd, const void *buf, size_t count)
+{
+	struct preload_file *file = preload_file(fd);
+
+	pthread_once(&real_once, preload_real_init);
+	if (file)
+		return preload_write(file, buf, count);
+	return real.write(fd, buf, count);
+}
+
+int ioctl(int fd, unsigned long request, ...)
+{
+	struct preload_file *file = preload_file(fd);
+	void *arg;
+	va_list ap;
+
+	pthread_once(&real_once, preload_real_init);
+	va_start(ap, request);
+	arg = va_arg(ap, void *);
+	va_end(ap);
+	if (file)
+		return preload_ioctl(fd, file, request, arg);
+	return real.ioctl(fd, request, arg);
+}
+
+int poll(struct pollfd *fds, nfds_t nfds, int timeout)
+{
+	pthread_once(&real_once, preload_real_init);
+	return preload_poll(fds, nfds, timeout, NULL, NULL, false);
+}
+
+int __poll_chk(struct pollfd *fds, nfds_t nfds, int timeout, size_t fdslen)
+{
+	if (fdslen / sizeof(*fds) < nfds)
+		abort();
+	return poll(fds, nfds, timeout);
+}
+
+int ppoll(struct pollfd *fds, nfds_t nfds, const struct timespec *tmo, const sigset_t *sigmask)
+{
+	int timeout = -1;
+
+	pthread_once(&real_once, preload_real_init);
+	if (tmo)
+		timeout = (int)(tmo->tv_sec * 1000 + (tmo->tv_nsec + 999999) / 1000000);
+	return preload_poll(fds, nfds, timeout, tmo, sigmask, true);
+}
@@ -0,0 +1,1042 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+#include <errno.h>
+#include <math.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "metee_sim.h"
+#include "metee_broker_proto.h"
+
+#define SIM_MAX_CLIENTS 16
+#define SIM_MAX_SESSIONS 64
+#define SIM_QUEUE_MAX 64
+#define SIM_BACKLOG 16
+#define SIM_LOG_LEN 256
+#define SIM_DEFAULT_SEED 0x9e3779b97f4a7c15ULL
+
+/* MKHI */
+#define SIM_MKHI_GEN_GROUP_ID 0xFF
+#define SIM_MKHI_GET_FW_VERSION 0x02
+#define SIM_MKHI_INVALID_COMMAND 0x8D
+
+/* AMTHI */
+#define SIM_AMTHI_CODE_VERSIONS_REQUEST 0x0400001A
+#define SIM_AMTHI_RESPONSE_BIT 0x00800000
+#define SIM_AMTHI_STATUS_INTERNAL_ERROR 0x1
+#define SIM_AMTHI_BIOS_VERSION_LEN 65
+#define SIM_AMTHI_VERSIONS_NUMBER 50
+#define SIM_AMTHI_STRING_LEN 20
+
+/* GSC firmware update */
+#define SIM_FWU_START 1
+#define SIM_FWU_DATA 2
+#define SIM_FWU_END 3
+#define SIM_FWU_GET_IP_VERSION 6
+#define SIM_FWU_STATUS_SIZE_ERROR 0x5
+#define SIM_FWU_STATUS_INVALID_PARAMS 0x85
+#define SIM_FWU_STATUS_INVALID_COMMAND 0x8D
+
+#pragma pack(push, 1)
+struct sim_amthi_hdr {
+	uint8_t major;
+	uint8_t minor;
+	uint16_t reserved;
+	uint32_t command;
+	uint32_t length; /* after the header */
+};
+
+struct sim_amthi_string {
+	uint16_t length;
+	uint8_t string[SIM_AMTHI_STRING_LEN];
+};
+
+struct sim_amthi_code_versions_rsp {
+	struct sim_amthi_hdr hdr;
+	uint32_t status;
+	uint8_t bios_version[SIM_AMTHI_BIOS_VERSION_LEN];
+	uint32_t versions_count;
+	struct {
+		struct sim_amthi_string description;
+		struct sim_amthi_string version;
+	} versions[SIM_AMTHI_VERSIONS_NUMBER];
+};
+
+struct sim_fwu_hdr {
+	uint8_t command_id;
+	uint8_t flags; /* bit 0: response */
+	uint8_t reserved[2];
+};
+
+struct sim_fwu_rsp {
+	struct sim_fwu_hdr hdr;
+	uint32_t status;
+	uint32_t reserved;
+};
+
+struct sim_fwu_ip_version_rsp {
+	struct sim_fwu_rsp rsp;
+	uint32_t partition;
+	uint32_t version_length;
+	uint16_t version[4];
+};
+#pragma pack(pop)
+
+/* fwu_start_req: header, image length, payload type, flags, reserved[8] */
+#define SIM_FWU_START_REQ_LEN (sizeof(struct sim_fwu_hdr) + 11 * sizeof(uint32_t))
+/* fwu_data_req: header, data length, reserved, data */
+#define SIM_FWU_DATA_REQ_LEN (sizeof(struct sim_fwu_hdr) + 2 * sizeof(uint32_t))
+
+struct sim_rsp {
+	struct sim_rsp *next;
+	uint64_t due; /* CLOCK_MONOTONIC ns */
+	bool reset; /* FW resets after the response is read */
+	size_t len;
+	uint8_t data[];
+};
+
+struct sim_client {
+	struct metee_sim_client cfg;
+	uint32_t conns;
+	uint32_t responses;
+};
+
+struct metee_sim_conn {
+	struct metee_sim *sim;
+	struct metee_sim_conn *next;
+	struct sim_client *client; /* NULL after FW reset */
+	int timer_fd;              /* armed at due time of the first response */
+	struct sim_rsp *head;
+	struct sim_rsp *tail;
+	uint32_t queued;
+	uint64_t last_due;         /* responses leave in request order */
+};
+
+struct sim_session {
+	int fd;                      /* -1 when the slot is free */
+	struct metee_sim_conn *conn; /* NULL before BROKER_CONNECT */
+	uint32_t outstanding;        /* requests without reply */
+};
+
+struct metee_sim {
+	struct metee_sim_config cfg;
+	pthread_mutex_t lock; /* clients counters, connections, random state */
+	struct sim_client clients[SIM_MAX_CLIENTS];
+	size_t nclients;
+	struct metee_sim_conn *conns;
+	uint64_t rng;
+	uint32_t resets;
+	int listen_fd;
+	int stop_fd;
+	struct sim_session sessions[SIM_MAX_SESSIONS];
+	uint8_t buf[sizeof(struct broker_hdr) + BROKER_MAX_PAYLOAD];
+};
+
+DEFINE_GUID(SIM_GUID_MKHI, 0x8e6a6715, 0x9abc, 0x4043,
+	    0x88, 0xef, 0x9e, 0x39, 0xc6, 0xf6, 0x3e, 0x0f);
+DEFINE_GUID(SIM_GUID_AMTHI, 0x12f80028, 0xb4b7, 0x4b2d,
+	    0xac, 0xa8, 0x46, 0xe0, 0xff, 0x65, 0x81, 0x4c);
+DEFINE_GUID(SIM_GUID_FWU, 0x87d90ca5, 0x3495, 0x4559,
+	    0x81, 0x05, 0x3f, 0xbf, 0xa3, 0x7b, 0x8b, 0x79);
+
+static void sim_log(struct metee_sim *sim, bool is_error, const char *fmt, ...)
+{
+	char msg[SIM_LOG_LEN];
+	va_list varl;
+
+	if (!sim->cfg.log_callback || (!is_error && !sim->cfg.verbose))
+		return;
+	va_start(varl, fmt);
+	vsnprintf(msg, sizeof(msg), fmt, varl);
+	va_end(varl);
+	sim->cfg.log_callback(is_error, msg);
+}
+
+static uint64_t sim_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* xorshift64*, reproducible across runs for the same seed */
+static uint64_t sim_random(struct metee_sim *sim)
+{
+	uint64_t x = sim->rng;
+
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	sim->rng = x;
+	return x * 2685821657736338717ULL;
+}
+
+static uint64_t sim_latency(struct metee_sim *sim, const struct metee_sim_client *c)
+{
+	uint64_t ns = (uint64_t)c->latency_us * 1000;
+	double u;
+
+	switch (c->latency) {
+	case METEE_SIM_LATENCY_UNIFORM:
+		ns += (sim_random(sim) % ((uint64_t)c->jitter_us + 1)) * 1000;
+		break;
+	case METEE_SIM_LATENCY_EXPONENTIAL:
+		/* uniform in (0, 1] */
+		u = ldexp((double)((sim_random(sim) >> 11) + 1), -53);
+		ns += (uint64_t)(-log(u) * (double)c->jitter_us * 1000);
+		break;
+	case METEE_SIM_LATENCY_FIXED:
+	default:
+		break;
+	}
+	return ns;
+}
+
+/* readiness of the connection follows the first response, due zero disarms */
+static void sim_conn_arm(struct metee_sim_conn *conn, uint64_t due)
+{
+	struct itimerspec its;
+
+	memset(&its, 0, sizeof(its));
+	its.it_value.tv_sec = (time_t)(due / 1000000000ULL);
+	its.it_value.tv_nsec = (long)(due % 1000000000ULL);
+	timerfd_settime(conn->timer_fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+static void sim_conn_flush(struct metee_sim_conn *conn)
+{
+	while (conn->head) {
+		struct sim_rsp *rsp = conn->head;
+
+		conn->head = rsp->next;
+		free(rsp);
+	}
+	conn->tail = NULL;
+	conn->queued = 0;
+	conn->last_due = 0;
+}
+
+static void sim_reset_locked(struct metee_sim *sim)
+{
+	struct metee_sim_conn *conn;
+	uint64_t now = sim_now();
+
+	for (conn = sim->conns; conn; conn = conn->next) {
+		if (conn->client)
+			conn->client->conns--;
+		conn->client = NULL;
+		sim_conn_flush(conn);
+		/* wake waiters to report the disconnection */
+		sim_conn_arm(conn, now);
+	}
+	sim->resets++;
+}
+
+static void sim_put_string(struct sim_amthi_string *str, const char *value)
+{
+	size_t len = strlen(value);
+
+	if (len > sizeof(str->string))
+		len = sizeof(str->string);
+	str->length = (uint16_t)len;
+	memcpy(str->string, value, len);
+}
+
+static size_t sim_mkhi(const struct metee_sim_client *c, const uint8_t *req, size_t len, uint8_t *rsp)
+{
+	uint32_t hdr;
+	uint32_t group;
+	uint32_t command;
+	uint16_t version[8];
+
+	/* FW drops malformed messages */
+	if (len < sizeof(hdr))
+		return 0;
+	memcpy(&hdr, req, sizeof(hdr));
+	group = hdr & 0xFF;
+	command = (hdr >> 8) & 0x7F;
+	/* group and command with response bit, result in the top byte */
+	hdr = (hdr & 0x7FFF) | 0x8000;
+
+	if (group != SIM_MKHI_GEN_GROUP_ID || command != SIM_MKHI_GET_FW_VERSION) {
+		hdr |= (uint32_t)SIM_MKHI_INVALID_COMMAND << 24;
+		memcpy(rsp, &hdr, sizeof(hdr));
+		return sizeof(hdr);
+	}
+
+	/* code and NFTP: minor, major, build, hotfix */
+	version[0] = version[4] = c->fw_version[1];
+	version[1] = version[5] = c->fw_version[0];
+	version[2] = version[6] = c->fw_version[3];
+	version[3] = version[7] = c->fw_version[2];
+	memcpy(rsp, &hdr, sizeof(hdr));
+	memcpy(rsp + sizeof(hdr), version, sizeof(version));
+	return sizeof(hdr) + sizeof(version);
+}
+
+static size_t sim_amthi(const struct metee_sim_client *c, const uint8_t *req, size_t len, uint8_t *rsp)
+{
+	struct sim_amthi_code_versions_rsp *versions = (struct sim_amthi_code_versions_rsp *)rsp;
+	struct sim_amthi_hdr hdr;
+	uint32_t status;
+	char value[SIM_AMTHI_STRING_LEN + 1];
+
+	if (len < sizeof(hdr))
+		return 0;
+	memcpy(&hdr, req, sizeof(hdr));
+	hdr.command |= SIM_AMTHI_RESPONSE_BIT;
+
+	if (hdr.command != (SIM_AMTHI_CODE_VERSIONS_REQUEST | SIM_AMTHI_RESPONSE_BIT)) {
+		status = SIM_AMTHI_STATUS_INTERNAL_ERROR;
+		hdr.length = sizeof(status);
+		memcpy(rsp, &hdr, sizeof(hdr));
+		memcpy(rsp + sizeof(hdr), &status, sizeof(status));
+		return sizeof(hdr) + sizeof(status);
+	}
+
+	memset(versions, 0, sizeof(*versions));
+	hdr.length = sizeof(*versions) - sizeof(hdr);
+	versions->hdr = hdr;
+	memcpy(versions->bios_version, "METEE SIM", sizeof("METEE SIM"));
+	versions->versions_count = 2;
+	sim_put_string(&versions->versions[0].description, "AMT");
+	snprintf(value, sizeof(value), "%u.%u.%u", c->fw_version[0], c->fw_version[1], c->fw_version[2]);
+	sim_put_string(&versions->versions[0].version, value);
+	sim_put_string(&versions->versions[1].description, "Build Number");
+	snprintf(value, sizeof(value), "%u", c->fw_version[3]);
+	sim_put_string(&versions->versions[1].version, value);
+	return sizeof(*versions);
+}
+
+static size_t sim_fwu(const struct metee_sim_client *c, const uint8_t *req, size_t len, uint8_t *rsp)
+{
+	struct sim_fwu_ip_version_rsp version;
+	struct sim_fwu_rsp ack;
+	uint32_t data_length;
+
+	if (len < sizeof(struct sim_fwu_hdr))
+		return 0;
+	memset(&ack, 0, sizeof(ack));
+	ack.hdr.command_id = req[0];
+	ack.hdr.flags = 1;
+
+	switch (req[0]) {
+	case SIM_FWU_GET_IP_VERSION:
+		memset(&version, 0, sizeof(version));
+		version.rsp = ack;
+		if (len >= sizeof(struct sim_fwu_hdr) + sizeof(uint32_t))
+			memcpy(&version.partition, req + sizeof(struct sim_fwu_hdr), sizeof(uint32_t));
+		version.version_length = sizeof(version.version);
+		memcpy(version.version, c->fw_version, sizeof(version.version));
+		memcpy(rsp, &version, sizeof(version));
+		return sizeof(version);
+	case SIM_FWU_START:
+		if (len < SIM_FWU_START_REQ_LEN)
+			ack.status = SIM_FWU_STATUS_INVALID_PARAMS;
+		break;
+	case SIM_FWU_DATA:
+		if (len < SIM_FWU_DATA_REQ_LEN) {
+			ack.status = SIM_FWU_STATUS_INVALID_PARAMS;
+			break;
+		}
+		memcpy(&data_length, req + sizeof(struct sim_fwu_hdr), sizeof(data_length));
+		if (data_length != len - SIM_FWU_DATA_REQ_LEN)
+			ack.status = SIM_FWU_STATUS_SIZE_ERROR;
+		break;
+	case SIM_FWU_END:
+		break;
+	default:
+		ack.status = SIM_FWU_STATUS_INVALID_COMMAND;
+		break;
+	}
+	memcpy(rsp, &ack, sizeof(ack));
+	return sizeof(ack);
+}
+
+/* smallest MTU that holds every response of the kind */
+static uint32_t sim_min_msg_len(enum metee_sim_kind kind)
+{
+	switch (kind) {
+	case METEE_SIM_MKHI:
+		return sizeof(uint32_t) + 8 * sizeof(uint16_t);
+	case METEE_SIM_AMTHI:
+		return sizeof(struct sim_amthi_code_versions_rsp);
+	case METEE_SIM_FWU:
+		return sizeof(struct sim_fwu_ip_version_rsp);
+	default:
+		return 1;
+	}
+}
+
+static TEESTATUS sim_respond(const struct metee_sim_client *c, const void *req, size_t len,
+			     uint8_t *rsp, size_t *rsp_len)
+{
+	TEESTATUS status;
+
+	switch (c->kind) {
+	case METEE_SIM_ECHO:
+		memcpy(rsp, req, len);
+		*rsp_len = len;
+		return TEE_SUCCESS;
+	case METEE_SIM_MKHI:
+		*rsp_len = sim_mkhi(c, req, len, rsp);
+		return TEE_SUCCESS;
+	case METEE_SIM_AMTHI:
+		*rsp_len = sim_amthi(c, req, len, rsp);
+		return TEE_SUCCESS;
+	case METEE_SIM_FWU:
+		*rsp_len = sim_fwu(c, req, len, rsp);
+		return TEE_SUCCESS;
+	case METEE_SIM_CUSTOM:
+		*rsp_len = 0;
+		status = c->responder(c->ctx, req, len, rsp, rsp_len);
+		if (status)
+			return status;
+		return (*rsp_len > c->max_msg_len) ? TEE_INTERNAL_ERROR : TEE_SUCCESS;
+	default:
+		return TEE_INTERNAL_ERROR;
+	}
+}
+
+void metee_sim_client_preset(enum metee_sim_kind kind, struct metee_sim_client *client)
+{
+	if (!client)
+		return;
+	memset(client, 0, sizeof(*client));
+	client->kind = kind;
+	client->protocol_ver = 1;
+	client->max_conn = 1;
+	client->fw_version[0] = 18;
+	client->fw_version[1] = 0;
+	client->fw_version[2] = 5;
+	client->fw_version[3] = 2040;
+
+	switch (kind) {
+	case METEE_SIM_MKHI:
+		client->guid = SIM_GUID_MKHI;
+		client->max_msg_len = 512;
+		break;
+	case METEE_SIM_AMTHI:
+		client->guid = SIM_GUID_AMTHI;
+		client->max_msg_len = 4160;
+		break;
+	case METEE_SIM_FWU:
+		client->guid = SIM_GUID_FWU;
+		client->max_msg_len = 4096;
+		break;
+	case METEE_SIM_ECHO:
+	case METEE_SIM_CUSTOM:
+	default:
+		client->guid = SIM_GUID_MKHI;
+		client->max_msg_len = 4096;
+		client->max_conn = 0;
+		break;
+	}
+}
+
+TEESTATUS metee_sim_create(const struct metee_sim_config *config, struct metee_sim **sim)
+{
+	struct sockaddr_un addr;
+	struct metee_sim *s;
+	size_t len = 0;
+	size_t i;
+	int err;
+
+	if (!config || !sim)
+		return TEE_INVALID_PARAMETER;
+	if (config->socket_path) {
+		len = strlen(config->socket_path);
+		if (len == 0 || len >= sizeof(addr.sun_path))
+			return TEE_INVALID_PARAMETER;
+	}
+
+	s = calloc(1, sizeof(*s));
+	if (!s)
+		return TEE_INTERNAL_ERROR;
+	s->cfg = *config;
+	s->rng = config->seed ? config->seed : SIM_DEFAULT_SEED;
+	s->listen_fd = -1;
+	for (i = 0; i < SIM_MAX_SESSIONS; i++)
+		s->sessions[i].fd = -1;
+	pthread_mutex_init(&s->lock, NULL);
+
+	s->stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (s->stop_fd < 0) {
+		err = errno;
+		goto err_free;
+	}
+	if (!config->socket_path) {
+		*sim = s;
+		return TEE_SUCCESS;
+	}
+
+	s->listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (s->listen_fd < 0) {
+		err = errno;
+		goto err_stop;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	memcpy(addr.sun_path, config->socket_path, len);
+	unlink(config->socket_path);
+	if (bind(s->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) ||
+	    listen(s->listen_fd, SIM_BACKLOG)) {
+		err = errno;
+		sim_log(s, true, "Cannot listen on %s: %d\n", config->socket_path, err);
+		goto err_listen;
+	}
+
+	*sim = s;
+	return TEE_SUCCESS;
+
+err_listen:
+	close(s->listen_fd);
+err_stop:
+	close(s->stop_fd);
+err_free:
+	pthread_mutex_destroy(&s->lock);
+	free(s);
+	return (err == EACCES) ? TEE_PERMISSION_DENIED : TEE_INTERNAL_ERROR;
+}
+
+TEESTATUS metee_sim_add_client(struct metee_sim *sim, const struct metee_sim_client *client)
+{
+	TEESTATUS status = TEE_SUCCESS;
+	size_t i;
+
+	if (!sim || !client)
+		return TEE_INVALID_PARAMETER;
+	if (client->kind > METEE_SIM_CUSTOM ||
+	    (client->kind == METEE_SIM_CUSTOM && !client->responder) ||
+	    client->max_msg_len < sim_min_msg_len(client->kind) ||
+	    client->max_msg_len > BROKER_MAX_PAYLOAD ||
+	    client->latency > METEE_SIM_LATENCY_EXPONENTIAL)
+		return TEE_INVALID_PARAMETER;
+
+	pthread_mutex_lock(&sim->lock);
+	for (i = 0; i < sim->nclients; i++) {
+		if (!memcmp(&sim->clients[i].cfg.guid, &client->guid, sizeof(client->guid))) {
+			status = TEE_INVALID_PARAMETER;
+			goto End;
+		}
+	}
+	if (sim->nclients == SIM_MAX_CLIENTS) {
+		status = TEE_BUSY;
+		goto End;
+	}
+	memset(&sim->clients[sim->nclients], 0, sizeof(sim->clients[sim->nclients]));
+	sim->clients[sim->nclients].cfg = *client;
+	sim->nclients++;
+End:
+	pthread_mutex_unlock(&sim->lock);
+	return status;
+}
+
+void metee_sim_reset(struct metee_sim *sim)
+{
+	if (!sim)
+		return;
+	pthread_mutex_lock(&sim->lock);
+	sim_reset_locked(sim);
+	pthread_mutex_unlock(&sim->lock);
+	sim_log(sim, false, "FW reset\n");
+}
+
+uint32_t metee_sim_reset_count(struct metee_sim *sim)
+{
+	uint32_t resets;
+
+	if (!sim)
+		return 0;
+	pthread_mutex_lock(&sim->lock);
+	resets = sim->resets;
+	pthread_mutex_unlock(&sim->lock);
+	return resets;
+}
+
+TEESTATUS metee_sim_open(struct metee_sim *sim, const GUID *guid, struct metee_sim_conn **conn,
+			 uint32_t *max_msg_len, uint8_t *protocol_ver)
+{
+	struct sim_client *client = NULL;
+	struct metee_sim_conn *c;
+	TEESTATUS status = TEE_SUCCESS;
+	size_t i;
+
+	if (!sim || !guid || !conn || !max_msg_len || !protocol_ver)
+		return TEE_INVALID_PARAMETER;
+
+	c = calloc(1, sizeof(*c));
+	if (!c)
+		return TEE_INTERNAL_ERROR;
+	c->sim = sim;
+	c->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+	if (c->timer_fd < 0) {
+		free(c);
+		return TEE_INTERNAL_ERROR;
+	}
+
+	pthread_mutex_lock(&sim->lock);
+	for (i = 0; i < sim->nclients; i++) {
+		if (!memcmp(&sim->clients[i].cfg.guid, guid, sizeof(*guid))) {
+			client = &sim->clients[i];
+			break;
+		}
+	}
+	if (!client) {
+		status = TEE_CLIENT_NOT_FOUND;
+		goto End;
+	}
+	if (client->cfg.max_conn && client->conns >= client->cfg.max_conn) {
+		status = TEE_BUSY;
+		goto End;
+	}
+	client->conns++;
+	c->client = client;
+	c->next = sim->conns;
+	sim->conns = c;
+	*max_msg_len = client->cfg.max_msg_len;
+	*protocol_ver = client->cfg.protocol_ver;
+End:
+	pthread_mutex_unlock(&sim->lock);
+	if (status) {
+		close(c->timer_fd);
+		free(c);
+		return status;
+	}
+	*conn = c;
+	return TEE_SUCCESS;
+}
+
+int metee_sim_fd(struct metee_sim_conn *conn)
+{
+	return conn ? conn->timer_fd : -1;
+}
+
+bool metee_sim_connected(struct metee_sim_conn *conn)
+{
+	bool connected;
+
+	if (!conn)
+		return false;
+	pthread_mutex_lock(&conn->sim->lock);
+	connected = conn->client != NULL;
+	pthread_mutex_unlock(&conn->sim->lock);
+	return connected;
+}
+
+uint32_t metee_sim_pending(struct metee_sim_conn *conn)
+{
+	uint32_t pending;
+
+	if (!conn)
+		return 0;
+	pthread_mutex_lock(&conn->sim->lock);
+	pending = conn->queued;
+	pthread_mutex_unlock(&conn->sim->lock);
+	return pending;
+}
+
+TEESTATUS metee_sim_write(struct metee_sim_conn *conn, const void *buffer, size_t size)
+{
+	struct metee_sim *sim;
+	struct sim_client *client;
+	struct sim_rsp *rsp;
+	TEESTATUS status;
+	size_t len = 0;
+	bool full;
+
+	if (!conn)
+		return TEE_INVALID_PARAMETER;
+	sim = conn->sim;
+
+	pthread_mutex_lock(&sim->lock);
+	client = conn->client;
+	full = conn->queued >= SIM_QUEUE_MAX;
+	pthread_mutex_unlock(&sim->lock);
+	if (!client)
+		return TEE_DISCONNECTED;
+	if (!buffer || !size || size > client->cfg.max_msg_len)
+		return TEE_INVALID_PARAMETER;
+	if (full)
+		return TEE_BUSY;
+
+	/* client configuration does not change, the response is built unlocked */
+	rsp = malloc(sizeof(*rsp) + client->cfg.max_msg_len);
+	if (!rsp)
+		return TEE_INTERNAL_ERROR;
+	status = sim_respond(&client->cfg, buffer, size, rsp->data, &len);
+	if (status || !len) {
+		free(rsp);
+		return status;
+	}
+	rsp->next = NULL;
+	rsp->len = len;
+
+	pthread_mutex_lock(&sim->lock);
+	if (conn->client != client) {
+		/* FW reset while the response was built */
+		pthread_mutex_unlock(&sim->lock);
+		free(rsp);
+		return TEE_DISCONNECTED;
+	}
+	rsp->due = sim_now();
+	if (rsp->due < conn->last_due)
+		rsp->due = conn->last_due;
+	rsp->due += sim_latency(sim, &client->cfg);
+	conn->last_due = rsp->due;
+	client->responses++;
+	rsp->reset = client->cfg.reset_after && !(client->responses % client->cfg.reset_after);
+	if (conn->tail)
+		conn->tail->next = rsp;
+	else
+		conn->head = rsp;
+	conn->tail = rsp;
+	conn->queued++;
+	if (conn->head == rsp)
+		sim_conn_arm(conn, rsp->due);
+	pthread_mutex_unlock(&sim->lock);
+
+	sim_log(sim, false, "Request %zu bytes, response %zu bytes\n", size, len);
+	return TEE_SUCCESS;
+}
+
+/* first response if due, called locked */
+static TEESTATUS sim_conn_pop(struct metee_sim_conn *conn, void *buffer, size_t size,
+			      size_t *bytes, bool *reset)
+{
+	struct sim_rsp *rsp = conn->head;
+
+	if (!conn->client)
+		return TEE_DISCONNECTED;
+	if (!rsp || rsp->due > sim_now())
+		return TEE_TIMEOUT;
+	if (rsp->len > size)
+		return TEE_INSUFFICIENT_BUFFER;
+
+	memcpy(buffer, rsp->data, rsp->len);
+	*bytes = rsp->len;
+	*reset = rsp->reset;
+	conn->head = rsp->next;
+	if (!conn->head)
+		conn->tail = NULL;
+	conn->queued--;
+	sim_conn_arm(conn, conn->head ? conn->head->due : 0);
+	free(rsp);
+	return TEE_SUCCESS;
+}
+
+TEESTATUS metee_sim_read(struct metee_sim_conn *conn, void *buffer, size_t size,
+			 size_t *bytes, int timeout)
+{
+	struct metee_sim *sim;
+	struct pollfd pfd;
+	uint64_t deadline = 0;
+	TEESTATUS status;
+	bool reset = false;
+	int wait = timeout;
+
+	if (!conn || !buffer || !bytes)
+		return TEE_INVALID_PARAMETER;
+	sim = conn->sim;
+	if (timeout > 0)
+		deadline = sim_now() + (uint64_t)timeout * 1000000;
+
+	while (true) {
+		pthread_mutex_lock(&sim->lock);
+		status = sim_conn_pop(conn, buffer, size, bytes, &reset);
+		pthread_mutex_unlock(&sim->lock);
+		if (reset) {
+			sim_log(sim, false, "Injected FW reset\n");
+			metee_sim_reset(sim);
+		}
+		if (status != TEE_TIMEOUT || timeout == 0)
+			return status;
+
+		if (deadline) {
+			uint64_t now = sim_now();
+
+			if (now >= deadline)
+				return TEE_TIMEOUT;
+			/* round up, do not spin on the last millisecond */
+			wait = (int)((deadline - now + 999999) / 1000000);
+		}
+		pfd.fd = conn->timer_fd;
+		pfd.events = POLLIN;
+		if (poll(&pfd, 1, wait) < 0 && errno != EINTR)
+			return TEE_INTERNAL_ERROR;
+	}
+}
+
+void metee_sim_close(struct metee_sim_conn *conn)
+{
+	struct metee_sim *sim;
+	struct metee_sim_conn **pos;
+
+	if (!conn)
+		return;
+	sim = conn->sim;
+
+	pthread_mutex_lock(&sim->lock);
+	for (pos = &sim->conns; *pos; pos = &(*pos)->next) {
+		if (*pos == conn) {
+			*pos = conn->next;
+			break;
+		}
+	}
+	if (conn->client)
+		conn->client->conns--;
+	sim_conn_flush(conn);
+	pthread_mutex_unlock(&sim->lock);
+
+	close(conn->timer_fd);
+	free(conn);
+}
+
+static void sim_session_drop(struct sim_session *s)
+{
+	metee_sim_close(s->conn);
+	close(s->fd);
+	s->fd = -1;
+	s->conn = NULL;
+	s->outstanding = 0;
+}
+
+static void sim_reply(struct metee_sim *sim, struct sim_session *s,
+		      uint16_t type, TEESTATUS status, const void *payload, size_t len)
+{
+	struct broker_hdr hdr;
+
+	hdr.type = type;
+	hdr.status = status;
+	hdr.param = 0;
+	/* never block on a client that does not read its replies */
+	if (broker_send(s->fd, &hdr, payload, len) < 0 && errno != EINTR) {
+		sim_log(sim, true, "Client %d reply failed %d, dropping\n", s->fd, errno);
+		sim_session_drop(s);
+	}
+}
+
+static void sim_session_connect(struct metee_sim *sim, struct sim_session *s,
+				const struct broker_hdr *hdr, size_t len)
+{
+	struct broker_connect_rsp rsp;
+	TEESTATUS status;
+
+	if (hdr->param != BROKER_PROTO_VERSION || len != sizeof(GUID)) {
+		sim_reply(sim, s, BROKER_CONNECT, TEE_NOTSUPPORTED, NULL, 0);
+		return;
+	}
+
+	/* reconnect drops the previous connection like the device does */
+	metee_sim_close(s->conn);
+	s->conn = NULL;
+	s->outstanding = 0;
+
+	memset(&rsp, 0, sizeof(rsp));
+	status = metee_sim_open(sim, (const GUID *)(sim->buf + sizeof(*hdr)), &s->conn,
+				&rsp.max_msg_len, &rsp.protocol_ver);
+	if (status) {
+		sim_log(sim, true, "Client %d connect failed %u\n", s->fd, status);
+		sim_reply(sim, s, BROKER_CONNECT, status, NULL, 0);
+		return;
+	}
+	sim_reply(sim, s, BROKER_CONNECT, TEE_SUCCESS, &rsp, sizeof(rsp));
+}
+
+static void sim_session_data(struct metee_sim *sim, struct sim_session *s, size_t len)
+{
+	TEESTATUS status;
+
+	if (!s->conn) {
+		sim_reply(sim, s, BROKER_DATA, TEE_DISCONNECTED, NULL, 0);
+		return;
+	}
+	status = metee_sim_write(s->conn, sim->buf + sizeof(struct broker_hdr), len);
+	if (status) {
+		sim_reply(sim, s, BROKER_DATA, status, NULL, 0);
+		return;
+	}
+	s->outstanding++;
+}
+
+static void sim_session_recv(struct metee_sim *sim, struct sim_session *s)
+{
+	struct broker_hdr hdr;
+	int truncated;
+	ssize_t rc;
+	size_t len;
+
+	rc = broker_recv(s->fd, &hdr, sim->buf + sizeof(hdr), BROKER_MAX_PAYLOAD, &truncated);
+	if (rc <= 0) {
+		sim_session_drop(s);
+		return;
+	}
+	/* keep header in front of payload for handlers */
+	memcpy(sim->buf, &hdr, sizeof(hdr));
+	len = (size_t)rc - sizeof(hdr);
+	if (truncated) {
+		sim_reply(sim, s, hdr.type, TEE_INVALID_PARAMETER, NULL, 0);
+		return;
+	}
+
+	switch (hdr.type) {
+	case BROKER_CONNECT:
+		sim_session_connect(sim, s, &hdr, len);
+		break;
+	case BROKER_DATA:
+		sim_session_data(sim, s, len);
+		break;
+	default:
+		/* no shared memory data path */
+		sim_reply(sim, s, hdr.type, TEE_NOTSUPPORTED, NULL, 0);
+		break;
+	}
+}
+
+/* forward due responses, every outstanding request fails after FW reset */
+static void sim_session_respond(struct metee_sim *sim, struct sim_session *s)
+{
+	TEESTATUS status;
+	size_t bytes = 0;
+
+	while (s->fd != -1 && s->outstanding) {
+		status = metee_sim_read(s->conn, sim->buf, sizeof(sim->buf), &bytes, 0);
+		if (status == TEE_TIMEOUT)
+			return;
+		if (status == TEE_DISCONNECTED) {
+			while (s->fd != -1 && s->outstanding) {
+				s->outstanding--;
+				sim_reply(sim, s, BROKER_DATA, TEE_DISCONNECTED, NULL, 0);
+			}
+			return;
+		}
+		s->outstanding--;
+		sim_reply(sim, s, BROKER_DATA, status, sim->buf, status ? 0 : bytes);
+	}
+}
+
+static void sim_accept(struct metee_sim *sim)
+{
+	int fd;
+	size_t i;
+
+	fd = accept4(sim->listen_fd, NULL, NULL, SOCK_CLOEXEC | SOCK_NONBLOCK);
+	if (fd < 0)
+		return;
+	for (i = 0; i < SIM_MAX_SESSIONS; i++) {
+		if (sim->sessions[i].fd == -1) {
+			memset(&sim->sessions[i], 0, sizeof(sim->sessions[i]));
+			sim->sessions[i].fd = fd;
+			sim_log(sim, false, "Client %d accepted\n", fd);
+			return;
+		}
+	}
+	sim_log(sim, true, "Too many clients\n");
+	close(fd);
+}
+
+TEESTATUS metee_sim_run(struct metee_sim *sim)
+{
+	struct pollfd pfd[2 + 2 * SIM_MAX_SESSIONS];
+	struct sim_session *owner[2 + 2 * SIM_MAX_SESSIONS];
+	uint64_t value;
+
+	if (!sim || sim->listen_fd == -1)
+		return TEE_INVALID_PARAMETER;
+
+	while (true) {
+		nfds_t n = 2;
+		nfds_t i;
+
+		pfd[0].fd = sim->stop_fd;
+		pfd[0].events = POLLIN;
+		pfd[1].fd = sim->listen_fd;
+		pfd[1].events = POLLIN;
+		for (i = 0; i < SIM_MAX_SESSIONS; i++) {
+			struct sim_session *s = &sim->sessions[i];
+
+			if (s->fd == -1)
+				continue;
+			pfd[n].fd = s->fd;
+			pfd[n].events = POLLIN;
+			owner[n++] = s;
+			if (s->outstanding) {
+				pfd[n].fd = metee_sim_fd(s->conn);
+				pfd[n].events = POLLIN;
+				owner[n++] = s;
+			}
+		}
+
+		if (poll(pfd, n, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			return TEE_INTERNAL_ERROR;
+		}
+
+		if (pfd[0].revents) {
+			if (read(sim->stop_fd, &value, sizeof(value)) < 0) {
+				/* nothing to do, stop anyway */
+			}
+			return TEE_SUCCESS;
+		}
+		if (pfd[1].revents & POLLIN)
+			sim_accept(sim);
+		for (i = 2; i < n; i++) {
+			struct sim_session *s = owner[i];
+
+			if (!pfd[i].revents || s->fd == -1)
+				continue;
+			if (pfd[i].fd == s->fd)
+				sim_session_recv(sim, s);
+			else
+				sim_session_respond(sim, s);
+		}
+	}
+}
+
+void metee_sim_stop(struct metee_sim *sim)
+{
+	uint64_t value = 1;
+
+	if (!sim)
+		return;
+	if (write(sim->stop_fd, &value, sizeof(value)) < 0) {
+		/* eventfd counter overflow only, already signaled */
+	}
+}
+
+void metee_sim_destroy(struct metee_sim *sim)
+{
+	size_t i;
+
+	if (!sim)
+		return;
+	for (i = 0; i < SIM_MAX_SESSIONS; i++) {
+		if (sim->sessions[i].fd != -1)
+			sim_session_drop(&sim->sessions[i]);
+	}
+	/* connections left open by device API users */
+	while (sim->conns)
+		metee_sim_close(sim->conns);
+	if (sim->listen_fd != -1) {
+		close(sim->listen_fd);
+		unlink(sim->cfg.socket_path);
+	}
+	close(sim->stop_fd);
+	pthread_mutex_destroy(&sim->lock);
+	free(sim);
+}
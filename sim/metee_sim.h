@@ -0,0 +1,169 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+/*! \file metee_sim.h
+ *  \brief metee firmware simulator: fake FW clients served to metee handles without ME hardware
+ */
+#ifndef __METEE_SIM_H
+#define __METEE_SIM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "metee.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! Simulated FW client behavior */
+enum metee_sim_kind {
+	METEE_SIM_ECHO = 0,   /**< every request is returned as response */
+	METEE_SIM_MKHI = 1,   /**< MKHI: GEN GET_FW_VERSION */
+	METEE_SIM_AMTHI = 2,  /**< AMTHI: CFG_GET_CODE_VERSIONS */
+	METEE_SIM_FWU = 3,    /**< GSC firmware update: GET_IP_VERSION, START, DATA, END */
+	METEE_SIM_CUSTOM = 4, /**< responder function */
+};
+
+/*! Response latency distribution */
+enum metee_sim_latency_dist {
+	METEE_SIM_LATENCY_FIXED = 0,       /**< latency_us */
+	METEE_SIM_LATENCY_UNIFORM = 1,     /**< latency_us plus uniform [0, jitter_us] */
+	METEE_SIM_LATENCY_EXPONENTIAL = 2, /**< latency_us plus exponential with mean jitter_us */
+};
+
+/*! Simulated FW client */
+struct metee_sim_client {
+	GUID guid; /**< client GUID */
+	enum metee_sim_kind kind; /**< client behavior */
+	uint32_t max_msg_len; /**< client MTU */
+	uint8_t protocol_ver; /**< client protocol version */
+	uint32_t max_conn; /**< simultaneous connections, zero for unlimited */
+	enum metee_sim_latency_dist latency; /**< response latency distribution */
+	uint32_t latency_us; /**< fixed or minimal response latency in microseconds */
+	uint32_t jitter_us; /**< distribution parameter in microseconds */
+	uint32_t reset_after; /**< FW resets after every reset_after responses of the client, zero never */
+	uint16_t fw_version[4]; /**< major, minor, hotfix, build reported by the client */
+	TeeScriptResponder responder; /**< METEE_SIM_CUSTOM responder */
+	void *ctx; /**< responder context */
+};
+
+/*! Simulator configuration */
+struct metee_sim_config {
+	const char *socket_path; /**< socket served by metee_sim_run(), NULL for device API only */
+	uint64_t seed; /**< latency random generator seed, zero for default */
+	TeeLogCallback2 log_callback; /**< log callback, may be NULL */
+	bool verbose; /**< log every request */
+};
+
+struct metee_sim;
+struct metee_sim_conn;
+
+/*! Fill client with defaults of the well-known FW client of the kind
+ *  \param kind client behavior, METEE_SIM_ECHO and METEE_SIM_CUSTOM use MKHI GUID
+ *  \param client client to fill
+ */
+void metee_sim_client_preset(enum metee_sim_kind kind, struct metee_sim_client *client);
+
+/*! Create simulator and bind listening socket
+ *  \param config simulator configuration
+ *  \param sim created simulator
+ *  \return 0 if successful, otherwise error code
+ */
+TEESTATUS metee_sim_create(const struct metee_sim_config *config, struct metee_sim **sim);
+
+/*! Register FW client, before the first connection
+ *  \param sim the simulator
+ *  \param client client description, copied
+ *  \return 0 if successful, otherwise error code
+ */
+TEESTATUS metee_sim_add_client(struct metee_sim *sim, const struct metee_sim_client *client);
+
+/*! Serve metee handles initialized with TEE_DEVICE_TYPE_BROKER and the simulator
+ *  socket path until metee_sim_stop() is called
+ *  \param sim the simulator
+ *  \return 0 if stopped, otherwise error code
+ */
+TEESTATUS metee_sim_run(struct metee_sim *sim);
+
+/*! Stop metee_sim_run(), async-signal-safe
+ *  \param sim the simulator
+ */
+void metee_sim_stop(struct metee_sim *sim);
+
+/*! Reset firmware: drop every connection and pending response, thread-safe
+ *  \param sim the simulator
+ */
+void metee_sim_reset(struct metee_sim *sim);
+
+/*! Number of FW resets since creation
+ *  \param sim the simulator
+ *  \return reset count
+ */
+uint32_t metee_sim_reset_count(struct metee_sim *sim);
+
+/*! Close all connections, remove socket and free simulator
+ *  \param sim the simulator
+ */
+void metee_sim_destroy(struct metee_sim *sim);
+
+/*! Device API: connect to FW client, thread-safe
+ *  \param sim the simulator
+ *  \param guid FW client GUID
+ *  \param conn created connection
+ *  \param max_msg_len FW client MTU
+ *  \param protocol_ver FW client protocol version
+ *  \return 0 if successful, TEE_CLIENT_NOT_FOUND or TEE_BUSY when max_conn is reached
+ */
+TEESTATUS metee_sim_open(struct metee_sim *sim, const GUID *guid, struct metee_sim_conn **conn,
+			 uint32_t *max_msg_len, uint8_t *protocol_ver);
+
+/*! Device API: descriptor readable when a response is due or the FW was reset
+ *  \param conn the connection
+ *  \return file descriptor
+ */
+int metee_sim_fd(struct metee_sim_conn *conn);
+
+/*! Device API: connection state
+ *  \param conn the connection
+ *  \return false after FW reset
+ */
+bool metee_sim_connected(struct metee_sim_conn *conn);
+
+/*! Device API: responses not read yet, including the ones not due
+ *  \param conn the connection
+ *  \return number of pending responses
+ */
+uint32_t metee_sim_pending(struct metee_sim_conn *conn);
+
+/*! Device API: send request, the response is available after the client latency
+ *  \param conn the connection
+ *  \param buffer request
+ *  \param size request size
+ *  \return 0 if successful, TEE_DISCONNECTED after FW reset
+ */
+TEESTATUS metee_sim_write(struct metee_sim_conn *conn, const void *buffer, size_t size);
+
+/*! Device API: receive response
+ *  \param conn the connection
+ *  \param buffer response buffer
+ *  \param size buffer size
+ *  \param bytes response size
+ *  \param timeout timeout in milliseconds, zero for no wait, negative for infinite
+ *  \return 0 if successful, TEE_TIMEOUT when no response is due,
+ *          TEE_DISCONNECTED after FW reset
+ */
+TEESTATUS metee_sim_read(struct metee_sim_conn *conn, void *buffer, size_t size,
+			 size_t *bytes, int timeout);
+
+/*! Device API: disconnect and free connection
+ *  \param conn the connection
+ */
+void metee_sim_close(struct metee_sim_conn *conn);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __METEE_SIM_H */
@@ -790,3 +790,256 @@ Cleanup:
 	FUNC_EXIT(handle, status);
 	return status;
 }
+
+TEESTATUS TEEAPI TeeGetStats(IN PTEEHANDLE handle, OUT struct tee_stats *stats)
+{
+	TEESTATUS status = TEE_NOTSUPPORTED;
+
+	if (NULL == handle) {
+		return TEE_INVALID_PARAMETER;
+	}
+
+	FUNC_ENTRY(handle);
+	UNREFERENCED_PARAMETER(stats);
+	FUNC_EXIT(handle, status);
+	return status;
+}
+
+TEESTATUS TEEAPI TeeTraceStart(IN size_t size)
+{
+	UNREFERENCED_PARAMETER(size);
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeTraceStop(void)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeTraceDrain(IN TeeTraceCallback callback, IN OPTIONAL void *ctx,
+			       OUT OPTIONAL uint64_t *dropped)
+{
+	UNREFERENCED_PARAMETER(callback);
+	UNREFERENCED_PARAMETER(ctx);
+	UNREFERENCED_PARAMETER(dropped);
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeSetLogCallback3(IN const PTEEHANDLE handle, IN OPTIONAL TeeLogCallback3 log_callback,
+				    IN OPTIONAL void *ctx)
+{
+	UNREFERENCED_PARAMETER(handle);
+	UNREFERENCED_PARAMETER(log_callback);
+	UNREFERENCED_PARAMETER(ctx);
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeLogEventFormat(IN const struct tee_log_event *event, OUT char *buf, IN size_t size)
+{
+	UNREFERENCED_PARAMETER(event);
+	UNREFERENCED_PARAMETER(buf);
+	UNREFERENCED_PARAMETER(size);
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeCaptureStart(IN PTEEHANDLE handle, IN const char *path)
+{
+	UNREFERENCED_PARAMETER(handle);
+	UNREFERENCED_PARAMETER(path);
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeCaptureStop(IN PTEEHANDLE handle)
+{
+	UNREFERENCED_PARAMETER(handle);
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeReplaySetSpeed(IN PTEEHANDLE handle, IN uint32_t speed)
+{
+	UNREFERENCED_PARAMETER(handle);
+	UNREFERENCED_PARAMETER(speed);
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeFaultStart(IN PTEEHANDLE handle, IN const struct tee_fault_config *config)
+{
+	UNREFERENCED_PARAMETER(handle);
+	UNREFERENCED_PARAMETER(config);
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeFaultStop(IN PTEEHANDLE handle)
+{
+	UNREFERENCED_PARAMETER(handle);
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeFaultGetStats(IN PTEEHANDLE handle, OUT struct tee_fault_stats *stats)
+{
+	UNREFERENCED_PARAMETER(handle);
+	UNREFERENCED_PARAMETER(stats);
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeCancelTokenCreate(OUT struct tee_cancel_token **token)
+{
+	UNREFERENCED_PARAMETER(token);
+	return TEE_NOTSUPPORTED;
+}
+
+void TEEAPI TeeCancelTokenFree(IN struct tee_cancel_token *token)
+{
+	UNREFERENCED_PARAMETER(token);
+}
+
+TEESTATUS TEEAPI TeeCancelTokenSetDeadline(IN struct tee_cancel_token *token, IN uint32_t timeout)
+{
+	UNREFERENCED_PARAMETER(token);
+	UNREFERENCED_PARAMETER(timeout);
+	return TEE_NOTSUPPORTED;
+}
+
+void TEEAPI TeeCancelTokenCancel(IN struct tee_cancel_token *token)
+{
+	UNREFERENCED_PARAMETER(token);
+}
+
+void TEEAPI TeeCancelTokenReset(IN struct tee_cancel_token *token)
+{
+	UNREFERENCED_PARAMETER(token);
+}
+
+bool TEEAPI TeeCancelTokenIsCanceled(IN struct tee_cancel_token *token)
+{
+	UNREFERENCED_PARAMETER(token);
+	return false;
+}
+
+TEESTATUS TEEAPI TeeReadEx(IN PTEEHANDLE handle, IN OUT void *buffer, IN size_t bufferSize,
+			   OUT OPTIONAL size_t *pNumOfBytesRead, IN OPTIONAL uint32_t timeout,
+			   IN OPTIONAL struct tee_cancel_token *token)
+{
+	UNREFERENCED_PARAMETER(handle);
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(bufferSize);
+	UNREFERENCED_PARAMETER(pNumOfBytesRead);
+	UNREFERENCED_PARAMETER(timeout);
+	UNREFERENCED_PARAMETER(token);
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeWriteEx(IN PTEEHANDLE handle, IN const void *buffer, IN size_t bufferSize,
+			    OUT OPTIONAL size_t *numberOfBytesWritten, IN OPTIONAL uint32_t timeout,
+			    IN OPTIONAL struct tee_cancel_token *token)
+{
+	UNREFERENCED_PARAMETER(handle);
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(bufferSize);
+	UNREFERENCED_PARAMETER(numberOfBytesWritten);
+	UNREFERENCED_PARAMETER(timeout);
+	UNREFERENCED_PARAMETER(token);
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeTransact(IN PTEEHANDLE handle, IN const void *request, IN size_t requestSize,
+			     IN OUT void *response, IN size_t responseSize,
+			     OUT OPTIONAL size_t *pNumOfBytesRead, IN OPTIONAL uint32_t timeout,
+			     IN OPTIONAL struct tee_cancel_token *token)
+{
+	UNREFERENCED_PARAMETER(handle);
+	UNREFERENCED_PARAMETER(request);
+	UNREFERENCED_PARAMETER(requestSize);
+	UNREFERENCED_PARAMETER(response);
+	UNREFERENCED_PARAMETER(responseSize);
+	UNREFERENCED_PARAMETER(pNumOfBytesRead);
+	UNREFERENCED_PARAMETER(timeout);
+	UNREFERENCED_PARAMETER(token);
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeHotplugStart(IN TEE_DEVICE_HANDLE source)
+{
+	UNREFERENCED_PARAMETER(source);
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeHotplugStop(void)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeHotplugQuery(IN const char *name, OUT bool *present)
+{
+	UNREFERENCED_PARAMETER(name);
+	UNREFERENCED_PARAMETER(present);
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeHotplugBind(IN PTEEHANDLE handle, IN OPTIONAL const char *name)
+{
+	UNREFERENCED_PARAMETER(handle);
+	UNREFERENCED_PARAMETER(name);
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeHotplugWait(IN PTEEHANDLE handle, IN OPTIONAL uint32_t timeout)
+{
+	UNREFERENCED_PARAMETER(handle);
+	UNREFERENCED_PARAMETER(timeout);
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeSetDevStatePolicy(IN PTEEHANDLE handle, IN uint32_t policy)
+{
+	UNREFERENCED_PARAMETER(handle);
+	UNREFERENCED_PARAMETER(policy);
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeGetDevState(IN PTEEHANDLE handle, IN OUT char *state, IN OUT size_t *stateSize)
+{
+	UNREFERENCED_PARAMETER(handle);
+	UNREFERENCED_PARAMETER(state);
+	UNREFERENCED_PARAMETER(stateSize);
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeDevStateBind(IN PTEEHANDLE handle, IN OPTIONAL const char *path)
+{
+	UNREFERENCED_PARAMETER(handle);
+	UNREFERENCED_PARAMETER(path);
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeePowerPin(IN PTEEHANDLE handle)
+{
+	UNREFERENCED_PARAMETER(handle);
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeePowerUnpin(IN PTEEHANDLE handle)
+{
+	UNREFERENCED_PARAMETER(handle);
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeePowerPreWake(IN PTEEHANDLE handle)
+{
+	UNREFERENCED_PARAMETER(handle);
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeGetPowerStats(IN PTEEHANDLE handle, OUT struct tee_power_stats *stats)
+{
+	UNREFERENCED_PARAMETER(handle);
+	UNREFERENCED_PARAMETER(stats);
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeePowerBind(IN PTEEHANDLE handle, IN OPTIONAL const char *dir)
+{
+	UNREFERENCED_PARAMETER(handle);
+	UNREFERENCED_PARAMETER(dir);
+	return TEE_NOTSUPPORTED;
+}
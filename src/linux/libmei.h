@@ -13,6 +13,7 @@
 
 #include <linux/uuid.h>
 #include <linux/mei.h>
+#include <stdarg.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <unistd.h>
@@ -66,6 +67,12 @@ typedef void(*mei_log_callback)(bool is_error, const char* fmt, ...);
  */
 typedef void(*mei_log_callback2)(bool is_error, const char* msg);
 
+/*! structured log callback function format
+ *  args point to the arguments of fmt, valid only during the call
+ */
+typedef void(*mei_log_callback3)(void *ctx, bool is_error, const char *file,
+				 const char *func, int line, const char *fmt, va_list *args);
+
 /*! Structure to store connection data
  */
 struct mei {
@@ -82,6 +89,8 @@ struct mei {
 	uint8_t vtag;           /**< vtag used in communication */
 	mei_log_callback log_callback; /**< Deprecated Log callback */
 	mei_log_callback2 log_callback2; /**< Log callback */
+	mei_log_callback3 log_callback3; /**< Structured log callback */
+	void *log_ctx;          /**< Structured log callback context */
 };
 
 /*! Default name of mei device
@@ -321,6 +330,15 @@ int mei_set_log_callback(struct mei *me, mei_log_callback log_callback);
  */
 int mei_set_log_callback2(struct mei *me, mei_log_callback2 log_callback);
 
+/*! Set structured log callback, takes precedence over the text callbacks
+ *
+ *  \param me The mei handle
+ *  \param log_callback pointer to function to run for log write, set NULL to use text logging
+ *  \param ctx context passed to the callback
+ *  \return 0 if successful, otherwise error code.
+ */
+int mei_set_log_callback3(struct mei *me, mei_log_callback3 log_callback, void *ctx);
+
 #ifdef __cplusplus
 }
 #endif /*  __cplusplus */
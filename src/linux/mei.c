@@ -19,19 +19,36 @@
 #include <stdarg.h>
 
 #include "libmei.h"
+#ifdef METEE_TRACE
+#include "metee_trace.h"
+#define MEI_TRACE_ACTIVE() metee_trace_active()
+#define MEI_TRACE(_me, is_err, payload, len, fmt, ARGS...) \
+	METEE_TRACE_RECORD(_me, is_err, payload, len, fmt, ##ARGS)
+#else
+#define MEI_TRACE_ACTIVE() 0
+#define MEI_TRACE(_me, is_err, payload, len, fmt, ARGS...) {}
+#endif /* METEE_TRACE */
 
 /*****************************************************************************
  * Intel Management Engine Interface
  *****************************************************************************/
+/* Lowest log level compiled in, prints above it are removed at compile time */
+#ifndef METEE_MIN_LOG_LEVEL
+#define METEE_MIN_LOG_LEVEL MEI_LOG_LEVEL_VERBOSE
+#endif
+
 #ifdef ANDROID
 #define LOG_TAG "libmei"
 #include <android/log_macros.h>
 #define mei_msg(_me, fmt, ARGS...) \
-((_me->log_level >= MEI_LOG_LEVEL_VERBOSE) \
+((METEE_MIN_LOG_LEVEL >= MEI_LOG_LEVEL_VERBOSE && _me->log_level >= MEI_LOG_LEVEL_VERBOSE) \
 ? (void)ALOGV(fmt, ##ARGS) \
 : (void)0)
 
-#define mei_err(_me, fmt, ARGS...) ALOGE(fmt, ##ARGS)
+#define mei_err(_me, fmt, ARGS...) \
+((METEE_MIN_LOG_LEVEL > MEI_LOG_LEVEL_QUIET) \
+? (void)ALOGE(fmt, ##ARGS) \
+: (void)0)
 #ifdef DEBUG
 static inline void __dump_buffer(const char *buf)
 {
@@ -52,10 +69,16 @@ static inline void __dump_buffer(const char *buf)
 
 #define LEGACY_CALLBACK_SET(h) ((h)->log_callback ? 1 : 0)
 #define STANDARD_CALLBACK_SET(h) ((h)->log_callback2 ? 1 : 0)
+#define STRUCTURED_CALLBACK_SET(h) ((h)->log_callback3 ? 1 : 0)
 
 #define mei_msg(_me, fmt, ARGS...) do { \
-	if ((_me)->log_level >= MEI_LOG_LEVEL_VERBOSE) { \
-		if (LEGACY_CALLBACK_SET(_me)) \
+	if (METEE_MIN_LOG_LEVEL >= MEI_LOG_LEVEL_VERBOSE && \
+	    (_me)->log_level >= MEI_LOG_LEVEL_VERBOSE) { \
+		if (MEI_TRACE_ACTIVE()) \
+			MEI_TRACE(_me, false, NULL, 0, fmt, ##ARGS) \
+		else if (STRUCTURED_CALLBACK_SET(_me)) \
+			callback3_print_helper((_me), false, __FILE__, __FUNCTION__, __LINE__, fmt, ##ARGS); \
+		else if (LEGACY_CALLBACK_SET(_me)) \
 			(_me)->log_callback(false, fmt, ##ARGS); \
 		else if (STANDARD_CALLBACK_SET(_me)) \
 			callback_print_helper((_me), false, fmt, ##ARGS); \
@@ -65,8 +88,13 @@ static inline void __dump_buffer(const char *buf)
 } while (0)
 
 #define mei_err(_me, fmt, ARGS...) do { \
-	if ((_me)->log_level > MEI_LOG_LEVEL_QUIET) { \
-		if (LEGACY_CALLBACK_SET(_me)) \
+	if (METEE_MIN_LOG_LEVEL > MEI_LOG_LEVEL_QUIET && \
+	    (_me)->log_level > MEI_LOG_LEVEL_QUIET) { \
+		if (MEI_TRACE_ACTIVE()) \
+			MEI_TRACE(_me, true, NULL, 0, fmt, ##ARGS) \
+		else if (STRUCTURED_CALLBACK_SET(_me)) \
+			callback3_print_helper((_me), true, __FILE__, __FUNCTION__, __LINE__, fmt, ##ARGS); \
+		else if (LEGACY_CALLBACK_SET(_me)) \
 			(_me)->log_callback(true, "me: error: " fmt, ##ARGS); \
 		else if (STANDARD_CALLBACK_SET(_me)) \
 			callback_print_helper((_me), true, fmt, ##ARGS); \
@@ -100,23 +128,24 @@ static void dump_hex_buffer(const unsigned char *buf, size_t len)
 #undef LINE_LEN
 }
 
+#endif /* DEBUG */
+
 static void mei_dump_hex_buffer(struct mei *me,
 				const unsigned char *buf, size_t len)
 {
-	if (me->log_level < MEI_LOG_LEVEL_VERBOSE)
+	if (METEE_MIN_LOG_LEVEL < MEI_LOG_LEVEL_VERBOSE ||
+	    me->log_level < MEI_LOG_LEVEL_VERBOSE)
 		return;
 
+	/* raw bytes are cheaper to keep than the hex dump */
+	if (MEI_TRACE_ACTIVE()) {
+		MEI_TRACE(me, false, buf, len, "buffer %zu bytes\n", len)
+		return;
+	}
+#ifdef DEBUG
 	dump_hex_buffer(buf, len);
-}
-#else /* DEBUG */
-static void mei_dump_hex_buffer(struct mei *me,
-				const unsigned char *buf, size_t len)
-{
-	(void)(me);
-	(void)(buf);
-	(void)(len);
-}
 #endif /* DEBUG */
+}
 
 static void callback_print_helper(struct mei *me, bool is_error, const char* args, ...)
 {
@@ -129,6 +158,15 @@ static void callback_print_helper(struct mei *me, bool is_error, const char* arg
 	me->log_callback2(is_error, msg);
 }
 
+static void callback3_print_helper(struct mei *me, bool is_error, const char *file,
+				   const char *func, int line, const char *fmt, ...)
+{
+	va_list varl;
+	va_start(varl, fmt);
+	me->log_callback3(me->log_ctx, is_error, file, func, line, fmt, &varl);
+	va_end(varl);
+}
+
 void mei_deinit(struct mei *me)
 {
 	if (!me)
@@ -420,6 +458,8 @@ static int __mei_init_with_log_int(struct mei *me, const char *device, const uui
 	me->device = NULL;
 	me->log_callback = log_callback;
 	me->log_callback2 = log_callback2;
+	me->log_callback3 = NULL;
+	me->log_ctx = NULL;
 	mei_deinit(me);
 
 	me->log_level = verbose ? MEI_LOG_LEVEL_VERBOSE : MEI_LOG_LEVEL_ERROR;
@@ -530,6 +570,8 @@ int mei_init_fd(struct mei *me, int fd, const uuid_le *guid,
 	me->fd = fd;
 	me->log_callback = NULL;
 	me->log_callback2 = NULL;
+	me->log_callback3 = NULL;
+	me->log_ctx = NULL;
 
 	me->log_level = verbose ? MEI_LOG_LEVEL_VERBOSE : MEI_LOG_LEVEL_ERROR;
 
@@ -916,3 +958,15 @@ int mei_set_log_callback2(struct mei *me, mei_log_callback2 log_callback)
 
 	return 0;
 }
+
+int mei_set_log_callback3(struct mei *me, mei_log_callback3 log_callback, void *ctx)
+{
+	if (!me)
+		return -EINVAL;
+
+	me->log_callback3 = log_callback;
+	me->log_ctx = ctx;
+	mei_msg(me, "New log callback set\n");
+
+	return 0;
+}
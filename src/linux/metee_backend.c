@@ -0,0 +1,72 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+#include <errno.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "metee_backend.h"
+
+int metee_backend_poll(struct mei *me, void *priv, const int *cancel_fds, bool on_read, size_t len, int timeout)
+{
+	struct pollfd pfd[1 + METEE_CANCEL_FDS];
+	int rv;
+	int i;
+
+	(void)priv;
+	(void)len;
+	pfd[0].fd = me->fd;
+	pfd[0].events = (on_read) ? POLLIN : POLLOUT;
+	for (i = 0; i < METEE_CANCEL_FDS; i++) {
+		pfd[1 + i].fd = cancel_fds[i];
+		pfd[1 + i].events = POLLIN;
+		pfd[1 + i].revents = 0;
+	}
+
+	errno = 0;
+	rv = poll(pfd, 1 + METEE_CANCEL_FDS, timeout);
+	if (rv < 0)
+		return -errno;
+	if (rv == 0)
+		return -ETIME;
+	for (i = 0; i < METEE_CANCEL_FDS; i++) {
+		if (pfd[1 + i].revents != 0)
+			return -ECANCELED;
+	}
+	return 0;
+}
+
+int metee_backend_sleep(const int *cancel_fds, int timeout)
+{
+	struct pollfd pfd[METEE_CANCEL_FDS];
+	int rv;
+	int i;
+
+	for (i = 0; i < METEE_CANCEL_FDS; i++) {
+		pfd[i].fd = cancel_fds[i];
+		pfd[i].events = POLLIN;
+		pfd[i].revents = 0;
+	}
+
+	errno = 0;
+	rv = poll(pfd, METEE_CANCEL_FDS, timeout);
+	if (rv < 0)
+		return -errno;
+	return (rv > 0) ? -ECANCELED : 0;
+}
+
+int metee_backend_remaining(const struct timespec *start, int timeout)
+{
+	struct timespec now;
+	int64_t elapsed;
+
+	if (timeout < 0)
+		return timeout;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	/* whole nanoseconds first, a negative tv_nsec difference must not round up */
+	elapsed = ((int64_t)(now.tv_sec - start->tv_sec) * 1000000000 +
+		   (now.tv_nsec - start->tv_nsec)) / 1000000;
+	return (elapsed >= timeout) ? 0 : (int)(timeout - elapsed);
+}
@@ -0,0 +1,94 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+#ifndef __METEE_BACKEND_H
+#define __METEE_BACKEND_H
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <time.h>
+
+#include <libmei.h>
+#include "metee.h"
+
+/*
+ * Transport backend of a Linux handle, selected by the device address type.
+ * The client state (file descriptor, GUID, MTU, protocol version and
+ * connection state) is kept in struct mei for every backend; anything else
+ * belongs to the backend private data.
+ * Functions return 0 or the number of bytes on success and negative errno
+ * on failure; errno values are translated to TEESTATUS by the library.
+ */
+/* descriptors ending a wait when readable: handle-wide cancel and operation token, negative if unused */
+#define METEE_CANCEL_FDS 2
+
+struct metee_backend_params {
+	const struct tee_device_address *device;
+	const GUID *guid;
+	bool verbose;
+	TeeLogCallback log_callback;
+	TeeLogCallback2 log_callback2;
+};
+
+struct metee_backend_ops {
+	const char *name;
+	/* initialize me and allocate private data, me->state is MEI_CL_STATE_INITIALIZED on success */
+	int (*open)(struct mei *me, void **priv, const struct metee_backend_params *params);
+	/* release everything allocated by open */
+	void (*close)(struct mei *me, void *priv);
+	/* connect to the client, fills buf_size and prot_ver */
+	int (*connect)(struct mei *me, void *priv);
+	/* wait until a message can be read or len bytes written, -ETIME on timeout, -ECANCELED when one of cancel_fds is readable */
+	int (*wait)(struct mei *me, void *priv, const int *cancel_fds, bool on_read, size_t len, int timeout);
+	ssize_t (*read)(struct mei *me, void *priv, void *buffer, size_t len);
+	ssize_t (*write)(struct mei *me, void *priv, const void *buffer, size_t len);
+	/* optional, wake waits not watching cancel_fds */
+	void (*cancel)(struct mei *me, void *priv);
+	/* optional, -EOPNOTSUPP when not set */
+	int (*fwstatus)(struct mei *me, void *priv, uint32_t fwsts_num, uint32_t *fwsts);
+	int (*trc)(struct mei *me, void *priv, uint32_t *trc_val);
+	int (*kind)(struct mei *me, void *priv, char *kind, size_t *kind_size);
+	/* optional, open the device again after it was replaced, me->state is MEI_CL_STATE_INITIALIZED on success */
+	int (*reopen)(struct mei *me, void *priv);
+};
+
+extern const struct metee_backend_ops metee_backend_mei;
+extern const struct metee_backend_ops metee_backend_broker;
+extern const struct metee_backend_ops metee_backend_replay;
+extern const struct metee_backend_ops metee_backend_script;
+extern const struct metee_backend_ops metee_backend_socket;
+extern const struct metee_backend_ops metee_backend_fault;
+
+/* wait on the device file descriptor, for backends without other wait condition */
+int metee_backend_poll(struct mei *me, void *priv, const int *cancel_fds, bool on_read, size_t len, int timeout);
+
+/* sleep up to timeout, -ECANCELED when one of cancel_fds is readable, negative timeout is infinite */
+int metee_backend_sleep(const int *cancel_fds, int timeout);
+
+/* remaining part of timeout after start, negative timeout is infinite */
+int metee_backend_remaining(const struct timespec *start, int timeout);
+
+/* status reported by a peer as errno, reverse of the library translation */
+static inline int metee_status2errno(TEESTATUS status)
+{
+	switch (status) {
+		case TEE_SUCCESS: return 0;
+		case TEE_INVALID_PARAMETER: return -EMSGSIZE;
+		case TEE_CLIENT_NOT_FOUND: return -ENOTTY;
+		case TEE_BUSY: return -EBUSY;
+		case TEE_DISCONNECTED: return -ENODEV;
+		case TEE_TIMEOUT: return -ETIME;
+		case TEE_PERMISSION_DENIED: return -EACCES;
+		case TEE_NOTSUPPORTED: return -EOPNOTSUPP;
+		case TEE_UNABLE_TO_COMPLETE_OPERATION: return -ECANCELED;
+		case TEE_INSUFFICIENT_BUFFER: return -ENOSPC;
+		case TEE_DEVICE_RESETTING: return -ENETRESET;
+		default: return -EPROTO;
+	}
+}
+
+#endif /* __METEE_BACKEND_H */
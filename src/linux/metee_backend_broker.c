@@ -0,0 +1,360 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+/* metee broker client, socket or shared memory data path */
+#include <errno.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "metee_backend.h"
+#include "metee_broker_proto.h"
+
+struct broker_backend {
+	bool shm_enabled; /* attach shared memory data path on connect */
+	struct broker_shm_area *shm; /* broker shared memory, NULL if not attached */
+	int shm_doorbell[3]; /* eventfds: to broker, responses from broker, request ring space from broker */
+};
+
+static void broker_shm_detach(struct broker_backend *broker)
+{
+	if (!broker->shm)
+		return;
+	munmap(broker->shm, sizeof(*broker->shm));
+	close(broker->shm_doorbell[0]);
+	close(broker->shm_doorbell[1]);
+	close(broker->shm_doorbell[2]);
+	broker->shm = NULL;
+}
+
+static int broker_shm_attach(struct mei *me, struct broker_backend *broker)
+{
+	struct broker_hdr hdr = {BROKER_SHM_ATTACH, 0, 0};
+	int fds[BROKER_SHM_FDS];
+	size_t nfds = BROKER_SHM_FDS;
+	struct stat st;
+	void *area;
+	size_t i;
+	int rc;
+
+	broker_shm_detach(broker);
+
+	if (broker_send(me->fd, &hdr, NULL, 0) < 0)
+		return -ENODEV;
+	if (broker_recv_fds(me->fd, &hdr, fds, &nfds) <= 0) {
+		rc = -ENODEV;
+		goto End;
+	}
+	if (hdr.type != BROKER_SHM_ATTACH) {
+		rc = -EPROTO;
+		goto End;
+	}
+	if (hdr.status != TEE_SUCCESS) {
+		rc = metee_status2errno(hdr.status);
+		goto End;
+	}
+	if (nfds != BROKER_SHM_FDS ||
+	    fstat(fds[0], &st) || (size_t)st.st_size < sizeof(struct broker_shm_area)) {
+		rc = -EPROTO;
+		goto End;
+	}
+	area = mmap(NULL, sizeof(struct broker_shm_area), PROT_READ | PROT_WRITE,
+		    MAP_SHARED, fds[0], 0);
+	if (area == MAP_FAILED) {
+		rc = -errno;
+		goto End;
+	}
+
+	/* mapping holds the memory */
+	close(fds[0]);
+	broker->shm = area;
+	broker->shm_doorbell[0] = fds[1];
+	broker->shm_doorbell[1] = fds[2];
+	broker->shm_doorbell[2] = fds[3];
+	return 0;
+
+End:
+	for (i = 0; i < nfds; i++)
+		close(fds[i]);
+	return rc;
+}
+
+static void broker_shm_ring(int doorbell)
+{
+	uint64_t value = 1;
+
+	/* counter overflow only, the peer is woken anyway */
+	if (write(doorbell, &value, sizeof(value)) < 0)
+		return;
+}
+
+/* wait for the broker doorbell, broker hangup or cancel */
+static int broker_shm_wait(struct mei *me, int doorbell, const int *cancel_fds, int timeout)
+{
+	struct pollfd pfd[2 + METEE_CANCEL_FDS];
+	uint64_t value;
+	int rv;
+	int i;
+
+	pfd[0].fd = doorbell;
+	pfd[0].events = POLLIN;
+	pfd[1].fd = me->fd;
+	pfd[1].events = 0;
+	for (i = 0; i < METEE_CANCEL_FDS; i++) {
+		pfd[2 + i].fd = cancel_fds[i];
+		pfd[2 + i].events = POLLIN;
+		pfd[2 + i].revents = 0;
+	}
+
+	errno = 0;
+	rv = poll(pfd, 2 + METEE_CANCEL_FDS, timeout);
+	if (rv < 0)
+		return -errno;
+	if (rv == 0)
+		return -ETIME;
+	for (i = 0; i < METEE_CANCEL_FDS; i++) {
+		if (pfd[2 + i].revents != 0)
+			return -ECANCELED;
+	}
+	if (pfd[1].revents != 0) {
+		me->state = MEI_CL_STATE_DISCONNECTED;
+		return -ENODEV;
+	}
+	if (read(doorbell, &value, sizeof(value)) < 0 && errno != EAGAIN)
+		return -errno;
+	return 0;
+}
+
+static int broker_open(struct mei *me, void **priv, const struct metee_backend_params *params)
+{
+	const char *path = params->device->data.path;
+	struct broker_backend *broker;
+	struct sockaddr_un addr;
+	size_t len = strlen(path);
+	int fd;
+
+	memset(me, 0, sizeof(*me));
+	me->fd = -1;
+	if (len >= sizeof(addr.sun_path))
+		return -ENAMETOOLONG;
+
+	broker = calloc(1, sizeof(*broker));
+	if (!broker)
+		return -ENOMEM;
+	broker->shm_enabled = (params->device->type == TEE_DEVICE_TYPE_BROKER_SHM);
+
+	fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (fd < 0) {
+		int err = errno;
+
+		free(broker);
+		return -err;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	memcpy(addr.sun_path, path, len);
+	if (connect(fd, (struct sockaddr *)&addr, sizeof(addr))) {
+		int err = errno;
+
+		close(fd);
+		free(broker);
+		return (err == ECONNREFUSED) ? -ENOENT : -err;
+	}
+
+	me->fd = fd;
+	me->close_on_exit = true;
+	memcpy(&me->guid, params->guid, sizeof(me->guid));
+	me->state = MEI_CL_STATE_INITIALIZED;
+	*priv = broker;
+	return 0;
+}
+
+static void broker_close(struct mei *me, void *priv)
+{
+	broker_shm_detach(priv);
+	free(priv);
+	mei_deinit(me);
+}
+
+static int broker_connect(struct mei *me, void *priv)
+{
+	struct broker_hdr hdr = {BROKER_CONNECT, 0, BROKER_PROTO_VERSION};
+	struct broker_backend *broker = priv;
+	struct broker_connect_rsp rsp;
+	ssize_t rc;
+
+	if (broker_send(me->fd, &hdr, &me->guid, sizeof(me->guid)) < 0)
+		return -ENODEV;
+
+	rc = broker_recv(me->fd, &hdr, &rsp, sizeof(rsp), NULL);
+	if (rc <= 0)
+		return -ENODEV;
+	if (hdr.type != BROKER_CONNECT)
+		return -EPROTO;
+	if (hdr.status != TEE_SUCCESS)
+		return metee_status2errno(hdr.status);
+	if ((size_t)rc != sizeof(hdr) + sizeof(rsp))
+		return -EPROTO;
+
+	me->buf_size = rsp.max_msg_len;
+	me->prot_ver = rsp.protocol_ver;
+
+	if (broker->shm_enabled) {
+		/* no data path, the handle of an earlier connect is not usable either */
+		rc = broker_shm_attach(me, broker);
+		if (rc) {
+			me->state = MEI_CL_STATE_DISCONNECTED;
+			return rc;
+		}
+	}
+	me->state = MEI_CL_STATE_CONNECTED;
+	return 0;
+}
+
+static int broker_wait(struct mei *me, void *priv, const int *cancel_fds, bool on_read, size_t len, int timeout)
+{
+	struct broker_backend *broker = priv;
+	struct broker_shm_ring *ring;
+	struct timespec start;
+	uint32_t rsp_len;
+	uint16_t rsp_status;
+	bool err;
+	int rc;
+
+	if (!broker->shm)
+		return metee_backend_poll(me, priv, cancel_fds, on_read, len, timeout);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if (on_read) {
+		/* a malformed record is reported by read */
+		ring = &broker->shm->rsp;
+		while (!broker_ring_peek(ring, me->buf_size, &rsp_len, &rsp_status, &err) && !err) {
+			rc = broker_shm_wait(me, broker->shm_doorbell[1], cancel_fds,
+					     metee_backend_remaining(&start, timeout));
+			if (rc)
+				return rc;
+		}
+		return 0;
+	}
+
+	if (len > me->buf_size)
+		return -EMSGSIZE;
+	ring = &broker->shm->req;
+	while (!broker_ring_fits(ring, len)) {
+		if (!broker_ring_wait_space(ring, len))
+			continue;
+		rc = broker_shm_wait(me, broker->shm_doorbell[2], cancel_fds,
+				     metee_backend_remaining(&start, timeout));
+		if (rc)
+			return rc;
+	}
+	return 0;
+}
+
+static ssize_t broker_shm_read(struct mei *me, struct broker_backend *broker, void *buffer, size_t len)
+{
+	struct broker_shm_ring *ring = &broker->shm->rsp;
+	const uint8_t *payload;
+	uint32_t rsp_len;
+	uint16_t rsp_status;
+	ssize_t rc;
+	bool err;
+
+	payload = broker_ring_peek(ring, me->buf_size, &rsp_len, &rsp_status, &err);
+	if (err) {
+		me->state = MEI_CL_STATE_DISCONNECTED;
+		return -EPROTO;
+	}
+	if (!payload)
+		return -EAGAIN;
+
+	if (rsp_status == TEE_SUCCESS) {
+		if (rsp_len > len) {
+			rc = -ENOSPC;
+		} else {
+			memcpy(buffer, payload, rsp_len);
+			rc = rsp_len;
+		}
+	} else {
+		if (rsp_status == TEE_DISCONNECTED)
+			me->state = MEI_CL_STATE_DISCONNECTED;
+		rc = metee_status2errno(rsp_status);
+	}
+	if (broker_ring_pop(ring, rsp_len))
+		broker_shm_ring(broker->shm_doorbell[0]);
+	return rc;
+}
+
+static ssize_t broker_read(struct mei *me, void *priv, void *buffer, size_t len)
+{
+	struct broker_backend *broker = priv;
+	struct broker_hdr hdr;
+	int truncated;
+	ssize_t rc;
+
+	if (broker->shm)
+		return broker_shm_read(me, broker, buffer, len);
+
+	rc = broker_recv(me->fd, &hdr, buffer, len, &truncated);
+	if (rc <= 0) {
+		me->state = MEI_CL_STATE_DISCONNECTED;
+		return -ENODEV;
+	}
+	if (hdr.type != BROKER_DATA)
+		return -EPROTO;
+	if (hdr.status != TEE_SUCCESS) {
+		if (hdr.status == TEE_DISCONNECTED)
+			me->state = MEI_CL_STATE_DISCONNECTED;
+		return metee_status2errno(hdr.status);
+	}
+	if (truncated)
+		return -ENOSPC;
+
+	return rc - (ssize_t)sizeof(hdr);
+}
+
+static ssize_t broker_write(struct mei *me, void *priv, const void *buffer, size_t len)
+{
+	struct broker_backend *broker = priv;
+	struct broker_hdr hdr = {BROKER_DATA, 0, 0};
+	uint8_t *slot;
+
+	if (len > me->buf_size)
+		return -EMSGSIZE;
+
+	if (broker->shm) {
+		slot = broker_ring_reserve(&broker->shm->req, len);
+		if (!slot)
+			return -EBUSY;
+		memcpy(slot, buffer, len);
+		broker_ring_commit(&broker->shm->req, len, TEE_SUCCESS);
+		broker_shm_ring(broker->shm_doorbell[0]);
+		return (ssize_t)len;
+	}
+
+	if (broker_send(me->fd, &hdr, buffer, len) < 0) {
+		me->state = MEI_CL_STATE_DISCONNECTED;
+		return -ENODEV;
+	}
+	return (ssize_t)len;
+}
+
+const struct metee_backend_ops metee_backend_broker = {
+	.name = "broker",
+	.open = broker_open,
+	.close = broker_close,
+	.connect = broker_connect,
+	.wait = broker_wait,
+	.read = broker_read,
+	.write = broker_write,
+};
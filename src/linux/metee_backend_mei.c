@@ -0,0 +1,114 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+/* Intel MEI character device through libmei */
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <libmei.h>
+
+#include "metee_backend.h"
+
+static int mei_backend_open(struct mei *me, void **priv, const struct metee_backend_params *params)
+{
+	const struct tee_device_address *device = params->device;
+	const char *path = MEI_DEFAULT_DEVICE;
+	int rc;
+
+	*priv = NULL;
+	if (device->type == TEE_DEVICE_TYPE_HANDLE) {
+		rc = mei_init_fd(me, device->data.handle, (const uuid_le *)params->guid, 0, params->verbose);
+		if (rc)
+			return rc;
+		if (params->log_callback)
+			mei_set_log_callback(me, params->log_callback);
+		else
+			mei_set_log_callback2(me, params->log_callback2);
+		mei_set_log_level(me, params->verbose);
+		return 0;
+	}
+
+	if (device->type == TEE_DEVICE_TYPE_PATH)
+		path = device->data.path;
+	if (params->log_callback)
+		return mei_init_with_log(me, path, (const uuid_le *)params->guid, 0,
+					 params->verbose, params->log_callback);
+	return mei_init_with_log2(me, path, (const uuid_le *)params->guid, 0,
+				  params->verbose, params->log_callback2);
+}
+
+static void mei_backend_close(struct mei *me, void *priv)
+{
+	(void)priv;
+	mei_deinit(me);
+}
+
+static int mei_backend_connect(struct mei *me, void *priv)
+{
+	(void)priv;
+	return mei_connect(me);
+}
+
+static ssize_t mei_backend_read(struct mei *me, void *priv, void *buffer, size_t len)
+{
+	(void)priv;
+	return mei_recv_msg(me, buffer, len);
+}
+
+static ssize_t mei_backend_write(struct mei *me, void *priv, const void *buffer, size_t len)
+{
+	(void)priv;
+	return mei_send_msg(me, buffer, len);
+}
+
+static int mei_backend_fwstatus(struct mei *me, void *priv, uint32_t fwsts_num, uint32_t *fwsts)
+{
+	(void)priv;
+	return mei_fwstatus(me, fwsts_num, fwsts);
+}
+
+static int mei_backend_trc(struct mei *me, void *priv, uint32_t *trc_val)
+{
+	(void)priv;
+	return mei_gettrc(me, trc_val);
+}
+
+static int mei_backend_kind(struct mei *me, void *priv, char *kind, size_t *kind_size)
+{
+	(void)priv;
+	return mei_getkind(me, kind, kind_size);
+}
+
+/* the device node came back after removal, the old descriptor is dead */
+static int mei_backend_reopen(struct mei *me, void *priv)
+{
+	int fd;
+
+	(void)priv;
+	if (!me->close_on_exit || !me->device)
+		return -EOPNOTSUPP;
+	fd = open(me->device, O_RDWR | O_CLOEXEC);
+	if (fd == -1)
+		return -errno;
+	if (me->fd != -1)
+		close(me->fd);
+	me->fd = fd;
+	me->last_err = 0;
+	me->state = MEI_CL_STATE_INITIALIZED;
+	return 0;
+}
+
+const struct metee_backend_ops metee_backend_mei = {
+	.name = "mei",
+	.open = mei_backend_open,
+	.close = mei_backend_close,
+	.connect = mei_backend_connect,
+	.wait = metee_backend_poll,
+	.read = mei_backend_read,
+	.write = mei_backend_write,
+	.fwstatus = mei_backend_fwstatus,
+	.trc = mei_backend_trc,
+	.kind = mei_backend_kind,
+	.reopen = mei_backend_reopen,
+};
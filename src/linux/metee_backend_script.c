@@ -0,0 +1,216 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+/*
+ * In-memory firmware client: every written message is passed to a
+ * responder function and the response is queued for read.
+ * The loopback device is the scripted one with an echo responder.
+ */
+#include <errno.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "metee_backend.h"
+
+#define SCRIPT_LOOPBACK_MTU 4096
+#define SCRIPT_QUEUE_MAX 64
+
+struct script_msg {
+	struct script_msg *next;
+	size_t len;
+	uint8_t data[];
+};
+
+struct script_backend {
+	struct tee_script script;
+	bool lock; /* protects the queue */
+	struct script_msg *head; /* oldest response */
+	struct script_msg *tail;
+	uint32_t queued;
+};
+
+static inline void script_lock(struct script_backend *sb)
+{
+	while (__atomic_test_and_set(&sb->lock, __ATOMIC_ACQUIRE))
+		sched_yield();
+}
+
+static inline void script_unlock(struct script_backend *sb)
+{
+	__atomic_clear(&sb->lock, __ATOMIC_RELEASE);
+}
+
+static TEESTATUS script_echo(void *ctx, const void *request, size_t request_len,
+			     void *response, size_t *response_len)
+{
+	(void)ctx;
+	memcpy(response, request, request_len);
+	*response_len = request_len;
+	return TEE_SUCCESS;
+}
+
+/* drop queued responses, me->fd counts them */
+static void script_flush(struct mei *me, struct script_backend *sb)
+{
+	struct script_msg *msg;
+	uint64_t value;
+
+	script_lock(sb);
+	while ((msg = sb->head) != NULL) {
+		sb->head = msg->next;
+		free(msg);
+		if (read(me->fd, &value, sizeof(value)) < 0)
+			break;
+	}
+	sb->tail = NULL;
+	sb->queued = 0;
+	script_unlock(sb);
+}
+
+static int script_open(struct mei *me, void **priv, const struct metee_backend_params *params)
+{
+	const struct tee_device_address *device = params->device;
+	struct script_backend *sb;
+	int fd;
+
+	memset(me, 0, sizeof(*me));
+	me->fd = -1;
+	if (device->type == TEE_DEVICE_TYPE_SCRIPT &&
+	    (!device->data.script->responder || !device->data.script->max_msg_len))
+		return -EINVAL;
+
+	sb = calloc(1, sizeof(*sb));
+	if (!sb)
+		return -ENOMEM;
+	if (device->type == TEE_DEVICE_TYPE_SCRIPT) {
+		sb->script = *device->data.script;
+	} else {
+		sb->script.max_msg_len = SCRIPT_LOOPBACK_MTU;
+		sb->script.protocol_ver = 1;
+		sb->script.responder = script_echo;
+	}
+
+	fd = eventfd(0, EFD_SEMAPHORE | EFD_NONBLOCK | EFD_CLOEXEC);
+	if (fd < 0) {
+		int err = errno;
+
+		free(sb);
+		return -err;
+	}
+
+	me->fd = fd;
+	me->close_on_exit = true;
+	memcpy(&me->guid, params->guid, sizeof(me->guid));
+	me->state = MEI_CL_STATE_INITIALIZED;
+	*priv = sb;
+	return 0;
+}
+
+static void script_close(struct mei *me, void *priv)
+{
+	script_flush(me, priv);
+	free(priv);
+	mei_deinit(me);
+}
+
+static int script_connect(struct mei *me, void *priv)
+{
+	struct script_backend *sb = priv;
+
+	/* responses of the previous connection are gone with it */
+	script_flush(me, sb);
+	me->buf_size = sb->script.max_msg_len;
+	me->prot_ver = sb->script.protocol_ver;
+	me->state = MEI_CL_STATE_CONNECTED;
+	return 0;
+}
+
+static ssize_t script_read(struct mei *me, void *priv, void *buffer, size_t len)
+{
+	struct script_backend *sb = priv;
+	struct script_msg *msg;
+	uint64_t value;
+	ssize_t rc;
+
+	script_lock(sb);
+	msg = sb->head;
+	if (!msg) {
+		script_unlock(sb);
+		return -EAGAIN;
+	}
+	if (msg->len > len) {
+		script_unlock(sb);
+		return -ENOSPC;
+	}
+	sb->head = msg->next;
+	if (!sb->head)
+		sb->tail = NULL;
+	sb->queued--;
+	script_unlock(sb);
+
+	/* counter is positive while the message was queued */
+	if (read(me->fd, &value, sizeof(value)) < 0) {
+		free(msg);
+		return -errno;
+	}
+	memcpy(buffer, msg->data, msg->len);
+	rc = (ssize_t)msg->len;
+	free(msg);
+	return rc;
+}
+
+static ssize_t script_write(struct mei *me, void *priv, const void *buffer, size_t len)
+{
+	struct script_backend *sb = priv;
+	struct script_msg *msg;
+	uint64_t value = 1;
+	size_t rsp_len = 0;
+	TEESTATUS status;
+
+	if (len > me->buf_size)
+		return -EMSGSIZE;
+	if (__atomic_load_n(&sb->queued, __ATOMIC_RELAXED) >= SCRIPT_QUEUE_MAX)
+		return -EBUSY;
+
+	msg = malloc(sizeof(*msg) + sb->script.max_msg_len);
+	if (!msg)
+		return -ENOMEM;
+	status = sb->script.responder(sb->script.ctx, buffer, len, msg->data, &rsp_len);
+	if (status || !rsp_len || rsp_len > sb->script.max_msg_len) {
+		free(msg);
+		if (status)
+			return metee_status2errno(status);
+		return rsp_len ? -EPROTO : (ssize_t)len;
+	}
+	msg->len = rsp_len;
+	msg->next = NULL;
+
+	script_lock(sb);
+	if (sb->tail)
+		sb->tail->next = msg;
+	else
+		sb->head = msg;
+	sb->tail = msg;
+	sb->queued++;
+	script_unlock(sb);
+
+	if (write(me->fd, &value, sizeof(value)) < 0)
+		return -errno;
+	return (ssize_t)len;
+}
+
+const struct metee_backend_ops metee_backend_script = {
+	.name = "script",
+	.open = script_open,
+	.close = script_close,
+	.connect = script_connect,
+	.wait = metee_backend_poll,
+	.read = script_read,
+	.write = script_write,
+};
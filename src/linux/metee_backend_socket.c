@@ -0,0 +1,101 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+/*
+ * Firmware client emulated by the peer of a connected SOCK_SEQPACKET
+ * socket (e.g. one end of a socketpair), one packet per message.
+ * There is no handshake: the connection properties are fixed.
+ */
+#include <errno.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#include "metee_backend.h"
+
+#define SOCKET_MTU 4096
+
+static int socket_open(struct mei *me, void **priv, const struct metee_backend_params *params)
+{
+	int fd = params->device->data.handle;
+	socklen_t optlen = sizeof(int);
+	int type = 0;
+
+	memset(me, 0, sizeof(*me));
+	me->fd = -1;
+	*priv = NULL;
+	if (getsockopt(fd, SOL_SOCKET, SO_TYPE, &type, &optlen))
+		return -errno;
+	if (type != SOCK_SEQPACKET)
+		return -EINVAL;
+
+	/* the socket is owned by the caller like the device handle */
+	me->fd = fd;
+	me->close_on_exit = false;
+	memcpy(&me->guid, params->guid, sizeof(me->guid));
+	me->state = MEI_CL_STATE_INITIALIZED;
+	return 0;
+}
+
+static void socket_close(struct mei *me, void *priv)
+{
+	(void)priv;
+	mei_deinit(me);
+}
+
+static int socket_connect(struct mei *me, void *priv)
+{
+	(void)priv;
+	me->buf_size = SOCKET_MTU;
+	me->prot_ver = 1;
+	me->state = MEI_CL_STATE_CONNECTED;
+	return 0;
+}
+
+static ssize_t socket_read(struct mei *me, void *priv, void *buffer, size_t len)
+{
+	ssize_t rc;
+
+	(void)priv;
+	/* a message longer than the buffer is lost, like on the device */
+	rc = recv(me->fd, buffer, len, MSG_TRUNC | MSG_DONTWAIT);
+	if (rc < 0)
+		return -errno;
+	if (rc == 0) {
+		me->state = MEI_CL_STATE_DISCONNECTED;
+		return -ENODEV;
+	}
+	if ((size_t)rc > len)
+		return -ENOSPC;
+	return rc;
+}
+
+static ssize_t socket_write(struct mei *me, void *priv, const void *buffer, size_t len)
+{
+	ssize_t rc;
+
+	(void)priv;
+	if (len > me->buf_size)
+		return -EMSGSIZE;
+	rc = send(me->fd, buffer, len, MSG_NOSIGNAL | MSG_DONTWAIT);
+	if (rc < 0) {
+		if (errno == EPIPE || errno == ECONNRESET) {
+			me->state = MEI_CL_STATE_DISCONNECTED;
+			return -ENODEV;
+		}
+		return -errno;
+	}
+	return rc;
+}
+
+const struct metee_backend_ops metee_backend_socket = {
+	.name = "socket",
+	.open = socket_open,
+	.close = socket_close,
+	.connect = socket_connect,
+	.wait = metee_backend_poll,
+	.read = socket_read,
+	.write = socket_write,
+};
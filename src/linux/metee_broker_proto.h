@@ -0,0 +1,315 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+#ifndef __METEE_BROKER_PROTO_H
+#define __METEE_BROKER_PROTO_H
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+/*
+ * Wire protocol between metee library and metee broker.
+ *
+ * The broker listens on AF_UNIX SOCK_SEQPACKET socket, every packet
+ * is one message: struct broker_hdr followed by the payload.
+ * The client sends BROKER_CONNECT with the FW client GUID and receives
+ * the connection properties, then every BROKER_DATA request is forwarded
+ * to the FW client and answered by exactly one BROKER_DATA reply carrying
+ * either the FW response or a failure status.
+ *
+ * After BROKER_CONNECT the client may send BROKER_SHM_ATTACH to move the
+ * data path to shared memory: the reply carries a sealed memfd with two
+ * rings (requests and responses) and three eventfd doorbells: client to
+ * broker, broker to client for responses and broker to client for request
+ * ring space. Each side rings the peer doorbell after producing a record,
+ * and after consuming one if the peer waits for ring space; a client
+ * waiting for a response and one waiting for space never share a doorbell.
+ * The socket stays open for liveness only.
+ */
+
+#define BROKER_PROTO_VERSION 2
+
+/* biggest message accepted by the broker, header excluded */
+#define BROKER_MAX_PAYLOAD (64 * 1024)
+
+enum broker_msg_type {
+	BROKER_CONNECT = 1,
+	BROKER_DATA = 2,
+	BROKER_SHM_ATTACH = 3,
+};
+
+#pragma pack(push, 1)
+struct broker_hdr {
+	uint16_t type;     /* enum broker_msg_type */
+	uint16_t status;   /* TEESTATUS in replies, zero in requests */
+	uint32_t param;    /* BROKER_CONNECT request: protocol version */
+};
+
+struct broker_connect_rsp {
+	uint32_t max_msg_len;
+	uint8_t protocol_ver;
+	uint8_t reserved[3];
+};
+#pragma pack(pop)
+
+/* send header and payload as one packet without joining them */
+static inline ssize_t broker_send(int fd, const struct broker_hdr *hdr,
+				  const void *payload, size_t len)
+{
+	struct iovec iov[2];
+	struct msghdr msg = {0};
+
+	iov[0].iov_base = (void *)hdr;
+	iov[0].iov_len = sizeof(*hdr);
+	iov[1].iov_base = (void *)payload;
+	iov[1].iov_len = len;
+	msg.msg_iov = iov;
+	msg.msg_iovlen = len ? 2 : 1;
+
+	return sendmsg(fd, &msg, MSG_NOSIGNAL);
+}
+
+/* receive packet splitting header and payload, *truncated set if payload did not fit */
+static inline ssize_t broker_recv(int fd, struct broker_hdr *hdr,
+				  void *payload, size_t len, int *truncated)
+{
+	struct iovec iov[2];
+	struct msghdr msg = {0};
+	ssize_t rc;
+
+	iov[0].iov_base = hdr;
+	iov[0].iov_len = sizeof(*hdr);
+	iov[1].iov_base = payload;
+	iov[1].iov_len = len;
+	msg.msg_iov = iov;
+	msg.msg_iovlen = len ? 2 : 1;
+
+	rc = recvmsg(fd, &msg, 0);
+	if (truncated)
+		*truncated = !!(msg.msg_flags & MSG_TRUNC);
+	if (rc > 0 && (size_t)rc < sizeof(*hdr)) {
+		errno = EPROTO;
+		return -1;
+	}
+	return rc;
+}
+
+/* shared memory data path */
+#define BROKER_SHM_RING_SIZE (256 * 1024)
+#define BROKER_SHM_FDS 4 /* memfd, client to broker, response and request space doorbells */
+#define BROKER_SHM_REC_WRAP 0x1
+
+/* indices are free running byte counters, producer and consumer on own cache lines */
+struct broker_shm_ring {
+	uint32_t head;         /* written by producer */
+	uint32_t waiting;      /* producer waits for space */
+	uint8_t reserved0[56];
+	uint32_t tail;         /* written by consumer */
+	uint8_t reserved1[60];
+	uint8_t data[BROKER_SHM_RING_SIZE];
+};
+
+struct broker_shm_rec {
+	uint32_t len;     /* payload length */
+	uint16_t status;  /* TEESTATUS in responses */
+	uint16_t flags;   /* BROKER_SHM_REC_WRAP: skip to ring start */
+};
+
+struct broker_shm_area {
+	struct broker_shm_ring req; /* client to broker */
+	struct broker_shm_ring rsp; /* broker to client */
+};
+
+#define BROKER_SHM_REC_SIZE(len) \
+	(((uint32_t)sizeof(struct broker_shm_rec) + (uint32_t)(len) + 7U) & ~7U)
+
+/* producer: can a record of len bytes be reserved */
+static inline bool broker_ring_fits(struct broker_shm_ring *ring, size_t len)
+{
+	uint32_t head = ring->head;
+	uint32_t used = head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+	uint32_t pos = (head % BROKER_SHM_RING_SIZE) & ~7U;
+	uint32_t need = BROKER_SHM_REC_SIZE(len);
+
+	if (used > BROKER_SHM_RING_SIZE)
+		return false;
+	if (need > BROKER_SHM_RING_SIZE - pos)
+		need += BROKER_SHM_RING_SIZE - pos;
+	return need <= BROKER_SHM_RING_SIZE - used;
+}
+
+/* producer: contiguous payload area for up to len bytes, NULL if ring is full */
+static inline uint8_t *broker_ring_reserve(struct broker_shm_ring *ring, size_t len)
+{
+	struct broker_shm_rec *rec;
+	uint32_t head = ring->head;
+	uint32_t pos = (head % BROKER_SHM_RING_SIZE) & ~7U;
+
+	if (!broker_ring_fits(ring, len))
+		return NULL;
+	if (BROKER_SHM_REC_SIZE(len) > BROKER_SHM_RING_SIZE - pos) {
+		rec = (struct broker_shm_rec *)(ring->data + pos);
+		rec->len = 0;
+		rec->status = 0;
+		rec->flags = BROKER_SHM_REC_WRAP;
+		__atomic_store_n(&ring->head, head + BROKER_SHM_RING_SIZE - pos, __ATOMIC_RELEASE);
+		pos = 0;
+	}
+	return ring->data + pos + sizeof(*rec);
+}
+
+/* producer: publish record reserved with broker_ring_reserve() */
+static inline void broker_ring_commit(struct broker_shm_ring *ring, size_t len, uint16_t status)
+{
+	uint32_t head = ring->head;
+	struct broker_shm_rec *rec =
+		(struct broker_shm_rec *)(ring->data + ((head % BROKER_SHM_RING_SIZE) & ~7U));
+
+	rec->len = (uint32_t)len;
+	rec->status = status;
+	rec->flags = 0;
+	__atomic_store_n(&ring->head, head + BROKER_SHM_REC_SIZE(len), __ATOMIC_RELEASE);
+}
+
+/* producer: announce wait for space, false if space appeared meanwhile */
+static inline bool broker_ring_wait_space(struct broker_shm_ring *ring, size_t len)
+{
+	__atomic_store_n(&ring->waiting, 1, __ATOMIC_SEQ_CST);
+	return !broker_ring_fits(ring, len);
+}
+
+/*
+ * consumer: payload of the oldest record or NULL if ring is empty,
+ * sets *err if the record is malformed or longer than max_len;
+ * the peer may scribble over shared memory, record fields are read once
+ */
+static inline const uint8_t *broker_ring_peek(struct broker_shm_ring *ring, size_t max_len,
+					      uint32_t *len, uint16_t *status, bool *err)
+{
+	struct broker_shm_rec *rec;
+	uint32_t tail = ring->tail;
+	uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+	uint32_t pos;
+
+	*err = false;
+	if (head - tail > BROKER_SHM_RING_SIZE) {
+		*err = true;
+		return NULL;
+	}
+	if (head == tail)
+		return NULL;
+
+	pos = (tail % BROKER_SHM_RING_SIZE) & ~7U;
+	rec = (struct broker_shm_rec *)(ring->data + pos);
+	if (__atomic_load_n(&rec->flags, __ATOMIC_RELAXED) & BROKER_SHM_REC_WRAP) {
+		tail += BROKER_SHM_RING_SIZE - pos;
+		__atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+		if (head == tail)
+			return NULL;
+		rec = (struct broker_shm_rec *)ring->data;
+		pos = 0;
+	}
+	*len = __atomic_load_n(&rec->len, __ATOMIC_RELAXED);
+	*status = __atomic_load_n(&rec->status, __ATOMIC_RELAXED);
+	if (*len > max_len ||
+	    BROKER_SHM_REC_SIZE(*len) > BROKER_SHM_RING_SIZE - pos ||
+	    BROKER_SHM_REC_SIZE(*len) > head - tail) {
+		*err = true;
+		return NULL;
+	}
+	return ring->data + pos + sizeof(*rec);
+}
+
+/* consumer: release record of len bytes returned by broker_ring_peek(), true if producer must be woken */
+static inline bool broker_ring_pop(struct broker_shm_ring *ring, uint32_t len)
+{
+	__atomic_store_n(&ring->tail, ring->tail + BROKER_SHM_REC_SIZE(len), __ATOMIC_SEQ_CST);
+	return __atomic_exchange_n(&ring->waiting, 0, __ATOMIC_SEQ_CST) != 0;
+}
+
+/* send packet with attached descriptors */
+static inline ssize_t broker_send_fds(int fd, const struct broker_hdr *hdr,
+				      const int *fds, size_t nfds)
+{
+	union {
+		struct cmsghdr align;
+		char buf[CMSG_SPACE(sizeof(int) * BROKER_SHM_FDS)];
+	} ctrl;
+	struct iovec iov;
+	struct msghdr msg = {0};
+	struct cmsghdr *cmsg;
+
+	if (nfds > BROKER_SHM_FDS) {
+		errno = EINVAL;
+		return -1;
+	}
+	iov.iov_base = (void *)hdr;
+	iov.iov_len = sizeof(*hdr);
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	memset(&ctrl, 0, sizeof(ctrl));
+	msg.msg_control = ctrl.buf;
+	msg.msg_controllen = CMSG_SPACE(sizeof(int) * nfds);
+	cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(int) * nfds);
+	memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * nfds);
+
+	return sendmsg(fd, &msg, MSG_NOSIGNAL);
+}
+
+/* receive packet with attached descriptors, *nfds updated to the number received */
+static inline ssize_t broker_recv_fds(int fd, struct broker_hdr *hdr, int *fds, size_t *nfds)
+{
+	union {
+		struct cmsghdr align;
+		char buf[CMSG_SPACE(sizeof(int) * BROKER_SHM_FDS)];
+	} ctrl;
+	struct iovec iov;
+	struct msghdr msg = {0};
+	struct cmsghdr *cmsg;
+	size_t max = *nfds;
+	ssize_t rc;
+
+	iov.iov_base = hdr;
+	iov.iov_len = sizeof(*hdr);
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = ctrl.buf;
+	msg.msg_controllen = sizeof(ctrl.buf);
+
+	*nfds = 0;
+	rc = recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+	if (rc <= 0)
+		return rc;
+	for (cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+		size_t n, i;
+
+		if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+			continue;
+		n = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+		for (i = 0; i < n; i++) {
+			int rfd;
+
+			memcpy(&rfd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+			if (*nfds < max)
+				fds[(*nfds)++] = rfd;
+			else
+				close(rfd);
+		}
+	}
+	if ((size_t)rc < sizeof(*hdr) || (msg.msg_flags & MSG_CTRUNC)) {
+		errno = EPROTO;
+		return -1;
+	}
+	return rc;
+}
+
+#endif /* __METEE_BROKER_PROTO_H */
@@ -0,0 +1,361 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "metee.h"
+#include "metee_backend.h"
+#include "metee_capture.h"
+
+#define CAPTURE_CHUNK (1024 * 1024)
+
+struct metee_capture {
+	int fd;
+	uint8_t *map;
+	size_t size; /* mapped and file size */
+	struct metee_capture_hdr *hdr;
+};
+
+struct metee_replay {
+	int fd;
+	const uint8_t *map;
+	size_t size; /* mapped size */
+	uint64_t end; /* end of the last complete record */
+	uint64_t pos; /* next record */
+	uint32_t speed; /* 0 no delays, 1 original timing, N times faster */
+	uint64_t ref_rec_ns; /* timestamp of the last consumed record */
+	uint64_t ref_ns; /* replay time of the last consumed record */
+	uint64_t ready_ns; /* replay time of the response the last wait waited for */
+};
+
+static inline uint64_t capture_now(clockid_t clock)
+{
+	struct timespec ts;
+
+	clock_gettime(clock, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+static inline size_t capture_align(size_t len)
+{
+	return (len + 7) & ~(size_t)7;
+}
+
+TEESTATUS metee_capture_open(const char *path, struct metee_capture **cap)
+{
+	struct metee_capture *c;
+	TEESTATUS status;
+
+	c = calloc(1, sizeof(*c));
+	if (!c)
+		return TEE_INTERNAL_ERROR;
+
+	c->fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+	if (c->fd < 0) {
+		status = (errno == EACCES) ? TEE_PERMISSION_DENIED : TEE_INVALID_PARAMETER;
+		free(c);
+		return status;
+	}
+	c->size = CAPTURE_CHUNK;
+	if (ftruncate(c->fd, (off_t)c->size)) {
+		status = TEE_INTERNAL_ERROR;
+		goto err;
+	}
+	c->map = mmap(NULL, c->size, PROT_READ | PROT_WRITE, MAP_SHARED, c->fd, 0);
+	if (c->map == MAP_FAILED) {
+		status = TEE_INTERNAL_ERROR;
+		goto err;
+	}
+
+	c->hdr = (struct metee_capture_hdr *)c->map;
+	memcpy(c->hdr->magic, METEE_CAPTURE_MAGIC, sizeof(c->hdr->magic));
+	c->hdr->version = METEE_CAPTURE_VERSION;
+	c->hdr->hdr_size = (uint32_t)capture_align(sizeof(*c->hdr));
+	c->hdr->start_realtime_ns = capture_now(CLOCK_REALTIME);
+	__atomic_store_n(&c->hdr->end, c->hdr->hdr_size, __ATOMIC_RELEASE);
+	*cap = c;
+	return TEE_SUCCESS;
+
+err:
+	close(c->fd);
+	unlink(path);
+	free(c);
+	return status;
+}
+
+void metee_capture_close(struct metee_capture *cap)
+{
+	uint64_t end;
+
+	if (!cap)
+		return;
+	end = cap->hdr->end;
+	munmap(cap->map, cap->size);
+	/* drop the preallocated tail; if that fails readers still stop at header end */
+	if (ftruncate(cap->fd, (off_t)end) == 0)
+		fsync(cap->fd);
+	close(cap->fd);
+	free(cap);
+}
+
+static TEESTATUS capture_grow(struct metee_capture *cap, size_t need)
+{
+	size_t size = cap->size;
+	void *map;
+
+	while (size < need)
+		size *= 2;
+	if (ftruncate(cap->fd, (off_t)size))
+		return TEE_INTERNAL_ERROR;
+	map = mremap(cap->map, cap->size, size, MREMAP_MAYMOVE);
+	if (map == MAP_FAILED)
+		return TEE_INTERNAL_ERROR;
+	cap->map = map;
+	cap->size = size;
+	cap->hdr = (struct metee_capture_hdr *)cap->map;
+	return TEE_SUCCESS;
+}
+
+/* caller serializes appends to one capture */
+TEESTATUS metee_capture_append(struct metee_capture *cap, enum metee_capture_type type,
+			       const void *guid, uint8_t vtag,
+			       const void *payload, size_t len)
+{
+	size_t rec_len = capture_align(sizeof(struct metee_capture_rec) + len);
+	struct metee_capture_rec *rec;
+	uint64_t end = cap->hdr->end;
+	TEESTATUS status;
+
+	if (len > UINT32_MAX / 2)
+		return TEE_INVALID_PARAMETER;
+	if (end + rec_len > cap->size) {
+		status = capture_grow(cap, end + rec_len);
+		if (status)
+			return status;
+	}
+
+	rec = (struct metee_capture_rec *)(cap->map + end);
+	memset(rec, 0, sizeof(*rec));
+	rec->len = (uint32_t)rec_len;
+	rec->type = (uint8_t)type;
+	rec->vtag = vtag;
+	rec->timestamp_ns = capture_now(CLOCK_MONOTONIC);
+	memcpy(rec->guid, guid, sizeof(rec->guid));
+	rec->payload_len = (uint32_t)len;
+	if (len)
+		memcpy(rec->payload, payload, len);
+	__atomic_store_n(&cap->hdr->end, end + rec_len, __ATOMIC_RELEASE);
+	return TEE_SUCCESS;
+}
+
+static int replay_open(struct mei *me, void **priv, const struct metee_backend_params *params)
+{
+	const struct metee_capture_hdr *hdr;
+	struct metee_replay *r;
+	struct stat st;
+	int rc;
+
+	memset(me, 0, sizeof(*me));
+	me->fd = -1;
+	r = calloc(1, sizeof(*r));
+	if (!r)
+		return -ENOMEM;
+
+	r->fd = open(params->device->data.path, O_RDONLY | O_CLOEXEC);
+	if (r->fd < 0) {
+		rc = -errno;
+		free(r);
+		return rc;
+	}
+	if (fstat(r->fd, &st) || (size_t)st.st_size < sizeof(*hdr)) {
+		rc = -EINVAL;
+		goto err;
+	}
+	r->size = (size_t)st.st_size;
+	r->map = mmap(NULL, r->size, PROT_READ, MAP_PRIVATE, r->fd, 0);
+	if (r->map == MAP_FAILED) {
+		rc = -errno;
+		goto err;
+	}
+
+	hdr = (const struct metee_capture_hdr *)r->map;
+	if (memcmp(hdr->magic, METEE_CAPTURE_MAGIC, sizeof(hdr->magic)) ||
+	    hdr->version != METEE_CAPTURE_VERSION ||
+	    hdr->hdr_size < sizeof(*hdr) || hdr->hdr_size > r->size) {
+		munmap((void *)r->map, r->size);
+		rc = -EINVAL;
+		goto err;
+	}
+	r->end = (hdr->end < r->size) ? hdr->end : r->size;
+	r->pos = hdr->hdr_size;
+	r->speed = 1;
+
+	/* the file descriptor is owned by the replay */
+	me->fd = r->fd;
+	me->close_on_exit = false;
+	memcpy(&me->guid, params->guid, sizeof(me->guid));
+	me->state = MEI_CL_STATE_INITIALIZED;
+	*priv = r;
+	return 0;
+
+err:
+	close(r->fd);
+	free(r);
+	return rc;
+}
+
+static void replay_close(struct mei *me, void *priv)
+{
+	struct metee_replay *replay = priv;
+
+	mei_deinit(me);
+	munmap((void *)replay->map, replay->size);
+	close(replay->fd);
+	free(replay);
+}
+
+void metee_replay_set_speed(struct metee_replay *replay, uint32_t speed)
+{
+	replay->speed = speed;
+}
+
+/* record at pos, NULL at the end or on a damaged record */
+static const struct metee_capture_rec *replay_peek(const struct metee_replay *replay)
+{
+	const struct metee_capture_rec *rec;
+
+	if (replay->pos + sizeof(*rec) > replay->end)
+		return NULL;
+	rec = (const struct metee_capture_rec *)(replay->map + replay->pos);
+	if (rec->len < sizeof(*rec) || rec->len > replay->end - replay->pos ||
+	    rec->payload_len > rec->len - sizeof(*rec))
+		return NULL;
+	return rec;
+}
+
+static void replay_consume(struct metee_replay *replay, const struct metee_capture_rec *rec,
+			   uint64_t now)
+{
+	replay->ref_rec_ns = rec->timestamp_ns;
+	replay->ref_ns = now;
+	replay->pos += rec->len;
+}
+
+static int replay_connect(struct mei *me, void *priv)
+{
+	struct metee_replay *replay = priv;
+	const struct metee_capture_rec *rec;
+	struct metee_capture_connect conn;
+
+	/* messages of the previous connection that the application did not replay are dropped */
+	while ((rec = replay_peek(replay)) != NULL && rec->type != METEE_CAPTURE_CONNECT)
+		replay->pos += rec->len;
+	if (!rec)
+		return -ENODEV;
+	if (memcmp(rec->guid, &me->guid, sizeof(rec->guid)))
+		return -ENOTTY;
+	if (rec->payload_len < sizeof(conn))
+		return -EPROTO;
+
+	memcpy(&conn, rec->payload, sizeof(conn));
+	me->buf_size = conn.max_msg_len;
+	me->prot_ver = conn.protocol_ver;
+	me->state = MEI_CL_STATE_CONNECTED;
+	replay_consume(replay, rec, capture_now(CLOCK_MONOTONIC));
+	return 0;
+}
+
+/* the next response is due at its captured offset from the previous record, scaled by speed */
+static int replay_wait(struct mei *me, void *priv, const int *cancel_fds, bool on_read, size_t len, int timeout)
+{
+	struct metee_replay *replay = priv;
+	const struct metee_capture_rec *rec = replay_peek(replay);
+	uint64_t now = capture_now(CLOCK_MONOTONIC);
+	uint64_t due = now;
+	int64_t wait_ms;
+	int rc;
+
+	(void)len;
+	if (!on_read)
+		return 0;
+	if (!rec || rec->type == METEE_CAPTURE_CONNECT) {
+		me->state = MEI_CL_STATE_DISCONNECTED;
+		return -ENODEV;
+	}
+
+	if (rec->type != METEE_CAPTURE_READ) {
+		/* nothing to receive before the next write */
+		rc = metee_backend_sleep(cancel_fds, timeout);
+		return rc ? rc : -ETIME;
+	}
+
+	if (replay->speed && rec->timestamp_ns > replay->ref_rec_ns)
+		due = replay->ref_ns + (rec->timestamp_ns - replay->ref_rec_ns) / replay->speed;
+	if (due > now) {
+		wait_ms = (int64_t)((due - now + 999999) / 1000000);
+		if (timeout >= 0 && wait_ms > timeout) {
+			rc = metee_backend_sleep(cancel_fds, timeout);
+			return rc ? rc : -ETIME;
+		}
+		rc = metee_backend_sleep(cancel_fds, (int)wait_ms);
+		if (rc)
+			return rc;
+	}
+	/* the due time, not the wake up, is the base of the next delay: no drift */
+	replay->ready_ns = (due > now) ? due : now;
+	return 0;
+}
+
+static ssize_t replay_read(struct mei *me, void *priv, void *buffer, size_t len)
+{
+	struct metee_replay *replay = priv;
+	const struct metee_capture_rec *rec = replay_peek(replay);
+
+	(void)me;
+	if (!rec || rec->type != METEE_CAPTURE_READ)
+		return -EAGAIN;
+	if (rec->payload_len > len)
+		return -ENOSPC;
+	memcpy(buffer, rec->payload, rec->payload_len);
+	replay_consume(replay, rec, replay->ready_ns);
+	return (ssize_t)rec->payload_len;
+}
+
+static ssize_t replay_write(struct mei *me, void *priv, const void *buffer, size_t len)
+{
+	struct metee_replay *replay = priv;
+	const struct metee_capture_rec *rec;
+
+	/* responses the application did not read are dropped */
+	while ((rec = replay_peek(replay)) != NULL && rec->type == METEE_CAPTURE_READ)
+		replay->pos += rec->len;
+	if (!rec || rec->type != METEE_CAPTURE_WRITE) {
+		me->state = MEI_CL_STATE_DISCONNECTED;
+		return -ENODEV;
+	}
+
+	/* requests often carry nonces or time stamps, a different payload is replayed anyway */
+	(void)buffer;
+	replay_consume(replay, rec, capture_now(CLOCK_MONOTONIC));
+	return (ssize_t)len;
+}
+
+const struct metee_backend_ops metee_backend_replay = {
+	.name = "replay",
+	.open = replay_open,
+	.close = replay_close,
+	.connect = replay_connect,
+	.wait = replay_wait,
+	.read = replay_read,
+	.write = replay_write,
+};
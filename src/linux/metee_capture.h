@@ -0,0 +1,66 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+#ifndef __METEE_CAPTURE_H
+#define __METEE_CAPTURE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "metee.h"
+
+/*
+ * Capture file: header followed by records, all little endian as written
+ * by the host. The header end field is updated after every appended
+ * record, a reader never sees a partially written record even while the
+ * capture runs or after a crash.
+ */
+#define METEE_CAPTURE_MAGIC "METEECAP"
+#define METEE_CAPTURE_VERSION 1
+
+struct metee_capture_hdr {
+	char magic[8];
+	uint32_t version;
+	uint32_t hdr_size; /* offset of the first record */
+	uint64_t end; /* offset after the last complete record */
+	uint64_t start_realtime_ns; /* wall clock at capture start, informational */
+};
+
+enum metee_capture_type {
+	METEE_CAPTURE_CONNECT = 1, /* payload: struct metee_capture_connect */
+	METEE_CAPTURE_WRITE = 2, /* host to firmware message */
+	METEE_CAPTURE_READ = 3, /* firmware to host message */
+};
+
+struct metee_capture_rec {
+	uint32_t len; /* whole record, 8 bytes aligned */
+	uint8_t type; /* enum metee_capture_type */
+	uint8_t vtag;
+	uint16_t reserved;
+	uint64_t timestamp_ns; /* CLOCK_MONOTONIC */
+	uint8_t guid[16]; /* firmware client */
+	uint32_t payload_len;
+	uint32_t reserved2;
+	uint8_t payload[];
+};
+
+struct metee_capture_connect {
+	uint32_t max_msg_len;
+	uint8_t protocol_ver;
+	uint8_t reserved[3];
+};
+
+struct metee_capture;
+struct metee_replay;
+
+TEESTATUS metee_capture_open(const char *path, struct metee_capture **cap);
+void metee_capture_close(struct metee_capture *cap);
+TEESTATUS metee_capture_append(struct metee_capture *cap, enum metee_capture_type type,
+			       const void *guid, uint8_t vtag,
+			       const void *payload, size_t len);
+
+/* replay is the private data of metee_backend_replay */
+void metee_replay_set_speed(struct metee_replay *replay, uint32_t speed);
+
+#endif /* __METEE_CAPTURE_H */
@@ -0,0 +1,388 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+/*
+ * Fault and latency injection between the library and the transport
+ * backend of a handle. Every operation is matched against the rules, the
+ * first rule firing decides the fault; everything else is passed to the
+ * wrapped backend. An injected disconnect keeps the wrapped connection,
+ * TeeConnect restores it and drops the responses not read, like a FW
+ * reset does.
+ */
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "metee_fault.h"
+#include "metee_stats.h"
+
+#define FAULT_NONE TEE_FAULT_KIND_MAX
+#define FAULT_PPM 1000000U
+
+struct fault_rule {
+	struct tee_fault_rule cfg;
+	uint64_t seen; /* operations the rule applies to */
+	uint64_t injected;
+};
+
+struct metee_fault {
+	const struct metee_backend_ops *ops; /* wrapped backend */
+	void *priv;
+	pthread_mutex_t lock; /* protects rules and random state */
+	uint64_t rng;
+	size_t rules_num;
+	struct fault_rule rules[TEE_FAULT_RULES_MAX];
+	bool detached; /* injected disconnect, the wrapped connection is kept */
+	uint32_t read_fault; /* fault of the read in progress, applied on the data */
+	uint32_t truncate_len;
+	uint64_t write_begin; /* wait start of the write in progress */
+	uint64_t transact_start; /* start of the last write not followed by read yet */
+	uint64_t failing_since; /* first fault not followed by successful read yet */
+	struct tee_fault_stats stats;
+};
+
+static inline uint64_t fault_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+static inline void fault_add(uint64_t *counter, uint64_t value)
+{
+	__atomic_fetch_add(counter, value, __ATOMIC_RELAXED);
+}
+
+/* xorshift64*, called locked */
+static uint64_t fault_random(struct metee_fault *fault)
+{
+	fault->rng ^= fault->rng >> 12;
+	fault->rng ^= fault->rng << 25;
+	fault->rng ^= fault->rng >> 27;
+	return fault->rng * 0x2545F4914F6CDD1DULL;
+}
+
+/* fault for the operation, FAULT_NONE if no rule fires */
+static uint32_t fault_pick(struct metee_fault *fault, uint32_t op, struct tee_fault_rule *rule)
+{
+	uint32_t kind = FAULT_NONE;
+	size_t i;
+
+	fault_add(&fault->stats.operations, 1);
+	pthread_mutex_lock(&fault->lock);
+	for (i = 0; i < fault->rules_num; i++) {
+		struct fault_rule *r = &fault->rules[i];
+		bool fire;
+
+		if (!(r->cfg.ops & op))
+			continue;
+		r->seen++;
+		if (kind != FAULT_NONE || r->seen <= r->cfg.skip ||
+		    (r->cfg.limit && r->injected >= r->cfg.limit))
+			continue;
+		if (r->cfg.period)
+			fire = (r->seen - r->cfg.skip) % r->cfg.period == 0;
+		else
+			fire = fault_random(fault) % FAULT_PPM < r->cfg.probability;
+		if (!fire)
+			continue;
+		r->injected++;
+		kind = r->cfg.kind;
+		*rule = r->cfg;
+	}
+	pthread_mutex_unlock(&fault->lock);
+
+	if (kind != FAULT_NONE) {
+		uint64_t expected = 0;
+
+		fault_add(&fault->stats.injected[kind], 1);
+		__atomic_compare_exchange_n(&fault->failing_since, &expected, fault_now(), false,
+					    __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+	}
+	return kind;
+}
+
+/* no cancel for waits outside of read and write */
+static const int fault_no_cancel[METEE_CANCEL_FDS] = {-1, -1};
+
+/* read and drop up to max responses already available */
+static void fault_drop(struct mei *me, struct metee_fault *fault, unsigned int max)
+{
+	void *scratch = malloc(me->buf_size ? me->buf_size : 1);
+	unsigned int i;
+
+	if (!scratch)
+		return;
+	for (i = 0; i < max; i++) {
+		if (fault->ops->wait(me, fault->priv, fault_no_cancel, true, 0, 0) ||
+		    fault->ops->read(me, fault->priv, scratch, me->buf_size) < 0)
+			break;
+	}
+	free(scratch);
+}
+
+/* the wrapped connection is back, responses of the old session are lost */
+static void fault_reattach(struct mei *me, struct metee_fault *fault)
+{
+	me->state = MEI_CL_STATE_CONNECTED;
+	fault->detached = false;
+	fault_drop(me, fault, (unsigned int)-1);
+}
+
+TEESTATUS metee_fault_create(const struct tee_fault_config *config,
+			     const struct metee_backend_ops *ops, void *priv,
+			     struct metee_fault **fault)
+{
+	struct metee_fault *f;
+	size_t i;
+
+	if (!config || config->rules_num > TEE_FAULT_RULES_MAX ||
+	    (config->rules_num && !config->rules))
+		return TEE_INVALID_PARAMETER;
+	for (i = 0; i < config->rules_num; i++) {
+		if (config->rules[i].kind >= TEE_FAULT_KIND_MAX ||
+		    config->rules[i].probability > FAULT_PPM)
+			return TEE_INVALID_PARAMETER;
+	}
+
+	f = calloc(1, sizeof(*f));
+	if (!f)
+		return TEE_INTERNAL_ERROR;
+	pthread_mutex_init(&f->lock, NULL);
+	f->ops = ops;
+	f->priv = priv;
+	f->rng = config->seed ? config->seed : 0x9E3779B97F4A7C15ULL;
+	f->rules_num = config->rules_num;
+	for (i = 0; i < config->rules_num; i++)
+		f->rules[i].cfg = config->rules[i];
+	f->read_fault = FAULT_NONE;
+	*fault = f;
+	return TEE_SUCCESS;
+}
+
+void metee_fault_destroy(struct metee_fault *fault, struct mei *me,
+			 const struct metee_backend_ops **ops, void **priv)
+{
+	if (fault->detached)
+		fault_reattach(me, fault);
+	*ops = fault->ops;
+	*priv = fault->priv;
+	pthread_mutex_destroy(&fault->lock);
+	free(fault);
+}
+
+const struct metee_backend_ops *metee_fault_inner(struct metee_fault *fault, void **priv)
+{
+	*priv = fault->priv;
+	return fault->ops;
+}
+
+void metee_fault_get_stats(struct metee_fault *fault, struct tee_fault_stats *stats)
+{
+	const uint64_t *src = (const uint64_t *)&fault->stats;
+	uint64_t *dst = (uint64_t *)stats;
+	size_t i;
+
+	for (i = 0; i < sizeof(*stats) / sizeof(uint64_t); i++)
+		dst[i] = __atomic_load_n(&src[i], __ATOMIC_RELAXED);
+}
+
+/* installed on an initialized handle by TeeFaultStart only */
+static int fault_open(struct mei *me, void **priv, const struct metee_backend_params *params)
+{
+	(void)me;
+	(void)priv;
+	(void)params;
+	return -EOPNOTSUPP;
+}
+
+static void fault_close(struct mei *me, void *priv)
+{
+	struct metee_fault *fault = priv;
+
+	fault->ops->close(me, fault->priv);
+	pthread_mutex_destroy(&fault->lock);
+	free(fault);
+}
+
+static int fault_connect(struct mei *me, void *priv)
+{
+	struct metee_fault *fault = priv;
+	struct tee_fault_rule rule;
+	int rc;
+
+	switch (fault_pick(fault, TEE_FAULT_OP_CONNECT, &rule)) {
+	case TEE_FAULT_DELAY:
+		rc = metee_backend_sleep(fault_no_cancel, (int)rule.delay_ms);
+		if (rc)
+			return rc;
+		break;
+	case TEE_FAULT_TIMEOUT:
+		metee_backend_sleep(fault_no_cancel, (int)rule.delay_ms);
+		return -ETIME;
+	case TEE_FAULT_BUSY:
+		return -EBUSY;
+	case TEE_FAULT_DISCONNECT:
+		return -ENODEV;
+	default:
+		break;
+	}
+
+	if (fault->detached) {
+		fault_reattach(me, fault);
+		return 0;
+	}
+	return fault->ops->connect(me, fault->priv);
+}
+
+static int fault_wait(struct mei *me, void *priv, const int *cancel_fds, bool on_read, size_t len, int timeout)
+{
+	struct metee_fault *fault = priv;
+	struct tee_fault_rule rule;
+	int rc;
+
+	if (on_read)
+		fault->read_fault = FAULT_NONE;
+	else
+		fault->write_begin = fault_now();
+
+	switch (fault_pick(fault, on_read ? TEE_FAULT_OP_READ : TEE_FAULT_OP_WRITE, &rule)) {
+	case TEE_FAULT_DELAY:
+		if (timeout >= 0 && rule.delay_ms >= (uint32_t)timeout) {
+			rc = metee_backend_sleep(cancel_fds, timeout);
+			return rc ? rc : -ETIME;
+		}
+		rc = metee_backend_sleep(cancel_fds, (int)rule.delay_ms);
+		if (rc)
+			return rc;
+		if (timeout >= 0)
+			timeout -= (int)rule.delay_ms;
+		break;
+	case TEE_FAULT_TIMEOUT:
+		if (rule.delay_ms && (timeout < 0 || rule.delay_ms < (uint32_t)timeout))
+			timeout = (int)rule.delay_ms;
+		rc = metee_backend_sleep(cancel_fds, timeout);
+		if (rc)
+			return rc;
+		if (on_read)
+			fault_drop(me, fault, 1);
+		return -ETIME;
+	case TEE_FAULT_BUSY:
+		return -EBUSY;
+	case TEE_FAULT_DISCONNECT:
+		me->state = MEI_CL_STATE_DISCONNECTED;
+		fault->detached = true;
+		return -ENODEV;
+	case TEE_FAULT_TRUNCATE:
+		if (on_read) {
+			fault->read_fault = TEE_FAULT_TRUNCATE;
+			fault->truncate_len = rule.truncate_len;
+		}
+		break;
+	default:
+		break;
+	}
+	return fault->ops->wait(me, fault->priv, cancel_fds, on_read, len, timeout);
+}
+
+static ssize_t fault_read(struct mei *me, void *priv, void *buffer, size_t len)
+{
+	struct metee_fault *fault = priv;
+	uint64_t start, now;
+	ssize_t rc;
+
+	rc = fault->ops->read(me, fault->priv, buffer, len);
+	if (rc < 0)
+		return rc;
+	if (fault->read_fault == TEE_FAULT_TRUNCATE) {
+		fault->read_fault = FAULT_NONE;
+		return ((size_t)rc > fault->truncate_len) ? (ssize_t)fault->truncate_len : rc;
+	}
+
+	now = fault_now();
+	start = __atomic_exchange_n(&fault->transact_start, 0, __ATOMIC_RELAXED);
+	if (start)
+		metee_hist_add(&fault->stats.transact, start, now);
+	start = __atomic_exchange_n(&fault->failing_since, 0, __ATOMIC_RELAXED);
+	if (start) {
+		fault_add(&fault->stats.recoveries, 1);
+		metee_hist_add(&fault->stats.recovery, start, now);
+	}
+	return rc;
+}
+
+static ssize_t fault_write(struct mei *me, void *priv, const void *buffer, size_t len)
+{
+	struct metee_fault *fault = priv;
+	ssize_t rc;
+
+	rc = fault->ops->write(me, fault->priv, buffer, len);
+	if (rc >= 0)
+		__atomic_store_n(&fault->transact_start, fault->write_begin, __ATOMIC_RELAXED);
+	return rc;
+}
+
+static void fault_cancel(struct mei *me, void *priv)
+{
+	struct metee_fault *fault = priv;
+
+	if (fault->ops->cancel)
+		fault->ops->cancel(me, fault->priv);
+}
+
+static int fault_fwstatus(struct mei *me, void *priv, uint32_t fwsts_num, uint32_t *fwsts)
+{
+	struct metee_fault *fault = priv;
+
+	if (!fault->ops->fwstatus)
+		return -EOPNOTSUPP;
+	return fault->ops->fwstatus(me, fault->priv, fwsts_num, fwsts);
+}
+
+static int fault_trc(struct mei *me, void *priv, uint32_t *trc_val)
+{
+	struct metee_fault *fault = priv;
+
+	if (!fault->ops->trc)
+		return -EOPNOTSUPP;
+	return fault->ops->trc(me, fault->priv, trc_val);
+}
+
+static int fault_kind(struct mei *me, void *priv, char *kind, size_t *kind_size)
+{
+	struct metee_fault *fault = priv;
+
+	if (!fault->ops->kind)
+		return -EOPNOTSUPP;
+	return fault->ops->kind(me, fault->priv, kind, kind_size);
+}
+
+static int fault_reopen(struct mei *me, void *priv)
+{
+	struct metee_fault *fault = priv;
+
+	if (!fault->ops->reopen)
+		return 0;
+	return fault->ops->reopen(me, fault->priv);
+}
+
+const struct metee_backend_ops metee_backend_fault = {
+	.name = "fault",
+	.open = fault_open,
+	.close = fault_close,
+	.connect = fault_connect,
+	.wait = fault_wait,
+	.read = fault_read,
+	.write = fault_write,
+	.cancel = fault_cancel,
+	.fwstatus = fault_fwstatus,
+	.trc = fault_trc,
+	.kind = fault_kind,
+	.reopen = fault_reopen,
+};
@@ -0,0 +1,27 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+#ifndef __METEE_FAULT_H
+#define __METEE_FAULT_H
+
+#include "metee.h"
+#include "metee_backend.h"
+
+/*
+ * Fault injector: metee_backend_fault wraps the backend of a handle, its
+ * private data is struct metee_fault holding the wrapped backend.
+ */
+struct metee_fault;
+
+TEESTATUS metee_fault_create(const struct tee_fault_config *config,
+			     const struct metee_backend_ops *ops, void *priv,
+			     struct metee_fault **fault);
+/* free the injector, returns the wrapped backend with the connection restored */
+void metee_fault_destroy(struct metee_fault *fault, struct mei *me,
+			 const struct metee_backend_ops **ops, void **priv);
+/* wrapped backend */
+const struct metee_backend_ops *metee_fault_inner(struct metee_fault *fault, void **priv);
+void metee_fault_get_stats(struct metee_fault *fault, struct tee_fault_stats *stats);
+
+#endif /* __METEE_FAULT_H */
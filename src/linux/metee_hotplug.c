@@ -0,0 +1,481 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+#include <dirent.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/netlink.h>
+
+#include "metee.h"
+#include "metee_hotplug.h"
+
+#define HOTPLUG_DEVICES_MAX 64
+#define HOTPLUG_MSG_LEN 8192
+#define HOTPLUG_SYSFS "/sys/class/mei"
+
+struct hotplug_device {
+	char name[METEE_HOTPLUG_NAME_LEN];
+	bool present;
+	uint32_t gen;
+};
+
+/* everything below is protected by hotplug_lock */
+static pthread_mutex_t hotplug_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t hotplug_cond; /* device added or monitor stopped */
+static pthread_once_t hotplug_once = PTHREAD_ONCE_INIT;
+static struct metee_hotplug_watch *hotplug_watches;
+static struct hotplug_device hotplug_devices[HOTPLUG_DEVICES_MAX];
+static size_t hotplug_devices_num;
+static bool hotplug_running;
+static bool hotplug_busy; /* start and stop in progress */
+static pthread_t hotplug_thread;
+static int hotplug_source = -1;
+static bool hotplug_own_source; /* netlink socket opened by start */
+static int hotplug_stop_fd = -1;
+
+static void hotplug_init(void)
+{
+	pthread_condattr_t attr;
+
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&hotplug_cond, &attr);
+	pthread_condattr_destroy(&attr);
+}
+
+static struct hotplug_device *hotplug_find(const char *name)
+{
+	size_t i;
+
+	for (i = 0; i < hotplug_devices_num; i++) {
+		if (!strcmp(hotplug_devices[i].name, name))
+			return &hotplug_devices[i];
+	}
+	return NULL;
+}
+
+static struct hotplug_device *hotplug_get(const char *name)
+{
+	struct hotplug_device *dev = hotplug_find(name);
+
+	if (dev || hotplug_devices_num == HOTPLUG_DEVICES_MAX)
+		return dev;
+	dev = &hotplug_devices[hotplug_devices_num++];
+	strncpy(dev->name, name, sizeof(dev->name) - 1);
+	dev->name[sizeof(dev->name) - 1] = '\0';
+	dev->present = false;
+	dev->gen = 0;
+	return dev;
+}
+
+/* called with the lock held; a device never seen keeps the watch usable */
+static bool hotplug_watch_stale(const struct metee_hotplug_watch *w)
+{
+	const struct hotplug_device *dev;
+
+	if (!hotplug_running || !w->name[0])
+		return false;
+	dev = hotplug_find(w->name);
+	return dev && (!dev->present || dev->gen != w->gen);
+}
+
+/* devices present at start have generation zero */
+static void hotplug_scan(void)
+{
+	struct hotplug_device *dev;
+	struct dirent *ent;
+	DIR *dir;
+
+	dir = opendir(HOTPLUG_SYSFS);
+	if (!dir)
+		return;
+	while ((ent = readdir(dir)) != NULL) {
+		if (strncmp(ent->d_name, "mei", 3) || strlen(ent->d_name) >= METEE_HOTPLUG_NAME_LEN)
+			continue;
+		dev = hotplug_get(ent->d_name);
+		if (dev)
+			dev->present = true;
+	}
+	closedir(dir);
+}
+
+static const char *hotplug_basename(const char *path)
+{
+	const char *slash = strrchr(path, '/');
+
+	return slash ? slash + 1 : path;
+}
+
+/* "ACTION@DEVPATH\0KEY=VALUE\0..." as sent by the kernel */
+static void hotplug_event(const char *msg, size_t len)
+{
+	const char *action = NULL;
+	const char *subsystem = NULL;
+	const char *devname = NULL;
+	const char *devpath = NULL;
+	struct metee_hotplug_watch *w;
+	struct hotplug_device *dev;
+	const char *name;
+	bool add;
+	size_t off;
+
+	for (off = strnlen(msg, len) + 1; off < len; off += strnlen(msg + off, len - off) + 1) {
+		const char *kv = msg + off;
+
+		if (!strncmp(kv, "ACTION=", 7))
+			action = kv + 7;
+		else if (!strncmp(kv, "SUBSYSTEM=", 10))
+			subsystem = kv + 10;
+		else if (!strncmp(kv, "DEVNAME=", 8))
+			devname = kv + 8;
+		else if (!strncmp(kv, "DEVPATH=", 8))
+			devpath = kv + 8;
+	}
+	if (!action || !subsystem || strcmp(subsystem, "mei"))
+		return;
+	if (!strcmp(action, "add"))
+		add = true;
+	else if (!strcmp(action, "remove"))
+		add = false;
+	else
+		return;
+	if (devname)
+		name = hotplug_basename(devname);
+	else if (devpath)
+		name = hotplug_basename(devpath);
+	else
+		return;
+	if (!name[0] || strlen(name) >= METEE_HOTPLUG_NAME_LEN)
+		return;
+
+	pthread_mutex_lock(&hotplug_lock);
+	dev = hotplug_get(name);
+	if (dev) {
+		dev->present = add;
+		dev->gen++;
+		for (w = hotplug_watches; w; w = w->next) {
+			if (strcmp(w->name, name) || w->stale)
+				continue;
+			__atomic_store_n(&w->stale, true, __ATOMIC_RELEASE);
+			if (w->notify)
+				w->notify(w->ctx);
+		}
+		if (add)
+			pthread_cond_broadcast(&hotplug_cond);
+	}
+	pthread_mutex_unlock(&hotplug_lock);
+}
+
+static void *hotplug_run(void *arg)
+{
+	struct pollfd fds[2];
+	struct sockaddr_nl sa;
+	struct iovec iov;
+	struct msghdr mh;
+	char *msg;
+	ssize_t len;
+
+	(void)arg;
+	msg = malloc(HOTPLUG_MSG_LEN + 1);
+	if (!msg)
+		return NULL;
+	fds[0].fd = hotplug_stop_fd;
+	fds[0].events = POLLIN;
+	fds[1].fd = hotplug_source;
+	fds[1].events = POLLIN;
+	for (;;) {
+		if (poll(fds, 2, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+		if (fds[0].revents)
+			break;
+		if (fds[1].revents & (POLLERR | POLLHUP | POLLNVAL))
+			break;
+		if (!(fds[1].revents & POLLIN))
+			continue;
+
+		memset(&sa, 0, sizeof(sa));
+		iov.iov_base = msg;
+		iov.iov_len = HOTPLUG_MSG_LEN;
+		memset(&mh, 0, sizeof(mh));
+		mh.msg_name = &sa;
+		mh.msg_namelen = sizeof(sa);
+		mh.msg_iov = &iov;
+		mh.msg_iovlen = 1;
+		len = recvmsg(hotplug_source, &mh, MSG_DONTWAIT);
+		if (len <= 0) {
+			if (len < 0 && (errno == EAGAIN || errno == EINTR || errno == ENOBUFS))
+				continue;
+			break;
+		}
+		/* uevents from the kernel only, not relayed by user space */
+		if (hotplug_own_source && sa.nl_pid != 0)
+			continue;
+		msg[len] = '\0';
+		hotplug_event(msg, (size_t)len);
+	}
+	free(msg);
+	return NULL;
+}
+
+static int hotplug_netlink(void)
+{
+	struct sockaddr_nl sa;
+	int fd;
+
+	fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+	if (fd < 0)
+		return -errno;
+	memset(&sa, 0, sizeof(sa));
+	sa.nl_family = AF_NETLINK;
+	sa.nl_groups = 1; /* kernel uevents */
+	if (bind(fd, (struct sockaddr *)&sa, sizeof(sa))) {
+		int err = errno;
+
+		close(fd);
+		return -err;
+	}
+	return fd;
+}
+
+static TEESTATUS hotplug_errno2status(int err)
+{
+	switch (err) {
+		case -EACCES:
+		case -EPERM: return TEE_PERMISSION_DENIED;
+		case -EAFNOSUPPORT:
+		case -EPROTONOSUPPORT: return TEE_NOTSUPPORTED;
+		default: return TEE_INTERNAL_ERROR;
+	}
+}
+
+void metee_hotplug_watch_add(struct metee_hotplug_watch *w)
+{
+	const struct hotplug_device *dev;
+
+	pthread_mutex_lock(&hotplug_lock);
+	dev = (hotplug_running) ? hotplug_find(w->name) : NULL;
+	w->gen = (dev) ? dev->gen : 0;
+	w->stale = hotplug_watch_stale(w);
+	w->next = hotplug_watches;
+	hotplug_watches = w;
+	pthread_mutex_unlock(&hotplug_lock);
+}
+
+void metee_hotplug_watch_del(struct metee_hotplug_watch *w)
+{
+	struct metee_hotplug_watch **p;
+
+	pthread_mutex_lock(&hotplug_lock);
+	for (p = &hotplug_watches; *p; p = &(*p)->next) {
+		if (*p == w) {
+			*p = w->next;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&hotplug_lock);
+}
+
+int metee_hotplug_snapshot(const struct metee_hotplug_watch *w, uint32_t *gen)
+{
+	const struct hotplug_device *dev;
+	int rc = 0;
+
+	pthread_mutex_lock(&hotplug_lock);
+	dev = (hotplug_running && w->name[0]) ? hotplug_find(w->name) : NULL;
+	*gen = (dev) ? dev->gen : 0;
+	if (dev && !dev->present)
+		rc = -ENODEV;
+	pthread_mutex_unlock(&hotplug_lock);
+	return rc;
+}
+
+void metee_hotplug_rearm(struct metee_hotplug_watch *w, uint32_t gen)
+{
+	pthread_mutex_lock(&hotplug_lock);
+	w->gen = gen;
+	__atomic_store_n(&w->stale, hotplug_watch_stale(w), __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&hotplug_lock);
+}
+
+int metee_hotplug_wait(const struct metee_hotplug_watch *w, int timeout)
+{
+	const struct hotplug_device *dev;
+	struct timespec deadline;
+	int rc = 0;
+
+	pthread_once(&hotplug_once, hotplug_init);
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	if (timeout > 0) {
+		deadline.tv_sec += timeout / 1000;
+		deadline.tv_nsec += (long)(timeout % 1000) * 1000000L;
+		if (deadline.tv_nsec >= 1000000000L) {
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000L;
+		}
+	}
+
+	pthread_mutex_lock(&hotplug_lock);
+	for (;;) {
+		if (!hotplug_running || !w->name[0]) {
+			rc = -EOPNOTSUPP;
+			break;
+		}
+		dev = hotplug_find(w->name);
+		if (!dev || dev->present)
+			break;
+		if (timeout < 0) {
+			pthread_cond_wait(&hotplug_cond, &hotplug_lock);
+		} else if (timeout == 0 ||
+			   pthread_cond_timedwait(&hotplug_cond, &hotplug_lock, &deadline) == ETIMEDOUT) {
+			dev = hotplug_find(w->name);
+			rc = (dev && !dev->present) ? -ETIME : 0;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&hotplug_lock);
+	return rc;
+}
+
+TEESTATUS TEEAPI TeeHotplugStart(IN TEE_DEVICE_HANDLE source)
+{
+	struct metee_hotplug_watch *w;
+	TEESTATUS status;
+	int fd = source;
+	int rc;
+
+	pthread_once(&hotplug_once, hotplug_init);
+	if (__atomic_test_and_set(&hotplug_busy, __ATOMIC_ACQUIRE))
+		return TEE_BUSY;
+
+	if (hotplug_running) {
+		status = TEE_BUSY;
+		goto End;
+	}
+
+	if (source == TEE_INVALID_DEVICE_HANDLE) {
+		fd = hotplug_netlink();
+		if (fd < 0) {
+			status = hotplug_errno2status(fd);
+			goto End;
+		}
+	}
+	hotplug_stop_fd = eventfd(0, EFD_CLOEXEC);
+	if (hotplug_stop_fd < 0) {
+		if (source == TEE_INVALID_DEVICE_HANDLE)
+			close(fd);
+		status = TEE_INTERNAL_ERROR;
+		goto End;
+	}
+	hotplug_source = fd;
+	hotplug_own_source = (source == TEE_INVALID_DEVICE_HANDLE);
+
+	/* subscribed before the scan, so no change is missed between them */
+	pthread_mutex_lock(&hotplug_lock);
+	hotplug_devices_num = 0;
+	hotplug_scan();
+	hotplug_running = true;
+	for (w = hotplug_watches; w; w = w->next) {
+		const struct hotplug_device *dev = hotplug_find(w->name);
+
+		w->gen = (dev) ? dev->gen : 0;
+		__atomic_store_n(&w->stale, hotplug_watch_stale(w), __ATOMIC_RELEASE);
+	}
+	pthread_mutex_unlock(&hotplug_lock);
+
+	rc = pthread_create(&hotplug_thread, NULL, hotplug_run, NULL);
+	if (rc) {
+		pthread_mutex_lock(&hotplug_lock);
+		hotplug_running = false;
+		pthread_mutex_unlock(&hotplug_lock);
+		close(hotplug_stop_fd);
+		hotplug_stop_fd = -1;
+		if (hotplug_own_source)
+			close(hotplug_source);
+		hotplug_source = -1;
+		status = TEE_INTERNAL_ERROR;
+		goto End;
+	}
+	status = TEE_SUCCESS;
+
+End:
+	__atomic_clear(&hotplug_busy, __ATOMIC_RELEASE);
+	return status;
+}
+
+TEESTATUS TEEAPI TeeHotplugStop(void)
+{
+	struct metee_hotplug_watch *w;
+	uint64_t one = 1;
+	TEESTATUS status;
+
+	if (__atomic_test_and_set(&hotplug_busy, __ATOMIC_ACQUIRE))
+		return TEE_BUSY;
+
+	if (!hotplug_running) {
+		status = TEE_SUCCESS;
+		goto End;
+	}
+	if (write(hotplug_stop_fd, &one, sizeof(one)) != sizeof(one)) {
+		status = TEE_INTERNAL_ERROR;
+		goto End;
+	}
+	pthread_join(hotplug_thread, NULL);
+	close(hotplug_stop_fd);
+	hotplug_stop_fd = -1;
+	if (hotplug_own_source)
+		close(hotplug_source);
+	hotplug_source = -1;
+
+	/* without the monitor nothing fails fast */
+	pthread_mutex_lock(&hotplug_lock);
+	hotplug_running = false;
+	hotplug_devices_num = 0;
+	for (w = hotplug_watches; w; w = w->next)
+		__atomic_store_n(&w->stale, false, __ATOMIC_RELEASE);
+	pthread_cond_broadcast(&hotplug_cond);
+	pthread_mutex_unlock(&hotplug_lock);
+	status = TEE_SUCCESS;
+
+End:
+	__atomic_clear(&hotplug_busy, __ATOMIC_RELEASE);
+	return status;
+}
+
+TEESTATUS TEEAPI TeeHotplugQuery(IN const char *name, OUT bool *present)
+{
+	const struct hotplug_device *dev;
+	TEESTATUS status;
+
+	if (!name || !present)
+		return TEE_INVALID_PARAMETER;
+
+	pthread_mutex_lock(&hotplug_lock);
+	if (!hotplug_running) {
+		status = TEE_NOTSUPPORTED;
+		goto End;
+	}
+	dev = hotplug_find(hotplug_basename(name));
+	if (!dev) {
+		status = TEE_DEVICE_NOT_FOUND;
+		goto End;
+	}
+	*present = dev->present;
+	status = TEE_SUCCESS;
+
+End:
+	pthread_mutex_unlock(&hotplug_lock);
+	return status;
+}
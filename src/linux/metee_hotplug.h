@@ -0,0 +1,49 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+#ifndef __METEE_HOTPLUG_H
+#define __METEE_HOTPLUG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Process-wide mei device monitor (TeeHotplugStart).
+ * A thread reads kernel uevents of the mei class and keeps a table of
+ * devices with their presence and generation, incremented on every add
+ * and remove. Every handle on a device has a watch; a watch becomes
+ * stale when its device is removed or replaced after the watch was
+ * armed, the watch callback is called at that moment to wake its waits.
+ */
+
+#define METEE_HOTPLUG_NAME_LEN 32
+
+struct metee_hotplug_watch {
+	struct metee_hotplug_watch *next;
+	char name[METEE_HOTPLUG_NAME_LEN]; /* device name, e.g. mei0 */
+	uint32_t gen; /* device generation the handle was connected to */
+	bool stale; /* device removed or replaced, read without lock */
+	void (*notify)(void *ctx); /* called under the monitor lock when the watch turns stale */
+	void *ctx;
+};
+
+/* register the watch, gen is the current device generation */
+void metee_hotplug_watch_add(struct metee_hotplug_watch *w);
+void metee_hotplug_watch_del(struct metee_hotplug_watch *w);
+
+static inline bool metee_hotplug_stale(const struct metee_hotplug_watch *w)
+{
+	return __atomic_load_n(&w->stale, __ATOMIC_ACQUIRE);
+}
+
+/* device state before reconnect: 0 if present, -ENODEV if removed, gen set to the current generation */
+int metee_hotplug_snapshot(const struct metee_hotplug_watch *w, uint32_t *gen);
+
+/* arm the watch on the generation taken by metee_hotplug_snapshot */
+void metee_hotplug_rearm(struct metee_hotplug_watch *w, uint32_t gen);
+
+/* wait until the device is present, -ETIME on timeout, -EOPNOTSUPP without monitor, negative timeout is infinite */
+int metee_hotplug_wait(const struct metee_hotplug_watch *w, int timeout);
+
+#endif /* __METEE_HOTPLUG_H */
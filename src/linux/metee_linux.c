@@ -12,20 +12,62 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/eventfd.h>
 #include <sys/ioctl.h>
 #include <poll.h>
+#include <pthread.h>
+#include <time.h>
 #include <unistd.h>
 #include <stdarg.h>
 
 #include "metee.h"
 #include "helpers.h"
+#include "metee_backend.h"
+#include "metee_capture.h"
+#include "metee_fault.h"
+#include "metee_hotplug.h"
+#include "metee_power.h"
+#include "metee_stats.h"
 
 #define MAX_FW_STATUS_NUM 5
 #define CANCEL_PIPES_NUM 2
+#define DEVSTATE_LEN 32
+#define DEVSTATE_POLL_MS 20 /* re-read interval for dev_state files without change notification */
+#define DEVSTATE_CONNECT_MS 10000 /* wait of TeeConnect for the device under TEE_DEVSTATE_WAIT */
 
 struct metee_linux_intl {
 	struct mei me;
 	int cancel_pipe[CANCEL_PIPES_NUM];
+	const struct metee_backend_ops *ops; /* transport backend */
+	void *priv; /* backend private data */
+	struct tee_stats stats;
+	uint64_t transact_start; /* start of the last write not followed by read yet */
+	TeeLogCallback3 log_callback3; /* structured log callback */
+	void *log_ctx; /* structured log callback context */
+	struct metee_capture *capture; /* traffic capture, NULL if not running */
+	pthread_mutex_t capture_lock; /* serializes capture appends and stop */
+	pthread_mutex_t cancel_lock; /* protects the handle-wide cancel state below */
+	uint32_t cancel_gen; /* incremented by every TeeCancelIO */
+	uint32_t cancel_waiters; /* waits started in the current generation */
+	uint32_t cancel_pending; /* waits of past generations not woken yet, the pipe is drained by the last */
+	struct metee_hotplug_watch hotplug; /* device removal monitor registration */
+	int devstate_fd; /* sysfs dev_state attribute, -1 if unknown */
+	uint32_t devstate_policy; /* enum tee_devstate_policy */
+	pthread_mutex_t devstate_lock; /* protects devstate_fd and the users below */
+	pthread_cond_t devstate_idle; /* signaled when the users of a generation are gone */
+	uint32_t devstate_gen; /* incremented by every TeeDevStateBind */
+	uint32_t devstate_users[2]; /* gates using the descriptor, by generation parity */
+	struct metee_power power[2]; /* runtime power management of the device, by generation parity */
+	pthread_mutex_t power_lock; /* protects power_gen and the users below */
+	pthread_cond_t power_idle; /* signaled when the users of a generation are gone */
+	uint32_t power_gen; /* incremented by every TeePowerBind */
+	uint32_t power_users[2]; /* calls using power[], by generation parity */
+};
+
+struct tee_cancel_token {
+	int fd; /* eventfd, readable when canceled */
+	bool canceled;
+	uint64_t deadline; /* CLOCK_MONOTONIC microseconds, 0 if none */
 };
 
 /* use inline function instead of macro to avoid -Waddress warning in GCC */
@@ -42,27 +84,6 @@ static inline struct metee_linux_intl *to_intl(PTEEHANDLE _h)
 	return _h ? (struct metee_linux_intl *)_h->handle : NULL;
 }
 
-static inline int __mei_select(struct mei *me, int pipe_fd,
-			       bool on_read, int timeout)
-{
-	int rv;
-	struct pollfd pfd[2];
-	pfd[0].fd = me->fd;
-	pfd[0].events = (on_read) ? POLLIN : POLLOUT;
-	pfd[1].fd = pipe_fd;
-	pfd[1].events = POLLIN;
-
-	errno = 0;
-	rv = poll(pfd, 2, timeout);
-	if (rv < 0)
-		return -errno;
-	if (rv == 0)
-		return -ETIME;
-	if (pfd[1].revents != 0)
-		return -ECANCELED;
-	return 0;
-}
-
 static inline TEESTATUS errno2status(ssize_t err)
 {
 	switch (err) {
@@ -75,6 +96,8 @@ static inline TEESTATUS errno2status(ssize_t err)
 		case -EOPNOTSUPP: return TEE_NOTSUPPORTED;
 		case -ECANCELED: return TEE_UNABLE_TO_COMPLETE_OPERATION;
 		case -ENOSPC: return TEE_INSUFFICIENT_BUFFER;
+		case -EMSGSIZE: return TEE_INVALID_PARAMETER;
+		case -ENETRESET: return TEE_DEVICE_RESETTING;
 		default     : return TEE_INTERNAL_ERROR;
 	}
 }
@@ -93,6 +116,29 @@ static inline TEESTATUS errno2status_init(ssize_t err)
 	}
 }
 
+/* append record to the running capture, no-op when not capturing */
+static void __capture(struct metee_linux_intl *intl, enum metee_capture_type type,
+		      const void *payload, size_t len)
+{
+	if (!__atomic_load_n(&intl->capture, __ATOMIC_RELAXED))
+		return;
+	pthread_mutex_lock(&intl->capture_lock);
+	if (intl->capture)
+		metee_capture_append(intl->capture, type, &intl->me.guid, intl->me.vtag,
+				     payload, len);
+	pthread_mutex_unlock(&intl->capture_lock);
+}
+
+static void __capture_connect(struct metee_linux_intl *intl)
+{
+	struct metee_capture_connect conn;
+
+	memset(&conn, 0, sizeof(conn));
+	conn.max_msg_len = intl->me.buf_size;
+	conn.protocol_ver = intl->me.prot_ver;
+	__capture(intl, METEE_CAPTURE_CONNECT, &conn, sizeof(conn));
+}
+
 void CallbackPrintHelper(IN PTEEHANDLE handle, bool is_error, const char* args, ...)
 {
 	char msg[DEBUG_MSG_LEN + 1];
@@ -103,12 +149,479 @@ void CallbackPrintHelper(IN PTEEHANDLE handle, bool is_error, const char* args,
 	handle->log_callback2(is_error, msg);
 }
 
+static inline uint64_t __log_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+/* operation start time, taken only when somebody will receive the event */
+static inline uint64_t __log_op_start(struct metee_linux_intl *intl)
+{
+	return (intl && intl->log_callback3) ? __log_now() : 0;
+}
+
+static void __log_message(struct metee_linux_intl *intl, bool is_error, const char *file,
+			  const char *func, int line, const char *fmt, va_list *args)
+{
+	struct tee_log_event event;
+
+	memset(&event, 0, sizeof(event));
+	event.level = is_error ? TEE_LOG_LEVEL_ERROR : TEE_LOG_LEVEL_VERBOSE;
+	event.op = TEE_LOG_OP_MESSAGE;
+	event.handle_id = (uintptr_t)intl;
+	event.file = file;
+	event.function = func;
+	event.line = (uint32_t)line;
+	event.fmt = fmt;
+	event.args = args;
+	intl->log_callback3(intl->log_ctx, &event);
+}
+
+/* libmei messages of handle with structured callback */
+static void __mei_log_callback3(void *ctx, bool is_error, const char *file,
+				const char *func, int line, const char *fmt, va_list *args)
+{
+	__log_message(ctx, is_error, file, func, line, fmt, args);
+}
+
+bool StructuredCallbackSet(IN PTEEHANDLE handle)
+{
+	struct metee_linux_intl *intl = to_intl(handle);
+
+	return intl && intl->log_callback3;
+}
+
+void StructuredPrintHelper(IN PTEEHANDLE handle, bool is_error, const char *file,
+			   const char *func, int line, const char *fmt, ...)
+{
+	va_list varl;
+	va_start(varl, fmt);
+	__log_message(to_intl(handle), is_error, file, func, line, fmt, &varl);
+	va_end(varl);
+}
+
+static void __log_op(PTEEHANDLE handle, enum tee_log_op op, const char *func,
+		     TEESTATUS status, ssize_t rc, size_t bytes, uint64_t start)
+{
+	struct metee_linux_intl *intl = to_intl(handle);
+	uint32_t level = status ? TEE_LOG_LEVEL_ERROR : TEE_LOG_LEVEL_VERBOSE;
+	struct tee_log_event event;
+
+	if (!intl || !intl->log_callback3 || METEE_MIN_LOG_LEVEL < level ||
+	    handle->log_level < level)
+		return;
+
+	memset(&event, 0, sizeof(event));
+	event.level = level;
+	event.op = op;
+	event.handle_id = (uintptr_t)intl;
+	event.error = (rc < 0) ? (int)-rc : 0;
+	event.status = status;
+	event.bytes = bytes;
+	event.duration_us = start ? __log_now() - start : 0;
+	event.file = __FILE__;
+	event.function = func;
+	intl->log_callback3(intl->log_ctx, &event);
+}
+
+static const struct metee_backend_ops *__backend_ops(uint32_t type)
+{
+	switch (type) {
+	case TEE_DEVICE_TYPE_BROKER:
+	case TEE_DEVICE_TYPE_BROKER_SHM:
+		return &metee_backend_broker;
+	case TEE_DEVICE_TYPE_REPLAY:
+		return &metee_backend_replay;
+	case TEE_DEVICE_TYPE_LOOPBACK:
+	case TEE_DEVICE_TYPE_SCRIPT:
+		return &metee_backend_script;
+	case TEE_DEVICE_TYPE_SOCKET:
+		return &metee_backend_socket;
+	default:
+		return &metee_backend_mei;
+	}
+}
+
+/* register a wait stopped by TeeCancelIO, returns its cancel generation */
+static uint32_t __cancel_enter(struct metee_linux_intl *intl)
+{
+	uint32_t gen;
+
+	pthread_mutex_lock(&intl->cancel_lock);
+	gen = intl->cancel_gen;
+	intl->cancel_waiters++;
+	pthread_mutex_unlock(&intl->cancel_lock);
+	return gen;
+}
+
+/*
+ * unregister the wait; the last wait stopped by TeeCancelIO takes the byte
+ * out of the pipe, so it does not stop later waits
+ */
+static void __cancel_leave(struct metee_linux_intl *intl, uint32_t gen)
+{
+	char buf;
+
+	pthread_mutex_lock(&intl->cancel_lock);
+	if (gen == intl->cancel_gen) {
+		intl->cancel_waiters--;
+	} else if (--intl->cancel_pending == 0) {
+		while (read(intl->cancel_pipe[0], &buf, sizeof(buf)) > 0)
+			;
+	}
+	pthread_mutex_unlock(&intl->cancel_lock);
+}
+
+/* stop the waits in flight: one byte wakes them all, the last one removes it */
+static bool __cancel_wake(struct metee_linux_intl *intl)
+{
+	const char buf[] = "X";
+	bool failed = false;
+
+	pthread_mutex_lock(&intl->cancel_lock);
+	intl->cancel_gen++;
+	if (intl->cancel_waiters) {
+		if (!intl->cancel_pending)
+			failed = write(intl->cancel_pipe[1], buf, 1) < 0;
+		intl->cancel_pending += intl->cancel_waiters;
+		intl->cancel_waiters = 0;
+	}
+	pthread_mutex_unlock(&intl->cancel_lock);
+	if (intl->ops->cancel)
+		intl->ops->cancel(&intl->me, intl->priv);
+	return !failed;
+}
+
+/* the device of the handle is removed: waits end with -ENODEV */
+static void __hotplug_notify(void *ctx)
+{
+	__cancel_wake(ctx);
+}
+
+static void __hotplug_bind(struct metee_linux_intl *intl, const char *name)
+{
+	const char *slash = (name) ? strrchr(name, '/') : NULL;
+
+	if (slash)
+		name = slash + 1;
+	memset(&intl->hotplug, 0, sizeof(intl->hotplug));
+	if (name)
+		strncpy(intl->hotplug.name, name, sizeof(intl->hotplug.name) - 1);
+	intl->hotplug.notify = __hotplug_notify;
+	intl->hotplug.ctx = intl;
+	metee_hotplug_watch_add(&intl->hotplug);
+}
+
+/* dev_state text without new line, negative errno on failure */
+static int __devstate_read(int fd, char *state, size_t size)
+{
+	ssize_t len;
+
+	len = pread(fd, state, size - 1, 0);
+	if (len < 0)
+		return -errno;
+	while (len > 0 && (state[len - 1] == '\n' || state[len - 1] == ' '))
+		len--;
+	state[len] = '\0';
+	return (int)len;
+}
+
+/* descriptor kept open by TeeDevStateBind until __devstate_put, -1 if unknown */
+static int __devstate_get(struct metee_linux_intl *intl, uint32_t *gen)
+{
+	int fd;
+
+	pthread_mutex_lock(&intl->devstate_lock);
+	fd = intl->devstate_fd;
+	*gen = intl->devstate_gen;
+	if (fd >= 0)
+		intl->devstate_users[*gen & 1]++;
+	pthread_mutex_unlock(&intl->devstate_lock);
+	return fd;
+}
+
+static void __devstate_put(struct metee_linux_intl *intl, uint32_t gen)
+{
+	pthread_mutex_lock(&intl->devstate_lock);
+	if (--intl->devstate_users[gen & 1] == 0)
+		pthread_cond_broadcast(&intl->devstate_idle);
+	pthread_mutex_unlock(&intl->devstate_lock);
+}
+
+/*
+ * one look at the device state: 0 if enabled or unknown, -ENETRESET when not
+ * enabled and the policy is to fail, -EINPROGRESS after a wait for a change.
+ * Reading the attribute re-arms the sysfs change notification polled here.
+ */
+static int __devstate_check(int fd, uint32_t policy, const int *cancel_fds, int timeout)
+{
+	struct pollfd pfd[METEE_CANCEL_FDS + 1];
+	char state[DEVSTATE_LEN];
+	nfds_t i;
+	int rc;
+
+	rc = __devstate_read(fd, state, sizeof(state));
+	if (rc <= 0 || !strcmp(state, "ENABLED"))
+		return 0;
+	if (policy != TEE_DEVSTATE_WAIT)
+		return -ENETRESET;
+	if (timeout == 0)
+		return -ETIME;
+	if (timeout < 0 || timeout > DEVSTATE_POLL_MS)
+		timeout = DEVSTATE_POLL_MS;
+
+	pfd[0].fd = fd;
+	pfd[0].events = POLLPRI;
+	for (i = 0; i < METEE_CANCEL_FDS; i++) {
+		pfd[i + 1].fd = cancel_fds[i];
+		pfd[i + 1].events = POLLIN;
+	}
+	rc = poll(pfd, METEE_CANCEL_FDS + 1, timeout);
+	if (rc < 0 && errno != EINTR)
+		return -errno;
+	for (i = 1; rc > 0 && i <= METEE_CANCEL_FDS; i++) {
+		if (pfd[i].revents & POLLIN)
+			return -ECANCELED;
+	}
+	return -EINPROGRESS;
+}
+
+/*
+ * 0 if the device is enabled or its state is unknown, -EAGAIN when it became
+ * enabled after a wait, -ENETRESET when not enabled and the policy is to fail.
+ * The descriptor is taken for one poll slice at a time, so TeeDevStateBind
+ * waits at most DEVSTATE_POLL_MS for the gates on the old one.
+ */
+static int __devstate_gate(struct metee_linux_intl *intl, const int *cancel_fds, int timeout)
+{
+	uint32_t policy = __atomic_load_n(&intl->devstate_policy, __ATOMIC_RELAXED);
+	struct timespec start;
+	bool waited = false;
+	uint32_t gen;
+	int fd;
+	int rc;
+
+	if (policy == TEE_DEVSTATE_IGNORE ||
+	    __atomic_load_n(&intl->devstate_fd, __ATOMIC_RELAXED) < 0)
+		return 0;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (;;) {
+		fd = __devstate_get(intl, &gen);
+		if (fd < 0)
+			return (waited) ? -EAGAIN : 0;
+		rc = __devstate_check(fd, policy, cancel_fds, metee_backend_remaining(&start, timeout));
+		__devstate_put(intl, gen);
+		if (rc != -EINPROGRESS)
+			return (!rc && waited) ? -EAGAIN : rc;
+		waited = true;
+	}
+}
+
+/* gate of TeeConnect, it has no timeout of its own: waits up to DEVSTATE_CONNECT_MS */
+static int __devstate_connect_gate(struct metee_linux_intl *intl)
+{
+	int fds[METEE_CANCEL_FDS] = {intl->cancel_pipe[0], -1};
+	struct timespec start;
+	uint32_t gen;
+	int rc;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	gen = __cancel_enter(intl);
+	for (;;) {
+		rc = __devstate_gate(intl, fds, metee_backend_remaining(&start, DEVSTATE_CONNECT_MS));
+		if (rc == -EAGAIN) {
+			rc = 0;
+			break;
+		}
+		if (rc != -ECANCELED || __atomic_load_n(&intl->cancel_gen, __ATOMIC_RELAXED) != gen)
+			break;
+		/* the byte of TeeCancelIO called before this wait, see __wait */
+		if (!metee_backend_remaining(&start, DEVSTATE_CONNECT_MS)) {
+			rc = -ETIME;
+			break;
+		}
+		poll(NULL, 0, 1);
+	}
+	__cancel_leave(intl, gen);
+	return rc;
+}
+
+static int __devstate_open(const char *device)
+{
+	const char *slash = (device) ? strrchr(device, '/') : NULL;
+	char path[PATH_MAX];
+	int len;
+
+	if (!device)
+		return -1;
+	len = snprintf(path, sizeof(path), "/sys/class/mei/%s/dev_state", (slash) ? slash + 1 : device);
+	if (len < 0 || (size_t)len >= sizeof(path))
+		return -1;
+	return open(path, O_RDONLY | O_CLOEXEC);
+}
+
+static void __power_open(struct metee_power *pw, const char *device)
+{
+	const char *slash = (device) ? strrchr(device, '/') : NULL;
+	char path[PATH_MAX];
+	int len;
+
+	if (device) {
+		len = snprintf(path, sizeof(path), "/sys/class/mei/%s/device/power",
+			       (slash) ? slash + 1 : device);
+		if (len > 0 && (size_t)len < sizeof(path) && !metee_power_open(pw, path))
+			return;
+	}
+	metee_power_open(pw, NULL);
+}
+
+/* power slot kept by TeePowerBind until __power_put */
+static struct metee_power *__power_get(struct metee_linux_intl *intl, uint32_t *gen)
+{
+	pthread_mutex_lock(&intl->power_lock);
+	*gen = intl->power_gen;
+	intl->power_users[*gen & 1]++;
+	pthread_mutex_unlock(&intl->power_lock);
+	return &intl->power[*gen & 1];
+}
+
+static void __power_put(struct metee_linux_intl *intl, uint32_t gen)
+{
+	pthread_mutex_lock(&intl->power_lock);
+	if (--intl->power_users[gen & 1] == 0)
+		pthread_cond_broadcast(&intl->power_idle);
+	pthread_mutex_unlock(&intl->power_lock);
+}
+
+static void __token_cancel(struct tee_cancel_token *token)
+{
+	uint64_t one = 1;
+
+	if (__atomic_exchange_n(&token->canceled, true, __ATOMIC_ACQ_REL))
+		return;
+	if (write(token->fd, &one, sizeof(one)) < 0)
+		return;
+}
+
+/* cancels the token if its deadline passed */
+static bool __token_canceled(struct tee_cancel_token *token, uint64_t now)
+{
+	uint64_t deadline = __atomic_load_n(&token->deadline, __ATOMIC_RELAXED);
+
+	if (__atomic_load_n(&token->canceled, __ATOMIC_ACQUIRE))
+		return true;
+	if (!deadline || now < deadline)
+		return false;
+	__token_cancel(token);
+	return true;
+}
+
+/* the eventfd of a canceled token stays readable until TeeCancelTokenReset */
+static bool __token_signaled(struct tee_cancel_token *token)
+{
+	struct pollfd pfd = { .fd = token->fd, .events = POLLIN };
+
+	return poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN);
+}
+
+/* wait for the backend, stopped by TeeCancelIO, the token or the token deadline */
+static int __wait(struct metee_linux_intl *intl, struct tee_cancel_token *token,
+		  bool on_read, size_t len, int timeout)
+{
+	int fds[METEE_CANCEL_FDS];
+	struct timespec start;
+	uint64_t now, deadline;
+	int ltimeout;
+	uint32_t gen;
+	int rc;
+
+	fds[0] = intl->cancel_pipe[0];
+	fds[1] = (token) ? token->fd : -1;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	gen = __cancel_enter(intl);
+	for (;;) {
+		/* after __cancel_enter: either seen here or woken by the monitor */
+		if (metee_hotplug_stale(&intl->hotplug)) {
+			intl->me.state = MEI_CL_STATE_DISCONNECTED;
+			rc = -ENODEV;
+			break;
+		}
+		ltimeout = metee_backend_remaining(&start, timeout);
+		if (token) {
+			now = __log_now();
+			if (__token_canceled(token, now)) {
+				rc = -ECANCELED;
+				break;
+			}
+			/* wake up at the deadline, the next round cancels the token */
+			deadline = __atomic_load_n(&token->deadline, __ATOMIC_RELAXED);
+			if (deadline) {
+				uint64_t left = (deadline - now + 999) / 1000;
+
+				if (left > INT_MAX)
+					left = INT_MAX;
+				if (ltimeout < 0 || left < (uint64_t)ltimeout)
+					ltimeout = (int)left;
+			}
+		}
+
+		rc = __devstate_gate(intl, fds, ltimeout);
+		if (rc == -EAGAIN) /* the device is back, recount the timeout */
+			continue;
+		if (!rc)
+			rc = intl->ops->wait(&intl->me, intl->priv, fds, on_read, len, ltimeout);
+		if (rc == -ETIME && token && __atomic_load_n(&token->deadline, __ATOMIC_RELAXED) &&
+		    metee_backend_remaining(&start, timeout) != 0)
+			continue;
+		if (rc != -ECANCELED || (token && (__atomic_load_n(&token->canceled, __ATOMIC_ACQUIRE) ||
+						   __token_signaled(token))) ||
+		    __atomic_load_n(&intl->cancel_gen, __ATOMIC_RELAXED) != gen)
+			break;
+		/*
+		 * the byte of TeeCancelIO called before this wait, left for the
+		 * waits it stopped: give them a millisecond to take it out
+		 */
+		if (!metee_backend_remaining(&start, timeout)) {
+			rc = -ETIME;
+			break;
+		}
+		if (token) {
+			struct pollfd pfd = { .fd = token->fd, .events = POLLIN };
+
+			poll(&pfd, 1, 1);
+		} else {
+			poll(NULL, 0, 1);
+		}
+	}
+	if (rc == -ECANCELED && metee_hotplug_stale(&intl->hotplug)) {
+		intl->me.state = MEI_CL_STATE_DISCONNECTED;
+		rc = -ENODEV;
+	}
+	__cancel_leave(intl, gen);
+	return rc;
+}
+
+static void __intl_free(struct metee_linux_intl *intl)
+{
+	pthread_mutex_destroy(&intl->capture_lock);
+	pthread_mutex_destroy(&intl->cancel_lock);
+	pthread_mutex_destroy(&intl->devstate_lock);
+	pthread_cond_destroy(&intl->devstate_idle);
+	pthread_mutex_destroy(&intl->power_lock);
+	pthread_cond_destroy(&intl->power_idle);
+	free(intl);
+}
+
 static TEESTATUS TeeInitFullInt(IN OUT PTEEHANDLE handle, IN const GUID* guid,
 			     IN const struct tee_device_address device,
 			     IN uint32_t log_level, IN TeeLogCallback log_callback,
 				 IN TeeLogCallback2 log_callback2)
 {
 	struct metee_linux_intl *intl;
+	struct metee_backend_params params;
 	TEESTATUS  status;
 	int rc;
 	bool verbose = (log_level == TEE_LOG_LEVEL_VERBOSE);
@@ -131,6 +644,7 @@ static TEESTATUS TeeInitFullInt(IN OUT PTEEHANDLE handle, IN const GUID* guid,
 	}
 	switch (device.type) {
 	case TEE_DEVICE_TYPE_NONE:
+	case TEE_DEVICE_TYPE_LOOPBACK:
 		if (device.data.path != NULL) {
 			ERRPRINT(handle, "Path is not NULL.\n");
 			status = TEE_INVALID_PARAMETER;
@@ -138,6 +652,9 @@ static TEESTATUS TeeInitFullInt(IN OUT PTEEHANDLE handle, IN const GUID* guid,
 		}
 		break;
 	case TEE_DEVICE_TYPE_PATH:
+	case TEE_DEVICE_TYPE_BROKER:
+	case TEE_DEVICE_TYPE_BROKER_SHM:
+	case TEE_DEVICE_TYPE_REPLAY:
 		if (device.data.path == NULL) {
 			ERRPRINT(handle, "Path is NULL.\n");
 			status = TEE_INVALID_PARAMETER;
@@ -145,12 +662,20 @@ static TEESTATUS TeeInitFullInt(IN OUT PTEEHANDLE handle, IN const GUID* guid,
 		}
 		break;
 	case TEE_DEVICE_TYPE_HANDLE:
+	case TEE_DEVICE_TYPE_SOCKET:
 		if (device.data.handle == TEE_INVALID_DEVICE_HANDLE) {
 			ERRPRINT(handle, "Handle is invalid.\n");
 			status = TEE_INVALID_PARAMETER;
 			goto End;
 		}
 		break;
+	case TEE_DEVICE_TYPE_SCRIPT:
+		if (device.data.script == NULL) {
+			ERRPRINT(handle, "Script is NULL.\n");
+			status = TEE_INVALID_PARAMETER;
+			goto End;
+		}
+		break;
 	case TEE_DEVICE_TYPE_GUID:
 	default:
 		ERRPRINT(handle, "Wrong device type %u.\n", device.type);
@@ -164,53 +689,54 @@ static TEESTATUS TeeInitFullInt(IN OUT PTEEHANDLE handle, IN const GUID* guid,
 		status = TEE_INTERNAL_ERROR;
 		goto End;
 	}
-
-	switch (device.type) {
-	case TEE_DEVICE_TYPE_NONE:
-		if (log_callback)
-			rc = mei_init_with_log(&intl->me, MEI_DEFAULT_DEVICE,
-				(uuid_le*)guid, 0, verbose, log_callback);
-		else
-			rc = mei_init_with_log2(&intl->me, MEI_DEFAULT_DEVICE,
-				(uuid_le*)guid, 0, verbose, log_callback2);
-		break;
-	case TEE_DEVICE_TYPE_PATH:
-		if (log_callback)
-			rc = mei_init_with_log(&intl->me, device.data.path,
-				(uuid_le*)guid, 0, verbose, log_callback);
-		else
-			rc = mei_init_with_log2(&intl->me, device.data.path,
-				(uuid_le*)guid, 0, verbose, log_callback2);
-
-		break;
-	case TEE_DEVICE_TYPE_HANDLE:
-		rc = mei_init_fd(&intl->me, device.data.handle, (uuid_le*)guid, 0, verbose);
-		if (!rc) {
-			if (log_callback)
-				mei_set_log_callback(&intl->me, log_callback);
-			else
-				mei_set_log_callback2(&intl->me, log_callback2);
-			mei_set_log_level(&intl->me, verbose);
-		}
-		break;
-	default:
-		rc = -EFAULT;
-		break;
-	}
+	intl->ops = __backend_ops(device.type);
+	intl->priv = NULL;
+	memset(&intl->stats, 0, sizeof(intl->stats));
+	intl->transact_start = 0;
+	intl->log_callback3 = NULL;
+	intl->log_ctx = NULL;
+	intl->capture = NULL;
+	pthread_mutex_init(&intl->capture_lock, NULL);
+	pthread_mutex_init(&intl->cancel_lock, NULL);
+	intl->cancel_gen = 0;
+	intl->cancel_waiters = 0;
+	intl->cancel_pending = 0;
+	pthread_mutex_init(&intl->devstate_lock, NULL);
+	pthread_cond_init(&intl->devstate_idle, NULL);
+	pthread_mutex_init(&intl->power_lock, NULL);
+	pthread_cond_init(&intl->power_idle, NULL);
+	intl->power_gen = 0;
+	intl->power_users[0] = 0;
+	intl->power_users[1] = 0;
+	intl->devstate_gen = 0;
+	intl->devstate_users[0] = 0;
+	intl->devstate_users[1] = 0;
+
+	params.device = &device;
+	params.guid = guid;
+	params.verbose = verbose;
+	params.log_callback = log_callback;
+	params.log_callback2 = log_callback2;
+	rc = intl->ops->open(&intl->me, &intl->priv, &params);
 	if (rc) {
-		free(intl);
-		ERRPRINT(handle, "Cannot init mei, rc = %d\n", rc);
+		ERRPRINT(handle, "Cannot init %s backend, rc = %d\n", intl->ops->name, rc);
+		__intl_free(intl);
 		status = errno2status_init(rc);
 		goto End;
 	}
-	rc = pipe(intl->cancel_pipe);
+	rc = pipe2(intl->cancel_pipe, O_NONBLOCK | O_CLOEXEC);
 	if (rc) {
-		mei_deinit(&intl->me);
-		free(intl);
+		intl->ops->close(&intl->me, intl->priv);
+		__intl_free(intl);
 		ERRPRINT(handle, "Cannot init mei, rc = %d\n", rc);
 		status = errno2status_init(rc);
 		goto End;
 	}
+	__hotplug_bind(intl, (intl->ops == &metee_backend_mei) ? intl->me.device : NULL);
+	intl->devstate_fd = (intl->ops == &metee_backend_mei) ? __devstate_open(intl->me.device) : -1;
+	intl->devstate_policy = TEE_DEVSTATE_FAIL;
+	__power_open(&intl->power[0], (intl->ops == &metee_backend_mei) ? intl->me.device : NULL);
+	metee_power_open(&intl->power[1], NULL);
 	handle->handle = intl;
 
 	status = TEE_SUCCESS;
@@ -258,8 +784,11 @@ TEESTATUS TEEAPI TeeInitHandle(IN OUT PTEEHANDLE handle, IN const GUID *guid,
 TEESTATUS TEEAPI TeeConnect(IN OUT PTEEHANDLE handle)
 {
 	struct mei *me = to_mei(handle);
+	struct metee_linux_intl *intl = to_intl(handle);
+	uint64_t op_start = __log_op_start(intl);
+	uint32_t hotplug_gen;
 	TEESTATUS  status;
-	int        rc;
+	int        rc = 0;
 
 	if (!handle) {
 		return TEE_INVALID_PARAMETER;
@@ -273,43 +802,82 @@ TEESTATUS TEEAPI TeeConnect(IN OUT PTEEHANDLE handle)
 		goto End;
 	}
 
-	rc = mei_connect(me);
+	rc = metee_hotplug_snapshot(&intl->hotplug, &hotplug_gen);
+	if (rc) {
+		ERRPRINT(handle, "Device %s is removed\n", intl->hotplug.name);
+		status = TEE_DISCONNECTED;
+		goto End;
+	}
+	if (metee_hotplug_stale(&intl->hotplug)) {
+		/* the device node was replaced, the old descriptor is dead */
+		me->state = MEI_CL_STATE_DISCONNECTED;
+		if (intl->ops->reopen) {
+			rc = intl->ops->reopen(me, intl->priv);
+			if (rc && rc != -EOPNOTSUPP) {
+				ERRPRINT(handle, "Cannot reopen device %s, rc = %d %s\n",
+					 intl->hotplug.name, rc, strerror(-rc));
+				status = errno2status(rc);
+				goto End;
+			}
+		}
+	}
+	rc = __devstate_connect_gate(intl);
+	if (rc) {
+		ERRPRINT(handle, "The device is not enabled\n");
+		status = (rc == -ECANCELED) ? TEE_UNABLE_TO_COMPLETE_OPERATION : TEE_DEVICE_RESETTING;
+		goto End;
+	}
+
+	rc = intl->ops->connect(me, intl->priv);
 	if (rc) {
-		ERRPRINT(handle, "Cannot establish a handle to the Intel MEI driver\n");
+		ERRPRINT(handle, "Cannot connect to the client through %s backend, rc = %d %s\n",
+			 intl->ops->name, rc, strerror(-rc));
 		status = errno2status(rc);
 		goto End;
 	}
 
 	handle->maxMsgLen = me->buf_size;
 	handle->protcolVer = me->prot_ver;
+	metee_hotplug_rearm(&intl->hotplug, hotplug_gen);
+	__capture_connect(intl);
 
+	stats_connect(&intl->stats);
 	status = TEE_SUCCESS;
 
 End:
+	if (intl)
+		stats_status(&intl->stats, status);
+	__log_op(handle, TEE_LOG_OP_CONNECT, __FUNCTION__, status, rc, 0, op_start);
 	FUNC_EXIT(handle, status);
 	return status;
 }
 
-TEESTATUS TEEAPI TeeRead(IN PTEEHANDLE handle, IN OUT void *buffer, IN size_t bufferSize,
-			 OUT OPTIONAL size_t *pNumOfBytesRead, IN OPTIONAL uint32_t timeout)
+/* TeeRead and TeeWrite, with or without a token, are logged under the plain names */
+static void __tee_op_end(PTEEHANDLE handle, enum tee_log_op op, TEESTATUS status,
+			 ssize_t rc, size_t bytes, uint64_t start)
+{
+	struct metee_linux_intl *intl = to_intl(handle);
+
+	if (intl)
+		stats_status(&intl->stats, status);
+	__log_op(handle, op, (op == TEE_LOG_OP_READ) ? "TeeRead" : "TeeWrite",
+		 status, rc, bytes, start);
+}
+
+static TEESTATUS __tee_read(PTEEHANDLE handle, void *buffer, size_t bufferSize,
+			    size_t *pNumOfBytesRead, uint32_t timeout,
+			    struct tee_cancel_token *token)
 {
 	struct mei *me = to_mei(handle);
 	struct metee_linux_intl *intl = to_intl(handle);
+	uint64_t op_start = __log_op_start(intl);
+	uint64_t start, ready, done;
+	struct metee_power *pw;
+	uint32_t power_gen;
+	size_t transferred = 0;
 	int ltimeout;
 	TEESTATUS status;
-	ssize_t rc;
-
-	if (!handle) {
-		return TEE_INVALID_PARAMETER;
-	}
-
-	FUNC_ENTRY(handle);
-
-	if (!me || !buffer || !bufferSize) {
-		ERRPRINT(handle, "One of the parameters was illegal\n");
-		status = TEE_INVALID_PARAMETER;
-		goto End;
-	}
+	ssize_t rc = 0;
 
 	if (timeout > INT_MAX) {
 		ERRPRINT(handle, "Timeout is too big %u > %d \n", timeout, INT_MAX);
@@ -325,17 +893,20 @@ TEESTATUS TEEAPI TeeRead(IN PTEEHANDLE handle, IN OUT void *buffer, IN size_t bu
 
 	DBGPRINT(handle, "call read length = %zd\n", bufferSize);
 
+	start = stats_now();
 	ltimeout = (timeout) ? (int)timeout : -1;
 
-	rc = __mei_select(me, intl->cancel_pipe[1], true, ltimeout);
+	rc = __wait(intl, token, true, 0, ltimeout);
 	if (rc) {
 		status = errno2status(rc);
 		ERRPRINT(handle, "select failed with status %zd %s\n",
 				rc, strerror(-rc));
 		goto End;
 	}
+	ready = stats_now();
+	stats_hist(&intl->stats.read_wait, start, ready);
 
-	rc = mei_recv_msg(me, buffer, bufferSize);
+	rc = intl->ops->read(me, intl->priv, buffer, bufferSize);
 	if (rc < 0) {
 		status = errno2status(rc);
 		ERRPRINT(handle, "read failed with status %zd %s\n",
@@ -343,36 +914,43 @@ TEESTATUS TEEAPI TeeRead(IN PTEEHANDLE handle, IN OUT void *buffer, IN size_t bu
 		goto End;
 	}
 
+	done = stats_now();
+	stats_hist(&intl->stats.read, ready, done);
+	stats_add(&intl->stats.read_msgs, 1);
+	stats_add(&intl->stats.read_bytes, (uint64_t)rc);
+	stats_transact_end(&intl->stats, &intl->transact_start, done);
+	pw = __power_get(intl, &power_gen);
+	metee_power_response(pw, __log_now());
+	__power_put(intl, power_gen);
+
 	status = TEE_SUCCESS;
+	transferred = (size_t)rc;
 	DBGPRINT(handle, "read succeeded with result %zd\n", rc);
+	__capture(intl, METEE_CAPTURE_READ, buffer, transferred);
 	if (pNumOfBytesRead)
 		*pNumOfBytesRead = (size_t)rc;
 
 End:
-	FUNC_EXIT(handle, status);
+	__tee_op_end(handle, TEE_LOG_OP_READ, status, rc, transferred, op_start);
 	return status;
 }
 
-TEESTATUS TEEAPI TeeWrite(IN PTEEHANDLE handle, IN const void *buffer, IN size_t bufferSize,
-			  OUT OPTIONAL size_t *numberOfBytesWritten, IN OPTIONAL uint32_t timeout)
+static TEESTATUS __tee_write(PTEEHANDLE handle, const void *buffer, size_t bufferSize,
+			     size_t *numberOfBytesWritten, uint32_t timeout,
+			     struct tee_cancel_token *token)
 {
 	struct mei *me  =  to_mei(handle);
 	struct metee_linux_intl *intl = to_intl(handle);
+	uint64_t op_start = __log_op_start(intl);
+	uint64_t start, ready;
+	enum metee_power_state power;
+	uint64_t power_start = 0;
+	struct metee_power *pw;
+	uint32_t power_gen;
+	size_t transferred = 0;
 	int ltimeout;
 	TEESTATUS status;
-	ssize_t rc;
-
-	if (!handle) {
-		return TEE_INVALID_PARAMETER;
-	}
-
-	FUNC_ENTRY(handle);
-
-	if (!me || !buffer || !bufferSize) {
-		ERRPRINT(handle, "One of the parameters was illegal\n");
-		status = TEE_INVALID_PARAMETER;
-		goto End;
-	}
+	ssize_t rc = 0;
 
 	if (timeout > INT_MAX) {
 		ERRPRINT(handle, "Timeout is too big %u > %d \n", timeout, INT_MAX);
@@ -388,39 +966,57 @@ TEESTATUS TEEAPI TeeWrite(IN PTEEHANDLE handle, IN const void *buffer, IN size_t
 
 	DBGPRINT(handle, "call write length = %zd\n", bufferSize);
 
+	/* the write itself resumes the device, sample its state first */
+	pw = __power_get(intl, &power_gen);
+	power = metee_power_sample(pw);
+	__power_put(intl, power_gen);
+	if (power != METEE_POWER_UNKNOWN)
+		power_start = __log_now();
+	start = stats_now();
 	ltimeout = (timeout) ? (int)timeout : -1;
 
-	rc = __mei_select(me, intl->cancel_pipe[1], false, ltimeout);
+	rc = __wait(intl, token, false, bufferSize, ltimeout);
 	if (rc) {
 		status = errno2status(rc);
 		ERRPRINT(handle, "select failed with status %zd %s\n",
 				rc, strerror(-rc));
 		goto End;
 	}
+	ready = stats_now();
+	stats_hist(&intl->stats.write_wait, start, ready);
 
-	rc  = mei_send_msg(me, buffer, bufferSize);
+	rc = intl->ops->write(me, intl->priv, buffer, bufferSize);
 	if (rc < 0) {
 		status = errno2status(rc);
 		ERRPRINT(handle, "write failed with status %zd %s\n", rc, strerror(-rc));
 		goto End;
 	}
 
+	stats_hist(&intl->stats.write, ready, stats_now());
+	stats_add(&intl->stats.write_msgs, 1);
+	stats_add(&intl->stats.write_bytes, (uint64_t)rc);
+	stats_transact_start(&intl->transact_start, start);
+	if (power != METEE_POWER_UNKNOWN) {
+		pw = __power_get(intl, &power_gen);
+		metee_power_request(pw, power, power_start);
+		__power_put(intl, power_gen);
+	}
+
+	transferred = (size_t)rc;
+	__capture(intl, METEE_CAPTURE_WRITE, buffer, transferred);
 	if (numberOfBytesWritten)
 		*numberOfBytesWritten = (size_t)rc;
 
 	status = TEE_SUCCESS;
 End:
-	FUNC_EXIT(handle, status);
+	__tee_op_end(handle, TEE_LOG_OP_WRITE, status, rc, transferred, op_start);
 	return status;
 }
 
-TEESTATUS TEEAPI TeeFWStatus(IN PTEEHANDLE handle,
-			     IN uint32_t fwStatusNum, OUT uint32_t *fwStatus)
+TEESTATUS TEEAPI TeeRead(IN PTEEHANDLE handle, IN OUT void *buffer, IN size_t bufferSize,
+			 OUT OPTIONAL size_t *pNumOfBytesRead, IN OPTIONAL uint32_t timeout)
 {
-	struct mei *me = to_mei(handle);
 	TEESTATUS status;
-	uint32_t fwsts;
-	int rc;
 
 	if (!handle) {
 		return TEE_INVALID_PARAMETER;
@@ -428,38 +1024,23 @@ TEESTATUS TEEAPI TeeFWStatus(IN PTEEHANDLE handle,
 
 	FUNC_ENTRY(handle);
 
-	if (!me || !fwStatus) {
-		status = TEE_INVALID_PARAMETER;
+	if (!handle->handle || !buffer || !bufferSize) {
 		ERRPRINT(handle, "One of the parameters was illegal\n");
-		goto End;
-	}
-	if (fwStatusNum > MAX_FW_STATUS_NUM) {
 		status = TEE_INVALID_PARAMETER;
-		ERRPRINT(handle, "fwStatusNum should be 0..5\n");
-		goto End;
-	}
-
-	rc  = mei_fwstatus(me, fwStatusNum, &fwsts);
-	if (rc < 0) {
-		status = errno2status(rc);
-		ERRPRINT(handle, "fw status failed with status %d %s\n", rc, strerror(-rc));
+		__tee_op_end(handle, TEE_LOG_OP_READ, status, 0, 0, 0);
 		goto End;
 	}
 
-	*fwStatus = fwsts;
-	status = TEE_SUCCESS;
-
+	status = __tee_read(handle, buffer, bufferSize, pNumOfBytesRead, timeout, NULL);
 End:
 	FUNC_EXIT(handle, status);
 	return status;
 }
 
-TEESTATUS TEEAPI TeeGetTRC(IN PTEEHANDLE handle, OUT uint32_t* trc_val)
+TEESTATUS TEEAPI TeeWrite(IN PTEEHANDLE handle, IN const void *buffer, IN size_t bufferSize,
+			  OUT OPTIONAL size_t *numberOfBytesWritten, IN OPTIONAL uint32_t timeout)
 {
-	struct mei* me = to_mei(handle);
 	TEESTATUS status;
-	uint32_t trc;
-	int rc;
 
 	if (!handle) {
 		return TEE_INVALID_PARAMETER;
@@ -467,17 +1048,167 @@ TEESTATUS TEEAPI TeeGetTRC(IN PTEEHANDLE handle, OUT uint32_t* trc_val)
 
 	FUNC_ENTRY(handle);
 
-	if (!me || !trc_val) {
-		status = TEE_INVALID_PARAMETER;
+	if (!handle->handle || !buffer || !bufferSize) {
 		ERRPRINT(handle, "One of the parameters was illegal\n");
+		status = TEE_INVALID_PARAMETER;
+		__tee_op_end(handle, TEE_LOG_OP_WRITE, status, 0, 0, 0);
 		goto End;
 	}
 
-	rc = mei_gettrc(me, &trc);
-	if (rc < 0) {
-		status = errno2status(rc);
-		ERRPRINT(handle, "TRC get failed with status %d %s\n", rc, strerror(-rc));
-		goto End;
+	status = __tee_write(handle, buffer, bufferSize, numberOfBytesWritten, timeout, NULL);
+End:
+	FUNC_EXIT(handle, status);
+	return status;
+}
+
+TEESTATUS TEEAPI TeeReadEx(IN PTEEHANDLE handle, IN OUT void *buffer, IN size_t bufferSize,
+			   OUT OPTIONAL size_t *pNumOfBytesRead, IN OPTIONAL uint32_t timeout,
+			   IN OPTIONAL struct tee_cancel_token *token)
+{
+	TEESTATUS status;
+
+	if (!handle) {
+		return TEE_INVALID_PARAMETER;
+	}
+
+	FUNC_ENTRY(handle);
+
+	if (!handle->handle || !buffer || !bufferSize) {
+		ERRPRINT(handle, "One of the parameters was illegal\n");
+		status = TEE_INVALID_PARAMETER;
+		__tee_op_end(handle, TEE_LOG_OP_READ, status, 0, 0, 0);
+		goto End;
+	}
+
+	status = __tee_read(handle, buffer, bufferSize, pNumOfBytesRead, timeout, token);
+End:
+	FUNC_EXIT(handle, status);
+	return status;
+}
+
+TEESTATUS TEEAPI TeeWriteEx(IN PTEEHANDLE handle, IN const void *buffer, IN size_t bufferSize,
+			    OUT OPTIONAL size_t *numberOfBytesWritten, IN OPTIONAL uint32_t timeout,
+			    IN OPTIONAL struct tee_cancel_token *token)
+{
+	TEESTATUS status;
+
+	if (!handle) {
+		return TEE_INVALID_PARAMETER;
+	}
+
+	FUNC_ENTRY(handle);
+
+	if (!handle->handle || !buffer || !bufferSize) {
+		ERRPRINT(handle, "One of the parameters was illegal\n");
+		status = TEE_INVALID_PARAMETER;
+		__tee_op_end(handle, TEE_LOG_OP_WRITE, status, 0, 0, 0);
+		goto End;
+	}
+
+	status = __tee_write(handle, buffer, bufferSize, numberOfBytesWritten, timeout, token);
+End:
+	FUNC_EXIT(handle, status);
+	return status;
+}
+
+TEESTATUS TEEAPI TeeTransact(IN PTEEHANDLE handle, IN const void *request, IN size_t requestSize,
+			     IN OUT void *response, IN size_t responseSize,
+			     OUT OPTIONAL size_t *pNumOfBytesRead, IN OPTIONAL uint32_t timeout,
+			     IN OPTIONAL struct tee_cancel_token *token)
+{
+	struct timespec start;
+	TEESTATUS status;
+	int remaining = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	status = TeeWriteEx(handle, request, requestSize, NULL, timeout, token);
+	if (status)
+		return status;
+	/* write and read share the timeout */
+	if (timeout) {
+		remaining = metee_backend_remaining(&start, (int)timeout);
+		if (!remaining)
+			remaining = 1;
+	}
+	return TeeReadEx(handle, response, responseSize, pNumOfBytesRead, (uint32_t)remaining, token);
+}
+
+TEESTATUS TEEAPI TeeFWStatus(IN PTEEHANDLE handle,
+			     IN uint32_t fwStatusNum, OUT uint32_t *fwStatus)
+{
+	struct mei *me = to_mei(handle);
+	struct metee_linux_intl *intl = to_intl(handle);
+	TEESTATUS status;
+	uint32_t fwsts;
+	int rc;
+
+	if (!handle) {
+		return TEE_INVALID_PARAMETER;
+	}
+
+	FUNC_ENTRY(handle);
+
+	if (!me || !fwStatus) {
+		status = TEE_INVALID_PARAMETER;
+		ERRPRINT(handle, "One of the parameters was illegal\n");
+		goto End;
+	}
+	if (fwStatusNum > MAX_FW_STATUS_NUM) {
+		status = TEE_INVALID_PARAMETER;
+		ERRPRINT(handle, "fwStatusNum should be 0..5\n");
+		goto End;
+	}
+	if (!intl->ops->fwstatus) {
+		status = TEE_NOTSUPPORTED;
+		DBGPRINT(handle, "Not supported by %s backend\n", intl->ops->name);
+		goto End;
+	}
+
+	rc = intl->ops->fwstatus(me, intl->priv, fwStatusNum, &fwsts);
+	if (rc < 0) {
+		status = errno2status(rc);
+		ERRPRINT(handle, "fw status failed with status %d %s\n", rc, strerror(-rc));
+		goto End;
+	}
+
+	*fwStatus = fwsts;
+	status = TEE_SUCCESS;
+
+End:
+	FUNC_EXIT(handle, status);
+	return status;
+}
+
+TEESTATUS TEEAPI TeeGetTRC(IN PTEEHANDLE handle, OUT uint32_t* trc_val)
+{
+	struct mei* me = to_mei(handle);
+	struct metee_linux_intl *intl = to_intl(handle);
+	TEESTATUS status;
+	uint32_t trc;
+	int rc;
+
+	if (!handle) {
+		return TEE_INVALID_PARAMETER;
+	}
+
+	FUNC_ENTRY(handle);
+
+	if (!me || !trc_val) {
+		status = TEE_INVALID_PARAMETER;
+		ERRPRINT(handle, "One of the parameters was illegal\n");
+		goto End;
+	}
+	if (!intl->ops->trc) {
+		status = TEE_NOTSUPPORTED;
+		DBGPRINT(handle, "Not supported by %s backend\n", intl->ops->name);
+		goto End;
+	}
+
+	rc = intl->ops->trc(me, intl->priv, &trc);
+	if (rc < 0) {
+		status = errno2status(rc);
+		ERRPRINT(handle, "TRC get failed with status %d %s\n", rc, strerror(-rc));
+		goto End;
 	}
 
 	*trc_val = trc;
@@ -491,9 +1222,8 @@ End:
 static void __TeeCancelIO(PTEEHANDLE handle)
 {
 	struct metee_linux_intl* intl = to_intl(handle);
-	const char buf[] = "X";
 
-	if (write(intl->cancel_pipe[1], buf, sizeof(buf)) < 0) {
+	if (!__cancel_wake(intl)) {
 		ERRPRINT(handle, "Pipe write failed\n");
 	}
 }
@@ -519,17 +1249,88 @@ void TEEAPI TeeDisconnect(PTEEHANDLE handle)
 
 	FUNC_ENTRY(handle);
 	if (intl) {
+		metee_hotplug_watch_del(&intl->hotplug);
 		__TeeCancelIO(handle);
-		mei_deinit(&intl->me);
+		metee_capture_close(intl->capture);
+		intl->ops->close(&intl->me, intl->priv);
 		close(intl->cancel_pipe[0]);
 		close(intl->cancel_pipe[1]);
-		free(intl);
+		if (intl->devstate_fd != -1)
+			close(intl->devstate_fd);
+		metee_power_close(&intl->power[0]);
+		metee_power_close(&intl->power[1]);
+		__intl_free(intl);
 		handle->handle = NULL;
 	}
 
 	FUNC_EXIT(handle, TEE_SUCCESS);
 }
 
+TEESTATUS TEEAPI TeeCancelTokenCreate(OUT struct tee_cancel_token **token)
+{
+	struct tee_cancel_token *t;
+
+	if (!token)
+		return TEE_INVALID_PARAMETER;
+
+	t = calloc(1, sizeof(*t));
+	if (!t)
+		return TEE_INTERNAL_ERROR;
+	t->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (t->fd < 0) {
+		free(t);
+		return TEE_INTERNAL_ERROR;
+	}
+	*token = t;
+	return TEE_SUCCESS;
+}
+
+void TEEAPI TeeCancelTokenFree(IN struct tee_cancel_token *token)
+{
+	if (!token)
+		return;
+	close(token->fd);
+	free(token);
+}
+
+TEESTATUS TEEAPI TeeCancelTokenSetDeadline(IN struct tee_cancel_token *token, IN uint32_t timeout)
+{
+	if (!token)
+		return TEE_INVALID_PARAMETER;
+	__atomic_store_n(&token->deadline, timeout ? __log_now() + (uint64_t)timeout * 1000 : 0,
+			 __ATOMIC_RELAXED);
+	return TEE_SUCCESS;
+}
+
+void TEEAPI TeeCancelTokenCancel(IN struct tee_cancel_token *token)
+{
+	if (token)
+		__token_cancel(token);
+}
+
+void TEEAPI TeeCancelTokenReset(IN struct tee_cancel_token *token)
+{
+	uint64_t value;
+
+	if (!token)
+		return;
+	__atomic_store_n(&token->deadline, 0, __ATOMIC_RELAXED);
+	/* flag first: a cancel racing with the drain leaves both set or both clear */
+	__atomic_store_n(&token->canceled, false, __ATOMIC_RELEASE);
+	if (read(token->fd, &value, sizeof(value)) < 0 && errno != EAGAIN)
+		return;
+	if (__atomic_load_n(&token->canceled, __ATOMIC_ACQUIRE)) {
+		value = 1;
+		if (write(token->fd, &value, sizeof(value)) < 0)
+			return;
+	}
+}
+
+bool TEEAPI TeeCancelTokenIsCanceled(IN struct tee_cancel_token *token)
+{
+	return token && __token_canceled(token, __log_now());
+}
+
 TEE_DEVICE_HANDLE TEEAPI TeeGetDeviceHandle(IN PTEEHANDLE handle)
 {
 	struct mei *me = to_mei(handle);
@@ -674,6 +1475,59 @@ Cleanup:
 	return status;
 }
 
+TEESTATUS TEEAPI TeeSetLogCallback3(IN const PTEEHANDLE handle, IN OPTIONAL TeeLogCallback3 log_callback,
+				    IN OPTIONAL void *ctx)
+{
+	struct metee_linux_intl *intl = to_intl(handle);
+	TEESTATUS status;
+
+	if (!handle) {
+		return TEE_INVALID_PARAMETER;
+	}
+
+	FUNC_ENTRY(handle);
+
+	if (!intl) {
+		status = TEE_INVALID_PARAMETER;
+		ERRPRINT(handle, "One of the parameters was illegal\n");
+		goto Cleanup;
+	}
+
+	intl->log_callback3 = log_callback;
+	intl->log_ctx = ctx;
+	mei_set_log_callback3(&intl->me, log_callback ? __mei_log_callback3 : NULL, intl);
+	status = TEE_SUCCESS;
+
+Cleanup:
+	FUNC_EXIT(handle, status);
+	return status;
+}
+
+TEESTATUS TEEAPI TeeLogEventFormat(IN const struct tee_log_event *event, OUT char *buf, IN size_t size)
+{
+	static const char *op_names[] = {"message", "connect", "read", "write"};
+	va_list varl;
+	int rc;
+
+	if (!event || !buf || !size)
+		return TEE_INVALID_PARAMETER;
+
+	if (event->op == TEE_LOG_OP_MESSAGE) {
+		if (!event->fmt || !event->args)
+			return TEE_INVALID_PARAMETER;
+		va_copy(varl, *(va_list *)event->args);
+		rc = vsnprintf(buf, size, event->fmt, varl);
+		va_end(varl);
+	} else if ((size_t)event->op < sizeof(op_names) / sizeof(op_names[0])) {
+		rc = snprintf(buf, size, "%s status %u error %d bytes %zu in %llu us\n",
+			      op_names[event->op], event->status, event->error, event->bytes,
+			      (unsigned long long)event->duration_us);
+	} else {
+		return TEE_INVALID_PARAMETER;
+	}
+	return (rc < 0) ? TEE_INTERNAL_ERROR : TEE_SUCCESS;
+}
+
 uint32_t TEEAPI TeeGetMaxMsgLen(IN const PTEEHANDLE handle)
 {
 	if (!handle) {
@@ -693,6 +1547,7 @@ uint8_t TEEAPI TeeGetProtocolVer(IN const PTEEHANDLE handle)
 TEESTATUS TEEAPI TeeGetKind(IN PTEEHANDLE handle, IN OUT char *kind, IN OUT size_t *kindSize)
 {
 	struct mei* me = to_mei(handle);
+	struct metee_linux_intl *intl = to_intl(handle);
 	TEESTATUS status;
 	int rc;
 
@@ -707,8 +1562,13 @@ TEESTATUS TEEAPI TeeGetKind(IN PTEEHANDLE handle, IN OUT char *kind, IN OUT size
 		ERRPRINT(handle, "One of the parameters was illegal\n");
 		goto End;
 	}
+	if (!intl->ops->kind) {
+		status = TEE_NOTSUPPORTED;
+		DBGPRINT(handle, "Not supported by %s backend\n", intl->ops->name);
+		goto End;
+	}
 
-	rc = mei_getkind(me, kind, kindSize);
+	rc = intl->ops->kind(me, intl->priv, kind, kindSize);
 	if (rc < 0) {
 		status = errno2status(rc);
 		if (status == TEE_INSUFFICIENT_BUFFER) {
@@ -724,4 +1584,622 @@ TEESTATUS TEEAPI TeeGetKind(IN PTEEHANDLE handle, IN OUT char *kind, IN OUT size
 End:
 	FUNC_EXIT(handle, status);
 	return status;
-}
\ No newline at end of file
+}
+
+TEESTATUS TEEAPI TeeGetStats(IN PTEEHANDLE handle, OUT struct tee_stats *stats)
+{
+	struct metee_linux_intl *intl = to_intl(handle);
+	TEESTATUS status;
+
+	if (!handle) {
+		return TEE_INVALID_PARAMETER;
+	}
+
+	FUNC_ENTRY(handle);
+
+	if (!intl || !stats) {
+		ERRPRINT(handle, "One of the parameters was illegal\n");
+		status = TEE_INVALID_PARAMETER;
+		goto End;
+	}
+
+#ifdef METEE_STATS
+	stats_snapshot(&intl->stats, stats);
+	status = TEE_SUCCESS;
+#else
+	DBGPRINT(handle, "Statistics are not compiled in\n");
+	status = TEE_NOTSUPPORTED;
+#endif
+
+End:
+	FUNC_EXIT(handle, status);
+	return status;
+}
+
+TEESTATUS TEEAPI TeeCaptureStart(IN PTEEHANDLE handle, IN const char *path)
+{
+	struct metee_linux_intl *intl = to_intl(handle);
+	struct metee_capture *cap = NULL;
+	TEESTATUS status;
+
+	if (!handle) {
+		return TEE_INVALID_PARAMETER;
+	}
+
+	FUNC_ENTRY(handle);
+
+	if (!intl || !path) {
+		ERRPRINT(handle, "One of the parameters was illegal\n");
+		status = TEE_INVALID_PARAMETER;
+		goto End;
+	}
+	if (__atomic_load_n(&intl->capture, __ATOMIC_RELAXED)) {
+		ERRPRINT(handle, "Capture is already running\n");
+		status = TEE_BUSY;
+		goto End;
+	}
+
+	status = metee_capture_open(path, &cap);
+	if (status) {
+		ERRPRINT(handle, "Cannot open capture file %s, status %u\n", path, status);
+		goto End;
+	}
+
+	pthread_mutex_lock(&intl->capture_lock);
+	if (intl->capture) {
+		pthread_mutex_unlock(&intl->capture_lock);
+		metee_capture_close(cap);
+		ERRPRINT(handle, "Capture is already running\n");
+		status = TEE_BUSY;
+		goto End;
+	}
+	__atomic_store_n(&intl->capture, cap, __ATOMIC_RELAXED);
+	pthread_mutex_unlock(&intl->capture_lock);
+	/* replay needs the connection parameters of the session in progress */
+	if (intl->me.state == MEI_CL_STATE_CONNECTED)
+		__capture_connect(intl);
+	status = TEE_SUCCESS;
+
+End:
+	FUNC_EXIT(handle, status);
+	return status;
+}
+
+TEESTATUS TEEAPI TeeCaptureStop(IN PTEEHANDLE handle)
+{
+	struct metee_linux_intl *intl = to_intl(handle);
+	struct metee_capture *cap;
+	TEESTATUS status;
+
+	if (!handle) {
+		return TEE_INVALID_PARAMETER;
+	}
+
+	FUNC_ENTRY(handle);
+
+	if (!intl) {
+		ERRPRINT(handle, "One of the parameters was illegal\n");
+		status = TEE_INVALID_PARAMETER;
+		goto End;
+	}
+
+	pthread_mutex_lock(&intl->capture_lock);
+	cap = intl->capture;
+	__atomic_store_n(&intl->capture, NULL, __ATOMIC_RELAXED);
+	pthread_mutex_unlock(&intl->capture_lock);
+	metee_capture_close(cap);
+	status = TEE_SUCCESS;
+
+End:
+	FUNC_EXIT(handle, status);
+	return status;
+}
+
+/* transport backend under the fault injector */
+static const struct metee_backend_ops *__inner_ops(struct metee_linux_intl *intl, void **priv)
+{
+	if (intl->ops == &metee_backend_fault)
+		return metee_fault_inner(intl->priv, priv);
+	*priv = intl->priv;
+	return intl->ops;
+}
+
+TEESTATUS TEEAPI TeeReplaySetSpeed(IN PTEEHANDLE handle, IN uint32_t speed)
+{
+	struct metee_linux_intl *intl = to_intl(handle);
+	TEESTATUS status;
+	void *priv;
+
+	if (!handle) {
+		return TEE_INVALID_PARAMETER;
+	}
+
+	FUNC_ENTRY(handle);
+
+	if (!intl || __inner_ops(intl, &priv) != &metee_backend_replay) {
+		ERRPRINT(handle, "The handle does not replay a capture\n");
+		status = TEE_INVALID_PARAMETER;
+		goto End;
+	}
+
+	metee_replay_set_speed(priv, speed);
+	status = TEE_SUCCESS;
+
+End:
+	FUNC_EXIT(handle, status);
+	return status;
+}
+
+TEESTATUS TEEAPI TeeFaultStart(IN PTEEHANDLE handle, IN const struct tee_fault_config *config)
+{
+	struct metee_linux_intl *intl = to_intl(handle);
+	struct metee_fault *fault;
+	TEESTATUS status;
+
+	if (!handle) {
+		return TEE_INVALID_PARAMETER;
+	}
+
+	FUNC_ENTRY(handle);
+
+	if (!intl || !config) {
+		ERRPRINT(handle, "One of the parameters was illegal\n");
+		status = TEE_INVALID_PARAMETER;
+		goto End;
+	}
+	if (intl->ops == &metee_backend_fault) {
+		ERRPRINT(handle, "Fault injection is already running\n");
+		status = TEE_BUSY;
+		goto End;
+	}
+
+	status = metee_fault_create(config, intl->ops, intl->priv, &fault);
+	if (status) {
+		ERRPRINT(handle, "Cannot start fault injection, status %u\n", status);
+		goto End;
+	}
+	intl->ops = &metee_backend_fault;
+	intl->priv = fault;
+	status = TEE_SUCCESS;
+
+End:
+	FUNC_EXIT(handle, status);
+	return status;
+}
+
+TEESTATUS TEEAPI TeeFaultStop(IN PTEEHANDLE handle)
+{
+	struct metee_linux_intl *intl = to_intl(handle);
+	TEESTATUS status;
+
+	if (!handle) {
+		return TEE_INVALID_PARAMETER;
+	}
+
+	FUNC_ENTRY(handle);
+
+	if (!intl) {
+		ERRPRINT(handle, "One of the parameters was illegal\n");
+		status = TEE_INVALID_PARAMETER;
+		goto End;
+	}
+
+	if (intl->ops == &metee_backend_fault)
+		metee_fault_destroy(intl->priv, &intl->me, &intl->ops, &intl->priv);
+	status = TEE_SUCCESS;
+
+End:
+	FUNC_EXIT(handle, status);
+	return status;
+}
+
+TEESTATUS TEEAPI TeeFaultGetStats(IN PTEEHANDLE handle, OUT struct tee_fault_stats *stats)
+{
+	struct metee_linux_intl *intl = to_intl(handle);
+	TEESTATUS status;
+
+	if (!handle) {
+		return TEE_INVALID_PARAMETER;
+	}
+
+	FUNC_ENTRY(handle);
+
+	if (!intl || !stats) {
+		ERRPRINT(handle, "One of the parameters was illegal\n");
+		status = TEE_INVALID_PARAMETER;
+		goto End;
+	}
+	if (intl->ops != &metee_backend_fault) {
+		ERRPRINT(handle, "Fault injection is not running\n");
+		status = TEE_INVALID_PARAMETER;
+		goto End;
+	}
+
+	metee_fault_get_stats(intl->priv, stats);
+	status = TEE_SUCCESS;
+
+End:
+	FUNC_EXIT(handle, status);
+	return status;
+}
+
+TEESTATUS TEEAPI TeeHotplugBind(IN PTEEHANDLE handle, IN OPTIONAL const char *name)
+{
+	struct metee_linux_intl *intl = to_intl(handle);
+	const char *slash = (name) ? strrchr(name, '/') : NULL;
+	TEESTATUS status;
+
+	if (!handle) {
+		return TEE_INVALID_PARAMETER;
+	}
+
+	FUNC_ENTRY(handle);
+
+	if (!intl) {
+		ERRPRINT(handle, "One of the parameters was illegal\n");
+		status = TEE_INVALID_PARAMETER;
+		goto End;
+	}
+	if (name && strlen((slash) ? slash + 1 : name) >= METEE_HOTPLUG_NAME_LEN) {
+		ERRPRINT(handle, "Device name is too long\n");
+		status = TEE_INVALID_PARAMETER;
+		goto End;
+	}
+
+	metee_hotplug_watch_del(&intl->hotplug);
+	__hotplug_bind(intl, name);
+	status = TEE_SUCCESS;
+
+End:
+	FUNC_EXIT(handle, status);
+	return status;
+}
+
+TEESTATUS TEEAPI TeeHotplugWait(IN PTEEHANDLE handle, IN OPTIONAL uint32_t timeout)
+{
+	struct metee_linux_intl *intl = to_intl(handle);
+	TEESTATUS status;
+	int rc;
+
+	if (!handle) {
+		return TEE_INVALID_PARAMETER;
+	}
+
+	FUNC_ENTRY(handle);
+
+	if (!intl) {
+		ERRPRINT(handle, "One of the parameters was illegal\n");
+		status = TEE_INVALID_PARAMETER;
+		goto End;
+	}
+	if (timeout > INT_MAX) {
+		ERRPRINT(handle, "Timeout is too big %u > %d \n", timeout, INT_MAX);
+		status = TEE_INVALID_PARAMETER;
+		goto End;
+	}
+
+	rc = metee_hotplug_wait(&intl->hotplug, (timeout) ? (int)timeout : -1);
+	if (rc) {
+		DBGPRINT(handle, "Device %s wait failed, rc = %d\n", intl->hotplug.name, rc);
+		status = errno2status(rc);
+		goto End;
+	}
+	status = TEE_SUCCESS;
+
+End:
+	FUNC_EXIT(handle, status);
+	return status;
+}
+
+TEESTATUS TEEAPI TeeSetDevStatePolicy(IN PTEEHANDLE handle, IN uint32_t policy)
+{
+	struct metee_linux_intl *intl = to_intl(handle);
+	TEESTATUS status;
+
+	if (!handle) {
+		return TEE_INVALID_PARAMETER;
+	}
+
+	FUNC_ENTRY(handle);
+
+	if (!intl || policy >= TEE_DEVSTATE_MAX) {
+		ERRPRINT(handle, "One of the parameters was illegal\n");
+		status = TEE_INVALID_PARAMETER;
+		goto End;
+	}
+
+	__atomic_store_n(&intl->devstate_policy, policy, __ATOMIC_RELAXED);
+	status = TEE_SUCCESS;
+
+End:
+	FUNC_EXIT(handle, status);
+	return status;
+}
+
+TEESTATUS TEEAPI TeeGetDevState(IN PTEEHANDLE handle, IN OUT char *state, IN OUT size_t *stateSize)
+{
+	struct metee_linux_intl *intl = to_intl(handle);
+	char buf[DEVSTATE_LEN];
+	TEESTATUS status;
+	uint32_t gen;
+	size_t len;
+	int fd;
+	int rc;
+
+	if (!handle) {
+		return TEE_INVALID_PARAMETER;
+	}
+
+	FUNC_ENTRY(handle);
+
+	if (!intl || !stateSize) {
+		ERRPRINT(handle, "One of the parameters was illegal\n");
+		status = TEE_INVALID_PARAMETER;
+		goto End;
+	}
+	fd = __devstate_get(intl, &gen);
+	if (fd < 0) {
+		DBGPRINT(handle, "The device state is unknown\n");
+		status = TEE_NOTSUPPORTED;
+		goto End;
+	}
+
+	rc = __devstate_read(fd, buf, sizeof(buf));
+	__devstate_put(intl, gen);
+	if (rc < 0) {
+		ERRPRINT(handle, "dev_state read failed with status %d %s\n", rc, strerror(-rc));
+		status = TEE_INTERNAL_ERROR;
+		goto End;
+	}
+	len = (size_t)rc + 1;
+	if (!state || *stateSize < len) {
+		DBGPRINT(handle, "Insufficient buffer %zu\n", *stateSize);
+		*stateSize = len;
+		status = TEE_INSUFFICIENT_BUFFER;
+		goto End;
+	}
+	memcpy(state, buf, len);
+	*stateSize = len;
+	status = TEE_SUCCESS;
+
+End:
+	FUNC_EXIT(handle, status);
+	return status;
+}
+
+TEESTATUS TEEAPI TeeDevStateBind(IN PTEEHANDLE handle, IN OPTIONAL const char *path)
+{
+	struct metee_linux_intl *intl = to_intl(handle);
+	TEESTATUS status;
+	uint32_t gen;
+	int old_fd;
+	int fd = -1;
+
+	if (!handle) {
+		return TEE_INVALID_PARAMETER;
+	}
+
+	FUNC_ENTRY(handle);
+
+	if (!intl) {
+		ERRPRINT(handle, "One of the parameters was illegal\n");
+		status = TEE_INVALID_PARAMETER;
+		goto End;
+	}
+	if (path) {
+		fd = open(path, O_RDONLY | O_CLOEXEC);
+		if (fd == -1) {
+			ERRPRINT(handle, "Cannot open %s, errno = %d %s\n", path, errno, strerror(errno));
+			status = (errno == EACCES) ? TEE_PERMISSION_DENIED : TEE_DEVICE_NOT_FOUND;
+			goto End;
+		}
+	}
+
+	pthread_mutex_lock(&intl->devstate_lock);
+	old_fd = intl->devstate_fd;
+	__atomic_store_n(&intl->devstate_fd, fd, __ATOMIC_RELAXED);
+	gen = intl->devstate_gen++;
+	/* gates holding the old descriptor let it go within one poll slice */
+	while (intl->devstate_users[gen & 1])
+		pthread_cond_wait(&intl->devstate_idle, &intl->devstate_lock);
+	pthread_mutex_unlock(&intl->devstate_lock);
+	if (old_fd != -1)
+		close(old_fd);
+	status = TEE_SUCCESS;
+
+End:
+	FUNC_EXIT(handle, status);
+	return status;
+}
+
+TEESTATUS TEEAPI TeePowerPin(IN PTEEHANDLE handle)
+{
+	struct metee_linux_intl *intl = to_intl(handle);
+	struct metee_power *pw;
+	TEESTATUS status;
+	uint32_t gen;
+	int rc;
+
+	if (!handle) {
+		return TEE_INVALID_PARAMETER;
+	}
+
+	FUNC_ENTRY(handle);
+
+	if (!intl) {
+		ERRPRINT(handle, "One of the parameters was illegal\n");
+		status = TEE_INVALID_PARAMETER;
+		goto End;
+	}
+
+	pw = __power_get(intl, &gen);
+	rc = metee_power_pin(pw);
+	__power_put(intl, gen);
+	if (rc) {
+		ERRPRINT(handle, "Cannot pin the device, rc = %d %s\n", rc, strerror(-rc));
+		status = errno2status(rc);
+		goto End;
+	}
+	status = TEE_SUCCESS;
+
+End:
+	FUNC_EXIT(handle, status);
+	return status;
+}
+
+TEESTATUS TEEAPI TeePowerUnpin(IN PTEEHANDLE handle)
+{
+	struct metee_linux_intl *intl = to_intl(handle);
+	struct metee_power *pw;
+	TEESTATUS status;
+	uint32_t gen;
+	int rc;
+
+	if (!handle) {
+		return TEE_INVALID_PARAMETER;
+	}
+
+	FUNC_ENTRY(handle);
+
+	if (!intl) {
+		ERRPRINT(handle, "One of the parameters was illegal\n");
+		status = TEE_INVALID_PARAMETER;
+		goto End;
+	}
+
+	pw = __power_get(intl, &gen);
+	rc = metee_power_unpin(pw);
+	__power_put(intl, gen);
+	if (rc) {
+		ERRPRINT(handle, "Cannot unpin the device, rc = %d %s\n", rc, strerror(-rc));
+		status = errno2status(rc);
+		goto End;
+	}
+	status = TEE_SUCCESS;
+
+End:
+	FUNC_EXIT(handle, status);
+	return status;
+}
+
+TEESTATUS TEEAPI TeePowerPreWake(IN PTEEHANDLE handle)
+{
+	struct metee_linux_intl *intl = to_intl(handle);
+	struct metee_power *pw;
+	TEESTATUS status;
+	uint32_t gen;
+	int rc;
+
+	if (!handle) {
+		return TEE_INVALID_PARAMETER;
+	}
+
+	FUNC_ENTRY(handle);
+
+	if (!intl) {
+		ERRPRINT(handle, "One of the parameters was illegal\n");
+		status = TEE_INVALID_PARAMETER;
+		goto End;
+	}
+
+	pw = __power_get(intl, &gen);
+	rc = metee_power_prewake(pw);
+	__power_put(intl, gen);
+	if (rc) {
+		ERRPRINT(handle, "Cannot wake the device, rc = %d %s\n", rc, strerror(-rc));
+		status = errno2status(rc);
+		goto End;
+	}
+	status = TEE_SUCCESS;
+
+End:
+	FUNC_EXIT(handle, status);
+	return status;
+}
+
+TEESTATUS TEEAPI TeeGetPowerStats(IN PTEEHANDLE handle, OUT struct tee_power_stats *stats)
+{
+	struct metee_linux_intl *intl = to_intl(handle);
+	struct metee_power *pw;
+	TEESTATUS status;
+	uint32_t gen;
+
+	if (!handle) {
+		return TEE_INVALID_PARAMETER;
+	}
+
+	FUNC_ENTRY(handle);
+
+	if (!intl || !stats) {
+		ERRPRINT(handle, "One of the parameters was illegal\n");
+		status = TEE_INVALID_PARAMETER;
+		goto End;
+	}
+
+#ifdef METEE_STATS
+	pw = __power_get(intl, &gen);
+	metee_power_get_stats(pw, stats);
+	__power_put(intl, gen);
+	status = TEE_SUCCESS;
+#else
+	DBGPRINT(handle, "Statistics are not compiled in\n");
+	status = TEE_NOTSUPPORTED;
+#endif
+
+End:
+	FUNC_EXIT(handle, status);
+	return status;
+}
+
+TEESTATUS TEEAPI TeePowerBind(IN PTEEHANDLE handle, IN OPTIONAL const char *dir)
+{
+	struct metee_linux_intl *intl = to_intl(handle);
+	struct metee_power *cur, *next;
+	TEESTATUS status;
+	uint32_t gen;
+	int rc;
+
+	if (!handle) {
+		return TEE_INVALID_PARAMETER;
+	}
+
+	FUNC_ENTRY(handle);
+
+	if (!intl) {
+		ERRPRINT(handle, "One of the parameters was illegal\n");
+		status = TEE_INVALID_PARAMETER;
+		goto End;
+	}
+
+	/* the slot of the other parity is idle since the previous bind */
+	cur = &intl->power[intl->power_gen & 1];
+	next = &intl->power[(intl->power_gen + 1) & 1];
+	rc = metee_power_open(next, dir);
+	if (rc) {
+		ERRPRINT(handle, "Cannot open power directory %s, rc = %d %s\n", dir, rc, strerror(-rc));
+		status = errno2status_init(rc);
+		goto End;
+	}
+	if (cur->pinned && next->dir) {
+		rc = metee_power_pin(next);
+		if (rc) {
+			ERRPRINT(handle, "Cannot pin the device, rc = %d %s\n", rc, strerror(-rc));
+			metee_power_close(next);
+			status = errno2status(rc);
+			goto End;
+		}
+	}
+
+	pthread_mutex_lock(&intl->power_lock);
+	gen = intl->power_gen++;
+	while (intl->power_users[gen & 1])
+		pthread_cond_wait(&intl->power_idle, &intl->power_lock);
+	pthread_mutex_unlock(&intl->power_lock);
+	metee_power_move(next, cur);
+	metee_power_close(cur);
+	status = TEE_SUCCESS;
+
+End:
+	FUNC_EXIT(handle, status);
+	return status;
+}
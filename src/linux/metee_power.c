@@ -0,0 +1,309 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "metee.h"
+#include "metee_power.h"
+#include "metee_stats.h"
+
+#define POWER_VALUE_LEN 32
+
+/* device pinned by handles of the process */
+struct power_pin {
+	struct power_pin *next;
+	char *dir;
+	unsigned int count;
+	char saved[POWER_VALUE_LEN]; /* control value before the first pin */
+};
+
+static pthread_mutex_t power_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct power_pin *power_pins;
+
+static int power_path(char *path, size_t size, const char *dir, const char *attr)
+{
+	int len = snprintf(path, size, "%s/%s", dir, attr);
+
+	return (len < 0 || (size_t)len >= size) ? -ENAMETOOLONG : 0;
+}
+
+/* attribute value without new line */
+static int power_read(int fd, char *value, size_t size)
+{
+	ssize_t len;
+
+	len = pread(fd, value, size - 1, 0);
+	if (len < 0)
+		return -errno;
+	while (len > 0 && (value[len - 1] == '\n' || value[len - 1] == ' '))
+		len--;
+	value[len] = '\0';
+	return 0;
+}
+
+static int power_read_attr(const char *dir, const char *attr, char *value, size_t size)
+{
+	char path[PATH_MAX];
+	int fd;
+	int rc;
+
+	rc = power_path(path, sizeof(path), dir, attr);
+	if (rc)
+		return rc;
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd == -1)
+		return -errno;
+	rc = power_read(fd, value, size);
+	close(fd);
+	return rc;
+}
+
+/* writing "on" resumes the device synchronously and keeps it resumed */
+static int power_write_attr(const char *dir, const char *attr, const char *value)
+{
+	char path[PATH_MAX];
+	size_t len = strlen(value);
+	int fd;
+	int rc;
+
+	rc = power_path(path, sizeof(path), dir, attr);
+	if (rc)
+		return rc;
+	fd = open(path, O_WRONLY | O_TRUNC | O_CLOEXEC);
+	if (fd == -1)
+		return -errno;
+	rc = (write(fd, value, len) == (ssize_t)len) ? 0 : -errno;
+	close(fd);
+	return rc;
+}
+
+static struct power_pin *power_find(const char *dir)
+{
+	struct power_pin *pin;
+
+	for (pin = power_pins; pin; pin = pin->next) {
+		if (!strcmp(pin->dir, dir))
+			return pin;
+	}
+	return NULL;
+}
+
+int metee_power_open(struct metee_power *pw, const char *dir)
+{
+	char path[PATH_MAX];
+	int rc;
+
+	memset(pw, 0, sizeof(*pw));
+	pw->status_fd = -1;
+	if (!dir)
+		return 0;
+	rc = power_path(path, sizeof(path), dir, "runtime_status");
+	if (rc)
+		return rc;
+	pw->status_fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (pw->status_fd == -1)
+		return -errno;
+	pw->dir = strdup(dir);
+	if (!pw->dir) {
+		close(pw->status_fd);
+		pw->status_fd = -1;
+		return -ENOMEM;
+	}
+	return 0;
+}
+
+void metee_power_close(struct metee_power *pw)
+{
+	if (pw->dir)
+		metee_power_unpin(pw);
+	if (pw->status_fd != -1)
+		close(pw->status_fd);
+	pw->status_fd = -1;
+	free(pw->dir);
+	pw->dir = NULL;
+}
+
+enum metee_power_state metee_power_state(struct metee_power *pw)
+{
+	char value[POWER_VALUE_LEN];
+
+	if (pw->status_fd == -1 || power_read(pw->status_fd, value, sizeof(value)))
+		return METEE_POWER_UNKNOWN;
+	if (!strcmp(value, "suspended") || !strcmp(value, "suspending") ||
+	    !strcmp(value, "resuming"))
+		return METEE_POWER_COLD;
+	return METEE_POWER_ACTIVE;
+}
+
+enum metee_power_state metee_power_sample(struct metee_power *pw)
+{
+#ifdef METEE_STATS
+	/* pinned devices are awake, spare the read */
+	if (__atomic_load_n(&pw->pinned, __ATOMIC_RELAXED))
+		return METEE_POWER_ACTIVE;
+	return metee_power_state(pw);
+#else /* METEE_STATS */
+	(void)pw;
+	return METEE_POWER_UNKNOWN;
+#endif /* METEE_STATS */
+}
+
+void metee_power_request(struct metee_power *pw, enum metee_power_state state, uint64_t start)
+{
+	if (state == METEE_POWER_UNKNOWN)
+		return;
+	__atomic_fetch_add(&pw->stats.requests, 1, __ATOMIC_RELAXED);
+	if (state == METEE_POWER_COLD)
+		__atomic_fetch_add(&pw->stats.cold_requests, 1, __ATOMIC_RELAXED);
+	__atomic_store_n(&pw->pending_cold, state == METEE_POWER_COLD, __ATOMIC_RELAXED);
+	__atomic_store_n(&pw->pending_start, start, __ATOMIC_RELEASE);
+}
+
+void metee_power_response(struct metee_power *pw, uint64_t now)
+{
+	uint64_t start = __atomic_exchange_n(&pw->pending_start, 0, __ATOMIC_ACQUIRE);
+
+	if (!start)
+		return;
+	metee_hist_add(__atomic_load_n(&pw->pending_cold, __ATOMIC_RELAXED) ?
+		       &pw->stats.cold_transact : &pw->stats.warm_transact, start, now);
+}
+
+int metee_power_pin(struct metee_power *pw)
+{
+	struct power_pin *pin;
+	int rc = 0;
+
+	if (!pw->dir)
+		return -EOPNOTSUPP;
+
+	pthread_mutex_lock(&power_lock);
+	if (pw->pinned)
+		goto out;
+	pin = power_find(pw->dir);
+	if (!pin) {
+		pin = calloc(1, sizeof(*pin));
+		if (!pin) {
+			rc = -ENOMEM;
+			goto out;
+		}
+		pin->dir = strdup(pw->dir);
+		if (!pin->dir) {
+			free(pin);
+			rc = -ENOMEM;
+			goto out;
+		}
+		rc = power_read_attr(pw->dir, "control", pin->saved, sizeof(pin->saved));
+		if (!rc)
+			rc = power_write_attr(pw->dir, "control", "on");
+		if (rc) {
+			free(pin->dir);
+			free(pin);
+			goto out;
+		}
+		pin->next = power_pins;
+		power_pins = pin;
+	}
+	pin->count++;
+	__atomic_store_n(&pw->pinned, true, __ATOMIC_RELAXED);
+out:
+	pthread_mutex_unlock(&power_lock);
+	return rc;
+}
+
+int metee_power_unpin(struct metee_power *pw)
+{
+	struct power_pin **p;
+	struct power_pin *pin;
+	int rc = 0;
+
+	if (!pw->dir)
+		return -EOPNOTSUPP;
+
+	pthread_mutex_lock(&power_lock);
+	if (!pw->pinned)
+		goto out;
+	__atomic_store_n(&pw->pinned, false, __ATOMIC_RELAXED);
+	for (p = &power_pins; *p; p = &(*p)->next) {
+		pin = *p;
+		if (strcmp(pin->dir, pw->dir))
+			continue;
+		if (--pin->count == 0) {
+			*p = pin->next;
+			rc = power_write_attr(pin->dir, "control", pin->saved);
+			free(pin->dir);
+			free(pin);
+		}
+		break;
+	}
+out:
+	pthread_mutex_unlock(&power_lock);
+	return rc;
+}
+
+int metee_power_prewake(struct metee_power *pw)
+{
+	char saved[POWER_VALUE_LEN];
+	bool cold;
+	int rc;
+
+	if (!pw->dir)
+		return -EOPNOTSUPP;
+
+	pthread_mutex_lock(&power_lock);
+	/* pinned devices are awake */
+	if (power_find(pw->dir)) {
+		rc = 0;
+		goto out;
+	}
+	cold = metee_power_state(pw) == METEE_POWER_COLD;
+	rc = power_read_attr(pw->dir, "control", saved, sizeof(saved));
+	if (rc)
+		goto out;
+	/* resume now, autosuspend runs again after its delay once the value is restored */
+	rc = power_write_attr(pw->dir, "control", "on");
+	if (rc)
+		goto out;
+	rc = power_write_attr(pw->dir, "control", saved);
+	if (!rc && cold)
+		__atomic_fetch_add(&pw->stats.prewakes, 1, __ATOMIC_RELAXED);
+out:
+	pthread_mutex_unlock(&power_lock);
+	return rc;
+}
+
+void metee_power_move(struct metee_power *to, struct metee_power *from)
+{
+	const uint64_t *src = (const uint64_t *)&from->stats;
+	uint64_t *dst = (uint64_t *)&to->stats;
+	uint64_t start = __atomic_exchange_n(&from->pending_start, 0, __ATOMIC_ACQUIRE);
+	uint64_t expected = 0;
+	size_t i;
+
+	for (i = 0; i < sizeof(to->stats) / sizeof(uint64_t); i++)
+		__atomic_fetch_add(&dst[i], __atomic_load_n(&src[i], __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+	/* the request waiting for its response, unless one was sent since */
+	if (start) {
+		__atomic_store_n(&to->pending_cold, from->pending_cold, __ATOMIC_RELAXED);
+		__atomic_compare_exchange_n(&to->pending_start, &expected, start, false,
+					    __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+	}
+}
+
+void metee_power_get_stats(const struct metee_power *pw, struct tee_power_stats *stats)
+{
+	const uint64_t *src = (const uint64_t *)&pw->stats;
+	uint64_t *dst = (uint64_t *)stats;
+	size_t i;
+
+	for (i = 0; i < sizeof(*stats) / sizeof(uint64_t); i++)
+		dst[i] = __atomic_load_n(&src[i], __ATOMIC_RELAXED);
+}
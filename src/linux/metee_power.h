@@ -0,0 +1,56 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+#ifndef __METEE_POWER_H
+#define __METEE_POWER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "metee.h"
+
+/*
+ * Runtime power management of the device behind a handle, through the
+ * power directory of its PCI device in sysfs. In statistics builds
+ * runtime_status is read through a cached descriptor on writes of
+ * unpinned handles to tell requests hitting a suspended device; pins set control to "on" and are counted per
+ * directory in the process, the last unpin restores the saved value.
+ */
+
+enum metee_power_state {
+	METEE_POWER_UNKNOWN = 0, /* no runtime_status attribute */
+	METEE_POWER_ACTIVE,
+	METEE_POWER_COLD, /* suspended, suspending or resuming */
+};
+
+struct metee_power {
+	char *dir; /* power directory, NULL if unknown */
+	int status_fd; /* runtime_status, -1 if unknown */
+	bool pinned; /* set under the process pin lock */
+	uint64_t pending_start; /* write start of the request waiting for its response, 0 if none */
+	bool pending_cold;
+	struct tee_power_stats stats;
+};
+
+/* dir NULL leaves the handle without power management */
+int metee_power_open(struct metee_power *pw, const char *dir);
+/* drops the pin of the handle */
+void metee_power_close(struct metee_power *pw);
+
+enum metee_power_state metee_power_state(struct metee_power *pw);
+/* state for the request statistics, UNKNOWN without METEE_STATS */
+enum metee_power_state metee_power_sample(struct metee_power *pw);
+/* successful write started at start, CLOCK_MONOTONIC microseconds */
+void metee_power_request(struct metee_power *pw, enum metee_power_state state, uint64_t start);
+/* successful read ending the request */
+void metee_power_response(struct metee_power *pw, uint64_t now);
+
+int metee_power_pin(struct metee_power *pw);
+int metee_power_unpin(struct metee_power *pw);
+int metee_power_prewake(struct metee_power *pw);
+/* adds the statistics and the pending request of from to to, from is idle */
+void metee_power_move(struct metee_power *to, struct metee_power *from);
+void metee_power_get_stats(const struct metee_power *pw, struct tee_power_stats *stats);
+
+#endif /* __METEE_POWER_H */
@@ -0,0 +1,110 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+#ifndef __METEE_STATS_H
+#define __METEE_STATS_H
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "metee.h"
+
+/* one sample of a histogram, for statistics kept in every build too */
+static inline void metee_hist_add(struct tee_stats_hist *hist, uint64_t start, uint64_t end)
+{
+	uint64_t us = (end > start) ? end - start : 0;
+
+	__atomic_fetch_add(&hist->count, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&hist->total_us, us, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&hist->buckets[TeeStatsHistBucket(us)], 1, __ATOMIC_RELAXED);
+}
+
+/*
+ * Per-handle counters are updated with relaxed atomics: TeeRead, TeeWrite
+ * and TeeGetStats may run on different threads, no ordering between
+ * counters is promised. Build without METEE_STATS removes all of it.
+ */
+
+#ifdef METEE_STATS
+
+static inline uint64_t stats_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+static inline void stats_add(uint64_t *counter, uint64_t value)
+{
+	__atomic_fetch_add(counter, value, __ATOMIC_RELAXED);
+}
+
+static inline void stats_hist(struct tee_stats_hist *hist, uint64_t start, uint64_t end)
+{
+	metee_hist_add(hist, start, end);
+}
+
+/* every connect after the first one of the handle is a reconnect */
+static inline void stats_connect(struct tee_stats *stats)
+{
+	if (__atomic_add_fetch(&stats->connects, 1, __ATOMIC_RELAXED) > 1)
+		stats_add(&stats->reconnects, 1);
+}
+
+static inline void stats_status(struct tee_stats *stats, TEESTATUS status)
+{
+	if (status == TEE_SUCCESS)
+		return;
+	if (status == TEE_TIMEOUT)
+		stats_add(&stats->timeouts, 1);
+	else if (status == TEE_UNABLE_TO_COMPLETE_OPERATION)
+		stats_add(&stats->cancels, 1);
+	stats_add(&stats->errors[(status < TEE_STATS_STATUS_MAX) ? status : TEE_STATS_STATUS_MAX - 1], 1);
+}
+
+static inline void stats_transact_start(uint64_t *start, uint64_t now)
+{
+	__atomic_store_n(start, now, __ATOMIC_RELAXED);
+}
+
+/* close transaction opened by the last write, a read without write is not a transaction */
+static inline void stats_transact_end(struct tee_stats *stats, uint64_t *start, uint64_t now)
+{
+	uint64_t begin = __atomic_exchange_n(start, 0, __ATOMIC_RELAXED);
+
+	if (begin)
+		stats_hist(&stats->transact, begin, now);
+}
+
+static inline void stats_snapshot(const struct tee_stats *stats, struct tee_stats *out)
+{
+	const uint64_t *src = (const uint64_t *)stats;
+	uint64_t *dst = (uint64_t *)out;
+	size_t i;
+
+	for (i = 0; i < sizeof(*stats) / sizeof(uint64_t); i++)
+		dst[i] = __atomic_load_n(&src[i], __ATOMIC_RELAXED);
+}
+
+#else /* METEE_STATS */
+
+static inline uint64_t stats_now(void) { return 0; }
+static inline void stats_add(uint64_t *counter, uint64_t value) { (void)counter; (void)value; }
+static inline void stats_hist(struct tee_stats_hist *hist, uint64_t start, uint64_t end)
+{
+	(void)hist; (void)start; (void)end;
+}
+static inline void stats_connect(struct tee_stats *stats) { (void)stats; }
+static inline void stats_status(struct tee_stats *stats, TEESTATUS status) { (void)stats; (void)status; }
+static inline void stats_transact_start(uint64_t *start, uint64_t now) { (void)start; (void)now; }
+static inline void stats_transact_end(struct tee_stats *stats, uint64_t *start, uint64_t now)
+{
+	(void)stats; (void)start; (void)now;
+}
+
+#endif /* METEE_STATS */
+
+#endif /* __METEE_STATS_H */
@@ -0,0 +1,570 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+#include <errno.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <time.h>
+
+#include "metee.h"
+#include "metee_trace.h"
+
+#ifdef METEE_TRACE
+
+#define TRACE_SIZE_MIN (4 * 1024)
+#define TRACE_SIZE_MAX (64 * 1024 * 1024)
+#define TRACE_ARGS_MAX 16
+#define TRACE_STR_MAX 128 /* stored bytes of one %s argument */
+#define TRACE_STRS_MAX 512 /* stored bytes of all %s arguments of one event */
+#define TRACE_MSG_LEN 1024
+#define TRACE_REC_PAD 1 /* filler up to the ring end */
+
+/*
+ * Multi-producer, single-consumer ring.
+ * A producer reserves space by moving head with compare-and-swap, fills
+ * the record and publishes it by storing its absolute position into pos
+ * last. The consumer delivers records in order while pos matches the
+ * expected position, then zeroes them and moves tail. A record never
+ * wraps: the space up to the ring end is filled with a pad record, or
+ * skipped implicitly when even the pad header does not fit.
+ */
+struct metee_trace {
+	uint64_t head __attribute__((aligned(64))); /* next free position */
+	uint64_t dropped;
+	uint64_t tail __attribute__((aligned(64))); /* oldest not drained position */
+	size_t size; /* power of two */
+	uint8_t *data;
+};
+
+struct trace_rec {
+	uint64_t pos; /* absolute position + 1, published last */
+	uint32_t len; /* whole record, 8 bytes aligned */
+	uint16_t nargs;
+	uint16_t flags;
+	/* fields below are absent in pad records */
+	uint64_t timestamp_ns;
+	uint64_t handle_id;
+	const struct metee_trace_site *site;
+	uint32_t str_len;
+	uint32_t payload_len;
+	uint64_t args[]; /* followed by %s bytes and payload */
+};
+
+#define TRACE_PAD_HDR offsetof(struct trace_rec, timestamp_ns)
+
+struct metee_trace *metee_trace_ring;
+static uint32_t trace_writers; /* producers that may still use the ring */
+static bool trace_busy; /* start, stop and drain in progress */
+
+enum trace_arg {
+	TRACE_ARG_NONE,
+	TRACE_ARG_INT,
+	TRACE_ARG_UINT,
+	TRACE_ARG_CHAR,
+	TRACE_ARG_DOUBLE,
+	TRACE_ARG_STR,
+	TRACE_ARG_PTR,
+};
+
+struct trace_spec {
+	const char *start; /* after '%' */
+	size_t len; /* up to and including conversion */
+	char conv;
+	char length; /* length modifier, 'H' for hh, 'q' for ll, 0 for none */
+	unsigned int stars; /* '*' width and precision */
+};
+
+/* parse conversion after '%', return pointer to the conversion character */
+static const char *trace_parse_spec(const char *p, struct trace_spec *spec)
+{
+	memset(spec, 0, sizeof(*spec));
+	spec->start = p;
+	while (*p && strchr("-+ #0'", *p))
+		p++;
+	for (; *p && (*p == '*' || *p == '.' || (*p >= '0' && *p <= '9')); p++)
+		if (*p == '*')
+			spec->stars++;
+	for (; *p && strchr("hljztLq", *p); p++) {
+		if (spec->length == *p && (*p == 'h' || *p == 'l'))
+			spec->length = (*p == 'h') ? 'H' : 'q';
+		else
+			spec->length = *p;
+	}
+	spec->conv = *p;
+	spec->len = (size_t)(p - spec->start) + (*p ? 1 : 0);
+	return *p ? p : p - 1;
+}
+
+static enum trace_arg trace_arg_kind(char conv)
+{
+	switch (conv) {
+	case 'd':
+	case 'i':
+		return TRACE_ARG_INT;
+	case 'u':
+	case 'o':
+	case 'x':
+	case 'X':
+		return TRACE_ARG_UINT;
+	case 'c':
+		return TRACE_ARG_CHAR;
+	case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+		return TRACE_ARG_DOUBLE;
+	case 's':
+		return TRACE_ARG_STR;
+	case 'p':
+		return TRACE_ARG_PTR;
+	default:
+		return TRACE_ARG_NONE;
+	}
+}
+
+static int64_t trace_va_int(char length, va_list *ap)
+{
+	switch (length) {
+	case 'l':
+		return va_arg(*ap, long);
+	case 'q':
+	case 'L':
+		return va_arg(*ap, long long);
+	case 'z':
+		return va_arg(*ap, ssize_t);
+	case 'j':
+		return va_arg(*ap, intmax_t);
+	case 't':
+		return va_arg(*ap, ptrdiff_t);
+	default:
+		return va_arg(*ap, int);
+	}
+}
+
+static uint64_t trace_va_uint(char length, va_list *ap)
+{
+	switch (length) {
+	case 'l':
+		return va_arg(*ap, unsigned long);
+	case 'q':
+	case 'L':
+		return va_arg(*ap, unsigned long long);
+	case 'z':
+		return va_arg(*ap, size_t);
+	case 'j':
+		return va_arg(*ap, uintmax_t);
+	case 't':
+		return (uint64_t)va_arg(*ap, ptrdiff_t);
+	default:
+		return va_arg(*ap, unsigned int);
+	}
+}
+
+/* store arguments as 64 bit values, strings are copied as they may not outlive the call */
+static uint16_t trace_capture(const char *fmt, va_list *ap, uint64_t *args,
+			      char *strs, uint32_t *str_len)
+{
+	struct trace_spec spec;
+	uint16_t n = 0;
+	unsigned int i;
+	const char *p;
+
+	*str_len = 0;
+	for (p = fmt; *p && n < TRACE_ARGS_MAX; p++) {
+		if (*p != '%')
+			continue;
+		p = trace_parse_spec(p + 1, &spec);
+		for (i = 0; i < spec.stars && n < TRACE_ARGS_MAX; i++)
+			args[n++] = (uint64_t)(int64_t)va_arg(*ap, int);
+		if (n == TRACE_ARGS_MAX)
+			break;
+
+		switch (trace_arg_kind(spec.conv)) {
+		case TRACE_ARG_INT:
+			args[n++] = (uint64_t)trace_va_int(spec.length, ap);
+			break;
+		case TRACE_ARG_UINT:
+			args[n++] = trace_va_uint(spec.length, ap);
+			break;
+		case TRACE_ARG_CHAR:
+			args[n++] = (uint64_t)(int64_t)va_arg(*ap, int);
+			break;
+		case TRACE_ARG_DOUBLE: {
+			double d = (spec.length == 'L') ? (double)va_arg(*ap, long double) :
+							     va_arg(*ap, double);
+
+			memcpy(&args[n++], &d, sizeof(d));
+			break;
+		}
+		case TRACE_ARG_STR: {
+			const char *s = va_arg(*ap, const char *);
+			size_t len = s ? strnlen(s, TRACE_STR_MAX) : 0;
+
+			if (len > TRACE_STRS_MAX - *str_len)
+				len = TRACE_STRS_MAX - *str_len;
+			memcpy(strs + *str_len, s ? s : "", len);
+			*str_len += (uint32_t)len;
+			args[n++] = s ? len : UINT64_MAX;
+			break;
+		}
+		case TRACE_ARG_PTR:
+			args[n++] = (uintptr_t)va_arg(*ap, void *);
+			break;
+		case TRACE_ARG_NONE:
+			break;
+		}
+	}
+	return n;
+}
+
+static inline size_t trace_align(size_t len)
+{
+	return (len + 7) & ~(size_t)7;
+}
+
+static inline uint64_t trace_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+static void trace_put(struct metee_trace *ring, uintptr_t handle_id,
+		      const struct metee_trace_site *site,
+		      const uint64_t *args, uint16_t nargs,
+		      const char *strs, uint32_t str_len,
+		      const void *payload, uint32_t payload_len)
+{
+	size_t need = trace_align(sizeof(struct trace_rec) + nargs * sizeof(uint64_t) +
+				  str_len + payload_len);
+	uint64_t head, tail, start, total;
+	struct trace_rec *rec;
+	size_t off, rem;
+	uint8_t *p;
+
+	head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+	do {
+		off = head & (ring->size - 1);
+		rem = ring->size - off;
+		total = (rem < need) ? rem + need : need;
+		tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+		if (head + total - tail > ring->size) {
+			__atomic_fetch_add(&ring->dropped, 1, __ATOMIC_RELAXED);
+			return;
+		}
+	} while (!__atomic_compare_exchange_n(&ring->head, &head, head + total, true,
+					      __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+	start = head;
+	if (rem < need) {
+		if (rem >= TRACE_PAD_HDR) {
+			rec = (struct trace_rec *)(ring->data + off);
+			rec->len = (uint32_t)rem;
+			rec->nargs = 0;
+			rec->flags = TRACE_REC_PAD;
+			__atomic_store_n(&rec->pos, start + 1, __ATOMIC_RELEASE);
+		}
+		start += rem;
+		off = 0;
+	}
+
+	rec = (struct trace_rec *)(ring->data + off);
+	rec->len = (uint32_t)need;
+	rec->nargs = nargs;
+	rec->flags = 0;
+	rec->timestamp_ns = trace_now();
+	rec->handle_id = handle_id;
+	rec->site = site;
+	rec->str_len = str_len;
+	rec->payload_len = payload_len;
+	p = (uint8_t *)rec->args;
+	memcpy(p, args, nargs * sizeof(uint64_t));
+	p += nargs * sizeof(uint64_t);
+	memcpy(p, strs, str_len);
+	if (payload_len)
+		memcpy(p + str_len, payload, payload_len);
+	__atomic_store_n(&rec->pos, start + 1, __ATOMIC_RELEASE);
+}
+
+void metee_trace_record(uintptr_t handle_id, const struct metee_trace_site *site,
+			const void *payload, size_t payload_len, ...)
+{
+	uint64_t args[TRACE_ARGS_MAX];
+	char strs[TRACE_STRS_MAX];
+	struct metee_trace *ring;
+	uint32_t str_len;
+	uint16_t nargs;
+	va_list ap;
+
+	va_start(ap, payload_len);
+	nargs = trace_capture(site->fmt, &ap, args, strs, &str_len);
+	va_end(ap);
+	if (payload_len > TEE_TRACE_PAYLOAD_MAX)
+		payload_len = TEE_TRACE_PAYLOAD_MAX;
+
+	/* TeeTraceStop waits for writers before releasing the ring */
+	__atomic_add_fetch(&trace_writers, 1, __ATOMIC_SEQ_CST);
+	ring = __atomic_load_n(&metee_trace_ring, __ATOMIC_SEQ_CST);
+	if (ring)
+		trace_put(ring, handle_id, site, args, nargs, strs, str_len,
+			  payload, (uint32_t)payload_len);
+	__atomic_sub_fetch(&trace_writers, 1, __ATOMIC_RELEASE);
+}
+
+/* snprintf one conversion: length modifier replaced by the stored type, '*' by the stored value */
+static int trace_format_one(char *out, size_t size, const struct trace_spec *spec,
+			    const uint64_t *args, uint16_t *n, uint16_t nargs,
+			    const char *strs, uint32_t str_len, uint32_t *str_off)
+{
+	char fmt[64];
+	char str[TRACE_STR_MAX + 1];
+	size_t f = 0;
+	size_t i;
+	double d;
+
+	fmt[f++] = '%';
+	for (i = 0; i < spec->len - 1 && f < sizeof(fmt) - 16; i++) {
+		char c = spec->start[i];
+
+		if (strchr("hljztLq", c))
+			continue;
+		if (c == '*') {
+			if (*n >= nargs)
+				return 0;
+			f += (size_t)snprintf(fmt + f, sizeof(fmt) - f, "%d", (int)(int64_t)args[(*n)++]);
+			continue;
+		}
+		fmt[f++] = c;
+	}
+	if (*n >= nargs)
+		return 0;
+
+	switch (trace_arg_kind(spec->conv)) {
+	case TRACE_ARG_INT:
+	case TRACE_ARG_UINT:
+		fmt[f++] = 'l';
+		fmt[f++] = 'l';
+		fmt[f++] = spec->conv;
+		fmt[f] = '\0';
+		if (trace_arg_kind(spec->conv) == TRACE_ARG_INT)
+			return snprintf(out, size, fmt, (long long)(int64_t)args[(*n)++]);
+		return snprintf(out, size, fmt, (unsigned long long)args[(*n)++]);
+	case TRACE_ARG_CHAR:
+		fmt[f++] = 'c';
+		fmt[f] = '\0';
+		return snprintf(out, size, fmt, (int)(int64_t)args[(*n)++]);
+	case TRACE_ARG_DOUBLE:
+		fmt[f++] = spec->conv;
+		fmt[f] = '\0';
+		memcpy(&d, &args[(*n)++], sizeof(d));
+		return snprintf(out, size, fmt, d);
+	case TRACE_ARG_STR: {
+		uint64_t len = args[(*n)++];
+
+		fmt[f++] = 's';
+		fmt[f] = '\0';
+		if (len == UINT64_MAX)
+			return snprintf(out, size, fmt, "(null)");
+		if (len > str_len - *str_off)
+			len = str_len - *str_off;
+		memcpy(str, strs + *str_off, (size_t)len);
+		str[len] = '\0';
+		*str_off += (uint32_t)len;
+		return snprintf(out, size, fmt, str);
+	}
+	case TRACE_ARG_PTR:
+		fmt[f++] = 'p';
+		fmt[f] = '\0';
+		return snprintf(out, size, fmt, (void *)(uintptr_t)args[(*n)++]);
+	case TRACE_ARG_NONE:
+	default:
+		return 0;
+	}
+}
+
+static void trace_format(char *out, size_t size, const struct trace_rec *rec)
+{
+	const char *strs = (const char *)&rec->args[rec->nargs];
+	struct trace_spec spec;
+	uint32_t str_off = 0;
+	uint16_t n = 0;
+	size_t o = 0;
+	const char *p;
+	int rc;
+
+	for (p = rec->site->fmt; *p && o < size - 1; p++) {
+		if (*p != '%') {
+			out[o++] = *p;
+			continue;
+		}
+		if (p[1] == '%') {
+			out[o++] = '%';
+			p++;
+			continue;
+		}
+		p = trace_parse_spec(p + 1, &spec);
+		rc = trace_format_one(out + o, size - o, &spec, rec->args, &n, rec->nargs,
+				      strs, rec->str_len, &str_off);
+		if (rc > 0)
+			o += ((size_t)rc < size - o) ? (size_t)rc : size - o - 1;
+	}
+	out[o] = '\0';
+}
+
+TEESTATUS TEEAPI TeeTraceStart(IN size_t size)
+{
+	struct metee_trace *ring;
+	size_t s = TRACE_SIZE_MIN;
+	TEESTATUS status;
+
+	if (size > TRACE_SIZE_MAX)
+		return TEE_INVALID_PARAMETER;
+	while (s < size)
+		s <<= 1;
+
+	if (__atomic_test_and_set(&trace_busy, __ATOMIC_ACQUIRE))
+		return TEE_BUSY;
+
+	if (metee_trace_ring) {
+		status = TEE_BUSY;
+		goto End;
+	}
+
+	ring = calloc(1, sizeof(*ring));
+	if (!ring) {
+		status = TEE_INTERNAL_ERROR;
+		goto End;
+	}
+	ring->data = calloc(1, s);
+	if (!ring->data) {
+		free(ring);
+		status = TEE_INTERNAL_ERROR;
+		goto End;
+	}
+	ring->size = s;
+	__atomic_store_n(&metee_trace_ring, ring, __ATOMIC_RELEASE);
+	status = TEE_SUCCESS;
+End:
+	__atomic_clear(&trace_busy, __ATOMIC_RELEASE);
+	return status;
+}
+
+TEESTATUS TEEAPI TeeTraceStop(void)
+{
+	struct metee_trace *ring;
+
+	if (__atomic_test_and_set(&trace_busy, __ATOMIC_ACQUIRE))
+		return TEE_BUSY;
+
+	ring = __atomic_exchange_n(&metee_trace_ring, NULL, __ATOMIC_SEQ_CST);
+	if (ring) {
+		while (__atomic_load_n(&trace_writers, __ATOMIC_ACQUIRE))
+			sched_yield();
+		free(ring->data);
+		free(ring);
+	}
+
+	__atomic_clear(&trace_busy, __ATOMIC_RELEASE);
+	return TEE_SUCCESS;
+}
+
+TEESTATUS TEEAPI TeeTraceDrain(IN TeeTraceCallback callback, IN OPTIONAL void *ctx,
+			       OUT OPTIONAL uint64_t *dropped)
+{
+	struct tee_trace_record record;
+	char msg[TRACE_MSG_LEN];
+	struct metee_trace *ring;
+	struct trace_rec *rec;
+	uint64_t tail, head;
+	size_t off, rem, len;
+	TEESTATUS status;
+
+	if (!callback)
+		return TEE_INVALID_PARAMETER;
+
+	if (__atomic_test_and_set(&trace_busy, __ATOMIC_ACQUIRE))
+		return TEE_BUSY;
+
+	ring = __atomic_load_n(&metee_trace_ring, __ATOMIC_ACQUIRE);
+	if (!ring) {
+		status = TEE_NOTSUPPORTED;
+		goto End;
+	}
+
+	tail = ring->tail;
+	for (;;) {
+		off = tail & (ring->size - 1);
+		rem = ring->size - off;
+		rec = (struct trace_rec *)(ring->data + off);
+		if (rem < TRACE_PAD_HDR) {
+			/* implicit filler, the producer wrapped after reserving it */
+			head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+			if (head <= tail)
+				break;
+			len = rem;
+		} else {
+			if (__atomic_load_n(&rec->pos, __ATOMIC_ACQUIRE) != tail + 1)
+				break;
+			len = rec->len;
+			if (len < TRACE_PAD_HDR || len > rem)
+				break;
+		}
+
+		if (len >= sizeof(struct trace_rec) && !(rec->flags & TRACE_REC_PAD)) {
+			trace_format(msg, sizeof(msg), rec);
+			record.timestamp_ns = rec->timestamp_ns;
+			record.handle_id = (uintptr_t)rec->handle_id;
+			record.site_id = (uintptr_t)rec->site;
+			record.is_error = rec->site->is_error;
+			record.file = rec->site->file;
+			record.function = rec->site->func;
+			record.line = rec->site->line;
+			record.msg = msg;
+			record.payload_len = rec->payload_len;
+			record.payload = rec->payload_len ?
+				(const uint8_t *)&rec->args[rec->nargs] + rec->str_len : NULL;
+			callback(ctx, &record);
+		}
+
+		/* stale bytes must never look like a published record */
+		memset(rec, 0, len);
+		tail += len;
+		__atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+	}
+
+	if (dropped)
+		*dropped = __atomic_exchange_n(&ring->dropped, 0, __ATOMIC_RELAXED);
+	status = TEE_SUCCESS;
+End:
+	__atomic_clear(&trace_busy, __ATOMIC_RELEASE);
+	return status;
+}
+
+#else /* METEE_TRACE */
+
+TEESTATUS TEEAPI TeeTraceStart(IN size_t size)
+{
+	(void)size;
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeTraceStop(void)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeTraceDrain(IN TeeTraceCallback callback, IN OPTIONAL void *ctx,
+			       OUT OPTIONAL uint64_t *dropped)
+{
+	(void)callback;
+	(void)ctx;
+	(void)dropped;
+	return TEE_NOTSUPPORTED;
+}
+
+#endif /* METEE_TRACE */
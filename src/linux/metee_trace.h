@@ -0,0 +1,46 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+#ifndef __METEE_TRACE_H
+#define __METEE_TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Process-wide binary trace ring (TeeTraceStart).
+ * While the ring is active log statements store the format arguments
+ * and optional payload bytes instead of printing; formatting happens
+ * in TeeTraceDrain. Producers never block: a record that does not fit
+ * is counted as dropped.
+ */
+
+/* one per log statement, the address is the call site id */
+struct metee_trace_site {
+	const char *fmt;
+	const char *file;
+	const char *func;
+	uint32_t line;
+	bool is_error;
+};
+
+extern struct metee_trace *metee_trace_ring;
+
+static inline bool metee_trace_active(void)
+{
+	return __atomic_load_n(&metee_trace_ring, __ATOMIC_RELAXED) != NULL;
+}
+
+/* record event, variadic arguments match site->fmt */
+void metee_trace_record(uintptr_t handle_id, const struct metee_trace_site *site,
+			const void *payload, size_t payload_len, ...);
+
+#define METEE_TRACE_RECORD(handle_id, is_err, payload, payload_len, _x_, ...) { \
+	static const struct metee_trace_site __trace_site = { \
+		_x_, __FILE__, __FUNCTION__, __LINE__, is_err}; \
+	metee_trace_record((uintptr_t)(handle_id), &__trace_site, payload, payload_len, ##__VA_ARGS__); \
+}
+
+#endif /* __METEE_TRACE_H */
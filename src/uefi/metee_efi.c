@@ -855,4 +855,179 @@ End:
 
 void TEEAPI TeeCancelIO(IN PTEEHANDLE handle)
 {
-}
\ No newline at end of file
+}
+TEESTATUS TEEAPI TeeGetStats(IN PTEEHANDLE handle, OUT struct tee_stats *stats)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeTraceStart(IN size_t size)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeTraceStop(void)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeTraceDrain(IN TeeTraceCallback callback, IN OPTIONAL void *ctx,
+			       OUT OPTIONAL uint64_t *dropped)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeSetLogCallback3(IN const PTEEHANDLE handle, IN OPTIONAL TeeLogCallback3 log_callback,
+				    IN OPTIONAL void *ctx)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeLogEventFormat(IN const struct tee_log_event *event, OUT char *buf, IN size_t size)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeCaptureStart(IN PTEEHANDLE handle, IN const char *path)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeCaptureStop(IN PTEEHANDLE handle)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeReplaySetSpeed(IN PTEEHANDLE handle, IN uint32_t speed)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeFaultStart(IN PTEEHANDLE handle, IN const struct tee_fault_config *config)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeFaultStop(IN PTEEHANDLE handle)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeFaultGetStats(IN PTEEHANDLE handle, OUT struct tee_fault_stats *stats)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeCancelTokenCreate(OUT struct tee_cancel_token **token)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+void TEEAPI TeeCancelTokenFree(IN struct tee_cancel_token *token)
+{
+}
+
+TEESTATUS TEEAPI TeeCancelTokenSetDeadline(IN struct tee_cancel_token *token, IN uint32_t timeout)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+void TEEAPI TeeCancelTokenCancel(IN struct tee_cancel_token *token)
+{
+}
+
+void TEEAPI TeeCancelTokenReset(IN struct tee_cancel_token *token)
+{
+}
+
+bool TEEAPI TeeCancelTokenIsCanceled(IN struct tee_cancel_token *token)
+{
+	return false;
+}
+
+TEESTATUS TEEAPI TeeReadEx(IN PTEEHANDLE handle, IN OUT void *buffer, IN size_t bufferSize,
+			   OUT OPTIONAL size_t *pNumOfBytesRead, IN OPTIONAL uint32_t timeout,
+			   IN OPTIONAL struct tee_cancel_token *token)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeWriteEx(IN PTEEHANDLE handle, IN const void *buffer, IN size_t bufferSize,
+			    OUT OPTIONAL size_t *numberOfBytesWritten, IN OPTIONAL uint32_t timeout,
+			    IN OPTIONAL struct tee_cancel_token *token)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeTransact(IN PTEEHANDLE handle, IN const void *request, IN size_t requestSize,
+			     IN OUT void *response, IN size_t responseSize,
+			     OUT OPTIONAL size_t *pNumOfBytesRead, IN OPTIONAL uint32_t timeout,
+			     IN OPTIONAL struct tee_cancel_token *token)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeHotplugStart(IN TEE_DEVICE_HANDLE source)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeHotplugStop(void)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeHotplugQuery(IN const char *name, OUT bool *present)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeHotplugBind(IN PTEEHANDLE handle, IN OPTIONAL const char *name)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeHotplugWait(IN PTEEHANDLE handle, IN OPTIONAL uint32_t timeout)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeSetDevStatePolicy(IN PTEEHANDLE handle, IN uint32_t policy)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeGetDevState(IN PTEEHANDLE handle, IN OUT char *state, IN OUT size_t *stateSize)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeDevStateBind(IN PTEEHANDLE handle, IN OPTIONAL const char *path)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeePowerPin(IN PTEEHANDLE handle)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeePowerUnpin(IN PTEEHANDLE handle)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeePowerPreWake(IN PTEEHANDLE handle)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeeGetPowerStats(IN PTEEHANDLE handle, OUT struct tee_power_stats *stats)
+{
+	return TEE_NOTSUPPORTED;
+}
+
+TEESTATUS TEEAPI TeePowerBind(IN PTEEHANDLE handle, IN OPTIONAL const char *dir)
+{
+	return TEE_NOTSUPPORTED;
+}
@@ -0,0 +1,116 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+#ifndef __FAKE_DEVICE_H
+#define __FAKE_DEVICE_H
+
+#include <atomic>
+#include <vector>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <errno.h>
+#include "meteepp.h"
+
+/*
+ * socketpair backed device with meteepp read/write interface.
+ * SOCK_SEQPACKET keeps message boundaries same as mei character device,
+ * the firmware side of the pair is driven by the test.
+ */
+class fake_device {
+public:
+	explicit fake_device(uint32_t mtu = 512) : _mtu(mtu), _fw_status(0), _connects(0)
+	{
+		if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, _fds))
+			throw intel::security::metee_exception("socketpair failed", TEE_INTERNAL_ERROR);
+	}
+	fake_device(const fake_device&) = delete;
+	fake_device& operator=(const fake_device&) = delete;
+	~fake_device()
+	{
+		close(_fds[0]);
+		if (_fds[1] != -1)
+			close(_fds[1]);
+	}
+
+	int device_handle() { return _fds[0]; }
+	uint32_t max_msg_len() { return _mtu; }
+	void cancel_io() {}
+	void connect() { _connects++; }
+	uint32_t fw_status(uint32_t fwStatusNum)
+	{
+		if (fwStatusNum != 0)
+			throw intel::security::metee_exception("FW status failed", TEE_NOTSUPPORTED);
+		return _fw_status;
+	}
+
+	size_t read(void *buffer, size_t size, uint32_t timeout)
+	{
+		wait(_fds[0], POLLIN, timeout, "Read failed");
+		ssize_t rc = recv(_fds[0], buffer, size, 0);
+		if (rc <= 0)
+			throw intel::security::metee_exception("Read failed", TEE_DISCONNECTED);
+		return (size_t)rc;
+	}
+
+	size_t write(const void *buffer, size_t size, uint32_t timeout)
+	{
+		if (size > _mtu)
+			throw intel::security::metee_exception("Write failed", TEE_INTERNAL_ERROR);
+		wait(_fds[0], POLLOUT, timeout, "Write failed");
+		ssize_t rc = send(_fds[0], buffer, size, MSG_NOSIGNAL);
+		if (rc < 0)
+			throw intel::security::metee_exception("Write failed", TEE_DISCONNECTED);
+		return (size_t)rc;
+	}
+
+	/* Firmware side */
+	int fw_handle() { return _fds[1]; }
+
+	std::vector<uint8_t> fw_receive(uint32_t timeout = 0)
+	{
+		std::vector<uint8_t> buffer(_mtu);
+
+		wait(_fds[1], POLLIN, timeout, "FW receive failed");
+		ssize_t rc = recv(_fds[1], buffer.data(), buffer.size(), 0);
+		if (rc < 0)
+			throw intel::security::metee_exception("FW receive failed", TEE_DISCONNECTED);
+		buffer.resize((size_t)rc);
+		return buffer;
+	}
+
+	void fw_send(const std::vector<uint8_t> &buffer)
+	{
+		if (send(_fds[1], buffer.data(), buffer.size(), MSG_NOSIGNAL) < 0)
+			throw intel::security::metee_exception("FW send failed", TEE_DISCONNECTED);
+	}
+
+	void fw_set_status(uint32_t status) { _fw_status = status; }
+	unsigned int connects() { return _connects; }
+
+	/* Simulate firmware reset: the host side sees disconnect */
+	void fw_reset()
+	{
+		close(_fds[1]);
+		_fds[1] = -1;
+	}
+
+private:
+	static void wait(int fd, short events, uint32_t timeout, const char *what)
+	{
+		struct pollfd pfd = { fd, events, 0 };
+		int rc = poll(&pfd, 1, timeout ? (int)timeout : -1);
+		if (rc == 0)
+			throw intel::security::metee_exception(what, TEE_TIMEOUT);
+		if (rc < 0)
+			throw intel::security::metee_exception(what, TEE_INTERNAL_ERROR);
+	}
+
+	uint32_t _mtu;
+	int _fds[2];
+	std::atomic<uint32_t> _fw_status;
+	unsigned int _connects;
+};
+
+#endif /* __FAKE_DEVICE_H */
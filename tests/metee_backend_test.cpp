@@ -0,0 +1,1181 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+#include <algorithm>
+#include <atomic>
+#include <sys/socket.h>
+#include "metee_test.h"
+
+static TEESTATUS OpenAddr(TEEHANDLE &handle, const struct tee_device_address &addr)
+{
+	TEESTATUS status = TeeInitFull2(&handle, &GUID_DEVINTERFACE_MKHI, addr, TEE_LOG_LEVEL_ERROR, nullptr);
+	if (status)
+		return status;
+	return TeeConnect(&handle);
+}
+
+static TEESTATUS OpenLoopback(TEEHANDLE &handle)
+{
+	struct tee_device_address addr = {};
+
+	addr.type = tee_device_address::TEE_DEVICE_TYPE_LOOPBACK;
+	return OpenAddr(handle, addr);
+}
+
+/*
+Loopback device echoes every message
+*/
+TEST(MeTeeBackendTEST, BACKEND_Loopback)
+{
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	struct tee_device_address addr = {};
+	uint8_t req[16] = {1, 2, 3};
+	uint8_t rsp[16];
+	size_t size = 0;
+
+	addr.type = tee_device_address::TEE_DEVICE_TYPE_LOOPBACK;
+	TEESTATUS status = OpenAddr(handle, addr);
+	if (status == TEE_INVALID_PARAMETER)
+		GTEST_SKIP();
+	ASSERT_EQ(TEE_SUCCESS, status);
+	EXPECT_EQ(4096, TeeGetMaxMsgLen(&handle));
+	EXPECT_EQ(1, TeeGetProtocolVer(&handle));
+
+	EXPECT_EQ(TEE_TIMEOUT, TeeRead(&handle, rsp, sizeof(rsp), &size, 10));
+	for (uint8_t i = 0; i < 3; i++) {
+		req[0] = i;
+		ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+	}
+	EXPECT_EQ(TEE_INSUFFICIENT_BUFFER, TeeRead(&handle, rsp, 4, &size, 1000));
+	for (uint8_t i = 0; i < 3; i++) {
+		ASSERT_EQ(TEE_SUCCESS, TeeRead(&handle, rsp, sizeof(rsp), &size, 1000));
+		EXPECT_EQ(sizeof(req), size);
+		EXPECT_EQ(i, rsp[0]);
+		EXPECT_EQ(3, rsp[2]);
+	}
+
+	/* responses are dropped on reconnect */
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+	ASSERT_EQ(TEE_SUCCESS, TeeConnect(&handle));
+	EXPECT_EQ(TEE_TIMEOUT, TeeRead(&handle, rsp, sizeof(rsp), &size, 10));
+
+	uint32_t fwsts;
+	EXPECT_EQ(TEE_NOTSUPPORTED, TeeFWStatus(&handle, 0, &fwsts));
+	TeeDisconnect(&handle);
+}
+
+struct ScriptCtx {
+	int calls = 0;
+	TEESTATUS status = TEE_SUCCESS;
+};
+
+/* answer with the request length, nothing for one byte requests */
+static TEESTATUS ScriptResponder(void *ctx, const void *request, size_t request_len,
+				 void *response, size_t *response_len)
+{
+	ScriptCtx *sc = static_cast<ScriptCtx*>(ctx);
+
+	(void)request;
+	sc->calls++;
+	if (sc->status)
+		return sc->status;
+	if (request_len == 1)
+		return TEE_SUCCESS;
+	*static_cast<uint32_t*>(response) = (uint32_t)request_len;
+	*response_len = sizeof(uint32_t);
+	return TEE_SUCCESS;
+}
+
+/*
+Scripted device answers through the responder
+*/
+TEST(MeTeeBackendTEST, BACKEND_Script)
+{
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	struct tee_device_address addr = {};
+	struct tee_script script = {};
+	ScriptCtx ctx;
+	uint8_t req[64] = {0};
+	uint32_t rsp;
+	size_t size = 0;
+
+	script.max_msg_len = 32;
+	script.protocol_ver = 3;
+	script.responder = ScriptResponder;
+	script.ctx = &ctx;
+	addr.type = tee_device_address::TEE_DEVICE_TYPE_SCRIPT;
+	addr.data.script = &script;
+	TEESTATUS status = OpenAddr(handle, addr);
+	if (status == TEE_INVALID_PARAMETER)
+		GTEST_SKIP();
+	ASSERT_EQ(TEE_SUCCESS, status);
+	EXPECT_EQ(32, TeeGetMaxMsgLen(&handle));
+	EXPECT_EQ(3, TeeGetProtocolVer(&handle));
+
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, 20, &size, 1000));
+	ASSERT_EQ(TEE_SUCCESS, TeeRead(&handle, &rsp, sizeof(rsp), &size, 1000));
+	EXPECT_EQ(sizeof(rsp), size);
+	EXPECT_EQ(20u, rsp);
+
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, 1, &size, 1000));
+	EXPECT_EQ(TEE_TIMEOUT, TeeRead(&handle, &rsp, sizeof(rsp), &size, 10));
+
+	EXPECT_EQ(TEE_INVALID_PARAMETER, TeeWrite(&handle, req, 33, &size, 1000));
+	ctx.status = TEE_BUSY;
+	EXPECT_EQ(TEE_BUSY, TeeWrite(&handle, req, 20, &size, 1000));
+	EXPECT_EQ(3, ctx.calls);
+
+	/* responses not read are limited */
+	ctx.status = TEE_SUCCESS;
+	do {
+		status = TeeWrite(&handle, req, 20, &size, 1000);
+	} while (status == TEE_SUCCESS && ctx.calls < 1000);
+	EXPECT_EQ(TEE_BUSY, status);
+	TeeDisconnect(&handle);
+
+	script.responder = nullptr;
+	EXPECT_NE(TEE_SUCCESS, OpenAddr(handle, addr));
+}
+
+/*
+Socket device: the test is the firmware on the other end of a socket pair
+*/
+TEST(MeTeeBackendTEST, BACKEND_Socket)
+{
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	struct tee_device_address addr = {};
+	uint8_t req[8] = {10, 0};
+	uint8_t rsp[8];
+	uint8_t fw[4096];
+	size_t size = 0;
+	int sv[2];
+
+	ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv));
+	addr.type = tee_device_address::TEE_DEVICE_TYPE_SOCKET;
+	addr.data.handle = sv[0];
+	TEESTATUS status = OpenAddr(handle, addr);
+	if (status == TEE_INVALID_PARAMETER) {
+		close(sv[0]);
+		close(sv[1]);
+		GTEST_SKIP();
+	}
+	ASSERT_EQ(TEE_SUCCESS, status);
+	EXPECT_EQ(4096, TeeGetMaxMsgLen(&handle));
+
+	std::thread peer([&] {
+		ssize_t len;
+
+		while ((len = recv(sv[1], fw, sizeof(fw), 0)) > 0) {
+			fw[0]++;
+			send(sv[1], fw, (size_t)len, MSG_NOSIGNAL);
+		}
+	});
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+	ASSERT_EQ(TEE_SUCCESS, TeeRead(&handle, rsp, sizeof(rsp), &size, 1000));
+	EXPECT_EQ(sizeof(req), size);
+	EXPECT_EQ(11, rsp[0]);
+	EXPECT_EQ(TEE_TIMEOUT, TeeRead(&handle, rsp, sizeof(rsp), &size, 10));
+
+	shutdown(sv[1], SHUT_RDWR);
+	peer.join();
+	EXPECT_EQ(TEE_DISCONNECTED, TeeRead(&handle, rsp, sizeof(rsp), &size, 1000));
+	TeeDisconnect(&handle);
+	close(sv[0]);
+	close(sv[1]);
+
+	/* message boundaries are required */
+	ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv));
+	addr.data.handle = sv[0];
+	EXPECT_EQ(TEE_INTERNAL_ERROR, TeeInitFull2(&handle, &GUID_DEVINTERFACE_MKHI, addr,
+						   TEE_LOG_LEVEL_QUIET, nullptr));
+	close(sv[0]);
+	close(sv[1]);
+}
+
+/*
+Fault injection wraps the loopback device
+*/
+TEST(MeTeeBackendTEST, BACKEND_Fault)
+{
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	struct tee_device_address addr = {};
+	struct tee_fault_rule rules[3] = {};
+	struct tee_fault_config config = {};
+	struct tee_fault_stats st;
+	uint8_t req[16] = {1, 2, 3};
+	uint8_t rsp[16];
+	size_t size = 0;
+
+	addr.type = tee_device_address::TEE_DEVICE_TYPE_LOOPBACK;
+	TEESTATUS status = OpenAddr(handle, addr);
+	if (status == TEE_INVALID_PARAMETER)
+		GTEST_SKIP();
+	ASSERT_EQ(TEE_SUCCESS, status);
+	EXPECT_EQ(TEE_INVALID_PARAMETER, TeeFaultGetStats(&handle, &st));
+
+	/* every second write is busy, the first read is truncated, the third loses the FW */
+	rules[0].kind = TEE_FAULT_BUSY;
+	rules[0].ops = TEE_FAULT_OP_WRITE;
+	rules[0].period = 2;
+	rules[0].limit = 2;
+	rules[1].kind = TEE_FAULT_TRUNCATE;
+	rules[1].ops = TEE_FAULT_OP_READ;
+	rules[1].period = 1;
+	rules[1].limit = 1;
+	rules[1].truncate_len = 2;
+	rules[2].kind = TEE_FAULT_DISCONNECT;
+	rules[2].ops = TEE_FAULT_OP_READ;
+	rules[2].period = 1;
+	rules[2].skip = 2;
+	rules[2].limit = 1;
+	config.rules = rules;
+	config.rules_num = 3;
+	rules[0].kind = TEE_FAULT_KIND_MAX;
+	EXPECT_EQ(TEE_INVALID_PARAMETER, TeeFaultStart(&handle, &config));
+	rules[0].kind = TEE_FAULT_BUSY;
+	ASSERT_EQ(TEE_SUCCESS, TeeFaultStart(&handle, &config));
+	EXPECT_EQ(TEE_BUSY, TeeFaultStart(&handle, &config));
+
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+	EXPECT_EQ(TEE_BUSY, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+	ASSERT_EQ(TEE_SUCCESS, TeeRead(&handle, rsp, sizeof(rsp), &size, 1000));
+	EXPECT_EQ(2u, size);
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+	ASSERT_EQ(TEE_SUCCESS, TeeRead(&handle, rsp, sizeof(rsp), &size, 1000));
+	EXPECT_EQ(sizeof(req), size);
+
+	EXPECT_EQ(TEE_BUSY, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+	EXPECT_EQ(TEE_DISCONNECTED, TeeRead(&handle, rsp, sizeof(rsp), &size, 1000));
+	EXPECT_EQ(TEE_DISCONNECTED, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+	ASSERT_EQ(TEE_SUCCESS, TeeConnect(&handle));
+	/* the response of the session before reset is lost */
+	EXPECT_EQ(TEE_TIMEOUT, TeeRead(&handle, rsp, sizeof(rsp), &size, 10));
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+	ASSERT_EQ(TEE_SUCCESS, TeeRead(&handle, rsp, sizeof(rsp), &size, 1000));
+
+	ASSERT_EQ(TEE_SUCCESS, TeeFaultGetStats(&handle, &st));
+	EXPECT_EQ(2u, st.injected[TEE_FAULT_BUSY]);
+	EXPECT_EQ(1u, st.injected[TEE_FAULT_TRUNCATE]);
+	EXPECT_EQ(1u, st.injected[TEE_FAULT_DISCONNECT]);
+	EXPECT_EQ(2u, st.recoveries);
+	EXPECT_EQ(2u, st.recovery.count);
+	EXPECT_EQ(2u, st.transact.count);
+	ASSERT_EQ(TEE_SUCCESS, TeeFaultStop(&handle));
+
+	/* delayed writes and lost responses */
+	memset(rules, 0, sizeof(rules));
+	rules[0].kind = TEE_FAULT_DELAY;
+	rules[0].ops = TEE_FAULT_OP_WRITE;
+	rules[0].probability = 1000000;
+	rules[0].delay_ms = 20;
+	rules[1].kind = TEE_FAULT_TIMEOUT;
+	rules[1].ops = TEE_FAULT_OP_READ;
+	rules[1].period = 2;
+	rules[1].delay_ms = 10;
+	config.rules_num = 2;
+	ASSERT_EQ(TEE_SUCCESS, TeeFaultStart(&handle, &config));
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+	ASSERT_EQ(TEE_SUCCESS, TeeRead(&handle, rsp, sizeof(rsp), &size, 1000));
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+	EXPECT_EQ(TEE_TIMEOUT, TeeRead(&handle, rsp, sizeof(rsp), &size, 1000));
+	EXPECT_EQ(TEE_TIMEOUT, TeeWrite(&handle, req, sizeof(req), &size, 10));
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+	ASSERT_EQ(TEE_SUCCESS, TeeRead(&handle, rsp, sizeof(rsp), &size, 1000));
+	ASSERT_EQ(TEE_SUCCESS, TeeFaultGetStats(&handle, &st));
+	EXPECT_EQ(4u, st.injected[TEE_FAULT_DELAY]);
+	EXPECT_EQ(1u, st.injected[TEE_FAULT_TIMEOUT]);
+	EXPECT_EQ(2u, st.transact.count);
+	EXPECT_GE(st.transact.total_us, 40000u);
+	EXPECT_EQ(2u, st.recoveries);
+	EXPECT_GE(st.recovery.total_us, 80000u);
+	ASSERT_EQ(TEE_SUCCESS, TeeFaultStop(&handle));
+
+	EXPECT_EQ(TEE_TIMEOUT, TeeRead(&handle, rsp, sizeof(rsp), &size, 10));
+	EXPECT_EQ(TEE_INVALID_PARAMETER, TeeFaultGetStats(&handle, &st));
+	TeeDisconnect(&handle);
+}
+
+/*
+Cancellation token stops only the operations it is attached to
+*/
+TEST(MeTeeBackendTEST, BACKEND_CancelToken)
+{
+	TEEHANDLE h1 = TEEHANDLE_ZERO;
+	TEEHANDLE h2 = TEEHANDLE_ZERO;
+	struct tee_device_address addr = {};
+	struct tee_cancel_token *token = nullptr;
+	uint8_t req[16] = {1, 2, 3};
+	uint8_t rsp[16];
+	size_t size = 0;
+	TEESTATUS s1 = TEE_SUCCESS;
+	TEESTATUS s2 = TEE_SUCCESS;
+
+	addr.type = tee_device_address::TEE_DEVICE_TYPE_LOOPBACK;
+	TEESTATUS status = OpenAddr(h1, addr);
+	if (status == TEE_INVALID_PARAMETER)
+		GTEST_SKIP();
+	ASSERT_EQ(TEE_SUCCESS, status);
+	ASSERT_EQ(TEE_SUCCESS, OpenAddr(h2, addr));
+	ASSERT_EQ(TEE_SUCCESS, TeeCancelTokenCreate(&token));
+	EXPECT_FALSE(TeeCancelTokenIsCanceled(token));
+
+	/* the read with the token ends, the other one gets its response */
+	std::thread r1([&]() {
+		uint8_t buf[16];
+		s1 = TeeReadEx(&h1, buf, sizeof(buf), nullptr, 0, token);
+	});
+	std::thread r2([&]() {
+		uint8_t buf[16];
+		s2 = TeeRead(&h2, buf, sizeof(buf), nullptr, 5000);
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	TeeCancelTokenCancel(token);
+	r1.join();
+	EXPECT_EQ(TEE_UNABLE_TO_COMPLETE_OPERATION, s1);
+	EXPECT_EQ(TEE_SUCCESS, TeeWrite(&h2, req, sizeof(req), &size, 1000));
+	r2.join();
+	EXPECT_EQ(TEE_SUCCESS, s2);
+
+	/* canceled token stops every operation until reset */
+	EXPECT_TRUE(TeeCancelTokenIsCanceled(token));
+	EXPECT_EQ(TEE_UNABLE_TO_COMPLETE_OPERATION, TeeWriteEx(&h1, req, sizeof(req), &size, 1000, token));
+	TeeCancelTokenReset(token);
+	EXPECT_FALSE(TeeCancelTokenIsCanceled(token));
+	ASSERT_EQ(TEE_SUCCESS, TeeTransact(&h1, req, sizeof(req), rsp, sizeof(rsp), &size, 1000, token));
+	EXPECT_EQ(sizeof(req), size);
+	EXPECT_EQ(0, memcmp(req, rsp, sizeof(req)));
+
+	/* deadline */
+	ASSERT_EQ(TEE_SUCCESS, TeeCancelTokenSetDeadline(token, 50));
+	auto start = std::chrono::steady_clock::now();
+	EXPECT_EQ(TEE_UNABLE_TO_COMPLETE_OPERATION, TeeReadEx(&h1, rsp, sizeof(rsp), &size, 0, token));
+	EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(50));
+	EXPECT_TRUE(TeeCancelTokenIsCanceled(token));
+	TeeCancelTokenReset(token);
+	ASSERT_EQ(TEE_SUCCESS, TeeCancelTokenSetDeadline(token, 1000));
+	EXPECT_EQ(TEE_TIMEOUT, TeeReadEx(&h1, rsp, sizeof(rsp), &size, 10, token));
+	EXPECT_FALSE(TeeCancelTokenIsCanceled(token));
+
+	/* cancel racing with reset leaves the token consistent, no wait hangs */
+	for (int i = 0; i < 100; i++) {
+		std::thread c([&]() { TeeCancelTokenCancel(token); });
+		TeeCancelTokenReset(token);
+		c.join();
+		EXPECT_EQ(TeeCancelTokenIsCanceled(token) ? TEE_UNABLE_TO_COMPLETE_OPERATION : TEE_TIMEOUT,
+			  TeeReadEx(&h1, rsp, sizeof(rsp), &size, 1, token));
+		TeeCancelTokenReset(token);
+	}
+	TeeCancelTokenSetDeadline(token, 1000);
+
+	/* TeeCancelIO stops the waits in flight only */
+	TeeCancelIO(&h1);
+	EXPECT_EQ(TEE_TIMEOUT, TeeRead(&h1, rsp, sizeof(rsp), &size, 10));
+	std::thread r3([&]() {
+		uint8_t buf[16];
+		s1 = TeeReadEx(&h1, buf, sizeof(buf), nullptr, 5000, token);
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	TeeCancelIO(&h1);
+	r3.join();
+	EXPECT_EQ(TEE_UNABLE_TO_COMPLETE_OPERATION, s1);
+	EXPECT_FALSE(TeeCancelTokenIsCanceled(token));
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&h1, req, sizeof(req), &size, 1000));
+	EXPECT_EQ(TEE_SUCCESS, TeeRead(&h1, rsp, sizeof(rsp), &size, 1000));
+
+	TeeCancelTokenFree(token);
+	TeeDisconnect(&h1);
+	TeeDisconnect(&h2);
+}
+
+/* kernel uevent of a mei class device sent by a synthetic source */
+static void SendUevent(int fd, const char *action, const char *name, const char *subsystem = "mei")
+{
+	std::string devpath = std::string("/devices/pci0000:00/0000:00:16.0/mei/") + name;
+	std::string msg = std::string(action) + "@" + devpath;
+
+	msg.push_back('\0');
+	for (std::string kv : {std::string("ACTION=") + action, "DEVPATH=" + devpath,
+			       std::string("SUBSYSTEM=") + subsystem, std::string("DEVNAME=") + name,
+			       std::string("SEQNUM=1")}) {
+		msg += kv;
+		msg.push_back('\0');
+	}
+	ASSERT_EQ((ssize_t)msg.size(), send(fd, msg.data(), msg.size(), 0));
+}
+
+/* the monitor handles events on its own thread */
+static bool WaitPresent(const char *name, bool present)
+{
+	for (int i = 0; i < 500; i++) {
+		bool p = !present;
+		if (TeeHotplugQuery(name, &p) == TEE_SUCCESS && p == present)
+			return true;
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	}
+	return false;
+}
+
+/*
+Removal of the device fails its handles fast, they reconnect once it is back
+*/
+TEST(MeTeeBackendTEST, BACKEND_Hotplug)
+{
+	TEEHANDLE h1 = TEEHANDLE_ZERO;
+	TEEHANDLE h2 = TEEHANDLE_ZERO;
+	struct tee_device_address addr = {};
+	uint8_t req[16] = {1, 2, 3};
+	uint8_t rsp[16];
+	size_t size = 0;
+	bool present = false;
+	TEESTATUS s1 = TEE_SUCCESS;
+	int sv[2];
+
+	ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0, sv));
+	TEESTATUS status = TeeHotplugStart(sv[0]);
+	if (status == TEE_NOTSUPPORTED) {
+		close(sv[0]);
+		close(sv[1]);
+		GTEST_SKIP();
+	}
+	ASSERT_EQ(TEE_SUCCESS, status);
+	EXPECT_EQ(TEE_BUSY, TeeHotplugStart(sv[0]));
+
+	addr.type = tee_device_address::TEE_DEVICE_TYPE_LOOPBACK;
+	ASSERT_EQ(TEE_SUCCESS, OpenAddr(h1, addr));
+	ASSERT_EQ(TEE_SUCCESS, OpenAddr(h2, addr));
+	ASSERT_EQ(TEE_SUCCESS, TeeHotplugBind(&h1, "/dev/meihp7"));
+	ASSERT_EQ(TEE_SUCCESS, TeeHotplugBind(&h2, "meihp8"));
+	EXPECT_EQ(TEE_DEVICE_NOT_FOUND, TeeHotplugQuery("meihp7", &present));
+
+	/* events of other classes are ignored */
+	SendUevent(sv[1], "remove", "meihp8", "net");
+
+	/* the read in flight ends on removal instead of the timeout */
+	std::thread r1([&]() {
+		s1 = TeeRead(&h1, rsp, sizeof(rsp), nullptr, 5000);
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	auto start = std::chrono::steady_clock::now();
+	SendUevent(sv[1], "remove", "meihp7");
+	r1.join();
+	EXPECT_EQ(TEE_DISCONNECTED, s1);
+	EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(2000));
+	ASSERT_TRUE(WaitPresent("/dev/meihp7", false));
+
+	/* new operations fail at once, other devices work */
+	EXPECT_EQ(TEE_DISCONNECTED, TeeWrite(&h1, req, sizeof(req), &size, 1000));
+	EXPECT_EQ(TEE_DISCONNECTED, TeeConnect(&h1));
+	EXPECT_EQ(TEE_TIMEOUT, TeeHotplugWait(&h1, 20));
+	EXPECT_EQ(TEE_DEVICE_NOT_FOUND, TeeHotplugQuery("meihp8", &present));
+	EXPECT_EQ(TEE_SUCCESS, TeeWrite(&h2, req, sizeof(req), &size, 1000));
+	EXPECT_EQ(TEE_SUCCESS, TeeRead(&h2, rsp, sizeof(rsp), &size, 1000));
+
+	/* the device comes back */
+	std::thread w1([&]() {
+		s1 = TeeHotplugWait(&h1, 5000);
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	SendUevent(sv[1], "add", "meihp7");
+	w1.join();
+	EXPECT_EQ(TEE_SUCCESS, s1);
+	EXPECT_EQ(TEE_DISCONNECTED, TeeRead(&h1, rsp, sizeof(rsp), &size, 1000));
+	ASSERT_EQ(TEE_SUCCESS, TeeConnect(&h1));
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&h1, req, sizeof(req), &size, 1000));
+	EXPECT_EQ(TEE_SUCCESS, TeeRead(&h1, rsp, sizeof(rsp), &size, 1000));
+	EXPECT_EQ(0, memcmp(req, rsp, sizeof(req)));
+
+	/* without monitor nothing is failed */
+	SendUevent(sv[1], "remove", "meihp7");
+	ASSERT_TRUE(WaitPresent("meihp7", false));
+	EXPECT_EQ(TEE_SUCCESS, TeeHotplugStop());
+	EXPECT_EQ(TEE_NOTSUPPORTED, TeeHotplugQuery("meihp7", &present));
+	EXPECT_EQ(TEE_NOTSUPPORTED, TeeHotplugWait(&h1, 10));
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&h1, req, sizeof(req), &size, 1000));
+	EXPECT_EQ(TEE_SUCCESS, TeeRead(&h1, rsp, sizeof(rsp), &size, 1000));
+
+	TeeDisconnect(&h1);
+	TeeDisconnect(&h2);
+	close(sv[0]);
+	close(sv[1]);
+}
+
+static void WriteDevState(const std::string &path, const char *state)
+{
+	std::ofstream(path) << state << "\n";
+}
+
+/*
+Operations fail fast or wait while the device is not enabled, as the policy says
+*/
+TEST(MeTeeBackendTEST, BACKEND_DevState)
+{
+	TEEHANDLE h = TEEHANDLE_ZERO;
+	struct tee_device_address addr = {};
+	char tmpl[] = "/tmp/metee_devstate_XXXXXX";
+	uint8_t req[16] = {1, 2, 3};
+	uint8_t rsp[16];
+	char state[32];
+	size_t size = 0;
+	TEESTATUS s1 = TEE_SUCCESS;
+
+	addr.type = tee_device_address::TEE_DEVICE_TYPE_LOOPBACK;
+	TEESTATUS status = OpenAddr(h, addr);
+	if (status == TEE_INVALID_PARAMETER)
+		GTEST_SKIP();
+	ASSERT_EQ(TEE_SUCCESS, status);
+	size = sizeof(state);
+	EXPECT_EQ(TEE_NOTSUPPORTED, TeeGetDevState(&h, state, &size));
+
+	int fd = mkstemp(tmpl);
+	ASSERT_NE(-1, fd);
+	close(fd);
+	std::string path(tmpl);
+	WriteDevState(path, "RESETTING");
+	ASSERT_EQ(TEE_SUCCESS, TeeDevStateBind(&h, path.c_str()));
+	size = 0;
+	EXPECT_EQ(TEE_INSUFFICIENT_BUFFER, TeeGetDevState(&h, nullptr, &size));
+	EXPECT_EQ(sizeof("RESETTING"), size);
+	size = sizeof(state);
+	ASSERT_EQ(TEE_SUCCESS, TeeGetDevState(&h, state, &size));
+	EXPECT_STREQ("RESETTING", state);
+
+	/* fail fast by default */
+	auto start = std::chrono::steady_clock::now();
+	EXPECT_EQ(TEE_DEVICE_RESETTING, TeeWrite(&h, req, sizeof(req), &size, 1000));
+	EXPECT_EQ(TEE_DEVICE_RESETTING, TeeRead(&h, rsp, sizeof(rsp), &size, 1000));
+	EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+	EXPECT_EQ(TEE_DEVICE_RESETTING, TeeConnect(&h));
+
+	/* wait within the operation timeout */
+	ASSERT_EQ(TEE_SUCCESS, TeeSetDevStatePolicy(&h, TEE_DEVSTATE_WAIT));
+	start = std::chrono::steady_clock::now();
+	EXPECT_EQ(TEE_TIMEOUT, TeeWrite(&h, req, sizeof(req), &size, 50));
+	EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(50));
+
+	std::thread r1([&]() {
+		s1 = TeeRead(&h, rsp, sizeof(rsp), nullptr, 5000);
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	TeeCancelIO(&h);
+	r1.join();
+	EXPECT_EQ(TEE_UNABLE_TO_COMPLETE_OPERATION, s1);
+
+	std::thread c1([&]() {
+		s1 = TeeConnect(&h);
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	TeeCancelIO(&h);
+	c1.join();
+	EXPECT_EQ(TEE_UNABLE_TO_COMPLETE_OPERATION, s1);
+
+	/* reconnect and write go on once the device is enabled */
+	c1 = std::thread([&]() {
+		s1 = TeeConnect(&h);
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	WriteDevState(path, "ENABLED");
+	c1.join();
+	EXPECT_EQ(TEE_SUCCESS, s1);
+
+	WriteDevState(path, "RESETTING");
+	std::thread w1([&]() {
+		s1 = TeeWrite(&h, req, sizeof(req), nullptr, 5000);
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	start = std::chrono::steady_clock::now();
+	WriteDevState(path, "ENABLED");
+	w1.join();
+	EXPECT_EQ(TEE_SUCCESS, s1);
+	EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(1000));
+	EXPECT_EQ(TEE_SUCCESS, TeeRead(&h, rsp, sizeof(rsp), &size, 1000));
+	EXPECT_EQ(0, memcmp(req, rsp, sizeof(req)));
+
+	/* ignored or unbound state does not gate */
+	WriteDevState(path, "POWER_DOWN");
+	EXPECT_EQ(TEE_INVALID_PARAMETER, TeeSetDevStatePolicy(&h, TEE_DEVSTATE_MAX));
+	ASSERT_EQ(TEE_SUCCESS, TeeSetDevStatePolicy(&h, TEE_DEVSTATE_IGNORE));
+	EXPECT_EQ(TEE_SUCCESS, TeeWrite(&h, req, sizeof(req), &size, 1000));
+	EXPECT_EQ(TEE_SUCCESS, TeeRead(&h, rsp, sizeof(rsp), &size, 1000));
+	ASSERT_EQ(TEE_SUCCESS, TeeSetDevStatePolicy(&h, TEE_DEVSTATE_FAIL));
+	ASSERT_EQ(TEE_SUCCESS, TeeDevStateBind(&h, nullptr));
+	EXPECT_EQ(TEE_SUCCESS, TeeWrite(&h, req, sizeof(req), &size, 1000));
+	EXPECT_EQ(TEE_SUCCESS, TeeRead(&h, rsp, sizeof(rsp), &size, 1000));
+
+	TeeDisconnect(&h);
+	unlink(path.c_str());
+}
+
+static std::string ReadPowerAttr(const std::string &dir, const char *attr)
+{
+	std::string value;
+
+	std::ifstream(dir + "/" + attr) >> value;
+	return value;
+}
+
+/*
+Requests on a suspended device are counted, pins of the process keep the device on until the last unpin
+*/
+TEST(MeTeeBackendTEST, BACKEND_Power)
+{
+	TEEHANDLE h1 = TEEHANDLE_ZERO;
+	TEEHANDLE h2 = TEEHANDLE_ZERO;
+	struct tee_device_address addr = {};
+	struct tee_power_stats stats;
+	char tmpl[] = "/tmp/metee_power_XXXXXX";
+	uint8_t req[16] = {1, 2, 3};
+	uint8_t rsp[16];
+	size_t size = 0;
+
+	addr.type = tee_device_address::TEE_DEVICE_TYPE_LOOPBACK;
+	TEESTATUS status = OpenAddr(h1, addr);
+	if (status == TEE_INVALID_PARAMETER)
+		GTEST_SKIP();
+	ASSERT_EQ(TEE_SUCCESS, status);
+	ASSERT_EQ(TEE_SUCCESS, OpenAddr(h2, addr));
+	EXPECT_EQ(TEE_NOTSUPPORTED, TeePowerPin(&h1));
+	EXPECT_EQ(TEE_NOTSUPPORTED, TeePowerPreWake(&h1));
+
+	ASSERT_NE(nullptr, mkdtemp(tmpl));
+	std::string dir(tmpl);
+	WriteDevState(dir + "/control", "auto");
+	WriteDevState(dir + "/runtime_status", "suspended");
+	EXPECT_EQ(TEE_DEVICE_NOT_FOUND, TeePowerBind(&h1, (dir + "/none").c_str()));
+	ASSERT_EQ(TEE_SUCCESS, TeePowerBind(&h1, dir.c_str()));
+	ASSERT_EQ(TEE_SUCCESS, TeePowerBind(&h2, dir.c_str()));
+
+	/* cold and warm requests */
+	EXPECT_EQ(TEE_SUCCESS, TeeWrite(&h1, req, sizeof(req), &size, 1000));
+	EXPECT_EQ(TEE_SUCCESS, TeeRead(&h1, rsp, sizeof(rsp), &size, 1000));
+	WriteDevState(dir + "/runtime_status", "active");
+	EXPECT_EQ(TEE_SUCCESS, TeeWrite(&h1, req, sizeof(req), &size, 1000));
+	EXPECT_EQ(TEE_SUCCESS, TeeRead(&h1, rsp, sizeof(rsp), &size, 1000));
+	status = TeeGetPowerStats(&h1, &stats);
+	if (status == TEE_NOTSUPPORTED) {
+		TeeDisconnect(&h2);
+		TeeDisconnect(&h1);
+		unlink((dir + "/control").c_str());
+		unlink((dir + "/runtime_status").c_str());
+		rmdir(dir.c_str());
+		GTEST_SKIP();
+	}
+	ASSERT_EQ(TEE_SUCCESS, status);
+	EXPECT_EQ(2u, stats.requests);
+	EXPECT_EQ(1u, stats.cold_requests);
+	EXPECT_EQ(1u, stats.cold_transact.count);
+	EXPECT_EQ(1u, stats.warm_transact.count);
+	EXPECT_EQ(0u, stats.prewakes);
+
+	/* rebinding keeps the statistics */
+	ASSERT_EQ(TEE_SUCCESS, TeePowerBind(&h1, dir.c_str()));
+	ASSERT_EQ(TEE_SUCCESS, TeeGetPowerStats(&h1, &stats));
+	EXPECT_EQ(2u, stats.requests);
+	EXPECT_EQ(1u, stats.warm_transact.count);
+
+	/* pre-wake of a suspended device restores the control value */
+	WriteDevState(dir + "/runtime_status", "suspended");
+	EXPECT_EQ(TEE_SUCCESS, TeePowerPreWake(&h1));
+	EXPECT_EQ("auto", ReadPowerAttr(dir, "control"));
+	WriteDevState(dir + "/runtime_status", "active");
+	EXPECT_EQ(TEE_SUCCESS, TeePowerPreWake(&h1));
+	ASSERT_EQ(TEE_SUCCESS, TeeGetPowerStats(&h1, &stats));
+	EXPECT_EQ(1u, stats.prewakes);
+
+	/* pins are counted across handles */
+	EXPECT_EQ(TEE_SUCCESS, TeePowerPin(&h1));
+	EXPECT_EQ(TEE_SUCCESS, TeePowerPin(&h1));
+	EXPECT_EQ("on", ReadPowerAttr(dir, "control"));
+	EXPECT_EQ(TEE_SUCCESS, TeePowerPin(&h2));
+	/* pinned handles do not read the runtime status */
+	WriteDevState(dir + "/runtime_status", "suspended");
+	EXPECT_EQ(TEE_SUCCESS, TeeWrite(&h1, req, sizeof(req), &size, 1000));
+	EXPECT_EQ(TEE_SUCCESS, TeeRead(&h1, rsp, sizeof(rsp), &size, 1000));
+	ASSERT_EQ(TEE_SUCCESS, TeeGetPowerStats(&h1, &stats));
+	EXPECT_EQ(3u, stats.requests);
+	EXPECT_EQ(1u, stats.cold_requests);
+	EXPECT_EQ(2u, stats.warm_transact.count);
+	EXPECT_EQ(TEE_SUCCESS, TeePowerUnpin(&h1));
+	EXPECT_EQ("on", ReadPowerAttr(dir, "control"));
+	/* and the pin */
+	ASSERT_EQ(TEE_SUCCESS, TeePowerBind(&h2, dir.c_str()));
+	EXPECT_EQ("on", ReadPowerAttr(dir, "control"));
+	EXPECT_EQ(TEE_SUCCESS, TeePowerUnpin(&h1));
+	TeeDisconnect(&h2);
+	EXPECT_EQ("auto", ReadPowerAttr(dir, "control"));
+
+	/* rebinding while requests run */
+	std::atomic<bool> running{true};
+	std::thread io([&]() {
+		uint8_t buf[16];
+		size_t n;
+
+		while (running) {
+			EXPECT_EQ(TEE_SUCCESS, TeeWrite(&h1, req, sizeof(req), &n, 1000));
+			EXPECT_EQ(TEE_SUCCESS, TeeRead(&h1, buf, sizeof(buf), &n, 1000));
+		}
+	});
+	for (int i = 0; i < 50; i++)
+		EXPECT_EQ(TEE_SUCCESS, TeePowerBind(&h1, (i % 2) ? dir.c_str() : nullptr));
+	running = false;
+	io.join();
+
+	TeeDisconnect(&h1);
+	unlink((dir + "/control").c_str());
+	unlink((dir + "/runtime_status").c_str());
+	rmdir(dir.c_str());
+}
+
+/*
+Handle statistics count messages, bytes, errors and latencies
+*/
+TEST(MeTeeBackendTEST, BACKEND_Stats)
+{
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	struct tee_stats st;
+	uint8_t req[8] = {0};
+	uint8_t rsp[256];
+	size_t size;
+
+	TEESTATUS status = OpenLoopback(handle);
+	if (status == TEE_INVALID_PARAMETER)
+		GTEST_SKIP();
+	ASSERT_EQ(TEE_SUCCESS, status);
+	status = TeeGetStats(&handle, &st);
+	if (status == TEE_NOTSUPPORTED) {
+		TeeDisconnect(&handle);
+		GTEST_SKIP();
+	}
+	ASSERT_EQ(TEE_SUCCESS, status);
+	EXPECT_EQ(1u, st.connects);
+	EXPECT_EQ(0u, st.reconnects);
+
+	for (int i = 0; i < 2; i++) {
+		ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+		ASSERT_EQ(TEE_SUCCESS, TeeRead(&handle, rsp, sizeof(rsp), &size, 1000));
+	}
+	EXPECT_EQ(TEE_TIMEOUT, TeeRead(&handle, rsp, sizeof(rsp), &size, 10));
+	EXPECT_EQ(TEE_INVALID_PARAMETER, TeeWrite(&handle, req, 0, &size, 10));
+	ASSERT_EQ(TEE_SUCCESS, TeeConnect(&handle));
+
+	ASSERT_EQ(TEE_SUCCESS, TeeGetStats(&handle, &st));
+	EXPECT_EQ(2u, st.write_msgs);
+	EXPECT_EQ(2 * sizeof(req), st.write_bytes);
+	EXPECT_EQ(2u, st.read_msgs);
+	EXPECT_EQ(2 * sizeof(req), st.read_bytes);
+	EXPECT_EQ(1u, st.timeouts);
+	EXPECT_EQ(0u, st.cancels);
+	EXPECT_EQ(2u, st.connects);
+	EXPECT_EQ(1u, st.reconnects);
+	EXPECT_EQ(1u, st.errors[TEE_TIMEOUT]);
+	EXPECT_EQ(1u, st.errors[TEE_INVALID_PARAMETER]);
+	EXPECT_EQ(2u, st.write.count);
+	EXPECT_EQ(2u, st.write_wait.count);
+	EXPECT_EQ(2u, st.read.count);
+	EXPECT_EQ(2u, st.read_wait.count);
+	EXPECT_EQ(2u, st.transact.count);
+	uint64_t in_buckets = 0;
+	for (size_t i = 0; i < TEE_STATS_HIST_BUCKETS; i++)
+		in_buckets += st.transact.buckets[i];
+	EXPECT_EQ(2u, in_buckets);
+	EXPECT_GE(st.transact.total_us, st.read.total_us);
+
+	EXPECT_EQ(TEE_INVALID_PARAMETER, TeeGetStats(&handle, nullptr));
+	TeeDisconnect(&handle);
+}
+
+struct TraceEvent {
+	uint64_t timestamp_ns;
+	uintptr_t handle_id;
+	uintptr_t site_id;
+	bool is_error;
+	std::string function;
+	std::string msg;
+};
+
+static void TraceCollect(void *ctx, const struct tee_trace_record *record)
+{
+	static_cast<std::vector<TraceEvent>*>(ctx)->push_back({record->timestamp_ns,
+		record->handle_id, record->site_id, record->is_error,
+		record->function, record->msg});
+}
+
+/*
+Trace ring keeps events unformatted and formats them on drain
+*/
+TEST(MeTeeBackendTEST, BACKEND_Trace)
+{
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	std::vector<TraceEvent> events;
+	uint8_t req[8] = {0};
+	uint8_t rsp[256];
+	uint64_t dropped = 1;
+	size_t size;
+
+	TEESTATUS status = OpenLoopback(handle);
+	if (status == TEE_INVALID_PARAMETER)
+		GTEST_SKIP();
+	ASSERT_EQ(TEE_SUCCESS, status);
+	status = TeeTraceStart(0);
+	if (status == TEE_NOTSUPPORTED) {
+		TeeDisconnect(&handle);
+		GTEST_SKIP();
+	}
+	ASSERT_EQ(TEE_SUCCESS, status);
+	EXPECT_EQ(TEE_BUSY, TeeTraceStart(0));
+	TeeSetLogLevel(&handle, TEE_LOG_LEVEL_VERBOSE);
+
+	for (int i = 0; i < 2; i++) {
+		ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+		ASSERT_EQ(TEE_SUCCESS, TeeRead(&handle, rsp, sizeof(rsp), &size, 1000));
+	}
+	EXPECT_EQ(TEE_INVALID_PARAMETER, TeeWrite(&handle, req, sizeof(req), &size, 0x80000000U));
+	TeeSetLogLevel(&handle, TEE_LOG_LEVEL_ERROR);
+
+	ASSERT_EQ(TEE_SUCCESS, TeeTraceDrain(TraceCollect, &events, &dropped));
+	EXPECT_EQ(0u, dropped);
+	std::vector<uintptr_t> write_exit;
+	bool timeout_error = false;
+	for (size_t i = 0; i < events.size(); i++) {
+		EXPECT_EQ((uintptr_t)handle.handle, events[i].handle_id);
+		if (i)
+			EXPECT_LE(events[i - 1].timestamp_ns, events[i].timestamp_ns);
+		if (events[i].function == "TeeWrite" && events[i].msg == "Exit with status: 0\n")
+			write_exit.push_back(events[i].site_id);
+		if (events[i].is_error && events[i].msg == "Timeout is too big 2147483648 > 2147483647 \n")
+			timeout_error = true;
+	}
+	ASSERT_EQ(2u, write_exit.size());
+	EXPECT_EQ(write_exit[0], write_exit[1]);
+	EXPECT_TRUE(timeout_error);
+
+	events.clear();
+	ASSERT_EQ(TEE_SUCCESS, TeeTraceDrain(TraceCollect, &events, nullptr));
+	EXPECT_TRUE(events.empty());
+	EXPECT_EQ(TEE_INVALID_PARAMETER, TeeTraceDrain(nullptr, nullptr, nullptr));
+	EXPECT_EQ(TEE_SUCCESS, TeeTraceStop());
+	EXPECT_EQ(TEE_NOTSUPPORTED, TeeTraceDrain(TraceCollect, &events, nullptr));
+	TeeDisconnect(&handle);
+}
+
+/*
+Full trace ring drops new events, the ring is reusable after drain
+*/
+TEST(MeTeeBackendTEST, BACKEND_TraceDropped)
+{
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	std::vector<TraceEvent> events;
+	uint8_t req[8] = {0};
+
+	TEESTATUS status = OpenLoopback(handle);
+	if (status == TEE_INVALID_PARAMETER)
+		GTEST_SKIP();
+	ASSERT_EQ(TEE_SUCCESS, status);
+	if (TeeTraceStart(4096) == TEE_NOTSUPPORTED) {
+		TeeDisconnect(&handle);
+		GTEST_SKIP();
+	}
+	TeeSetLogLevel(&handle, TEE_LOG_LEVEL_VERBOSE);
+	ASSERT_EQ(TEE_SUCCESS, TeeTraceDrain(TraceCollect, &events, nullptr));
+
+	for (int round = 0; round < 5; round++) {
+		uint64_t dropped = 0;
+
+		events.clear();
+		for (int i = 0; i < 100; i++)
+			TeeWrite(&handle, req, 0, nullptr, 0);
+		ASSERT_EQ(TEE_SUCCESS, TeeTraceDrain(TraceCollect, &events, &dropped));
+		EXPECT_EQ(300u, events.size() + dropped);
+		EXPECT_LT(0u, dropped);
+		for (const auto &ev : events)
+			EXPECT_FALSE(ev.msg.empty());
+	}
+	TeeSetLogLevel(&handle, TEE_LOG_LEVEL_ERROR);
+	TeeTraceStop();
+	TeeDisconnect(&handle);
+}
+
+/*
+Events of concurrent producers are either drained or counted as dropped
+*/
+TEST(MeTeeBackendTEST, BACKEND_TraceConcurrent)
+{
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	const int threads = 4;
+	const int iterations = 2000;
+	std::vector<TraceEvent> events;
+	std::atomic<int> running(threads);
+	uint64_t dropped = 0;
+	uint64_t total_dropped = 0;
+
+	TEESTATUS status = OpenLoopback(handle);
+	if (status == TEE_INVALID_PARAMETER)
+		GTEST_SKIP();
+	ASSERT_EQ(TEE_SUCCESS, status);
+	if (TeeTraceStart(16 * 1024) == TEE_NOTSUPPORTED) {
+		TeeDisconnect(&handle);
+		GTEST_SKIP();
+	}
+	TeeSetLogLevel(&handle, TEE_LOG_LEVEL_VERBOSE);
+	ASSERT_EQ(TEE_SUCCESS, TeeTraceDrain(TraceCollect, &events, nullptr));
+	events.clear();
+
+	std::vector<std::thread> producers;
+	for (int t = 0; t < threads; t++)
+		producers.emplace_back([&] {
+			uint8_t req[8] = {0};
+
+			for (int i = 0; i < iterations; i++)
+				TeeWrite(&handle, req, 0, nullptr, 0);
+			running--;
+		});
+	while (running) {
+		ASSERT_EQ(TEE_SUCCESS, TeeTraceDrain(TraceCollect, &events, &dropped));
+		total_dropped += dropped;
+	}
+	for (auto &th : producers)
+		th.join();
+	ASSERT_EQ(TEE_SUCCESS, TeeTraceDrain(TraceCollect, &events, &dropped));
+	total_dropped += dropped;
+	TeeSetLogLevel(&handle, TEE_LOG_LEVEL_ERROR);
+
+	/* entry, error and exit for every call */
+	EXPECT_EQ(3u * threads * iterations, events.size() + total_dropped);
+	for (const auto &ev : events) {
+		EXPECT_EQ("TeeWrite", ev.function);
+		EXPECT_TRUE(ev.msg == "Entry\n" || ev.msg == "One of the parameters was illegal\n" ||
+			    ev.msg == "Exit with status: 4\n") << ev.msg;
+	}
+	TeeTraceStop();
+	TeeDisconnect(&handle);
+}
+
+struct LogEvents {
+	std::vector<struct tee_log_event> ops;
+	std::vector<std::string> messages;
+};
+
+static void LogCollect(void *ctx, const struct tee_log_event *event)
+{
+	LogEvents *events = static_cast<LogEvents*>(ctx);
+
+	if (event->op == TEE_LOG_OP_MESSAGE) {
+		char buf[256];
+
+		ASSERT_EQ(TEE_SUCCESS, TeeLogEventFormat(event, buf, sizeof(buf)));
+		events->messages.push_back(buf);
+	} else {
+		events->ops.push_back(*event);
+	}
+}
+
+static int text_logs;
+static void TextLogCount(bool, const char *)
+{
+	text_logs++;
+}
+
+/*
+Structured callback gets typed operation events instead of text
+*/
+TEST(MeTeeBackendTEST, BACKEND_LogCallback3)
+{
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	LogEvents events;
+	uint8_t req[8] = {0};
+	uint8_t rsp[256];
+	char buf[128];
+	size_t size;
+
+	TEESTATUS status = OpenLoopback(handle);
+	if (status == TEE_INVALID_PARAMETER)
+		GTEST_SKIP();
+	ASSERT_EQ(TEE_SUCCESS, status);
+	ASSERT_EQ(TEE_SUCCESS, TeeSetLogCallback2(&handle, TextLogCount));
+	status = TeeSetLogCallback3(&handle, LogCollect, &events);
+	if (status == TEE_NOTSUPPORTED) {
+		TeeDisconnect(&handle);
+		GTEST_SKIP();
+	}
+	ASSERT_EQ(TEE_SUCCESS, status);
+	TeeSetLogLevel(&handle, TEE_LOG_LEVEL_VERBOSE);
+	text_logs = 0;
+
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+	ASSERT_EQ(TEE_SUCCESS, TeeRead(&handle, rsp, sizeof(rsp), &size, 1000));
+	EXPECT_EQ(TEE_TIMEOUT, TeeRead(&handle, rsp, sizeof(rsp), &size, 10));
+
+	EXPECT_EQ(0, text_logs);
+	ASSERT_EQ(3u, events.ops.size());
+	EXPECT_EQ(TEE_LOG_OP_WRITE, events.ops[0].op);
+	EXPECT_EQ(TEE_LOG_LEVEL_VERBOSE, events.ops[0].level);
+	EXPECT_EQ((uintptr_t)handle.handle, events.ops[0].handle_id);
+	EXPECT_EQ(TEE_SUCCESS, events.ops[0].status);
+	EXPECT_EQ(sizeof(req), events.ops[0].bytes);
+	EXPECT_STREQ("TeeWrite", events.ops[0].function);
+	EXPECT_EQ(TEE_LOG_OP_READ, events.ops[1].op);
+	EXPECT_EQ(sizeof(req), events.ops[1].bytes);
+	EXPECT_EQ(TEE_LOG_OP_READ, events.ops[2].op);
+	EXPECT_EQ(TEE_LOG_LEVEL_ERROR, events.ops[2].level);
+	EXPECT_EQ(TEE_TIMEOUT, events.ops[2].status);
+	EXPECT_EQ(ETIME, events.ops[2].error);
+	EXPECT_EQ(0u, events.ops[2].bytes);
+	EXPECT_LE(5000u, events.ops[2].duration_us);
+	ASSERT_EQ(TEE_SUCCESS, TeeLogEventFormat(&events.ops[2], buf, sizeof(buf)));
+	EXPECT_EQ(0, strncmp(buf, "read status 6 error 62 bytes 0 in ", 34)) << buf;
+	EXPECT_NE(events.messages.end(),
+		  std::find(events.messages.begin(), events.messages.end(), "call write length = 8\n"));
+	EXPECT_NE(events.messages.end(),
+		  std::find(events.messages.begin(), events.messages.end(), "Exit with status: 6\n"));
+
+	/* errors only */
+	TeeSetLogLevel(&handle, TEE_LOG_LEVEL_ERROR);
+	events.ops.clear();
+	events.messages.clear();
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+	ASSERT_EQ(TEE_SUCCESS, TeeRead(&handle, rsp, sizeof(rsp), &size, 1000));
+	EXPECT_EQ(TEE_INVALID_PARAMETER, TeeWrite(&handle, req, 0, &size, 1000));
+	ASSERT_EQ(1u, events.ops.size());
+	EXPECT_EQ(TEE_INVALID_PARAMETER, events.ops[0].status);
+	EXPECT_EQ(0, events.ops[0].error);
+	ASSERT_EQ(1u, events.messages.size());
+	EXPECT_EQ("One of the parameters was illegal\n", events.messages[0]);
+
+	/* back to text */
+	ASSERT_EQ(TEE_SUCCESS, TeeSetLogCallback3(&handle, nullptr, nullptr));
+	EXPECT_EQ(TEE_INVALID_PARAMETER, TeeWrite(&handle, req, 0, &size, 1000));
+	EXPECT_EQ(1, text_logs);
+	EXPECT_EQ(1u, events.ops.size());
+	TeeDisconnect(&handle);
+}
+
+static TEESTATUS OpenReplay(TEEHANDLE &handle, const std::string &path, const GUID *guid = &GUID_DEVINTERFACE_MKHI)
+{
+	struct tee_device_address addr = {};
+
+	addr.type = tee_device_address::TEE_DEVICE_TYPE_REPLAY;
+	addr.data.path = path.c_str();
+	TEESTATUS status = TeeInitFull2(&handle, guid, addr, TEE_LOG_LEVEL_ERROR, nullptr);
+	if (status)
+		return status;
+	return TeeConnect(&handle);
+}
+
+/*
+Session captured on the socket device is replayed with the original timing
+*/
+TEST(MeTeeBackendTEST, BACKEND_CaptureReplay)
+{
+	std::string cap = "/tmp/metee_capture_test_" + std::to_string(getpid()) + ".cap";
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	struct tee_device_address addr = {};
+	uint8_t req[2] = {10, 0};
+	uint8_t rsp[256];
+	uint8_t fw[4096];
+	size_t size;
+	int sv[2];
+
+	ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv));
+	addr.type = tee_device_address::TEE_DEVICE_TYPE_SOCKET;
+	addr.data.handle = sv[0];
+	TEESTATUS status = OpenAddr(handle, addr);
+	if (status == TEE_INVALID_PARAMETER) {
+		close(sv[0]);
+		close(sv[1]);
+		GTEST_SKIP();
+	}
+	ASSERT_EQ(TEE_SUCCESS, status);
+	status = TeeCaptureStart(&handle, cap.c_str());
+	if (status == TEE_NOTSUPPORTED) {
+		TeeDisconnect(&handle);
+		close(sv[0]);
+		close(sv[1]);
+		GTEST_SKIP();
+	}
+	ASSERT_EQ(TEE_SUCCESS, status);
+	EXPECT_EQ(TEE_BUSY, TeeCaptureStart(&handle, cap.c_str()));
+
+	/* the first response is late */
+	std::thread peer([&] {
+		ssize_t len;
+		bool first = true;
+
+		while ((len = recv(sv[1], fw, sizeof(fw), 0)) > 0) {
+			if (first)
+				std::this_thread::sleep_for(std::chrono::milliseconds(200));
+			first = false;
+			fw[0]++;
+			send(sv[1], fw, (size_t)len, MSG_NOSIGNAL);
+		}
+	});
+	for (uint8_t i = 0; i < 2; i++) {
+		req[1] = i;
+		ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+		ASSERT_EQ(TEE_SUCCESS, TeeRead(&handle, rsp, sizeof(rsp), &size, 1000));
+	}
+	ASSERT_EQ(TEE_SUCCESS, TeeCaptureStop(&handle));
+	TeeDisconnect(&handle);
+	shutdown(sv[1], SHUT_RDWR);
+	peer.join();
+	close(sv[0]);
+	close(sv[1]);
+
+	ASSERT_EQ(TEE_SUCCESS, OpenReplay(handle, cap));
+	EXPECT_EQ(4096, TeeGetMaxMsgLen(&handle));
+	EXPECT_EQ(1, TeeGetProtocolVer(&handle));
+	/* the capture waits for a write */
+	EXPECT_EQ(TEE_TIMEOUT, TeeRead(&handle, rsp, sizeof(rsp), &size, 10));
+
+	for (uint8_t i = 0; i < 2; i++) {
+		req[1] = i;
+		auto start = std::chrono::steady_clock::now();
+		ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+		ASSERT_EQ(TEE_SUCCESS, TeeRead(&handle, rsp, sizeof(rsp), &size, 1000));
+		auto elapsed = std::chrono::steady_clock::now() - start;
+		EXPECT_EQ(sizeof(req), size);
+		EXPECT_EQ(11, rsp[0]);
+		EXPECT_EQ(i, rsp[1]);
+		if (i == 0)
+			EXPECT_LE(std::chrono::milliseconds(150), elapsed);
+		else
+			EXPECT_GT(std::chrono::milliseconds(150), elapsed);
+	}
+	EXPECT_EQ(TEE_DISCONNECTED, TeeRead(&handle, rsp, sizeof(rsp), &size, 10));
+	EXPECT_EQ(TEE_DISCONNECTED, TeeWrite(&handle, req, sizeof(req), &size, 10));
+
+	uint32_t fwsts;
+	EXPECT_EQ(TEE_NOTSUPPORTED, TeeFWStatus(&handle, 0, &fwsts));
+	TeeDisconnect(&handle);
+
+	/* no delays, responses not read are skipped by the next write */
+	ASSERT_EQ(TEE_SUCCESS, OpenReplay(handle, cap));
+	ASSERT_EQ(TEE_SUCCESS, TeeReplaySetSpeed(&handle, 0));
+	auto start = std::chrono::steady_clock::now();
+	req[1] = 0;
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+	req[1] = 1;
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+	ASSERT_EQ(TEE_SUCCESS, TeeRead(&handle, rsp, sizeof(rsp), &size, 1000));
+	EXPECT_GT(std::chrono::milliseconds(150), std::chrono::steady_clock::now() - start);
+	EXPECT_EQ(1, rsp[1]);
+	TeeDisconnect(&handle);
+
+	const GUID other = {0x12345678, 0x9abc, 0x4043, {0x88, 0xef, 0x9e, 0x39, 0xc6, 0xf6, 0x3e, 0x0f}};
+	EXPECT_EQ(TEE_CLIENT_NOT_FOUND, OpenReplay(handle, cap, &other));
+	TeeDisconnect(&handle);
+	unlink(cap.c_str());
+}
+
+/*
+Replay of a missing or foreign file fails on init
+*/
+TEST(MeTeeBackendTEST, BACKEND_ReplayBadFile)
+{
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+
+	if (TeeReplaySetSpeed(&handle, 1) == TEE_NOTSUPPORTED)
+		GTEST_SKIP();
+	EXPECT_EQ(TEE_DEVICE_NOT_FOUND, OpenReplay(handle, "/tmp/metee_capture_not_exists.cap"));
+	EXPECT_EQ(TEE_INTERNAL_ERROR, OpenReplay(handle, "/proc/self/cmdline"));
+}
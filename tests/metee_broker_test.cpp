@@ -0,0 +1,520 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+#include <atomic>
+#include <sys/un.h>
+#include "metee_test.h"
+#include "metee_broker.h"
+#include "fake_device.h"
+
+/* FW clients with this GUID prefix are missing */
+static const uint32_t MissingClient = 0xbad00000;
+static std::atomic<int> fake_closes;
+
+/* Broker device operations over fake device, the FW side is driven by the test */
+static TEESTATUS FakeOpen(void *ctx, const GUID *guid, void **dev, uint32_t *max_msg_len, uint8_t *protocol_ver)
+{
+	fake_device *fake = static_cast<fake_device*>(ctx);
+
+	if ((guid->l & 0xfff00000) == MissingClient)
+		return TEE_CLIENT_NOT_FOUND;
+	fake->connect();
+	*dev = fake;
+	*max_msg_len = fake->max_msg_len();
+	*protocol_ver = 1;
+	return TEE_SUCCESS;
+}
+
+static int FakeFd(void *dev)
+{
+	return static_cast<fake_device*>(dev)->device_handle();
+}
+
+static TEESTATUS FakeWrite(void *dev, const void *buffer, size_t size, uint32_t timeout)
+{
+	try {
+		static_cast<fake_device*>(dev)->write(buffer, size, timeout);
+	}
+	catch (const intel::security::metee_exception &ex) {
+		return (TEESTATUS)ex.code().value();
+	}
+	return TEE_SUCCESS;
+}
+
+static TEESTATUS FakeRead(void *dev, void *buffer, size_t size, size_t *bytes, uint32_t timeout)
+{
+	try {
+		*bytes = static_cast<fake_device*>(dev)->read(buffer, size, timeout);
+	}
+	catch (const intel::security::metee_exception &ex) {
+		return (TEESTATUS)ex.code().value();
+	}
+	return TEE_SUCCESS;
+}
+
+static void FakeClose(void *)
+{
+	fake_closes++;
+}
+
+static const struct metee_broker_device_ops FakeOps = {
+	FakeOpen, FakeFd, FakeWrite, FakeRead, FakeClose
+};
+
+class MeTeeBrokerTEST : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		struct metee_broker_config cfg = {};
+
+		path = "/tmp/metee_broker_test_" + std::to_string(getpid()) + ".sock";
+		cfg.socket_path = path.c_str();
+		cfg.ops = &FakeOps;
+		cfg.ops_ctx = &dev;
+		cfg.timeout = 1000;
+		ASSERT_EQ(TEE_SUCCESS, metee_broker_create(&cfg, &broker));
+		runner = std::thread(metee_broker_run, broker);
+	}
+
+	void TearDown() override
+	{
+		metee_broker_stop(broker);
+		runner.join();
+		metee_broker_destroy(broker);
+	}
+
+	TEESTATUS Open(TEEHANDLE &handle, bool shm = false, const GUID *guid = &GUID_DEVINTERFACE_MKHI)
+	{
+		struct tee_device_address addr = {};
+
+		addr.type = shm ? tee_device_address::TEE_DEVICE_TYPE_BROKER_SHM : tee_device_address::TEE_DEVICE_TYPE_BROKER;
+		addr.data.path = path.c_str();
+		TEESTATUS status = TeeInitFull2(&handle, guid, addr, TEE_LOG_LEVEL_ERROR, nullptr);
+		if (status)
+			return status;
+		return TeeConnect(&handle);
+	}
+
+	/* FW side: answer count requests with the request, first byte incremented */
+	void Respond(int count, std::vector<uint8_t> *order = nullptr, int delay_ms = 0)
+	{
+		for (int i = 0; i < count; i++) {
+			std::vector<uint8_t> msg = dev.fw_receive(1000);
+			if (order)
+				order->push_back(msg[1]);
+			if (i == 0 && delay_ms)
+				std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+			msg[0]++;
+			dev.fw_send(msg);
+		}
+	}
+
+	fake_device dev{256};
+	std::string path;
+	struct metee_broker *broker = nullptr;
+	std::thread runner;
+};
+
+/*
+Client connects through the broker and completes transaction
+*/
+TEST_F(MeTeeBrokerTEST, BROKER_Transact)
+{
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	uint8_t req[2] = {10, 0};
+	uint8_t rsp[256];
+	size_t size = 0;
+
+	ASSERT_EQ(TEE_SUCCESS, Open(handle));
+	EXPECT_EQ(256, TeeGetMaxMsgLen(&handle));
+	EXPECT_EQ(1, TeeGetProtocolVer(&handle));
+
+	std::thread fw([&] { Respond(1, nullptr, 0); });
+	EXPECT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+	EXPECT_EQ(sizeof(req), size);
+	EXPECT_EQ(TEE_SUCCESS, TeeRead(&handle, rsp, sizeof(rsp), &size, 1000));
+	fw.join();
+	EXPECT_EQ(sizeof(req), size);
+	EXPECT_EQ(11, rsp[0]);
+
+	uint32_t fwsts;
+	EXPECT_EQ(TEE_NOTSUPPORTED, TeeFWStatus(&handle, 0, &fwsts));
+	TeeDisconnect(&handle);
+}
+
+/*
+Requests of two clients are served in round robin order:
+client A queues three requests, client B one; B is served right after the first A request
+*/
+TEST_F(MeTeeBrokerTEST, BROKER_FairQueue)
+{
+	TEEHANDLE a = TEEHANDLE_ZERO;
+	TEEHANDLE b = TEEHANDLE_ZERO;
+	std::vector<uint8_t> order;
+	uint8_t rsp[256];
+	size_t size;
+
+	ASSERT_EQ(TEE_SUCCESS, Open(a));
+	ASSERT_EQ(TEE_SUCCESS, Open(b));
+
+	std::thread fw([&] { Respond(4, &order, 200); });
+	for (uint8_t i = 0; i < 3; i++) {
+		uint8_t req[2] = {0, (uint8_t)('a' + i)};
+		ASSERT_EQ(TEE_SUCCESS, TeeWrite(&a, req, sizeof(req), &size, 1000));
+	}
+	uint8_t req[2] = {0, 'x'};
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&b, req, sizeof(req), &size, 1000));
+
+	for (uint8_t i = 0; i < 3; i++) {
+		ASSERT_EQ(TEE_SUCCESS, TeeRead(&a, rsp, sizeof(rsp), &size, 2000));
+		EXPECT_EQ('a' + i, rsp[1]);
+	}
+	ASSERT_EQ(TEE_SUCCESS, TeeRead(&b, rsp, sizeof(rsp), &size, 2000));
+	EXPECT_EQ('x', rsp[1]);
+	fw.join();
+
+	EXPECT_EQ((std::vector<uint8_t>{'a', 'x', 'b', 'c'}), order);
+	TeeDisconnect(&a);
+	TeeDisconnect(&b);
+}
+
+/*
+FW does not answer: requester gets timeout, next request is served after reconnect
+*/
+TEST_F(MeTeeBrokerTEST, BROKER_FwTimeout)
+{
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	uint8_t req[2] = {0, 0};
+	uint8_t rsp[256];
+	size_t size;
+
+	ASSERT_EQ(TEE_SUCCESS, Open(handle));
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+	dev.fw_receive(1000);
+	EXPECT_EQ(TEE_TIMEOUT, TeeRead(&handle, rsp, sizeof(rsp), &size, 3000));
+
+	std::thread fw([&] { Respond(1, nullptr, 0); });
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+	EXPECT_EQ(TEE_SUCCESS, TeeRead(&handle, rsp, sizeof(rsp), &size, 3000));
+	fw.join();
+	EXPECT_EQ(2, dev.connects());
+	TeeDisconnect(&handle);
+}
+
+/*
+Failed connects and departed clients give their FW connection slot back,
+made-up GUIDs can not lock other clients out
+*/
+TEST_F(MeTeeBrokerTEST, BROKER_ConnSlots)
+{
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	GUID guid = GUID_DEVINTERFACE_MKHI;
+	int closes = fake_closes;
+
+	for (uint32_t i = 0; i < 40; i++) {
+		guid.l = MissingClient + i;
+		EXPECT_EQ(TEE_CLIENT_NOT_FOUND, Open(handle, false, &guid));
+		TeeDisconnect(&handle);
+	}
+	for (uint32_t i = 0; i < 40; i++) {
+		guid.l = 0x900d0000 + i;
+		ASSERT_EQ(TEE_SUCCESS, Open(handle, false, &guid));
+		TeeDisconnect(&handle);
+	}
+
+	TEEHANDLE a = TEEHANDLE_ZERO;
+	TEEHANDLE b = TEEHANDLE_ZERO;
+	uint8_t req[2] = {0, 0};
+	uint8_t rsp[256];
+	size_t size;
+
+	ASSERT_EQ(TEE_SUCCESS, Open(a));
+	ASSERT_EQ(TEE_SUCCESS, Open(b));
+	TeeDisconnect(&a);
+	std::thread fw([&] { Respond(1, nullptr, 0); });
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&b, req, sizeof(req), &size, 1000));
+	EXPECT_EQ(TEE_SUCCESS, TeeRead(&b, rsp, sizeof(rsp), &size, 1000));
+	fw.join();
+	TeeDisconnect(&b);
+	/* every connection of a departed GUID is closed once its last client left */
+	for (int i = 0; i < 100 && fake_closes - closes < 41; i++)
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	EXPECT_EQ(41, fake_closes - closes);
+}
+
+/*
+A live broker socket is not taken over, a stale one is replaced
+*/
+TEST_F(MeTeeBrokerTEST, BROKER_SocketInUse)
+{
+	struct metee_broker_config cfg = {};
+	struct metee_broker *other = nullptr;
+	std::string file = path + ".file";
+
+	cfg.socket_path = path.c_str();
+	cfg.ops = &FakeOps;
+	cfg.ops_ctx = &dev;
+	EXPECT_EQ(TEE_BUSY, metee_broker_create(&cfg, &other));
+
+	std::ofstream(file) << "data";
+	cfg.socket_path = file.c_str();
+	EXPECT_EQ(TEE_INVALID_PARAMETER, metee_broker_create(&cfg, &other));
+	EXPECT_EQ(0, access(file.c_str(), F_OK));
+	unlink(file.c_str());
+
+	/* socket of a broker that is gone */
+	std::string stale = path + ".stale";
+	struct sockaddr_un addr = {};
+	int fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+	ASSERT_NE(-1, fd);
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, stale.c_str(), sizeof(addr.sun_path) - 1);
+	unlink(stale.c_str());
+	ASSERT_EQ(0, bind(fd, (struct sockaddr *)&addr, sizeof(addr)));
+	close(fd);
+	cfg.socket_path = stale.c_str();
+	ASSERT_EQ(TEE_SUCCESS, metee_broker_create(&cfg, &other));
+	metee_broker_destroy(other);
+}
+
+/*
+Client leaving with outstanding request does not disturb other clients
+*/
+TEST_F(MeTeeBrokerTEST, BROKER_ClientGone)
+{
+	TEEHANDLE a = TEEHANDLE_ZERO;
+	TEEHANDLE b = TEEHANDLE_ZERO;
+	uint8_t req[2] = {0, 0};
+	uint8_t rsp[256];
+	size_t size;
+
+	ASSERT_EQ(TEE_SUCCESS, Open(a));
+	ASSERT_EQ(TEE_SUCCESS, Open(b));
+	std::thread fw([&] { Respond(2, nullptr, 100); });
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&a, req, sizeof(req), &size, 1000));
+	TeeDisconnect(&a);
+	req[1] = 'b';
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&b, req, sizeof(req), &size, 1000));
+	ASSERT_EQ(TEE_SUCCESS, TeeRead(&b, rsp, sizeof(rsp), &size, 2000));
+	EXPECT_EQ('b', rsp[1]);
+	fw.join();
+	TeeDisconnect(&b);
+}
+
+/*
+Client with shared memory data path completes transaction
+*/
+TEST_F(MeTeeBrokerTEST, BROKER_ShmTransact)
+{
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	uint8_t req[2] = {10, 0};
+	uint8_t rsp[256];
+	size_t size = 0;
+
+	ASSERT_EQ(TEE_SUCCESS, Open(handle, true));
+	EXPECT_EQ(256, TeeGetMaxMsgLen(&handle));
+
+	std::thread fw([&] { Respond(1, nullptr, 0); });
+	EXPECT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+	EXPECT_EQ(sizeof(req), size);
+	EXPECT_EQ(TEE_SUCCESS, TeeRead(&handle, rsp, sizeof(rsp), &size, 1000));
+	fw.join();
+	EXPECT_EQ(sizeof(req), size);
+	EXPECT_EQ(11, rsp[0]);
+
+	std::vector<uint8_t> big(257);
+	EXPECT_EQ(TEE_INVALID_PARAMETER, TeeWrite(&handle, big.data(), big.size(), &size, 1000));
+	EXPECT_EQ(TEE_TIMEOUT, TeeRead(&handle, rsp, sizeof(rsp), &size, 100));
+	TeeDisconnect(&handle);
+}
+
+/*
+Shared memory rings wrap around many times, every response matches its request
+*/
+TEST_F(MeTeeBrokerTEST, BROKER_ShmRingWrap)
+{
+	const int count = 5000;
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	std::vector<uint8_t> req(200);
+	uint8_t rsp[256];
+	size_t size;
+
+	ASSERT_EQ(TEE_SUCCESS, Open(handle, true));
+
+	std::thread fw([&] { Respond(count, nullptr, 0); });
+	for (int i = 0; i < count; i++) {
+		req[0] = (uint8_t)i;
+		req[1] = (uint8_t)(i >> 8);
+		req.resize(100 + (size_t)(i % 100));
+		ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req.data(), req.size(), &size, 1000));
+		ASSERT_EQ(TEE_SUCCESS, TeeRead(&handle, rsp, sizeof(rsp), &size, 1000));
+		ASSERT_EQ(req.size(), size);
+		ASSERT_EQ((uint8_t)(i + 1), rsp[0]);
+		ASSERT_EQ((uint8_t)(i >> 8), rsp[1]);
+	}
+	fw.join();
+	TeeDisconnect(&handle);
+}
+
+/*
+Shared memory and socket clients share the FW connection in round robin order
+*/
+TEST_F(MeTeeBrokerTEST, BROKER_ShmFairQueue)
+{
+	TEEHANDLE a = TEEHANDLE_ZERO;
+	TEEHANDLE b = TEEHANDLE_ZERO;
+	std::vector<uint8_t> order;
+	uint8_t rsp[256];
+	size_t size;
+
+	ASSERT_EQ(TEE_SUCCESS, Open(a, true));
+	ASSERT_EQ(TEE_SUCCESS, Open(b));
+
+	std::thread fw([&] { Respond(4, &order, 200); });
+	for (uint8_t i = 0; i < 3; i++) {
+		uint8_t req[2] = {0, (uint8_t)('a' + i)};
+		ASSERT_EQ(TEE_SUCCESS, TeeWrite(&a, req, sizeof(req), &size, 1000));
+	}
+	uint8_t req[2] = {0, 'x'};
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&b, req, sizeof(req), &size, 1000));
+
+	for (uint8_t i = 0; i < 3; i++) {
+		ASSERT_EQ(TEE_SUCCESS, TeeRead(&a, rsp, sizeof(rsp), &size, 2000));
+		EXPECT_EQ('a' + i, rsp[1]);
+	}
+	ASSERT_EQ(TEE_SUCCESS, TeeRead(&b, rsp, sizeof(rsp), &size, 2000));
+	EXPECT_EQ('x', rsp[1]);
+	fw.join();
+
+	EXPECT_EQ((std::vector<uint8_t>{'a', 'x', 'b', 'c'}), order);
+	TeeDisconnect(&a);
+	TeeDisconnect(&b);
+}
+
+/*
+Full request ring blocks the writer, full response ring pauses the client until it reads
+*/
+TEST_F(MeTeeBrokerTEST, BROKER_ShmBackpressure)
+{
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	std::vector<uint8_t> req(256);
+	uint8_t rsp[256];
+	size_t size;
+	int written = 0;
+
+	ASSERT_EQ(TEE_SUCCESS, Open(handle, true));
+	/* FW holds the first request, the rest piles up in the ring */
+	while (TeeWrite(&handle, req.data(), req.size(), &size, 100) == TEE_SUCCESS)
+		written++;
+	EXPECT_GT(written, 100);
+
+	std::thread fw([&] { Respond(written, nullptr, 0); });
+	for (int i = 0; i < written; i++)
+		ASSERT_EQ(TEE_SUCCESS, TeeRead(&handle, rsp, sizeof(rsp), &size, 2000));
+	fw.join();
+	EXPECT_EQ(TEE_SUCCESS, TeeWrite(&handle, req.data(), req.size(), &size, 100));
+	TeeDisconnect(&handle);
+}
+
+/*
+Reader waiting for a response and writer waiting for ring space on one handle
+do not consume each other's wakeups
+*/
+TEST_F(MeTeeBrokerTEST, BROKER_ShmReadWhileWriting)
+{
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	std::vector<uint8_t> req(256);
+	uint8_t rsp[256];
+	size_t size;
+	int written = 0;
+	int received = 0;
+	TEESTATUS write_status = TEE_INTERNAL_ERROR;
+
+	ASSERT_EQ(TEE_SUCCESS, Open(handle, true));
+	while (TeeWrite(&handle, req.data(), req.size(), &size, 100) == TEE_SUCCESS)
+		written++;
+
+	std::thread reader([&] {
+		size_t len;
+		while (received < written + 1 &&
+		       TeeRead(&handle, rsp, sizeof(rsp), &len, 3000) == TEE_SUCCESS)
+			received++;
+	});
+	std::thread writer([&] {
+		size_t len;
+		write_status = TeeWrite(&handle, req.data(), req.size(), &len, 3000);
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	std::thread fw([&] { Respond(written + 1, nullptr, 0); });
+	writer.join();
+	reader.join();
+	fw.join();
+	EXPECT_EQ(TEE_SUCCESS, write_status);
+	EXPECT_EQ(written + 1, received);
+	TeeDisconnect(&handle);
+}
+
+/*
+FW timeout is reported through the shared memory data path
+*/
+TEST_F(MeTeeBrokerTEST, BROKER_ShmFwTimeout)
+{
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	uint8_t req[2] = {0, 0};
+	uint8_t rsp[256];
+	size_t size;
+
+	ASSERT_EQ(TEE_SUCCESS, Open(handle, true));
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+	dev.fw_receive(1000);
+	EXPECT_EQ(TEE_TIMEOUT, TeeRead(&handle, rsp, sizeof(rsp), &size, 3000));
+	TeeDisconnect(&handle);
+}
+
+/*
+Shared memory data path is counted as wait only
+*/
+TEST_F(MeTeeBrokerTEST, BROKER_ShmStats)
+{
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	struct tee_stats st;
+	uint8_t req[8] = {0};
+	uint8_t rsp[256];
+	size_t size;
+
+	ASSERT_EQ(TEE_SUCCESS, Open(handle, true));
+	if (TeeGetStats(&handle, &st) == TEE_NOTSUPPORTED) {
+		TeeDisconnect(&handle);
+		GTEST_SKIP();
+	}
+
+	std::thread fw([&] { Respond(1, nullptr, 0); });
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+	ASSERT_EQ(TEE_SUCCESS, TeeRead(&handle, rsp, sizeof(rsp), &size, 1000));
+	fw.join();
+
+	ASSERT_EQ(TEE_SUCCESS, TeeGetStats(&handle, &st));
+	EXPECT_EQ(1u, st.write_msgs);
+	EXPECT_EQ(1u, st.read_msgs);
+	EXPECT_EQ(1u, st.write_wait.count);
+	EXPECT_EQ(1u, st.write.count);
+	EXPECT_EQ(1u, st.read_wait.count);
+	EXPECT_EQ(1u, st.read.count);
+	EXPECT_EQ(1u, st.transact.count);
+	TeeDisconnect(&handle);
+}
+
+/*
+Broker is not running
+*/
+TEST(MeTeeBrokerNoServerTEST, BROKER_NotRunning)
+{
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	struct tee_device_address addr = {};
+
+	addr.type = tee_device_address::TEE_DEVICE_TYPE_BROKER;
+	addr.data.path = "/tmp/metee_broker_not_running.sock";
+	EXPECT_EQ(TEE_DEVICE_NOT_FOUND,
+		TeeInitFull2(&handle, &GUID_DEVINTERFACE_MKHI, addr, TEE_LOG_LEVEL_ERROR, nullptr));
+}
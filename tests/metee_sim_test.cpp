@@ -0,0 +1,303 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+#include <poll.h>
+#include <sys/wait.h>
+#include "metee_test.h"
+#include "metee_sim.h"
+
+DEFINE_GUID(GUID_SIM_AMTHI, 0x12f80028, 0xb4b7, 0x4b2d,
+	0xac, 0xa8, 0x46, 0xe0, 0xff, 0x65, 0x81, 0x4c);
+DEFINE_GUID(GUID_SIM_FWU, 0x87d90ca5, 0x3495, 0x4559,
+	0x81, 0x05, 0x3f, 0xbf, 0xa3, 0x7b, 0x8b, 0x79);
+DEFINE_GUID(GUID_SIM_ECHO, 0x5f7a2c10, 0x1b2e, 0x4d3c,
+	0x9a, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77);
+DEFINE_GUID(GUID_SIM_UNKNOWN, 0x01020304, 0x0506, 0x0708,
+	0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10);
+
+class MeTeeSimTEST : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		struct metee_sim_config cfg = {};
+		struct metee_sim_client client;
+
+		path = "/tmp/metee_sim_test_" + std::to_string(getpid()) + ".sock";
+		cfg.socket_path = path.c_str();
+		ASSERT_EQ(TEE_SUCCESS, metee_sim_create(&cfg, &sim));
+		metee_sim_client_preset(METEE_SIM_MKHI, &client);
+		ASSERT_EQ(TEE_SUCCESS, metee_sim_add_client(sim, &client));
+		metee_sim_client_preset(METEE_SIM_AMTHI, &client);
+		ASSERT_EQ(TEE_SUCCESS, metee_sim_add_client(sim, &client));
+		metee_sim_client_preset(METEE_SIM_FWU, &client);
+		ASSERT_EQ(TEE_SUCCESS, metee_sim_add_client(sim, &client));
+		runner = std::thread(metee_sim_run, sim);
+	}
+
+	void TearDown() override
+	{
+		metee_sim_stop(sim);
+		runner.join();
+		metee_sim_destroy(sim);
+	}
+
+	TEESTATUS Open(TEEHANDLE &handle, const GUID *guid)
+	{
+		struct tee_device_address addr = {};
+
+		addr.type = tee_device_address::TEE_DEVICE_TYPE_BROKER;
+		addr.data.path = path.c_str();
+		TEESTATUS status = TeeInitFull2(&handle, guid, addr, TEE_LOG_LEVEL_ERROR, nullptr);
+		if (status)
+			return status;
+		return TeeConnect(&handle);
+	}
+
+	/* echo client with the given latency and reset injection */
+	void AddEcho(uint32_t latency_us, uint32_t reset_after = 0)
+	{
+		struct metee_sim_client client;
+
+		metee_sim_client_preset(METEE_SIM_ECHO, &client);
+		client.guid = GUID_SIM_ECHO;
+		client.latency_us = latency_us;
+		client.reset_after = reset_after;
+		ASSERT_EQ(TEE_SUCCESS, metee_sim_add_client(sim, &client));
+	}
+
+	std::string path;
+	struct metee_sim *sim = nullptr;
+	std::thread runner;
+};
+
+/*
+MKHI GET_FW_VERSION answered with the configured version
+*/
+TEST_F(MeTeeSimTEST, SIM_Mkhi)
+{
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	GEN_GET_FW_VERSION req;
+	GEN_GET_FW_VERSION_ACK rsp;
+	size_t size = 0;
+
+	ASSERT_EQ(TEE_SUCCESS, Open(handle, &GUID_DEVINTERFACE_MKHI));
+	EXPECT_EQ(512, TeeGetMaxMsgLen(&handle));
+	EXPECT_EQ(1, TeeGetProtocolVer(&handle));
+
+	req.Header.Data = 0;
+	req.Header.Fields.GroupId = MKHI_GEN_GROUP_ID;
+	req.Header.Fields.Command = GEN_GET_FW_VERSION_CMD;
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, &req, sizeof(req), &size, 1000));
+	ASSERT_EQ(TEE_SUCCESS, TeeRead(&handle, &rsp, sizeof(rsp), &size, 1000));
+	ASSERT_EQ(sizeof(rsp), size);
+	EXPECT_EQ(1u, rsp.Header.Fields.IsResponse);
+	EXPECT_EQ(GEN_GET_FW_VERSION_CMD, rsp.Header.Fields.Command);
+	EXPECT_EQ(0u, rsp.Header.Fields.Result);
+	EXPECT_EQ(18u, rsp.Data.FWVersion.CodeMajor);
+	EXPECT_EQ(0u, rsp.Data.FWVersion.CodeMinor);
+	EXPECT_EQ(5u, rsp.Data.FWVersion.CodeHotFix);
+	EXPECT_EQ(2040u, rsp.Data.FWVersion.CodeBuildNo);
+
+	req.Header.Fields.Command = 0x7F;
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, &req, sizeof(req), &size, 1000));
+	ASSERT_EQ(TEE_SUCCESS, TeeRead(&handle, &rsp, sizeof(rsp), &size, 1000));
+	ASSERT_EQ(sizeof(rsp.Header), size);
+	EXPECT_NE(0u, rsp.Header.Fields.Result);
+	TeeDisconnect(&handle);
+}
+
+/*
+AMTHI code versions and GSC FWU IP version
+*/
+TEST_F(MeTeeSimTEST, SIM_AmthiFwu)
+{
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	const uint32_t amthi_req[3] = {0x00000101, 0x0400001A, 0};
+	std::vector<uint8_t> rsp(4160);
+	uint32_t value;
+	size_t size = 0;
+
+	ASSERT_EQ(TEE_SUCCESS, Open(handle, &GUID_SIM_AMTHI));
+	EXPECT_EQ(4160, TeeGetMaxMsgLen(&handle));
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, amthi_req, sizeof(amthi_req), &size, 1000));
+	ASSERT_EQ(TEE_SUCCESS, TeeRead(&handle, rsp.data(), rsp.size(), &size, 1000));
+	/* header, status, BIOS version, count and 50 description-version pairs */
+	ASSERT_EQ(12u + 4 + 65 + 4 + 50 * 44, size);
+	memcpy(&value, &rsp[4], sizeof(value));
+	EXPECT_EQ(0x0480001Au, value);
+	memcpy(&value, &rsp[8], sizeof(value));
+	EXPECT_EQ(size - 12, value);
+	memcpy(&value, &rsp[12], sizeof(value));
+	EXPECT_EQ(0u, value);
+	EXPECT_STREQ("METEE SIM", (const char *)&rsp[16]);
+	TeeDisconnect(&handle);
+
+	const uint8_t fwu_req[8] = {6, 0, 0, 0, 2, 0, 0, 0};
+	uint16_t version[4];
+
+	ASSERT_EQ(TEE_SUCCESS, Open(handle, &GUID_SIM_FWU));
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, fwu_req, sizeof(fwu_req), &size, 1000));
+	ASSERT_EQ(TEE_SUCCESS, TeeRead(&handle, rsp.data(), rsp.size(), &size, 1000));
+	ASSERT_EQ(28u, size);
+	EXPECT_EQ(6, rsp[0]);
+	EXPECT_EQ(1, rsp[1] & 1);
+	memcpy(&value, &rsp[4], sizeof(value));
+	EXPECT_EQ(0u, value);
+	memcpy(&value, &rsp[12], sizeof(value));
+	EXPECT_EQ(2u, value);
+	memcpy(version, &rsp[20], sizeof(version));
+	EXPECT_EQ(18, version[0]);
+	EXPECT_EQ(2040, version[3]);
+	TeeDisconnect(&handle);
+}
+
+/*
+Connection limit and unknown client
+*/
+TEST_F(MeTeeSimTEST, SIM_MaxConn)
+{
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	TEEHANDLE handle2 = TEEHANDLE_ZERO;
+
+	ASSERT_EQ(TEE_SUCCESS, Open(handle, &GUID_DEVINTERFACE_MKHI));
+	EXPECT_EQ(TEE_BUSY, Open(handle2, &GUID_DEVINTERFACE_MKHI));
+	TeeDisconnect(&handle2);
+	TeeDisconnect(&handle);
+	EXPECT_EQ(TEE_SUCCESS, Open(handle2, &GUID_DEVINTERFACE_MKHI));
+	TeeDisconnect(&handle2);
+
+	EXPECT_EQ(TEE_CLIENT_NOT_FOUND, Open(handle, &GUID_SIM_UNKNOWN));
+	TeeDisconnect(&handle);
+}
+
+/*
+Responses are held for the client latency
+*/
+TEST_F(MeTeeSimTEST, SIM_Latency)
+{
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	uint8_t req[32] = {7};
+	uint8_t rsp[32];
+	size_t size = 0;
+
+	AddEcho(30000);
+	ASSERT_EQ(TEE_SUCCESS, Open(handle, &GUID_SIM_ECHO));
+	auto start = std::chrono::steady_clock::now();
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+	EXPECT_EQ(TEE_TIMEOUT, TeeRead(&handle, rsp, sizeof(rsp), &size, 5));
+	ASSERT_EQ(TEE_SUCCESS, TeeRead(&handle, rsp, sizeof(rsp), &size, 1000));
+	EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(30));
+	EXPECT_EQ(sizeof(req), size);
+	EXPECT_EQ(7, rsp[0]);
+	TeeDisconnect(&handle);
+}
+
+/*
+FW reset drops connections until the client reconnects
+*/
+TEST_F(MeTeeSimTEST, SIM_Reset)
+{
+	TEEHANDLE handle = TEEHANDLE_ZERO;
+	uint8_t req[8] = {1};
+	uint8_t rsp[8];
+	size_t size = 0;
+
+	/* latency keeps the last request pending at the explicit reset */
+	AddEcho(20000, 2);
+	ASSERT_EQ(TEE_SUCCESS, Open(handle, &GUID_SIM_ECHO));
+	for (int i = 0; i < 2; i++) {
+		ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+		ASSERT_EQ(TEE_SUCCESS, TeeRead(&handle, rsp, sizeof(rsp), &size, 1000));
+	}
+	EXPECT_EQ(1u, metee_sim_reset_count(sim));
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+	EXPECT_EQ(TEE_DISCONNECTED, TeeRead(&handle, rsp, sizeof(rsp), &size, 1000));
+
+	ASSERT_EQ(TEE_SUCCESS, TeeConnect(&handle));
+	ASSERT_EQ(TEE_SUCCESS, TeeWrite(&handle, req, sizeof(req), &size, 1000));
+	metee_sim_reset(sim);
+	EXPECT_EQ(TEE_DISCONNECTED, TeeRead(&handle, rsp, sizeof(rsp), &size, 1000));
+	EXPECT_EQ(2u, metee_sim_reset_count(sim));
+	TeeDisconnect(&handle);
+}
+
+/*
+Device API without socket, as used by in-process transports
+*/
+TEST(MeTeeSimDeviceTEST, SIM_Device)
+{
+	struct metee_sim_config cfg = {};
+	struct metee_sim_client client;
+	struct metee_sim_conn *conn = nullptr;
+	struct metee_sim *sim = nullptr;
+	uint32_t max_msg_len = 0;
+	uint8_t protocol_ver = 0;
+	uint8_t req[4] = {1, 2, 3, 4};
+	uint8_t rsp[4];
+	size_t size = 0;
+
+	cfg.seed = 1;
+	ASSERT_EQ(TEE_SUCCESS, metee_sim_create(&cfg, &sim));
+	EXPECT_EQ(TEE_INVALID_PARAMETER, metee_sim_run(sim));
+	metee_sim_client_preset(METEE_SIM_ECHO, &client);
+	client.max_msg_len = 16;
+	client.protocol_ver = 4;
+	client.latency = METEE_SIM_LATENCY_EXPONENTIAL;
+	client.latency_us = 10000;
+	client.jitter_us = 1000;
+	ASSERT_EQ(TEE_SUCCESS, metee_sim_add_client(sim, &client));
+	EXPECT_EQ(TEE_INVALID_PARAMETER, metee_sim_add_client(sim, &client));
+
+	EXPECT_EQ(TEE_CLIENT_NOT_FOUND, metee_sim_open(sim, &GUID_SIM_UNKNOWN, &conn,
+						       &max_msg_len, &protocol_ver));
+	ASSERT_EQ(TEE_SUCCESS, metee_sim_open(sim, &client.guid, &conn, &max_msg_len, &protocol_ver));
+	EXPECT_EQ(16u, max_msg_len);
+	EXPECT_EQ(4, protocol_ver);
+
+	EXPECT_EQ(TEE_INVALID_PARAMETER, metee_sim_write(conn, req, 17));
+	ASSERT_EQ(TEE_SUCCESS, metee_sim_write(conn, req, sizeof(req)));
+	EXPECT_EQ(1u, metee_sim_pending(conn));
+	EXPECT_EQ(TEE_TIMEOUT, metee_sim_read(conn, rsp, sizeof(rsp), &size, 0));
+	struct pollfd pfd = {metee_sim_fd(conn), POLLIN, 0};
+	EXPECT_EQ(1, poll(&pfd, 1, 1000));
+	EXPECT_EQ(TEE_INSUFFICIENT_BUFFER, metee_sim_read(conn, rsp, 2, &size, 0));
+	ASSERT_EQ(TEE_SUCCESS, metee_sim_read(conn, rsp, sizeof(rsp), &size, 0));
+	EXPECT_EQ(sizeof(req), size);
+	EXPECT_EQ(0, memcmp(req, rsp, sizeof(req)));
+	EXPECT_EQ(0u, metee_sim_pending(conn));
+
+	metee_sim_reset(sim);
+	EXPECT_EQ(TEE_DISCONNECTED, metee_sim_write(conn, req, sizeof(req)));
+	EXPECT_EQ(TEE_DISCONNECTED, metee_sim_read(conn, rsp, sizeof(rsp), &size, 0));
+	metee_sim_close(conn);
+	metee_sim_destroy(sim);
+}
+
+#ifdef METEE_PRELOAD_PATH
+/*
+Unmodified device tests run through the LD_PRELOAD /dev/mei emulator
+*/
+TEST(MeTeeSimDeviceTEST, SIM_Preload)
+{
+	const char *filter = "--gtest_filter=*PROD_MKHI_SimpleGetVersion*:*PROD_MKHI_PendingWriteStress*:"
+			     "*PROD_MKHI_DoubleConnect*:*PROD_MKHI_GetFWStatus*";
+	const char *preload = getenv("LD_PRELOAD");
+	int wstatus = 0;
+	pid_t pid;
+
+	if (preload && strstr(preload, "metee-preload"))
+		GTEST_SKIP();
+
+	pid = fork();
+	ASSERT_NE(-1, pid);
+	if (pid == 0) {
+		setenv("LD_PRELOAD", METEE_PRELOAD_PATH, 1);
+		execl("/proc/self/exe", "metee_test", filter, "--gtest_brief=1", (char *)NULL);
+		_exit(127);
+	}
+	ASSERT_EQ(pid, waitpid(pid, &wstatus, 0));
+	ASSERT_TRUE(WIFEXITED(wstatus));
+	EXPECT_EQ(0, WEXITSTATUS(wstatus));
+}
+#endif /* METEE_PRELOAD_PATH */
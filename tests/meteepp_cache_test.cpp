@@ -0,0 +1,104 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+#include "metee_test.h"
+#include "meteepp_cache.h"
+#ifdef __linux__
+#include "fake_device.h"
+
+using intel::security::basic_cached_client;
+using intel::security::response_cache;
+
+static const std::vector<uint8_t> QueryRequest = {0xFF, 0x02, 0x00, 0x00};
+
+/* Firmware side: answer count requests with request size and sequence number */
+static void CountingResponder(fake_device *dev, int count)
+{
+	for (int i = 0; i < count; i++) {
+		std::vector<uint8_t> msg = dev->fw_receive(1000);
+		dev->fw_send(std::vector<uint8_t>{(uint8_t)msg.size(), (uint8_t)i});
+	}
+}
+
+/*
+Repeated query is answered from the cache, different request goes to the device
+*/
+TEST(MeTeeCacheTEST, CACHE_HitAndMiss)
+{
+	fake_device dev;
+	response_cache cache;
+	basic_cached_client<fake_device> client(cache, dev, "fake0", GUID_DEVINTERFACE_MKHI);
+	std::thread fw(CountingResponder, &dev, 2);
+
+	std::vector<uint8_t> first = client.transact(QueryRequest, std::chrono::seconds(10), 1000);
+	std::vector<uint8_t> second = client.transact(QueryRequest, std::chrono::seconds(10), 1000);
+	std::vector<uint8_t> other = client.transact(std::vector<uint8_t>(3), std::chrono::seconds(10), 1000);
+	fw.join();
+
+	EXPECT_EQ(first, second);
+	EXPECT_EQ(1, other[1]);
+	EXPECT_EQ(1, cache.hits());
+	EXPECT_EQ(2, cache.misses());
+}
+
+/*
+Entry expires after TTL
+*/
+TEST(MeTeeCacheTEST, CACHE_Expire)
+{
+	fake_device dev;
+	response_cache cache;
+	basic_cached_client<fake_device> client(cache, dev, "fake0", GUID_DEVINTERFACE_MKHI);
+	std::thread fw(CountingResponder, &dev, 2);
+
+	EXPECT_EQ(0, client.transact(QueryRequest, std::chrono::milliseconds(50), 1000)[1]);
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	EXPECT_EQ(1, client.transact(QueryRequest, std::chrono::milliseconds(50), 1000)[1]);
+	fw.join();
+	EXPECT_EQ(0, cache.hits());
+}
+
+/*
+FW status change drops device entries
+*/
+TEST(MeTeeCacheTEST, CACHE_FwStatusChange)
+{
+	fake_device dev;
+	response_cache cache;
+	basic_cached_client<fake_device> client(cache, dev, "fake0", GUID_DEVINTERFACE_MKHI,
+		std::chrono::milliseconds(0));
+	std::thread fw(CountingResponder, &dev, 2);
+
+	dev.fw_set_status(0x90000245);
+	EXPECT_EQ(0, client.transact(QueryRequest, std::chrono::seconds(10), 1000)[1]);
+	EXPECT_EQ(0, client.transact(QueryRequest, std::chrono::seconds(10), 1000)[1]);
+	dev.fw_set_status(0x90000255);
+	EXPECT_EQ(1, client.transact(QueryRequest, std::chrono::seconds(10), 1000)[1]);
+	fw.join();
+}
+
+/*
+Reconnect drops device entries, other device entries are kept
+*/
+TEST(MeTeeCacheTEST, CACHE_ReconnectPerDevice)
+{
+	fake_device dev0;
+	fake_device dev1;
+	response_cache cache;
+	basic_cached_client<fake_device> client0(cache, dev0, "fake0", GUID_DEVINTERFACE_MKHI);
+	basic_cached_client<fake_device> client1(cache, dev1, "fake1", GUID_DEVINTERFACE_MKHI);
+	std::thread fw0(CountingResponder, &dev0, 2);
+	std::thread fw1(CountingResponder, &dev1, 1);
+
+	client0.transact(QueryRequest, std::chrono::seconds(10), 1000);
+	client1.transact(QueryRequest, std::chrono::seconds(10), 1000);
+	client0.connect();
+	EXPECT_EQ(1, dev0.connects());
+	EXPECT_EQ(1, client0.transact(QueryRequest, std::chrono::seconds(10), 1000)[1]);
+	EXPECT_EQ(0, client1.transact(QueryRequest, std::chrono::seconds(10), 1000)[1]);
+	fw0.join();
+	fw1.join();
+	EXPECT_EQ(1, cache.hits());
+}
+#endif /* __linux__ */
@@ -0,0 +1,236 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+#include "metee_test.h"
+#include "meteepp_coro.h"
+#include "fake_device.h"
+
+using intel::security::basic_async_metee;
+using intel::security::metee_exception;
+using intel::security::reactor;
+using intel::security::task;
+
+/* Firmware side: answer each message with the same message, MKHI response bit set */
+static void MkhiResponder(fake_device &dev, int count)
+{
+	for (int i = 0; i < count; i++) {
+		std::vector<uint8_t> msg = dev.fw_receive(1000);
+		MKHI_MESSAGE_HEADER *hdr = reinterpret_cast<MKHI_MESSAGE_HEADER*>(msg.data());
+		hdr->Fields.IsResponse = 1;
+		dev.fw_send(msg);
+	}
+}
+
+static std::vector<uint8_t> MkhiGetVersionRequest()
+{
+	GEN_GET_FW_VERSION req = {};
+
+	req.Header.Fields.Command = GEN_GET_FW_VERSION_CMD;
+	req.Header.Fields.GroupId = MKHI_GEN_GROUP_ID;
+	auto ptr = reinterpret_cast<uint8_t*>(&req);
+	return std::vector<uint8_t>(ptr, ptr + sizeof(req));
+}
+
+/*
+Asynchronous transaction over fake device
+1) Send request with co_await
+2) Receive response with co_await
+3) Check response header
+*/
+TEST(MeTeeCoroTEST, CORO_Transact)
+{
+	fake_device dev;
+	reactor r;
+	basic_async_metee<fake_device> tee(r, dev);
+	std::thread fw(MkhiResponder, std::ref(dev), 1);
+
+	auto coro = [&]() -> task<std::vector<uint8_t>> {
+		co_return co_await tee.transact(MkhiGetVersionRequest(), 1000);
+	};
+	std::vector<uint8_t> rsp = r.run(coro());
+	fw.join();
+
+	ASSERT_EQ(sizeof(GEN_GET_FW_VERSION), rsp.size());
+	MKHI_MESSAGE_HEADER *hdr = reinterpret_cast<MKHI_MESSAGE_HEADER*>(rsp.data());
+	EXPECT_EQ(GEN_GET_FW_VERSION_CMD, hdr->Fields.Command);
+	EXPECT_EQ(1, hdr->Fields.IsResponse);
+}
+
+/*
+Two coroutines pending on the same device are served by one thread
+*/
+TEST(MeTeeCoroTEST, CORO_ConcurrentReads)
+{
+	fake_device dev;
+	reactor r;
+	basic_async_metee<fake_device> tee(r, dev);
+	std::vector<size_t> sizes;
+
+	auto reader = [&]() -> task<void> {
+		std::vector<uint8_t> msg = co_await tee.read(1000);
+		sizes.push_back(msg.size());
+	};
+	r.spawn(reader());
+	r.spawn(reader());
+	dev.fw_send(std::vector<uint8_t>(10));
+	dev.fw_send(std::vector<uint8_t>(20));
+	r.run();
+
+	ASSERT_EQ(2, sizes.size());
+	EXPECT_EQ(10, sizes[0]);
+	EXPECT_EQ(20, sizes[1]);
+}
+
+/*
+Tasks completing in spawn without waiting do not keep run() blocked,
+exception of such a task is rethrown from run(), one task per call
+*/
+TEST(MeTeeCoroTEST, CORO_SpawnCompletesAtOnce)
+{
+	reactor r;
+	std::atomic<bool> done(false);
+	int ran = 0;
+
+	/* stop a hanging loop so the failure is reported */
+	std::thread watchdog([&]() {
+		for (int i = 0; i < 100 && !done; i++)
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		if (!done)
+			r.stop();
+	});
+	auto quick = [&]() -> task<void> {
+		ran++;
+		co_return;
+	};
+	r.spawn(quick());
+	r.spawn(quick());
+	r.run();
+	done = true;
+	watchdog.join();
+	EXPECT_EQ(2, ran);
+
+	auto failing = []() -> task<void> {
+		throw metee_exception("task failed", TEE_INTERNAL_ERROR);
+		co_return;
+	};
+	r.spawn(failing());
+	EXPECT_THROW(r.run(), metee_exception);
+
+	/* each failed task is reported by its own call */
+	r.spawn(failing());
+	r.spawn(failing());
+	EXPECT_THROW(r.run(), metee_exception);
+	EXPECT_THROW(r.run(), metee_exception);
+	EXPECT_NO_THROW(r.run());
+}
+
+/*
+Read without data completes with TEE_TIMEOUT
+*/
+TEST(MeTeeCoroTEST, CORO_ReadTimeout)
+{
+	fake_device dev;
+	reactor r;
+	basic_async_metee<fake_device> tee(r, dev);
+	TEESTATUS status = TEE_SUCCESS;
+
+	auto coro = [&]() -> task<void> {
+		try {
+			co_await tee.read(100);
+		}
+		catch (const metee_exception &ex) {
+			status = (TEESTATUS)ex.code().value();
+		}
+	};
+	auto start = std::chrono::steady_clock::now();
+	r.run(coro());
+
+	EXPECT_EQ(TEE_TIMEOUT, status);
+	EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+}
+
+/*
+Pending read is aborted from another thread
+*/
+TEST(MeTeeCoroTEST, CORO_CancelIO)
+{
+	fake_device dev;
+	reactor r;
+	basic_async_metee<fake_device> tee(r, dev);
+	TEESTATUS status = TEE_SUCCESS;
+
+	auto coro = [&]() -> task<void> {
+		try {
+			co_await tee.read(0);
+		}
+		catch (const metee_exception &ex) {
+			status = (TEESTATUS)ex.code().value();
+		}
+	};
+	std::thread canceler([&tee]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		tee.cancel_io();
+	});
+	r.run(coro());
+	canceler.join();
+
+	EXPECT_EQ(TEE_UNABLE_TO_COMPLETE_OPERATION, status);
+}
+
+/*
+Message above MTU is rejected by the device, error propagates to the awaiting coroutine
+*/
+TEST(MeTeeCoroTEST, CORO_BiggerThenMtuWrite)
+{
+	fake_device dev(16);
+	reactor r;
+	basic_async_metee<fake_device> tee(r, dev);
+	std::vector<uint8_t> buf(32);
+
+	auto coro = [&]() -> task<size_t> {
+		co_return co_await tee.write(buf, 0);
+	};
+	try {
+		r.run(coro());
+		FAIL();
+	}
+	catch (const metee_exception &ex) {
+		EXPECT_EQ(TEE_INTERNAL_ERROR, ex.code().value());
+	}
+}
+
+TEST_P(MeTeePPTEST, PROD_MKHI_CoroGetVersion)
+{
+	struct MeTeeTESTParams intf = GetParam();
+
+	try {
+		intel::security::metee metee(*intf.client);
+		reactor r;
+		intel::security::async_metee tee(r, metee);
+
+		metee.connect();
+		auto coro = [&]() -> task<std::vector<uint8_t>> {
+			co_return co_await tee.transact(MkhiRequest, 0);
+		};
+		std::vector<uint8_t> rsp = r.run(coro());
+		ASSERT_LE(sizeof(GEN_GET_FW_VERSION_ACK), rsp.size());
+		GEN_GET_FW_VERSION_ACK *pResponseMessage = reinterpret_cast<GEN_GET_FW_VERSION_ACK*>(rsp.data());
+		ASSERT_EQ(TEE_SUCCESS, pResponseMessage->Header.Fields.Result);
+		EXPECT_NE(0, pResponseMessage->Data.FWVersion.CodeMajor);
+	}
+	catch (const metee_exception &ex) {
+		if (ex.code().value() == TEE_DEVICE_NOT_FOUND)
+			GTEST_SKIP();
+		FAIL() << "Excepton: " << ex.what();
+	}
+}
+
+static struct MeTeeTESTParams interfaces[1] = {
+	{"PCH", NULL, &GUID_DEVINTERFACE_MKHI}};
+
+INSTANTIATE_TEST_SUITE_P(MeTeePPTESTInstance, MeTeePPTEST,
+		testing::ValuesIn(interfaces),
+		[](const testing::TestParamInfo<MeTeePPTEST::ParamType>& info) {
+			return info.param.name;
+		});
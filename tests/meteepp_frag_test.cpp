@@ -0,0 +1,147 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+#include "metee_test.h"
+#include "meteepp_frag.h"
+#ifdef __linux__
+#include "fake_device.h"
+
+namespace frag = intel::security::frag;
+
+/* Firmware side: echo count messages back */
+static void EchoResponder(fake_device *dev, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+		dev->fw_send(dev->fw_receive(1000));
+}
+
+static std::vector<uint8_t> MakePayload(size_t size)
+{
+	std::vector<uint8_t> payload(size);
+
+	for (size_t i = 0; i < size; i++)
+		payload[i] = (uint8_t)(i ^ (i >> 8));
+	return payload;
+}
+
+/* Continuation header with 16 bit chunk sequence number and total length */
+struct SeqFraming {
+	static const size_t header_size = 4;
+
+	static void encode(uint8_t *hdr, size_t offset, size_t total)
+	{
+		uint16_t seq = (uint16_t)(offset / 60);
+		hdr[0] = (uint8_t)seq;
+		hdr[1] = (uint8_t)(seq >> 8);
+		hdr[2] = (uint8_t)total;
+		hdr[3] = (uint8_t)(total >> 8);
+	}
+
+	static bool decode(const uint8_t *hdr, size_t &offset, size_t &total)
+	{
+		offset = (size_t)(hdr[0] | (hdr[1] << 8)) * 60;
+		total = (size_t)(hdr[2] | (hdr[3] << 8));
+		return offset <= total;
+	}
+};
+
+/*
+Payload bigger than MTU is split into chunks and reassembled
+*/
+TEST(MeTeeFragTEST, FRAG_RoundTrip)
+{
+	fake_device dev(128);
+	frag::basic_fragmenter<fake_device> fragmenter(dev);
+	std::vector<uint8_t> payload = MakePayload(10000);
+	size_t chunks = (payload.size() + fragmenter.chunk_size() - 1) / fragmenter.chunk_size();
+	std::thread fw(EchoResponder, &dev, chunks);
+
+	EXPECT_EQ(chunks, fragmenter.write(payload, 1000));
+	const std::vector<uint8_t> &rsp = fragmenter.read(1000);
+	fw.join();
+
+	EXPECT_EQ(payload, rsp);
+}
+
+/*
+Reassembly buffer is reused between messages, small and empty payloads use one message
+*/
+TEST(MeTeeFragTEST, FRAG_BufferReuse)
+{
+	fake_device dev(128);
+	frag::basic_fragmenter<fake_device> fragmenter(dev);
+	std::vector<uint8_t> big = MakePayload(1000);
+	std::vector<uint8_t> small = MakePayload(10);
+	size_t chunks = (big.size() + fragmenter.chunk_size() - 1) / fragmenter.chunk_size();
+	std::thread fw(EchoResponder, &dev, chunks + 2);
+
+	fragmenter.write(big, 1000);
+	const uint8_t *data = fragmenter.read(1000).data();
+	EXPECT_EQ(1, fragmenter.write(small, 1000));
+	const std::vector<uint8_t> &rsp = fragmenter.read(1000);
+	EXPECT_EQ(small, rsp);
+	EXPECT_EQ(data, rsp.data());
+	EXPECT_EQ(1, fragmenter.write(std::vector<uint8_t>(), 1000));
+	EXPECT_TRUE(fragmenter.read(1000).empty());
+	fw.join();
+}
+
+/*
+Custom continuation header
+*/
+TEST(MeTeeFragTEST, FRAG_CustomFraming)
+{
+	fake_device dev(64);
+	frag::basic_fragmenter<fake_device, SeqFraming> fragmenter(dev);
+	std::vector<uint8_t> payload = MakePayload(1000);
+	std::thread fw(EchoResponder, &dev, 17);
+
+	ASSERT_EQ(60, fragmenter.chunk_size());
+	EXPECT_EQ(17, fragmenter.write(payload, 1000));
+	EXPECT_EQ(payload, fragmenter.read(1000));
+	fw.join();
+}
+
+/*
+Chunk with unexpected offset is rejected
+*/
+TEST(MeTeeFragTEST, FRAG_OutOfOrderChunk)
+{
+	fake_device dev(64);
+	frag::basic_fragmenter<fake_device> fragmenter(dev);
+	std::vector<uint8_t> msg(64);
+
+	frag::offset_framing::encode(msg.data(), 0, 200);
+	dev.fw_send(msg);
+	frag::offset_framing::encode(msg.data(), 112, 200);
+	dev.fw_send(msg);
+	try {
+		fragmenter.read(1000);
+		FAIL();
+	}
+	catch (const intel::security::metee_exception &ex) {
+		EXPECT_EQ(TEE_INTERNAL_ERROR, ex.code().value());
+	}
+}
+
+/*
+Payload above the configured limit is rejected before allocation
+*/
+TEST(MeTeeFragTEST, FRAG_PayloadTooBig)
+{
+	fake_device dev(64);
+	frag::basic_fragmenter<fake_device> fragmenter(dev, 100);
+	std::vector<uint8_t> msg(64);
+
+	frag::offset_framing::encode(msg.data(), 0, 200);
+	dev.fw_send(msg);
+	try {
+		fragmenter.read(1000);
+		FAIL();
+	}
+	catch (const intel::security::metee_exception &ex) {
+		EXPECT_EQ(TEE_INSUFFICIENT_BUFFER, ex.code().value());
+	}
+}
+#endif /* __linux__ */
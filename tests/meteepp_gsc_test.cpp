@@ -0,0 +1,202 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+#include "metee_test.h"
+#include "meteepp_gsc.h"
+#ifdef __linux__
+#include <stdlib.h>
+#include "fake_device.h"
+
+namespace gsc = intel::security::gsc;
+
+/*
+ * Simulated GSC FWU responder.
+ * Collects the image from data requests; acknowledgments for data chunks
+ * are held until window chunks are received to verify the sender pipeline.
+ */
+struct FwuResponder {
+	fake_device &dev;
+	size_t window;
+	uint32_t fail_chunk;
+	std::vector<uint8_t> image;
+	std::vector<uint8_t> meta;
+	uint32_t expected;
+	uint32_t chunks;
+	bool ended;
+
+	FwuResponder(fake_device &d, size_t w, uint32_t fail = UINT32_MAX)
+		: dev(d), window(w), fail_chunk(fail), expected(0), chunks(0), ended(false) {}
+
+	void reply(uint8_t command, uint32_t status)
+	{
+		gsc::fwu_response rsp = {};
+		rsp.header.command_id = command;
+		rsp.header.is_response = 1;
+		rsp.status = status;
+		const uint8_t *ptr = reinterpret_cast<const uint8_t*>(&rsp);
+		dev.fw_send(std::vector<uint8_t>(ptr, ptr + sizeof(rsp)));
+	}
+
+	void run()
+	{
+		std::vector<uint32_t> acks;
+
+		while (!ended) {
+			std::vector<uint8_t> msg = dev.fw_receive(1000);
+			const gsc::fwu_header *hdr = reinterpret_cast<const gsc::fwu_header*>(msg.data());
+			switch (hdr->command_id) {
+			case gsc::FWU_START: {
+				const gsc::fwu_start_req *req = reinterpret_cast<const gsc::fwu_start_req*>(msg.data());
+				expected = req->update_img_length;
+				meta.assign(msg.begin() + sizeof(*req), msg.end());
+				reply(gsc::FWU_START, gsc::FWU_STATUS_SUCCESS);
+				break;
+			}
+			case gsc::FWU_DATA: {
+				const gsc::fwu_data_req *req = reinterpret_cast<const gsc::fwu_data_req*>(msg.data());
+				image.insert(image.end(), msg.begin() + sizeof(*req), msg.begin() + sizeof(*req) + req->data_length);
+				acks.push_back(chunks++ == fail_chunk ? gsc::FWU_STATUS_SIZE_ERROR : gsc::FWU_STATUS_SUCCESS);
+				if (acks.size() == window || image.size() >= expected) {
+					for (size_t i = 0; i < acks.size(); i++)
+						reply(gsc::FWU_DATA, acks[i]);
+					acks.clear();
+				}
+				if (chunks > fail_chunk)
+					return;
+				break;
+			}
+			case gsc::FWU_END:
+				reply(gsc::FWU_END, gsc::FWU_STATUS_SUCCESS);
+				ended = true;
+				break;
+			default:
+				reply(hdr->command_id, gsc::FWU_STATUS_INVALID_COMMAND);
+				break;
+			}
+		}
+	}
+};
+
+static std::vector<uint8_t> MakeImage(size_t size)
+{
+	std::vector<uint8_t> image(size);
+
+	for (size_t i = 0; i < size; i++)
+		image[i] = (uint8_t)(i * 7 + i / 251);
+	return image;
+}
+
+/*
+Serial update: image delivered intact, progress reported per chunk
+*/
+TEST(MeTeeGscTEST, FWU_StreamSerial)
+{
+	fake_device dev(128);
+	std::vector<uint8_t> image = MakeImage(1000);
+	std::vector<uint8_t> meta(16, 0xA5);
+	FwuResponder fw(dev, 1);
+	std::thread fwt(&FwuResponder::run, &fw);
+	gsc::basic_fwu_streamer<fake_device> streamer(dev);
+	std::vector<unsigned int> percents;
+
+	gsc::fwu_progress result = streamer.update(gsc::PAYLOAD_TYPE_GFX_FW, image.data(), image.size(),
+		meta.data(), meta.size(), 1000,
+		[&percents](const gsc::fwu_progress &p) { percents.push_back(p.percent()); });
+	fwt.join();
+
+	size_t chunks = (image.size() + streamer.chunk_size() - 1) / streamer.chunk_size();
+	EXPECT_EQ(image, fw.image);
+	EXPECT_EQ(meta, fw.meta);
+	EXPECT_TRUE(fw.ended);
+	EXPECT_EQ(image.size(), result.acked);
+	EXPECT_EQ(chunks, result.chunks);
+	ASSERT_EQ(chunks, percents.size());
+	EXPECT_EQ(100, percents.back());
+	EXPECT_GE(result.throughput(), 0);
+}
+
+/*
+Pipelined update: responder holds acknowledgments until window chunks arrive
+*/
+TEST(MeTeeGscTEST, FWU_StreamWindow)
+{
+	fake_device dev(256);
+	std::vector<uint8_t> image = MakeImage(10000);
+	FwuResponder fw(dev, 4);
+	std::thread fwt(&FwuResponder::run, &fw);
+	gsc::basic_fwu_streamer<fake_device> streamer(dev, 4);
+
+	gsc::fwu_progress result = streamer.update(gsc::PAYLOAD_TYPE_GFX_FW, image.data(), image.size(),
+		nullptr, 0, 1000);
+	fwt.join();
+
+	EXPECT_EQ(image, fw.image);
+	EXPECT_EQ(image.size(), result.acked);
+}
+
+/*
+Failure status from data chunk propagates in FWU category
+*/
+TEST(MeTeeGscTEST, FWU_StreamChunkFailure)
+{
+	fake_device dev(128);
+	std::vector<uint8_t> image = MakeImage(1000);
+	FwuResponder fw(dev, 1, 2);
+	std::thread fwt(&FwuResponder::run, &fw);
+	gsc::basic_fwu_streamer<fake_device> streamer(dev);
+
+	try {
+		streamer.update(gsc::PAYLOAD_TYPE_GFX_FW, image.data(), image.size(), nullptr, 0, 1000);
+		fwt.join();
+		FAIL();
+	}
+	catch (const intel::security::metee_exception &ex) {
+		fwt.join();
+		EXPECT_EQ(gsc::FWU_STATUS_SIZE_ERROR, ex.code().value());
+		EXPECT_EQ(&gsc::fwu_category, &ex.code().category());
+	}
+	EXPECT_EQ(3, fw.chunks);
+}
+
+/*
+Update from memory mapped image file
+*/
+TEST(MeTeeGscTEST, FWU_StreamImageMap)
+{
+	char path[] = "/tmp/metee_fwu_XXXXXX";
+	int fd = mkstemp(path);
+	ASSERT_NE(-1, fd);
+	std::vector<uint8_t> image = MakeImage(5000);
+	ASSERT_EQ((ssize_t)image.size(), ::write(fd, image.data(), image.size()));
+	close(fd);
+
+	fake_device dev(512);
+	FwuResponder fw(dev, 2);
+	std::thread fwt(&FwuResponder::run, &fw);
+	{
+		gsc::image_map map(path);
+		gsc::basic_fwu_streamer<fake_device> streamer(dev, 2);
+		EXPECT_EQ(image.size(), map.size());
+		streamer.update(gsc::PAYLOAD_TYPE_GFX_FW, map, std::vector<uint8_t>(), 1000);
+	}
+	fwt.join();
+	unlink(path);
+
+	EXPECT_EQ(image, fw.image);
+}
+
+/*
+Missing image file is reported as not found
+*/
+TEST(MeTeeGscTEST, FWU_ImageMapNotFound)
+{
+	try {
+		gsc::image_map map("/nonexistent/metee_fwu.img");
+		FAIL();
+	}
+	catch (const intel::security::metee_exception &ex) {
+		EXPECT_EQ(TEE_DEVICE_NOT_FOUND, ex.code().value());
+	}
+}
+#endif /* __linux__ */
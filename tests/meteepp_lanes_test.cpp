@@ -0,0 +1,182 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+#include "metee_test.h"
+#include "meteepp_lanes.h"
+#ifdef __linux__
+#include <mutex>
+#include "fake_device.h"
+
+using intel::security::basic_lane_scheduler;
+using intel::security::lane;
+using intel::security::lane_stats;
+using intel::security::metee_exception;
+
+typedef basic_lane_scheduler<fake_device> fake_scheduler;
+
+/* Slow firmware: answers count requests after delay, records the first byte of each */
+static void SlowResponder(fake_device *dev, int count, std::chrono::milliseconds delay,
+			  std::vector<uint8_t> *order)
+{
+	for (int i = 0; i < count; i++) {
+		std::vector<uint8_t> msg = dev->fw_receive(5000);
+		std::this_thread::sleep_for(delay);
+		order->push_back(msg[0]);
+		dev->fw_send(msg);
+	}
+}
+
+/*
+Urgent request waits only for the running bulk exchange, not for the bulk queue
+*/
+TEST(MeTeeLanesTEST, LANES_UrgentFirst)
+{
+	const int bulk_threads = 4;
+	const int bulk_each = 3;
+	fake_device dev;
+	fake_scheduler sched(dev);
+	std::vector<uint8_t> order;
+	std::thread fw(SlowResponder, &dev, bulk_threads * bulk_each + 1, std::chrono::milliseconds(30), &order);
+	std::vector<std::thread> bulk;
+
+	for (int t = 0; t < bulk_threads; t++) {
+		bulk.emplace_back([&sched]() {
+			for (int i = 0; i < bulk_each; i++)
+				sched.transact(lane::bulk, std::vector<uint8_t>{'B', 0, 0, 0}, 5000);
+		});
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(45));
+	auto start = std::chrono::steady_clock::now();
+	std::vector<uint8_t> rsp = sched.transact(lane::urgent, std::vector<uint8_t>{'U', 1}, 5000);
+	auto urgent_time = std::chrono::steady_clock::now() - start;
+	for (std::thread &t : bulk)
+		t.join();
+	fw.join();
+
+	EXPECT_EQ((std::vector<uint8_t>{'U', 1}), rsp);
+	EXPECT_LT(urgent_time, std::chrono::milliseconds(30 * 4));
+	ASSERT_EQ((size_t)(bulk_threads * bulk_each + 1), order.size());
+	size_t pos = std::find(order.begin(), order.end(), 'U') - order.begin();
+	EXPECT_LE(pos, 3u);
+
+	lane_stats us = sched.stats(lane::urgent);
+	lane_stats bs = sched.stats(lane::bulk);
+	EXPECT_EQ(1u, us.requests);
+	EXPECT_EQ(0u, us.errors);
+	EXPECT_EQ(1u, us.overtakes);
+	EXPECT_EQ(1u, us.queue.count);
+	EXPECT_EQ(1u, us.latency.count);
+	EXPECT_LT(us.latency.total_us, 30u * 4 * 1000);
+	EXPECT_EQ((uint64_t)(bulk_threads * bulk_each), bs.requests);
+	EXPECT_EQ((uint64_t)(bulk_threads * bulk_each), bs.latency.count);
+	EXPECT_GT(bs.queue.total_us, us.queue.total_us);
+}
+
+/*
+Write of a channel holds the connection until its read, waiting class times out in the queue
+*/
+TEST(MeTeeLanesTEST, LANES_ChannelAndQueueTimeout)
+{
+	fake_device dev;
+	fake_scheduler sched(dev);
+	fake_scheduler::channel bulk(sched, lane::bulk);
+	uint8_t req[4] = {'B'};
+	uint8_t rsp[4];
+
+	EXPECT_EQ(dev.max_msg_len(), bulk.max_msg_len());
+	EXPECT_EQ(sizeof(req), bulk.write(req, sizeof(req), 1000));
+	try {
+		sched.transact(lane::urgent, std::vector<uint8_t>{'U'}, 20);
+		FAIL() << "urgent exchange passed the held connection";
+	}
+	catch (const metee_exception &ex) {
+		EXPECT_EQ(TEE_TIMEOUT, ex.code().value());
+	}
+	dev.fw_send(dev.fw_receive(1000));
+	EXPECT_EQ(sizeof(req), bulk.read(rsp, sizeof(rsp), 1000));
+
+	std::thread fw([&dev]() { dev.fw_send(dev.fw_receive(1000)); });
+	EXPECT_EQ((std::vector<uint8_t>{'U'}), sched.transact(lane::urgent, std::vector<uint8_t>{'U'}, 1000));
+	fw.join();
+
+	lane_stats us = sched.stats(lane::urgent);
+	EXPECT_EQ(1u, us.requests);
+	EXPECT_EQ(1u, us.errors);
+	EXPECT_EQ(1u, us.latency.count);
+	EXPECT_EQ(1u, sched.stats(lane::bulk).requests);
+}
+
+/*
+Pipelined writes keep the connection until all their responses are read,
+an urgent exchange queued meanwhile neither reads nor steals a bulk response
+*/
+TEST(MeTeeLanesTEST, LANES_ChannelPipeline)
+{
+	fake_device dev;
+	fake_scheduler sched(dev);
+	fake_scheduler::channel bulk(sched, lane::bulk);
+	uint8_t req[2] = {'B', 0};
+	uint8_t rsp[2];
+	std::vector<uint8_t> urgent_rsp;
+
+	bulk.write(req, sizeof(req), 1000);
+	req[1] = 1;
+	bulk.write(req, sizeof(req), 1000);
+	std::thread urgent([&]() {
+		urgent_rsp = sched.transact(lane::urgent, std::vector<uint8_t>{'U', 0}, 2000);
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	dev.fw_send(dev.fw_receive(1000));
+	dev.fw_send(dev.fw_receive(1000));
+
+	EXPECT_EQ(sizeof(rsp), bulk.read(rsp, sizeof(rsp), 1000));
+	EXPECT_EQ(0, rsp[1]);
+	EXPECT_THROW(dev.fw_receive(50), metee_exception);
+	EXPECT_EQ(sizeof(rsp), bulk.read(rsp, sizeof(rsp), 1000));
+	EXPECT_EQ(1, rsp[1]);
+
+	dev.fw_send(dev.fw_receive(1000));
+	urgent.join();
+	EXPECT_EQ((std::vector<uint8_t>{'U', 0}), urgent_rsp);
+	EXPECT_EQ(1u, sched.stats(lane::bulk).requests);
+	EXPECT_EQ(1u, sched.stats(lane::urgent).requests);
+
+	/* one request answered by two messages */
+	bulk.hold(1000);
+	bulk.write(req, sizeof(req), 1000);
+	urgent = std::thread([&]() {
+		urgent_rsp = sched.transact(lane::urgent, std::vector<uint8_t>{'U', 1}, 2000);
+	});
+	std::vector<uint8_t> msg = dev.fw_receive(1000);
+	dev.fw_send(msg);
+	dev.fw_send(msg);
+	bulk.read(rsp, sizeof(rsp), 1000);
+	EXPECT_THROW(dev.fw_receive(50), metee_exception);
+	bulk.read(rsp, sizeof(rsp), 1000);
+	EXPECT_EQ('B', rsp[0]);
+	bulk.release();
+	dev.fw_send(dev.fw_receive(1000));
+	urgent.join();
+	EXPECT_EQ((std::vector<uint8_t>{'U', 1}), urgent_rsp);
+}
+
+/*
+Lanes with own connections do not wait for each other
+*/
+TEST(MeTeeLanesTEST, LANES_SeparateConnections)
+{
+	fake_device urgent_dev;
+	fake_device bulk_dev;
+	fake_scheduler sched(urgent_dev, bulk_dev);
+	fake_scheduler::channel bulk(sched, lane::bulk);
+	uint8_t req[1] = {'B'};
+
+	bulk.write(req, sizeof(req), 1000);
+	std::thread fw([&urgent_dev]() { urgent_dev.fw_send(urgent_dev.fw_receive(1000)); });
+	EXPECT_EQ((std::vector<uint8_t>{'U'}), sched.transact(lane::urgent, std::vector<uint8_t>{'U'}, 1000));
+	fw.join();
+	EXPECT_EQ(0u, sched.stats(lane::urgent).overtakes);
+	EXPECT_EQ((std::vector<uint8_t>{'B'}), bulk_dev.fw_receive(1000));
+}
+#endif // __linux__
@@ -0,0 +1,195 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+#include "metee_test.h"
+#include "meteepp_mkhi.h"
+#ifdef __linux__
+#include "fake_device.h"
+#endif /* __linux__ */
+
+namespace mkhi = intel::security::mkhi;
+
+TEST_P(MeTeePPTEST, PROD_MKHI_ClientGetVersion)
+{
+	struct MeTeeTESTParams intf = GetParam();
+	GEN_GET_FW_VERSION req = {};
+
+	req.Header.Fields.Command = GEN_GET_FW_VERSION_CMD;
+	req.Header.Fields.GroupId = MKHI_GEN_GROUP_ID;
+	try {
+		intel::security::metee metee(*intf.client);
+		metee.connect();
+		mkhi::client client(metee);
+
+		GEN_GET_FW_VERSION_ACK rsp = client.call<GEN_GET_FW_VERSION, GEN_GET_FW_VERSION_ACK>(req, 0);
+		EXPECT_NE(0, rsp.Data.FWVersion.CodeMajor);
+	}
+	catch (const intel::security::metee_exception& ex) {
+		if (ex.code().value() == TEE_DEVICE_NOT_FOUND)
+			GTEST_SKIP();
+		FAIL() << "Excepton: " << ex.what();
+	}
+}
+
+#ifdef __linux__
+/* Firmware side: receive count requests, then answer them in reverse order */
+static void MkhiReverseResponder(fake_device *dev, int count)
+{
+	std::vector<std::vector<uint8_t>> msgs;
+
+	for (int i = 0; i < count; i++)
+		msgs.push_back(dev->fw_receive(1000));
+	for (int i = count - 1; i >= 0; i--) {
+		MKHI_MESSAGE_HEADER *hdr = reinterpret_cast<MKHI_MESSAGE_HEADER*>(msgs[i].data());
+		hdr->Fields.IsResponse = 1;
+		msgs[i].push_back((uint8_t)i);
+		dev->fw_send(msgs[i]);
+	}
+}
+
+/*
+Pipelined requests with different commands
+1) Send three requests before any read
+2) Firmware answers in reverse order
+3) Each ticket gets its own response
+*/
+TEST(MeTeeMkhiTEST, MKHI_PipelineOutOfOrder)
+{
+	fake_device dev;
+	mkhi::basic_client<fake_device> client(dev);
+	std::thread fw(MkhiReverseResponder, &dev, 3);
+
+	mkhi::basic_client<fake_device>::ticket t[3];
+	for (uint8_t i = 0; i < 3; i++)
+		t[i] = client.send(mkhi::GEN_GROUP_ID, uint8_t(i + 1), nullptr, 0, 1000);
+	EXPECT_EQ(3, client.in_flight());
+
+	for (uint8_t i = 0; i < 3; i++) {
+		mkhi::response rsp = client.receive(t[i], 1000);
+		EXPECT_EQ(i + 1, rsp.header().command);
+		ASSERT_EQ(1, rsp.payload_size());
+		EXPECT_EQ(i, rsp.payload()[0]);
+	}
+	fw.join();
+	EXPECT_EQ(0, client.in_flight());
+	EXPECT_EQ(3, client.pool().available());
+}
+
+/*
+Requests with the same group and command are matched in send order
+*/
+TEST(MeTeeMkhiTEST, MKHI_PipelineSameCommandFifo)
+{
+	fake_device dev;
+	mkhi::basic_client<fake_device> client(dev);
+	std::thread fw([&dev]() {
+		for (uint8_t i = 0; i < 2; i++) {
+			std::vector<uint8_t> msg = dev.fw_receive(1000);
+			reinterpret_cast<MKHI_MESSAGE_HEADER*>(msg.data())->Fields.IsResponse = 1;
+			msg.push_back(i);
+			dev.fw_send(msg);
+		}
+	});
+
+	mkhi::basic_client<fake_device>::ticket t0 =
+		client.send(mkhi::GEN_GROUP_ID, GEN_GET_FW_VERSION_CMD, nullptr, 0, 1000);
+	mkhi::basic_client<fake_device>::ticket t1 =
+		client.send(mkhi::GEN_GROUP_ID, GEN_GET_FW_VERSION_CMD, nullptr, 0, 1000);
+	EXPECT_EQ(1, client.receive(t1, 1000).payload()[0]);
+	EXPECT_EQ(0, client.receive(t0, 1000).payload()[0]);
+	fw.join();
+}
+
+/*
+Failure result in MKHI header raises mkhi_error in MKHI category
+*/
+TEST(MeTeeMkhiTEST, MKHI_ResultError)
+{
+	fake_device dev;
+	mkhi::basic_client<fake_device> client(dev);
+	std::thread fw([&dev]() {
+		std::vector<uint8_t> msg = dev.fw_receive(1000);
+		MKHI_MESSAGE_HEADER *hdr = reinterpret_cast<MKHI_MESSAGE_HEADER*>(msg.data());
+		hdr->Fields.IsResponse = 1;
+		hdr->Fields.Result = mkhi::STATUS_NOT_READY;
+		dev.fw_send(msg);
+	});
+
+	try {
+		client.receive(client.send(mkhi::GEN_GROUP_ID, GEN_GET_FW_VERSION_CMD, nullptr, 0, 1000), 1000);
+		fw.join();
+		FAIL();
+	}
+	catch (const mkhi::mkhi_error& ex) {
+		fw.join();
+		EXPECT_EQ(mkhi::STATUS_NOT_READY, ex.code().value());
+		EXPECT_EQ(&mkhi::mkhi_category, &ex.code().category());
+		EXPECT_EQ(mkhi::GEN_GROUP_ID, ex.group());
+		EXPECT_EQ(GEN_GET_FW_VERSION_CMD, ex.command());
+	}
+	EXPECT_EQ(0, client.in_flight());
+}
+
+/*
+Typed calls reuse pooled buffers, no allocation per call
+*/
+TEST(MeTeeMkhiTEST, MKHI_TypedCallPooled)
+{
+	const int count = 100;
+	fake_device dev;
+	mkhi::basic_client<fake_device> client(dev);
+	GEN_GET_FW_VERSION req = {};
+	std::thread fw([&dev]() {
+		for (int i = 0; i < count; i++) {
+			std::vector<uint8_t> msg = dev.fw_receive(1000);
+			msg.resize(sizeof(GEN_GET_FW_VERSION_ACK));
+			GEN_GET_FW_VERSION_ACK *ack = reinterpret_cast<GEN_GET_FW_VERSION_ACK*>(msg.data());
+			ack->Header.Fields.IsResponse = 1;
+			ack->Data.FWVersion.CodeMajor = 16;
+			dev.fw_send(msg);
+		}
+	});
+
+	req.Header.Fields.Command = GEN_GET_FW_VERSION_CMD;
+	req.Header.Fields.GroupId = MKHI_GEN_GROUP_ID;
+	for (int i = 0; i < count; i++) {
+		GEN_GET_FW_VERSION_ACK ack = client.call<GEN_GET_FW_VERSION, GEN_GET_FW_VERSION_ACK>(req, 1000);
+		EXPECT_EQ(16, ack.Data.FWVersion.CodeMajor);
+	}
+	fw.join();
+	EXPECT_EQ(1, client.pool().allocations());
+}
+
+/*
+Unsolicited message is dropped, receive of unknown ticket is rejected
+*/
+TEST(MeTeeMkhiTEST, MKHI_UnsolicitedAndUnknownTicket)
+{
+	fake_device dev;
+	mkhi::basic_client<fake_device> client(dev);
+	std::thread fw([&dev]() {
+		std::vector<uint8_t> msg = dev.fw_receive(1000);
+		std::vector<uint8_t> other(msg);
+		MKHI_MESSAGE_HEADER *hdr = reinterpret_cast<MKHI_MESSAGE_HEADER*>(other.data());
+		hdr->Fields.IsResponse = 1;
+		hdr->Fields.Command = GEN_GET_MKHI_VERSION_CMD;
+		dev.fw_send(other);
+		reinterpret_cast<MKHI_MESSAGE_HEADER*>(msg.data())->Fields.IsResponse = 1;
+		dev.fw_send(msg);
+	});
+
+	mkhi::basic_client<fake_device>::ticket t =
+		client.send(mkhi::GEN_GROUP_ID, GEN_GET_FW_VERSION_CMD, nullptr, 0, 1000);
+	EXPECT_EQ(GEN_GET_FW_VERSION_CMD, client.receive(t, 1000).header().command);
+	fw.join();
+
+	try {
+		client.receive(t, 1000);
+		FAIL();
+	}
+	catch (const intel::security::metee_exception& ex) {
+		EXPECT_EQ(TEE_INVALID_PARAMETER, ex.code().value());
+	}
+}
+#endif /* __linux__ */
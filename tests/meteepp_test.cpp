@@ -3,10 +3,24 @@
  * Copyright (C) 2021-2025 Intel Corporation
  */
 #include "metee_test.h"
+#ifdef __linux__
+#include "fake_device.h"
+#endif /* __linux__ */
 
 DEFINE_GUID(GUID_NON_EXISTS_CLIENT,
 	0x85eb8fa6, 0xbdd, 0x4d01, 0xbe, 0xc4, 0xa5, 0x97, 0x43, 0x4e, 0xd7, 0x62);
 
+/* MKHI response should carry the request group and command with response bit set */
+struct MkhiHeaderMatch {
+	static bool match(const MKHI_MESSAGE_HEADER& req, const MKHI_MESSAGE_HEADER& rsp)
+	{
+		return rsp.Fields.GroupId == req.Fields.GroupId &&
+		       rsp.Fields.Command == req.Fields.Command &&
+		       rsp.Fields.IsResponse == 1;
+	}
+};
+typedef intel::security::header_check<MKHI_MESSAGE_HEADER, MkhiHeaderMatch> MkhiCheck;
+
 TEST_P(MeTeePPTEST, PROD_MKHI_SimpleGetVersion)
 {
 	struct MeTeeTESTParams intf = GetParam();
@@ -129,6 +143,144 @@ TEST_P(MeTeePPTEST, PROD_MKHI_MoveSemantics)
 	EXPECT_NE(0, pResponseMessage->Data.FWVersion.CodeBuildNo);
 }
 
+TEST_P(MeTeePPTEST, PROD_MKHI_TypedTransact)
+{
+	struct MeTeeTESTParams intf = GetParam();
+	GEN_GET_FW_VERSION req = {};
+
+	req.Header.Fields.Command = GEN_GET_FW_VERSION_CMD;
+	req.Header.Fields.GroupId = MKHI_GEN_GROUP_ID;
+	try {
+		intel::security::metee metee(*intf.client);
+		metee.connect();
+
+		GEN_GET_FW_VERSION_ACK rsp =
+			metee.transact<GEN_GET_FW_VERSION, GEN_GET_FW_VERSION_ACK, MkhiCheck>(req, 0);
+		ASSERT_EQ(TEE_SUCCESS, rsp.Header.Fields.Result);
+		EXPECT_NE(0, rsp.Data.FWVersion.CodeMajor);
+	}
+	catch (const intel::security::metee_exception& ex) {
+		if (ex.code().value() == TEE_DEVICE_NOT_FOUND)
+			GTEST_SKIP();
+		FAIL() << "Excepton: " << ex.what();
+	}
+}
+
+#ifdef __linux__
+/* Firmware side: answer GetVersion with version 1.2.3.4, optionally with wrong command */
+static void MkhiVersionResponder(fake_device *dev, uint8_t command)
+{
+	std::vector<uint8_t> msg = dev->fw_receive(1000);
+	GEN_GET_FW_VERSION_ACK ack = {};
+
+	ack.Header = *reinterpret_cast<MKHI_MESSAGE_HEADER*>(msg.data());
+	ack.Header.Fields.Command = command;
+	ack.Header.Fields.IsResponse = 1;
+	ack.Data.FWVersion.CodeMajor = 1;
+	ack.Data.FWVersion.CodeMinor = 2;
+	ack.Data.FWVersion.CodeHotFix = 3;
+	ack.Data.FWVersion.CodeBuildNo = 4;
+	const uint8_t *ptr = reinterpret_cast<const uint8_t*>(&ack);
+	dev->fw_send(std::vector<uint8_t>(ptr, ptr + sizeof(ack)));
+}
+
+/*
+Typed transaction over fake device
+1) Send typed request
+2) Receive typed response into reusable buffer
+3) Validate header with MKHI matcher
+*/
+TEST(MeTeePPFakeTEST, TypedTransact)
+{
+	fake_device dev;
+	std::vector<uint8_t> buffer;
+	GEN_GET_FW_VERSION req = {};
+	GEN_GET_FW_VERSION_ACK rsp;
+
+	req.Header.Fields.Command = GEN_GET_FW_VERSION_CMD;
+	req.Header.Fields.GroupId = MKHI_GEN_GROUP_ID;
+	std::thread fw(MkhiVersionResponder, &dev, (uint8_t)GEN_GET_FW_VERSION_CMD);
+	size_t size = intel::security::transact<GEN_GET_FW_VERSION, GEN_GET_FW_VERSION_ACK, MkhiCheck>(
+		dev, buffer, req, rsp, 1000);
+	fw.join();
+
+	EXPECT_EQ(sizeof(rsp), size);
+	EXPECT_EQ(dev.max_msg_len(), buffer.size());
+	EXPECT_EQ(1, rsp.Data.FWVersion.CodeMajor);
+	EXPECT_EQ(4, rsp.Data.FWVersion.CodeBuildNo);
+}
+
+/*
+Response with different command fails header validation
+*/
+TEST(MeTeePPFakeTEST, TypedTransactHeaderMismatch)
+{
+	fake_device dev;
+	std::vector<uint8_t> buffer;
+	GEN_GET_FW_VERSION req = {};
+	GEN_GET_FW_VERSION_ACK rsp;
+
+	req.Header.Fields.Command = GEN_GET_FW_VERSION_CMD;
+	req.Header.Fields.GroupId = MKHI_GEN_GROUP_ID;
+	std::thread fw(MkhiVersionResponder, &dev, (uint8_t)(GEN_GET_FW_VERSION_CMD + 1));
+	try {
+		intel::security::transact<GEN_GET_FW_VERSION, GEN_GET_FW_VERSION_ACK, MkhiCheck>(
+			dev, buffer, req, rsp, 1000);
+		fw.join();
+		FAIL();
+	}
+	catch (const intel::security::metee_exception& ex) {
+		fw.join();
+		EXPECT_EQ(TEE_INTERNAL_ERROR, ex.code().value());
+	}
+}
+
+/*
+Response shorter than the response type is rejected
+*/
+TEST(MeTeePPFakeTEST, TypedTransactShortResponse)
+{
+	fake_device dev;
+	std::vector<uint8_t> buffer;
+	GEN_GET_FW_VERSION req = {};
+	GEN_GET_FW_VERSION_ACK rsp;
+
+	std::thread fw([&dev]() {
+		std::vector<uint8_t> msg = dev.fw_receive(1000);
+		dev.fw_send(msg);
+	});
+	try {
+		intel::security::transact(dev, buffer, req, rsp, 1000);
+		fw.join();
+		FAIL();
+	}
+	catch (const intel::security::metee_exception& ex) {
+		fw.join();
+		EXPECT_EQ(TEE_INTERNAL_ERROR, ex.code().value());
+	}
+}
+
+/*
+Message bigger than client MTU is rejected before write
+*/
+TEST(MeTeePPFakeTEST, TypedTransactBiggerThenMtu)
+{
+	fake_device dev(sizeof(GEN_GET_FW_VERSION));
+	std::vector<uint8_t> buffer;
+	GEN_GET_FW_VERSION req = {};
+	GEN_GET_FW_VERSION_ACK rsp;
+
+	try {
+		intel::security::transact(dev, buffer, req, rsp, 1000);
+		FAIL();
+	}
+	catch (const intel::security::metee_exception& ex) {
+		EXPECT_EQ(TEE_INVALID_PARAMETER, ex.code().value());
+	}
+	EXPECT_TRUE(buffer.empty());
+}
+#endif /* __linux__ */
+
 static struct MeTeeTESTParams interfaces[1] = {
 	{"PCH", NULL, &GUID_DEVINTERFACE_MKHI}};
 
@@ -0,0 +1,216 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2026 Intel Corporation
+ */
+#include "metee_test.h"
+#ifdef __linux__
+#include <fstream>
+#include <ftw.h>
+#include <sys/stat.h>
+#include "meteepp_workers.h"
+#include "fake_device.h"
+
+using intel::security::basic_device_workers;
+using intel::security::device_placement;
+using intel::security::list_placements;
+using intel::security::metee_exception;
+using intel::security::parse_cpulist;
+using intel::security::read_placement;
+
+typedef basic_device_workers<fake_device> fake_workers;
+
+/* mei class directory of a test, removed with the object */
+class fake_sysfs {
+public:
+	fake_sysfs()
+	{
+		char tmpl[] = "/tmp/metee_sysfs_XXXXXX";
+		if (!mkdtemp(tmpl))
+			throw std::runtime_error("mkdtemp failed");
+		_root = tmpl;
+	}
+	~fake_sysfs()
+	{
+		nftw(_root.c_str(), [](const char *path, const struct stat *, int, struct FTW *) {
+			return remove(path);
+		}, 8, FTW_DEPTH | FTW_PHYS);
+	}
+	const std::string& root() const { return _root; }
+
+	void add(const std::string& name, const char *numa_node, const char *cpulist)
+	{
+		std::string dir = _root + "/" + name;
+		mkdir(dir.c_str(), 0755);
+		dir += "/device";
+		mkdir(dir.c_str(), 0755);
+		if (numa_node)
+			std::ofstream(dir + "/numa_node") << numa_node << "\n";
+		if (cpulist)
+			std::ofstream(dir + "/local_cpulist") << cpulist << "\n";
+	}
+private:
+	std::string _root;
+};
+
+/* first CPU the test may run on */
+static unsigned int FirstAllowedCpu()
+{
+	cpu_set_t set;
+
+	if (sched_getaffinity(0, sizeof(set), &set))
+		return 0;
+	for (unsigned int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+		if (CPU_ISSET(cpu, &set))
+			return cpu;
+	}
+	return 0;
+}
+
+TEST(MeTeeWorkersTEST, WORKERS_ParseCpulist)
+{
+	EXPECT_EQ((std::vector<unsigned int>{0, 1, 2, 3, 8, 10, 11}), parse_cpulist("0-3,8,10-11\n"));
+	EXPECT_EQ((std::vector<unsigned int>{5}), parse_cpulist("5"));
+	EXPECT_EQ((std::vector<unsigned int>{1, 2}), parse_cpulist("2,1-2"));
+	EXPECT_TRUE(parse_cpulist("").empty());
+	EXPECT_TRUE(parse_cpulist("3-1").empty());
+	EXPECT_TRUE(parse_cpulist("1,x").empty());
+}
+
+/*
+Devices are listed by number with their node and local CPUs, missing attributes are unknown
+*/
+TEST(MeTeeWorkersTEST, WORKERS_ReadPlacement)
+{
+	fake_sysfs sysfs;
+
+	sysfs.add("mei10", "1", "16-23");
+	sysfs.add("mei0", "0", "0-7");
+	sysfs.add("mei1", "-1", nullptr);
+	sysfs.add("meix", "0", "0");
+
+	std::vector<device_placement> devices = list_placements(sysfs.root());
+	ASSERT_EQ(3u, devices.size());
+	EXPECT_EQ("mei0", devices[0].name);
+	EXPECT_EQ("/dev/mei0", devices[0].path);
+	EXPECT_EQ(0, devices[0].numa_node);
+	EXPECT_EQ(8u, devices[0].cpus.size());
+	EXPECT_EQ("mei1", devices[1].name);
+	EXPECT_EQ(-1, devices[1].numa_node);
+	EXPECT_TRUE(devices[1].cpus.empty());
+	EXPECT_EQ("mei10", devices[2].name);
+	EXPECT_EQ(1, devices[2].numa_node);
+	EXPECT_EQ(16u, devices[2].cpus.front());
+
+	device_placement none = read_placement("mei5", sysfs.root());
+	EXPECT_EQ(-1, none.numa_node);
+	EXPECT_TRUE(none.cpus.empty());
+	EXPECT_TRUE(list_placements(sysfs.root() + "/none").empty());
+}
+
+/*
+Every worker opens its device and runs its jobs on the device local CPUs
+*/
+TEST(MeTeeWorkersTEST, WORKERS_PinnedJobs)
+{
+	const unsigned int cpu = FirstAllowedCpu();
+	fake_sysfs sysfs;
+	std::vector<fake_device *> opened;
+	std::mutex opened_mutex;
+
+	sysfs.add("mei0", "0", std::to_string(cpu).c_str());
+	sysfs.add("mei1", "-1", nullptr);
+
+	std::vector<device_placement> devices = list_placements(sysfs.root());
+	ASSERT_EQ(2u, devices.size());
+	fake_workers workers(devices, [&](const device_placement& p) {
+		std::unique_ptr<fake_device> dev(new fake_device(p.name == "mei0" ? 128 : 256));
+		std::lock_guard<std::mutex> lock(opened_mutex);
+		opened.push_back(dev.get());
+		return dev;
+	});
+
+	ASSERT_EQ(2u, workers.size());
+	EXPECT_EQ(2u, opened.size());
+	EXPECT_TRUE(workers.pinned(0));
+	EXPECT_FALSE(workers.pinned(1));
+	EXPECT_EQ("mei1", workers.placement(1).name);
+
+	int ran_on = -1;
+	size_t buffer_size = 0;
+	workers.submit(0, [&](fake_device& dev, std::vector<uint8_t>& buffer) {
+		ran_on = sched_getcpu();
+		buffer_size = buffer.size();
+		EXPECT_EQ(128u, dev.max_msg_len());
+	}).get();
+	EXPECT_EQ(static_cast<int>(cpu), ran_on);
+	EXPECT_EQ(128u, buffer_size);
+
+	std::vector<size_t> sizes(2);
+	std::mutex sizes_mutex;
+	std::vector<std::future<void>> results = workers.fan_out([&](fake_device& dev, std::vector<uint8_t>& buffer) {
+		std::lock_guard<std::mutex> lock(sizes_mutex);
+		sizes[dev.max_msg_len() == 128 ? 0 : 1] = buffer.size();
+	});
+	ASSERT_EQ(2u, results.size());
+	for (std::future<void>& r : results)
+		r.get();
+	EXPECT_EQ((std::vector<size_t>{128, 256}), sizes);
+
+	std::future<void> failed = workers.submit(1, [](fake_device&, std::vector<uint8_t>&) {
+		throw metee_exception("job failed", TEE_BUSY);
+	});
+	EXPECT_THROW(failed.get(), metee_exception);
+}
+
+/*
+Jobs of a device that failed to open get the open error, other devices keep working
+*/
+TEST(MeTeeWorkersTEST, WORKERS_OpenFailure)
+{
+	fake_sysfs sysfs;
+
+	sysfs.add("mei0", nullptr, nullptr);
+	sysfs.add("mei1", nullptr, nullptr);
+
+	fake_workers workers(list_placements(sysfs.root()), [](const device_placement& p) {
+		if (p.name == "mei1")
+			throw metee_exception("open failed", TEE_DEVICE_NOT_FOUND);
+		return std::unique_ptr<fake_device>(new fake_device());
+	});
+
+	std::vector<std::future<void>> results = workers.fan_out([](fake_device&, std::vector<uint8_t>&) {});
+	ASSERT_EQ(2u, results.size());
+	EXPECT_NO_THROW(results[0].get());
+	try {
+		results[1].get();
+		FAIL() << "job ran without device";
+	}
+	catch (const metee_exception &ex) {
+		EXPECT_EQ(TEE_DEVICE_NOT_FOUND, ex.code().value());
+	}
+}
+
+/*
+Factory returning no device fails the jobs of the device
+*/
+TEST(MeTeeWorkersTEST, WORKERS_NullDevice)
+{
+	fake_sysfs sysfs;
+
+	sysfs.add("mei0", nullptr, nullptr);
+
+	fake_workers workers(list_placements(sysfs.root()), [](const device_placement&) {
+		return std::unique_ptr<fake_device>();
+	});
+
+	std::vector<std::future<void>> results = workers.fan_out([](fake_device&, std::vector<uint8_t>&) {});
+	ASSERT_EQ(1u, results.size());
+	try {
+		results[0].get();
+		FAIL() << "job ran without device";
+	}
+	catch (const metee_exception &ex) {
+		EXPECT_EQ(TEE_INTERNAL_ERROR, ex.code().value());
+	}
+}
+#endif // __linux__